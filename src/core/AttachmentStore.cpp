@@ -0,0 +1,118 @@
+/*
+ *  Copyright (C) 2026 The cpp-password-manager contributors
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "AttachmentStore.h"
+#include "crypto/CryptoHash.h"
+
+AttachmentStore::AttachmentStore(
+	QObject* parent
+)
+	: QObject(
+		parent
+	),
+	totalSize(
+		0
+	)
+{
+}
+
+QByteArray AttachmentStore::digest(
+	const QByteArray &data
+)
+{
+	return CryptoHash::hash(
+		data,
+		CryptoHash::Sha256
+	);
+}
+
+QByteArray AttachmentStore::acquire(
+	const QByteArray &digest,
+	const QByteArray &data
+)
+{
+	auto i_ = this->blobs.find(
+		digest
+	);
+	if(i_ == this->blobs.end())
+	{
+		i_ = this->blobs.insert(
+			digest,
+			{data, 0}
+		);
+		this->totalSize += data.size();
+	}
+	i_->refCount++;
+	return i_->data;
+}
+
+void AttachmentStore::release(
+	const QByteArray &digest
+)
+{
+	const auto i_ = this->blobs.find(
+		digest
+	);
+	if(i_ == this->blobs.end())
+	{
+		return;
+	}
+	i_->refCount--;
+	if(i_->refCount <= 0)
+	{
+		this->totalSize -= i_->data.size();
+		this->blobs.erase(
+			i_
+		);
+	}
+}
+
+bool AttachmentStore::contains(
+	const QByteArray &digest
+) const
+{
+	return this->blobs.contains(
+		digest
+	);
+}
+
+QByteArray AttachmentStore::getData(
+	const QByteArray &digest
+) const
+{
+	return this->blobs.value(
+		digest
+	).data;
+}
+
+int AttachmentStore::getRefCount(
+	const QByteArray &digest
+) const
+{
+	return this->blobs.value(
+		digest
+	).refCount;
+}
+
+int AttachmentStore::count() const
+{
+	return static_cast<int>(this->blobs.size());
+}
+
+qint64 AttachmentStore::getTotalSize() const
+{
+	return this->totalSize;
+}
@@ -0,0 +1,67 @@
+/*
+ *  Copyright (C) 2026 The cpp-password-manager contributors
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef KEEPASSX_ATTACHMENTSTORE_H
+#define KEEPASSX_ATTACHMENTSTORE_H
+#include <QHash>
+#include <QObject>
+
+/**
+* Database wide pool of attachment contents keyed by their SHA-256 digest.
+* Identical attachments of entries and history items share one buffer,
+* the blob is dropped when its last reference is released.
+*/
+class AttachmentStore final:public QObject
+{
+	Q_OBJECT public:
+	explicit AttachmentStore(
+		QObject* parent = nullptr
+	);
+	static QByteArray digest(
+		const QByteArray &data
+	);
+	/**
+	* Adds a reference to the blob and returns the shared copy of its data.
+	*/
+	QByteArray acquire(
+		const QByteArray &digest,
+		const QByteArray &data
+	);
+	void release(
+		const QByteArray &digest
+	);
+	bool contains(
+		const QByteArray &digest
+	) const;
+	QByteArray getData(
+		const QByteArray &digest
+	) const;
+	int getRefCount(
+		const QByteArray &digest
+	) const;
+	int count() const;
+	qint64 getTotalSize() const;
+private:
+	struct Blob
+	{
+		QByteArray data;
+		int refCount;
+	};
+
+	QHash<QByteArray, Blob> blobs;
+	qint64 totalSize;
+};
+#endif // KEEPASSX_ATTACHMENTSTORE_H
@@ -145,6 +145,10 @@ void Config::init(
 		"AutoSaveOnExit",
 		false
 	);
+	this->defaults.insert(
+		"AutoSaveJournal",
+		false
+	);
 	this->defaults.insert(
 		"ShowToolbar",
 		true
@@ -177,6 +181,10 @@ void Config::init(
 		"security/passwordscleartext",
 		false
 	);
+	this->defaults.insert(
+		"search/parallelscanthreshold",
+		20000
+	);
 	this->defaults.insert(
 		"GUI/Language",
 		"system"
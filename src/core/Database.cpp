@@ -18,8 +18,14 @@
 #include <QFile>
 #include <QTimer>
 #include <QXmlStreamReader>
+#include "core/AttachmentStore.h"
+#include "core/EntryDispatcher.h"
+#include "core/Global.h"
 #include "core/Group.h"
 #include "core/Metadata.h"
+#include "core/SearchIndex.h"
+#include "core/StringPool.h"
+#include "core/UrlIndex.h"
 #include "crypto/Random.h"
 #include "format/KeePass2.h"
 QHash<UUID, Database*> Database::uuidMap;
@@ -30,6 +36,31 @@ Database::Database()
 			this
 		)
 	),
+	attachmentStore(
+		new AttachmentStore(
+			this
+		)
+	),
+	stringPool(
+		new StringPool(
+			this
+		)
+	),
+	entryDispatcher(
+		new EntryDispatcher(
+			this
+		)
+	),
+	searchIndex(
+		new SearchIndex(
+			this
+		)
+	),
+	urlIndex(
+		new UrlIndex(
+			this
+		)
+	),
 	timer(
 		new QTimer(
 			this
@@ -38,6 +69,9 @@ Database::Database()
 	emitModified(
 		false
 	),
+	transactionDepth(
+		0
+	),
 	uuid(
 		UUID::random()
 	)
@@ -46,6 +80,8 @@ Database::Database()
 	this->data.compressionAlgo = CompressionGZip;
 	this->data.transformRounds = 100000;
 	this->data.hasKey = false;
+	this->data.formatVersion = KeePass2::FILE_VERSION;
+	this->changes.modified = false;
 	this->setRootGroup(
 		new Group()
 	);
@@ -71,6 +107,30 @@ Database::Database()
 		this,
 		&Database::sig_nameTextChanged
 	);
+	this->connect(
+		this->entryDispatcher,
+		&EntryDispatcher::sig_entryModified,
+		this,
+		&Database::sig_modifiedImmediate
+	);
+	this->connect(
+		this->entryDispatcher,
+		&EntryDispatcher::sig_entryModified,
+		this,
+		&Database::sig_entryModified
+	);
+	this->connect(
+		this,
+		&Database::sig_entryModified,
+		this->searchIndex,
+		&SearchIndex::do_entryModified
+	);
+	this->connect(
+		this,
+		&Database::sig_entryModified,
+		this->urlIndex,
+		&UrlIndex::do_entryModified
+	);
 	this->connect(
 		this,
 		&Database::sig_modifiedImmediate,
@@ -83,10 +143,23 @@ Database::Database()
 		this,
 		&Database::sig_modified
 	);
+	// values replaced by the edits are dropped from the pool once they settle
+	this->connect(
+		this->timer,
+		&QTimer::timeout,
+		this->stringPool,
+		&StringPool::squeeze
+	);
 }
 
 Database::~Database()
 {
+	// the whole tree goes, so the indexes are dropped at once instead of
+	// letting every entry remove itself. The tree still goes before the
+	// members and the other children
+	this->searchIndex->clear();
+	this->urlIndex->clear();
+	delete this->rootGroup;
 	this->uuidMap.remove(
 		this->uuid
 	);
@@ -126,74 +199,172 @@ const Metadata* Database::getMetadata() const
 	return this->metadata;
 }
 
+AttachmentStore* Database::getAttachmentStore()
+{
+	return this->attachmentStore;
+}
+
+const AttachmentStore* Database::getAttachmentStore() const
+{
+	return this->attachmentStore;
+}
+
+StringPool* Database::getStringPool()
+{
+	return this->stringPool;
+}
+
+const StringPool* Database::getStringPool() const
+{
+	return this->stringPool;
+}
+
+EntryDispatcher* Database::getEntryDispatcher()
+{
+	return this->entryDispatcher;
+}
+
+SearchIndex* Database::getSearchIndex() const
+{
+	return this->searchIndex;
+}
+
+UrlIndex* Database::getUrlIndex() const
+{
+	return this->urlIndex;
+}
+
 Entry* Database::resolveEntry(
 	const UUID &uuid
 )
 {
-	return this->recFindEntry(
+	return this->entryIndex.value(
 		uuid,
-		this->rootGroup
+		nullptr
 	);
 }
 
-Entry* Database::recFindEntry(
-	const UUID &uuid,
-	Group* group
+const Entry* Database::resolveEntry(
+	const UUID &uuid
+) const
+{
+	return this->entryIndex.value(
+		uuid,
+		nullptr
+	);
+}
+
+Group* Database::resolveGroup(
+	const UUID &uuid
 )
 {
-	const QList<Entry*> entryList_ = group->getEntries();
-	for(Entry* entry_: entryList_)
+	return this->groupIndex.value(
+		uuid,
+		nullptr
+	);
+}
+
+bool Database::containsEntry(
+	const UUID &uuid,
+	const Entry* entry
+) const
+{
+	for(auto it_ = this->entryIndex.constFind(
+			uuid
+		); it_ != this->entryIndex.constEnd() && it_.key() == uuid; ++it_)
 	{
-		if(entry_->getUUID() == uuid)
+		if(it_.value() == entry)
 		{
-			return entry_;
+			return true;
 		}
 	}
-	const QList<Group*> children_ = group->getChildren();
-	for(Group* child_: children_)
+	return false;
+}
+
+bool Database::isIndexConsistent() const
+{
+	qsizetype groupCount_ = 0;
+	qsizetype entryCount_ = 0;
+	for(const Group* group_: this->rootGroup->groupsRecursive(
+			true
+		))
 	{
-		if(Entry* result_ = this->recFindEntry(
-			uuid,
-			child_
+		if(!this->groupIndex.contains(
+			group_->getUUID(),
+			const_cast<Group*>(group_)
 		))
 		{
-			return result_;
+			return false;
+		}
+		for(Entry* entry_: group_->getEntries())
+		{
+			if(!this->entryIndex.contains(
+				entry_->getUUID(),
+				entry_
+			))
+			{
+				return false;
+			}
 		}
+		groupCount_++;
+		entryCount_ += group_->getEntries().size();
 	}
-	return nullptr;
+	// everything in the tree is indexed, so the sizes only match if there
+	// are no stale items left
+	return this->groupIndex.size() == groupCount_ && this->entryIndex.size()
+		== entryCount_;
 }
 
-Group* Database::resolveGroup(
-	const UUID &uuid
+void Database::indexEntry(
+	Entry* entry
 )
 {
-	return this->recFindGroup(
-		uuid,
-		this->rootGroup
+	this->entryIndex.insert(
+		entry->getUUID(),
+		entry
+	);
+	this->searchIndex->insert(
+		entry
+	);
+	this->urlIndex->insert(
+		entry
 	);
 }
 
-Group* Database::recFindGroup(
-	const UUID &uuid,
+void Database::unindexEntry(
+	Entry* entry
+)
+{
+	this->entryIndex.remove(
+		entry->getUUID(),
+		entry
+	);
+	this->searchIndex->remove(
+		entry
+	);
+	this->urlIndex->remove(
+		entry
+	);
+}
+
+void Database::indexGroup(
 	Group* group
 )
 {
-	if(group->getUUID() == uuid)
-	{
-		return group;
-	}
-	const QList<Group*> children_ = group->getChildren();
-	for(Group* child_: children_)
-	{
-		if(Group* result_ = this->recFindGroup(
-			uuid,
-			child_
-		))
-		{
-			return result_;
-		}
-	}
-	return nullptr;
+	this->groupIndex.insert(
+		group->getUUID(),
+		group
+	);
+}
+
+void Database::unindexGroup(
+	Group* group
+)
+{
+	this->groupIndex.remove(
+		group->getUUID(),
+		group
+	);
 }
 
 QList<DeletedObject> Database::getDeletedObjects()
@@ -226,6 +397,27 @@ void Database::addDeletedObject(
 	);
 }
 
+void Database::setDeletionTime(
+	const UUID &uuid,
+	const QDateTime &deletionTime
+)
+{
+	if(deletionTime.timeSpec() != Qt::UTC)
+	{
+		return;
+	}
+	for(qsizetype i_ = this->deletedObjects.size() - 1; i_ >= 0; --i_)
+	{
+		if(this->deletedObjects.at(
+			i_
+		).uuid == uuid)
+		{
+			this->deletedObjects[i_].deletionTime = deletionTime;
+			return;
+		}
+	}
+}
+
 UUID Database::getCipher() const
 {
 	return this->data.cipher;
@@ -246,6 +438,30 @@ quint64 Database::transformRounds() const
 	return this->data.transformRounds;
 }
 
+QByteArray Database::getHeaderHash() const
+{
+	return this->data.headerHash;
+}
+
+void Database::setHeaderHash(
+	const QByteArray &headerHash
+)
+{
+	this->data.headerHash = headerHash;
+}
+
+quint32 Database::getFormatVersion() const
+{
+	return this->data.formatVersion;
+}
+
+void Database::setFormatVersion(
+	const quint32 version
+)
+{
+	this->data.formatVersion = version;
+}
+
 QByteArray Database::transformedMasterKey() const
 {
 	return this->data.transformedMasterKey;
@@ -417,6 +633,167 @@ void Database::setEmitModified(
 	this->emitModified = value;
 }
 
+void Database::beginTransaction()
+{
+	if(this->transactionDepth++ == 0)
+	{
+		sig_transactionStarted();
+	}
+}
+
+void Database::commitTransaction()
+{
+	if(this->transactionDepth == 0 || --this->transactionDepth > 0)
+	{
+		return;
+	}
+	const DatabaseChanges changes_ = this->changes;
+	this->changes = DatabaseChanges();
+	this->changes.modified = false;
+	sig_transactionCommitted(
+		changes_
+	);
+	// the per object notifications that were held back, each object once. a
+	// group added from another database brings its subtree along
+	QSet<Group*> groups_ = changes_.modifiedGroups;
+	QSet<Entry*> addedEntries_ = changes_.addedEntries;
+	for(Group* group_: changes_.addedGroups)
+	{
+		if(group_->getDatabase() != this)
+		{
+			continue;
+		}
+		for(Group* child_: group_->groupsRecursive(
+				true
+			))
+		{
+			groups_.insert(
+				child_
+			);
+			for(Entry* entry_: child_->getEntries())
+			{
+				addedEntries_.insert(
+					entry_
+				);
+			}
+		}
+	}
+	for(Group* group_: asConst(
+			groups_
+		))
+	{
+		sig_groupModified(
+			group_
+		);
+	}
+	for(Entry* entry_: asConst(
+			addedEntries_
+		))
+	{
+		sig_entryAdded(
+			entry_
+		);
+	}
+	for(Entry* entry_: changes_.modifiedEntries)
+	{
+		if(!addedEntries_.contains(
+			entry_
+		))
+		{
+			sig_entryModified(
+				entry_
+			);
+		}
+	}
+	if(changes_.modified)
+	{
+		sig_modifiedImmediate();
+	}
+}
+
+bool Database::isInTransaction() const
+{
+	return this->transactionDepth > 0;
+}
+
+void Database::recordGroupAdded(
+	Group* group
+)
+{
+	this->changes.addedGroups.insert(
+		group
+	);
+	this->changes.modified = true;
+}
+
+void Database::recordGroupModified(
+	Group* group
+)
+{
+	this->changes.modifiedGroups.insert(
+		group
+	);
+	this->changes.modified = true;
+}
+
+void Database::recordEntryAdded(
+	Entry* entry
+)
+{
+	this->changes.addedEntries.insert(
+		entry
+	);
+	this->changes.modified = true;
+}
+
+void Database::recordEntryModified(
+	Entry* entry
+)
+{
+	this->changes.modifiedEntries.insert(
+		entry
+	);
+	this->changes.modified = true;
+}
+
+void Database::recordEntryRemoved(
+	Entry* entry
+)
+{
+	// the entry may be deleted next, only its address stays in the changes
+	this->changes.addedEntries.remove(
+		entry
+	);
+	this->changes.modifiedEntries.remove(
+		entry
+	);
+	this->changes.removedEntries.insert(
+		entry
+	);
+	this->changes.modified = true;
+}
+
+void Database::forgetGroup(
+	Group* group
+)
+{
+	this->changes.addedGroups.remove(
+		group
+	);
+	this->changes.modifiedGroups.remove(
+		group
+	);
+	for(Entry* entry_: group->getEntries())
+	{
+		this->changes.addedEntries.remove(
+			entry_
+		);
+		this->changes.modifiedEntries.remove(
+			entry_
+		);
+	}
+}
+
 void Database::copyAttributesFrom(
 	const Database* other
 )
@@ -442,8 +819,13 @@ Database* Database::databaseByUUID(
 	);
 }
 
-void Database::do_startModifiedTimer() const
+void Database::do_startModifiedTimer()
 {
+	if(this->transactionDepth > 0)
+	{
+		this->changes.modified = true;
+		return;
+	}
 	if(!this->emitModified)
 	{
 		return;
@@ -456,3 +838,15 @@ void Database::do_startModifiedTimer() const
 		150
 	);
 }
+
+void Database::do_groupModified()
+{
+	if(const auto group_ = qobject_cast<Group*>(
+		this->sender()
+	))
+	{
+		sig_groupModified(
+			group_
+		);
+	}
+}
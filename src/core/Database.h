@@ -18,13 +18,20 @@
 #define KEEPASSX_DATABASE_H
 #include <QDateTime>
 #include <QHash>
+#include <QMultiHash>
 #include <QObject>
+#include <QSet>
 #include "core/UUID.h"
 #include "keys/CompositeKey.h"
+class AttachmentStore;
 class Entry;
+class EntryDispatcher;
 class Group;
 class Metadata;
 class QTimer;
+class SearchIndex;
+class UrlIndex;
+class StringPool;
 
 struct DeletedObject
 {
@@ -37,8 +44,25 @@ Q_DECLARE_TYPEINFO(
 	Q_MOVABLE_TYPE
 );
 
+/**
+* Changes collected while a transaction of the database is open, reported
+* at once when the outermost transaction is committed.
+*/
+struct DatabaseChanges
+{
+	QSet<Group*> addedGroups;
+	QSet<Group*> modifiedGroups;
+	QSet<Entry*> addedEntries;
+	QSet<Entry*> modifiedEntries;
+	// entries taken out of a group, they may have been deleted since
+	QSet<const Entry*> removedEntries;
+	bool modified;
+};
+
 class Database final:public QObject
 {
+	friend class Entry;
+	friend class Group;
 	Q_OBJECT public:
 	enum CompressionAlgorithm: u_int8_t
 	{
@@ -57,6 +81,8 @@ class Database final:public QObject
 		QByteArray transformedMasterKey;
 		CompositeKey key;
 		bool hasKey;
+		QByteArray headerHash;
+		quint32 formatVersion;
 	};
 
 	Database();
@@ -75,12 +101,43 @@ class Database final:public QObject
 	);
 	Metadata* getMetadata();
 	const Metadata* getMetadata() const;
+	AttachmentStore* getAttachmentStore();
+	const AttachmentStore* getAttachmentStore() const;
+	StringPool* getStringPool();
+	const StringPool* getStringPool() const;
+	EntryDispatcher* getEntryDispatcher();
+	/**
+	* Returns the search index of the entries. The index is a cache, a
+	* lookup through a const database may still bring it up to date.
+	*/
+	SearchIndex* getSearchIndex() const;
+	/**
+	* Returns the index of the entries by the host of their URL, a cache
+	* like the search index.
+	*/
+	UrlIndex* getUrlIndex() const;
 	Entry* resolveEntry(
 		const UUID &uuid
 	);
+	const Entry* resolveEntry(
+		const UUID &uuid
+	) const;
 	Group* resolveGroup(
 		const UUID &uuid
 	);
+	/**
+	* Returns whether entry is still in the database under uuid. The entry
+	* isn't looked at, it may have been deleted.
+	*/
+	bool containsEntry(
+		const UUID &uuid,
+		const Entry* entry
+	) const;
+	/**
+	* Compares the UUID index used by resolveEntry() and resolveGroup() with
+	* the group tree. Walks the whole tree, meant for tests and debugging.
+	*/
+	bool isIndexConsistent() const;
 	QList<DeletedObject> getDeletedObjects();
 	void addDeletedObject(
 		const DeletedObject &delObj
@@ -88,11 +145,36 @@ class Database final:public QObject
 	void addDeletedObject(
 		const UUID &uuid
 	);
+	/**
+	* Sets the deletion time of the newest deleted object with the given
+	* UUID, for replaying a deletion that happened at another time.
+	*/
+	void setDeletionTime(
+		const UUID &uuid,
+		const QDateTime &deletionTime
+	);
 	UUID getCipher() const;
 	CompressionAlgorithm getCompressionAlgo() const;
 	QByteArray transformSeed() const;
 	quint64 transformRounds() const;
 	QByteArray transformedMasterKey() const;
+	/**
+	* Returns the header hash of the file the database was read from, empty
+	* for databases that weren't read from a file.
+	*/
+	QByteArray getHeaderHash() const;
+	void setHeaderHash(
+		const QByteArray &headerHash
+	);
+	/**
+	* Returns the KDBX version the database is written in,
+	* KeePass2::FILE_VERSION for new databases and the version of the file
+	* for databases that were read.
+	*/
+	quint32 getFormatVersion() const;
+	void setFormatVersion(
+		quint32 version
+	);
 	void setCipher(
 		const UUID &cipher
 	);
@@ -126,6 +208,14 @@ class Database final:public QObject
 	void setEmitModified(
 		bool value
 	);
+	/**
+	* Opens a transaction. Until the matching commitTransaction() the groups
+	* and entries of the database don't emit their change signals, the
+	* changes are merged and reported once at commit. Transactions nest.
+	*/
+	void beginTransaction();
+	void commitTransaction();
+	bool isInTransaction() const;
 	void copyAttributesFrom(
 		const Database* other
 	);
@@ -155,27 +245,85 @@ Q_SIGNALS:
 		int index
 	);
 	void sig_groupMoved();
+	/**
+	* Emitted when a group of the database or its properties change.
+	*/
+	void sig_groupModified(
+		Group* group
+	);
+	/**
+	* Emitted when an entry is added to or moved within the database.
+	*/
+	void sig_entryAdded(
+		Entry* entry
+	);
+	void sig_entryModified(
+		Entry* entry
+	);
 	void sig_nameTextChanged();
 	void sig_modified();
 	void sig_modifiedImmediate();
+	/**
+	* Emitted when the outermost transaction opens, before any change.
+	*/
+	void sig_transactionStarted();
+	/**
+	* Emitted when the outermost transaction is committed. Models apply the
+	* changes as a single layout change.
+	*/
+	void sig_transactionCommitted(
+		const DatabaseChanges &changes
+	);
 private Q_SLOTS:
-	void do_startModifiedTimer() const;
+	void do_startModifiedTimer();
+	void do_groupModified();
 private:
-	Entry* recFindEntry(
-		const UUID &uuid,
+	void indexEntry(
+		Entry* entry
+	);
+	void unindexEntry(
+		Entry* entry
+	);
+	void indexGroup(
 		Group* group
 	);
-	Group* recFindGroup(
-		const UUID &uuid,
+	void unindexGroup(
+		Group* group
+	);
+	void recordGroupAdded(
+		Group* group
+	);
+	void recordGroupModified(
+		Group* group
+	);
+	void recordEntryAdded(
+		Entry* entry
+	);
+	void recordEntryModified(
+		Entry* entry
+	);
+	void recordEntryRemoved(
+		Entry* entry
+	);
+	void forgetGroup(
 		Group* group
 	);
 	void createRecycleBin();
 	Metadata* const metadata;
+	AttachmentStore* const attachmentStore;
+	StringPool* const stringPool;
+	EntryDispatcher* const entryDispatcher;
+	SearchIndex* const searchIndex;
+	UrlIndex* const urlIndex;
 	Group* rootGroup;
 	QList<DeletedObject> deletedObjects;
+	QMultiHash<UUID, Entry*> entryIndex;
+	QMultiHash<UUID, Group*> groupIndex;
 	QTimer* timer;
 	DatabaseData data;
 	bool emitModified;
+	int transactionDepth;
+	DatabaseChanges changes;
 	UUID uuid;
 	static QHash<UUID, Database*> uuidMap;
 };
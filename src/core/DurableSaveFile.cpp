@@ -0,0 +1,466 @@
+/*
+ *  Copyright (C) 2026 The cpp-password-manager contributors
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "DurableSaveFile.h"
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#if defined(Q_OS_WIN)
+#include <io.h>
+#include <windows.h>
+#elif defined(Q_OS_UNIX)
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+const qint64 DurableSaveFile::ChunkSize = 1024 * 1024;
+
+static QString resolveTarget(
+	const QString &fileName
+)
+{
+	// replace the file a symlink points to instead of the link itself
+	const QFileInfo fileInfo_(
+		fileName
+	);
+	if(fileInfo_.exists())
+	{
+		return fileInfo_.canonicalFilePath();
+	}
+	return fileInfo_.absoluteFilePath();
+}
+
+DurableSaveFile::DurableSaveFile(
+	const QString &fileName,
+	QObject* parent
+)
+	: QIODevice(
+		parent
+	),
+	fileName(
+		resolveTarget(
+			fileName
+		)
+	),
+	tempFile(
+		this->fileName + ".XXXXXX"
+	),
+	sizeHint(
+		0
+	),
+	written(
+		0
+	),
+	error(
+		false
+	),
+	committed(
+		false
+	)
+{
+	this->tempFile.setAutoRemove(
+		false
+	);
+}
+
+DurableSaveFile::~DurableSaveFile()
+{
+	if(this->isOpen())
+	{
+		this->cancelWriting();
+	}
+}
+
+QString DurableSaveFile::getFileName() const
+{
+	return this->fileName;
+}
+
+void DurableSaveFile::setSizeHint(
+	const qint64 size
+)
+{
+	this->sizeHint = size;
+}
+
+bool DurableSaveFile::isSequential() const
+{
+	return true;
+}
+
+bool DurableSaveFile::open(
+	OpenMode mode
+)
+{
+	if(this->isOpen())
+	{
+		qWarning(
+			"DurableSaveFile::open: File is already open."
+		);
+		return false;
+	}
+	if((mode & ReadOnly) || !(mode & WriteOnly) || (mode & Append))
+	{
+		qWarning(
+			"DurableSaveFile::open: Only WriteOnly mode is supported."
+		);
+		return false;
+	}
+	this->error = false;
+	this->committed = false;
+	this->written = 0;
+	if(!this->tempFile.open())
+	{
+		this->setErrorString(
+			this->tempFile.errorString()
+		);
+		return false;
+	}
+	// new databases stay private to the owner
+	if(const QFileInfo target_(
+		this->fileName
+	); target_.exists())
+	{
+		this->tempFile.setPermissions(
+			target_.permissions()
+		);
+	}
+#if defined(Q_OS_LINUX)
+	// reserve the blocks up front so the file isn't extended chunk by chunk,
+	// not every file system supports this so failures are ignored
+	if(this->sizeHint > 0)
+	{
+		posix_fallocate(
+			this->tempFile.handle(),
+			0,
+			this->sizeHint
+		);
+	}
+#endif
+	this->buffer.reserve(
+		ChunkSize
+	);
+	this->buffer.resize(
+		0
+	);
+	if(!QIODevice::open(
+		mode | Unbuffered
+	))
+	{
+		this->cancelWriting();
+		return false;
+	}
+	Q_EMIT this->sig_stageReached(
+		TemporaryCreated
+	);
+	return true;
+}
+
+bool DurableSaveFile::commit()
+{
+	if(!this->isOpen())
+	{
+		qWarning(
+			"DurableSaveFile::commit: File is not open."
+		);
+		return false;
+	}
+	if(!this->error && !this->buffer.isEmpty())
+	{
+		this->writeChunk(
+			this->buffer.constData(),
+			this->buffer.size()
+		);
+		this->buffer.resize(
+			0
+		);
+	}
+	// drop the preallocated tail if the hint was too large
+	if(!this->error && this->tempFile.size() != this->written && !this->
+		tempFile.resize(
+			this->written
+		))
+	{
+		this->raiseError(
+			this->tempFile.errorString()
+		);
+	}
+	if(!this->error)
+	{
+		if(this->syncFile(
+			&this->tempFile
+		))
+		{
+			Q_EMIT this->sig_stageReached(
+				DataSynced
+			);
+		}
+		else
+		{
+			this->raiseError(
+				this->tempFile.errorString()
+			);
+		}
+	}
+	if(this->error)
+	{
+		const QString errorString_ = this->errorString();
+		this->cancelWriting();
+		this->setErrorString(
+			errorString_
+		);
+		return false;
+	}
+	this->tempFile.close();
+	if(!this->replaceTarget())
+	{
+		const QString errorString_ = this->errorString();
+		this->cancelWriting();
+		this->setErrorString(
+			errorString_
+		);
+		return false;
+	}
+	this->committed = true;
+	QIODevice::close();
+	Q_EMIT this->sig_stageReached(
+		Renamed
+	);
+	// the new file is in place already, a failure here only means the rename
+	// might not survive a power loss
+	if(this->syncDirectory())
+	{
+		Q_EMIT this->sig_stageReached(
+			DirectorySynced
+		);
+	}
+	else
+	{
+		qWarning(
+			"DurableSaveFile::commit: Syncing the directory failed."
+		);
+	}
+	return true;
+}
+
+void DurableSaveFile::cancelWriting()
+{
+	if(!this->committed && !this->tempFile.fileName().isEmpty())
+	{
+		this->tempFile.remove();
+	}
+	this->buffer.resize(
+		0
+	);
+	if(this->isOpen())
+	{
+		QIODevice::close();
+	}
+}
+
+bool DurableSaveFile::syncFile(
+	QFileDevice* file
+)
+{
+	if(!file->flush())
+	{
+		return false;
+	}
+#if defined(Q_OS_WIN)
+	return _commit(
+		file->handle()
+	) == 0;
+#elif defined(Q_OS_MACOS)
+	return fsync(
+		file->handle()
+	) == 0;
+#elif defined(Q_OS_UNIX)
+	return fdatasync(
+		file->handle()
+	) == 0;
+#else
+	return true;
+#endif
+}
+
+qint64 DurableSaveFile::readData(
+	char* data,
+	const qint64 maxSize
+)
+{
+	Q_UNUSED(
+		data
+	);
+	Q_UNUSED(
+		maxSize
+	);
+	return -1;
+}
+
+qint64 DurableSaveFile::writeData(
+	const char* data,
+	const qint64 maxSize
+)
+{
+	if(this->error)
+	{
+		return -1;
+	}
+	qint64 pos_ = 0;
+	while(pos_ < maxSize)
+	{
+		const qint64 count_ = qMin(
+			maxSize - pos_,
+			ChunkSize - this->buffer.size()
+		);
+		if(this->buffer.isEmpty() && count_ == ChunkSize)
+		{
+			// whole chunks bypass the buffer
+			if(!this->writeChunk(
+				data + pos_,
+				count_
+			))
+			{
+				return -1;
+			}
+		}
+		else
+		{
+			this->buffer.append(
+				data + pos_,
+				count_
+			);
+			if(this->buffer.size() == ChunkSize)
+			{
+				if(!this->writeChunk(
+					this->buffer.constData(),
+					ChunkSize
+				))
+				{
+					return -1;
+				}
+				this->buffer.resize(
+					0
+				);
+			}
+		}
+		pos_ += count_;
+	}
+	return maxSize;
+}
+
+bool DurableSaveFile::writeChunk(
+	const char* data,
+	const qint64 size
+)
+{
+	if(this->tempFile.write(
+		data,
+		size
+	) != size)
+	{
+		this->raiseError(
+			this->tempFile.errorString()
+		);
+		return false;
+	}
+	this->written += size;
+	Q_EMIT this->sig_stageReached(
+		ChunkWritten
+	);
+	return true;
+}
+
+bool DurableSaveFile::replaceTarget()
+{
+	const QString tempFileName_ = this->tempFile.fileName();
+#if defined(Q_OS_WIN)
+	// MOVEFILE_WRITE_THROUGH returns after the rename is on disk
+	if(!MoveFileExW(
+		reinterpret_cast<const wchar_t*>(QDir::toNativeSeparators(
+			tempFileName_
+		).utf16()),
+		reinterpret_cast<const wchar_t*>(QDir::toNativeSeparators(
+			this->fileName
+		).utf16()),
+		MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH
+	))
+	{
+		this->setErrorString(
+			qt_error_string(
+				GetLastError()
+			)
+		);
+		return false;
+	}
+#else
+	if(::rename(
+		QFile::encodeName(
+			tempFileName_
+		).constData(),
+		QFile::encodeName(
+			this->fileName
+		).constData()
+	) != 0)
+	{
+		this->setErrorString(
+			qt_error_string(
+				errno
+			)
+		);
+		return false;
+	}
+#endif
+	return true;
+}
+
+bool DurableSaveFile::syncDirectory() const
+{
+#if defined(Q_OS_UNIX)
+	const int fd_ = ::open(
+		QFile::encodeName(
+			QFileInfo(
+				this->fileName
+			).absolutePath()
+		).constData(),
+		O_RDONLY
+	);
+	if(fd_ < 0)
+	{
+		return false;
+	}
+	const bool success_ = fsync(
+		fd_
+	) == 0;
+	::close(
+		fd_
+	);
+	return success_;
+#else
+	return true;
+#endif
+}
+
+void DurableSaveFile::raiseError(
+	const QString &errorMessage
+)
+{
+	this->error = true;
+	this->setErrorString(
+		errorMessage
+	);
+}
@@ -0,0 +1,101 @@
+/*
+ *  Copyright (C) 2026 The cpp-password-manager contributors
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef KEEPASSX_DURABLESAVEFILE_H
+#define KEEPASSX_DURABLESAVEFILE_H
+#include <QIODevice>
+#include <QTemporaryFile>
+class QFileDevice;
+
+/**
+* Write-only device that atomically replaces a file, similar to QSaveFile.
+* The data goes into a temporary file next to the target that is preallocated
+* to the size hint and written in aligned chunks. On commit the temporary
+* file is synced with fdatasync() and renamed over the target, the directory
+* is synced only after the rename since nothing before it needs to survive
+* a crash. Until the rename succeeds the previous file stays untouched.
+*/
+class DurableSaveFile final:public QIODevice
+{
+	Q_OBJECT public:
+	enum Stage: u_int8_t
+	{
+		TemporaryCreated,
+		ChunkWritten,
+		DataSynced,
+		Renamed,
+		DirectorySynced
+	};
+
+	static const qint64 ChunkSize;
+	explicit DurableSaveFile(
+		const QString &fileName,
+		QObject* parent = nullptr
+	);
+	~DurableSaveFile() override;
+	QString getFileName() const;
+	void setSizeHint(
+		qint64 size
+	);
+	bool isSequential() const override;
+	bool open(
+		OpenMode mode
+	) override;
+	bool commit();
+	void cancelWriting();
+	/**
+	* Flushes the file contents to the storage device, skipping metadata
+	* where the platform allows it.
+	*/
+	static bool syncFile(
+		QFileDevice* file
+	);
+Q_SIGNALS:
+	/**
+	* Emitted synchronously whenever a stage of the save completed. The files
+	* on disk at that point are what a crash would leave behind.
+	*/
+	void sig_stageReached(
+		DurableSaveFile::Stage stage
+	);
+protected:
+	qint64 readData(
+		char* data,
+		qint64 maxSize
+	) override;
+	qint64 writeData(
+		const char* data,
+		qint64 maxSize
+	) override;
+private:
+	bool writeChunk(
+		const char* data,
+		qint64 size
+	);
+	bool replaceTarget();
+	bool syncDirectory() const;
+	void raiseError(
+		const QString &errorMessage
+	);
+	const QString fileName;
+	QTemporaryFile tempFile;
+	QByteArray buffer;
+	qint64 sizeHint;
+	qint64 written;
+	bool error;
+	bool committed;
+};
+#endif // KEEPASSX_DURABLESAVEFILE_H
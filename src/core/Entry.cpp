@@ -15,22 +15,31 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "Entry.h"
+#include <QScopedPointer>
+#include "core/AttachmentStore.h"
 #include "core/Database.h"
 #include "core/DatabaseIcons.h"
+#include "core/EntryDispatcher.h"
+#include "core/Global.h"
 #include "core/Group.h"
+#include "core/ListDeleter.h"
 #include "core/Metadata.h"
+#include "core/PlaceholderTemplate.h"
+#include "core/SearchIndex.h"
 const int Entry::DefaultIconNumber = 0;
 
 Entry::Entry()
 	: attributes(
-		new EntryAttributes(
-			this
-		)
+		new EntryAttributes()
 	),
 	attachments(
-		new EntryAttachments(
-			this
-		)
+		new EntryAttachments()
+	),
+	historyAttributesSize(
+		0
+	),
+	historyAttachmentsSize(
+		0
 	),
 	tmpHistoryItem(
 		nullptr
@@ -43,36 +52,8 @@ Entry::Entry()
 	)
 {
 	this->data.iconNumber = this->DefaultIconNumber;
-	this->connect(
-		this->attributes,
-		&EntryAttributes::sig_modified,
-		this,
-		&Entry::sig_modified
-	);
-	this->connect(
-		this->attributes,
-		&EntryAttributes::sig_defaultKeyModified,
-		this,
-		&Entry::do_emitDataChanged
-	);
-	this->connect(
-		this->attachments,
-		&EntryAttachments::sig_modified,
-		this,
-		&Entry::sig_modified
-	);
-	this->connect(
-		this,
-		&Entry::sig_modified,
-		this,
-		&Entry::do_updateTimeinfo
-	);
-	this->connect(
-		this,
-		&Entry::sig_modified,
-		this,
-		&Entry::do_updateModifiedSinceBegin
-	);
+	this->attributes->owner = this;
+	this->attachments->owner = this;
 }
 
 Entry::~Entry()
@@ -89,9 +70,9 @@ Entry::~Entry()
 			);
 		}
 	}
-	qDeleteAll(
-		this->history
-	);
+	this->clearHistoryDeltas();
+	delete this->attachments;
+	delete this->attributes;
 }
 
 template<class T> inline bool Entry::set(
@@ -102,13 +83,13 @@ template<class T> inline bool Entry::set(
 	if(property != value)
 	{
 		property = value;
-		 sig_modified();
+		this->notifyModified();
 		return true;
 	}
 	return false;
 }
 
-void Entry::do_updateTimeinfo()
+void Entry::notifyModified()
 {
 	if(this->updateTimeinfo)
 	{
@@ -119,6 +100,35 @@ void Entry::do_updateTimeinfo()
 			QDateTime::currentDateTimeUtc()
 		);
 	}
+	this->modifiedSinceBegin = true;
+	Database* db_ = this->getGroupDatabase();
+	if(!db_)
+	{
+		return;
+	}
+	if(db_->isInTransaction())
+	{
+		db_->recordEntryModified(
+			this
+		);
+		return;
+	}
+	db_->getEntryDispatcher()->dispatchModified(
+		this
+	);
+}
+
+void Entry::notifyDataChanged()
+{
+	Database* db_ = this->getGroupDatabase();
+	// the layout change at commit refreshes the data of all entries
+	if(!db_ || db_->isInTransaction())
+	{
+		return;
+	}
+	db_->getEntryDispatcher()->dispatchDataChanged(
+		this
+	);
 }
 
 void Entry::setUpdateTimeinfo(
@@ -231,35 +241,35 @@ TimeInfo Entry::getTimeInfo() const
 QString Entry::getTitle() const
 {
 	return this->attributes->getValue(
-		EntryAttributes::TitleKey
+		EntryAttributes::Title
 	);
 }
 
 QString Entry::getURL() const
 {
 	return this->attributes->getValue(
-		EntryAttributes::URLKey
+		EntryAttributes::URL
 	);
 }
 
 QString Entry::getUsername() const
 {
 	return this->attributes->getValue(
-		EntryAttributes::UserNameKey
+		EntryAttributes::UserName
 	);
 }
 
 QString Entry::getPassword() const
 {
 	return this->attributes->getValue(
-		EntryAttributes::PasswordKey
+		EntryAttributes::Password
 	);
 }
 
 QString Entry::getNotes() const
 {
 	return this->attributes->getValue(
-		EntryAttributes::NotesKey
+		EntryAttributes::Notes
 	);
 }
 
@@ -297,10 +307,23 @@ void Entry::setUUID(
 	{
 		return;
 	};
+	Database* db_ = this->group ? this->group->getDatabase() : nullptr;
+	if(db_)
+	{
+		db_->unindexEntry(
+			this
+		);
+	}
 	this->set(
 		this->uuid,
 		uuid
 	);
+	if(db_)
+	{
+		db_->indexEntry(
+			this
+		);
+	}
 }
 
 void Entry::setIcon(
@@ -315,8 +338,8 @@ void Entry::setIcon(
 	{
 		this->data.iconNumber = iconNumber;
 		this->data.customIcon = UUID();
-		 sig_modified();
-		this->do_emitDataChanged();
+		this->notifyModified();
+		this->notifyDataChanged();
 	}
 }
 
@@ -332,8 +355,8 @@ void Entry::setIcon(
 	{
 		this->data.customIcon = uuid;
 		this->data.iconNumber = 0;
-		 sig_modified();
-		this->do_emitDataChanged();
+		this->notifyModified();
+		this->notifyDataChanged();
 	}
 }
 
@@ -381,7 +404,16 @@ void Entry::setTimeInfo(
 	const TimeInfo &timeInfo
 )
 {
+	const bool lastModifiedChanged_ = this->data.timeInfo.
+		getLastModificationTime() != timeInfo.getLastModificationTime();
 	this->data.timeInfo = timeInfo;
+	// the search index keeps the modification time for ranking
+	if(Database* db_ = this->getGroupDatabase(); db_ && lastModifiedChanged_)
+	{
+		db_->getSearchIndex()->do_entryModified(
+			this
+		);
+	}
 }
 
 void Entry::setTitle(
@@ -458,7 +490,7 @@ void Entry::setExpires(
 		this->data.timeInfo.setExpires(
 			value
 		);
-		 sig_modified();
+		this->notifyModified();
 	}
 }
 
@@ -471,64 +503,329 @@ void Entry::setExpiryTime(
 		this->data.timeInfo.setExpiryTime(
 			dateTime
 		);
-		 sig_modified();
+		this->notifyModified();
+	}
+}
+
+int Entry::getHistoryCount() const
+{
+	return static_cast<int>(this->historyDeltas.size());
+}
+
+QSet<UUID> Entry::getHistoryCustomIcons() const
+{
+	QSet<UUID> icons_;
+	for(const EntryDelta &delta_: asConst(
+			this->historyDeltas
+		))
+	{
+		if(!delta_.getData().customIcon.isNull())
+		{
+			icons_.insert(
+				delta_.getData().customIcon
+			);
+		}
+	}
+	return icons_;
+}
+
+QList<QPair<QByteArray, QByteArray>> Entry::getHistoryAttachments() const
+{
+	QList<QPair<QByteArray, QByteArray>> attachments_;
+	// every attachment of the history is carried by at least one delta
+	for(const EntryDelta &delta_: asConst(
+			this->historyDeltas
+		))
+	{
+		attachments_.append(
+			delta_.getAttachments()
+		);
+	}
+	return attachments_;
+}
+
+QList<Entry*> Entry::buildHistoryItems() const
+{
+	QList<Entry*> items_;
+	items_.resize(
+		this->historyDeltas.size()
+	);
+	const Entry* newer_ = nullptr;
+	for(qsizetype i_ = this->historyDeltas.size() - 1; i_ >= 0; --i_)
+	{
+		items_[i_] = this->buildHistoryItem(
+			this->historyDeltas.at(
+				i_
+			),
+			newer_
+		);
+		newer_ = items_.at(
+			i_
+		);
+	}
+	return items_;
+}
+
+Entry* Entry::buildHistoryItem(
+	const EntryDelta &delta,
+	const Entry* newer
+) const
+{
+	const auto item_ = new Entry();
+	item_->setUpdateTimeinfo(
+		false
+	);
+	item_->uuid = this->uuid;
+	if(newer)
+	{
+		item_->attributes->copyDataFrom(
+			newer->attributes
+		);
+		item_->attachments->copyDataFrom(
+			newer->attachments
+		);
+	}
+	delta.apply(
+		item_
+	);
+	item_->setUpdateTimeinfo(
+		true
+	);
+	return item_;
+}
+
+void Entry::appendHistoryItem(
+	const Entry* item
+)
+{
+	if(!this->historyDeltas.isEmpty())
+	{
+		const QScopedPointer<Entry> previous_(
+			this->buildHistoryItem(
+				this->historyDeltas.last(),
+				nullptr
+			)
+		);
+		this->replaceNewestHistoryDelta(
+			EntryDelta::diff(
+				previous_.data(),
+				item
+			)
+		);
+	}
+	this->appendHistoryDelta(
+		EntryDelta::diff(
+			item,
+			nullptr
+		)
+	);
+}
+
+void Entry::appendHistoryDelta(
+	const EntryDelta &delta
+)
+{
+	// the previous newest delta is now measured on its own
+	if(!this->historyDeltas.isEmpty())
+	{
+		this->historyAttributesSize += this->historyDeltas.last().
+			getAttributesSize();
+	}
+	this->historyAttachmentsSize += delta.countAttachments(
+		&this->historyAttachmentCounts,
+		this->attachments->getStore()
+	);
+	this->historyDeltas.append(
+		delta
+	);
+}
+
+void Entry::replaceNewestHistoryDelta(
+	const EntryDelta &delta
+)
+{
+	// count the new delta first, so shared blobs keep a reference
+	this->historyAttachmentsSize += delta.countAttachments(
+		&this->historyAttachmentCounts,
+		this->attachments->getStore()
+	);
+	this->historyAttachmentsSize -= this->historyDeltas.last().
+		uncountAttachments(
+			&this->historyAttachmentCounts,
+			this->attachments->getStore()
+		);
+	this->historyDeltas.last() = delta;
+}
+
+void Entry::removeOldestHistoryDelta()
+{
+	const EntryDelta &delta_ = this->historyDeltas.first();
+	if(this->historyDeltas.size() > 1)
+	{
+		this->historyAttributesSize -= delta_.getAttributesSize();
+	}
+	this->historyAttachmentsSize -= delta_.uncountAttachments(
+		&this->historyAttachmentCounts,
+		this->attachments->getStore()
+	);
+	this->historyDeltas.removeFirst();
+}
+
+void Entry::clearHistoryDeltas()
+{
+	this->releaseHistoryAttachments();
+	this->historyDeltas.clear();
+	this->historyAttributesSize = 0;
+	this->historyAttachmentsSize = 0;
+	this->historyAttachmentCounts.clear();
+}
+
+void Entry::acquireHistoryAttachments() const
+{
+	AttachmentStore* store_ = this->attachments->getStore();
+	if(!store_)
+	{
+		return;
+	}
+	QSet<QByteArray> acquired_;
+	for(const EntryDelta &delta_: asConst(
+			this->historyDeltas
+		))
+	{
+		const QList<QPair<QByteArray, QByteArray>> attachments_ = delta_.
+			getAttachments();
+		for(const QPair<QByteArray, QByteArray> &attachment_: attachments_)
+		{
+			if(!acquired_.contains(
+				attachment_.first
+			))
+			{
+				acquired_.insert(
+					attachment_.first
+				);
+				store_->acquire(
+					attachment_.first,
+					attachment_.second
+				);
+			}
+		}
 	}
 }
 
-QList<Entry*> Entry::getHistoryItems()
+void Entry::releaseHistoryAttachments() const
 {
-	return this->history;
+	AttachmentStore* store_ = this->attachments->getStore();
+	if(!store_)
+	{
+		return;
+	}
+	for(auto i_ = this->historyAttachmentCounts.cbegin(); i_ != this->
+		historyAttachmentCounts.cend(); ++i_)
+	{
+		store_->release(
+			i_.key()
+		);
+	}
 }
 
-const QList<Entry*> &Entry::getHistoryItems() const
+int Entry::getHistoryDeltasSize() const
 {
-	return this->history;
+	if(this->historyDeltas.isEmpty())
+	{
+		return 0;
+	}
+	int size_ = this->historyAttributesSize + this->historyAttachmentsSize;
+	size_ += this->historyDeltas.last().getAttributesSize(
+		this->attributes
+	);
+	QSet<QByteArray> digests_;
+	for(const QString &key_: this->attachments->getKeys())
+	{
+		const QByteArray digest_ = this->attachments->getDigest(
+			key_
+		);
+		if(this->historyAttachmentCounts.contains(
+			digest_
+		) && !digests_.contains(
+			digest_
+		))
+		{
+			digests_.insert(
+				digest_
+			);
+			size_ -= static_cast<int>(this->attachments->getValue(
+				key_
+			).size());
+		}
+	}
+	return size_;
 }
 
 void Entry::addHistoryItem(
 	Entry* entry
 )
 {
-	if(entry->parent())
+	if(entry->getGroup())
 	{
 		return;
 	};
-	this->history.append(
+	this->appendHistoryItem(
 		entry
 	);
-	 sig_modified();
+	delete entry;
+	this->notifyModified();
 }
 
 void Entry::removeHistoryItems(
-	const QList<Entry*> &historyEntries
+	const QList<int> &indexes
 )
 {
-	if(historyEntries.isEmpty())
+	if(indexes.isEmpty())
 	{
 		return;
 	}
-	for(Entry* entry_: historyEntries)
+	// the deltas of the remaining items change, they are stored again
+	QList<Entry*> items_ = this->buildHistoryItems();
+	const ListDeleter<Entry*> deleter_(
+		&items_
+	);
+	this->clearHistoryDeltas();
+	for(qsizetype i_ = 0; i_ < items_.size(); ++i_)
 	{
-		if(entry_->parent())
-		{
-			return;
-		};
-		if(entry_->getUUID() != getUUID())
-		{
-			return;
-		}
-		if(!this->history.contains(
-			entry_
+		if(!indexes.contains(
+			static_cast<int>(i_)
 		))
 		{
-			return;
+			this->appendHistoryItem(
+				items_.at(
+					i_
+				)
+			);
 		}
-		this->history.removeOne(
-			entry_
+	}
+	this->notifyModified();
+}
+
+void Entry::clearHistory()
+{
+	if(this->historyDeltas.isEmpty())
+	{
+		return;
+	}
+	this->clearHistoryDeltas();
+	this->notifyModified();
+}
+
+void Entry::resetHistoryCustomIcon(
+	const UUID &uuid
+)
+{
+	for(EntryDelta &delta_: this->historyDeltas)
+	{
+		delta_.resetCustomIcon(
+			uuid
 		);
-		delete entry_;
 	}
-	 sig_modified();
 }
 
 void Entry::truncateHistory()
@@ -541,56 +838,20 @@ void Entry::truncateHistory()
 	if(const int histMaxItems_ = db_->getMetadata()->getHistoryMaxItems();
 		histMaxItems_ > -1)
 	{
-		auto historyCount_ = 0;
-		QMutableListIterator i_(
-			history
-		);
-		i_.toBack();
-		while(i_.hasPrevious())
+		// the deltas only depend on newer items, the oldest ones can go
+		while(this->historyDeltas.size() > histMaxItems_)
 		{
-			historyCount_++;
-			const Entry* entry_ = i_.previous();
-			if(historyCount_ > histMaxItems_)
-			{
-				delete entry_;
-				i_.remove();
-			}
+			this->removeOldestHistoryDelta();
 		}
 	}
 	if(const int histMaxSize_ = db_->getMetadata()->getHistoryMaxSize();
 		histMaxSize_ > -1)
 	{
-		auto size_ = 0;
-		auto foundAttachements_ = QSet(
-			this->getAttachments()->getValues().constBegin(),
-			this->getAttachments()->getValues().constEnd()
-		);
-		QMutableListIterator i_(
-			this->history
-		);
-		i_.toBack();
-		while(i_.hasPrevious())
+		// the running size only needs the removed deltas to be updated
+		while(!this->historyDeltas.isEmpty() && this->getHistoryDeltasSize() >
+			histMaxSize_)
 		{
-			Entry* historyItem_ = i_.previous();
-			// don't calculate size if it's already above the maximum
-			if(size_ <= histMaxSize_)
-			{
-				size_ += historyItem_->getAttributes()->getAttributesSize();
-				const QSet<QByteArray> newAttachments_ = QSet(
-					historyItem_->getAttachments()->getValues().constBegin(),
-					historyItem_->getAttachments()->getValues().constEnd()
-				) - foundAttachements_;
-				for(const QByteArray &attachment: newAttachments_)
-				{
-					size_ += static_cast<int>(attachment.size());
-				}
-				foundAttachements_ += newAttachments_;
-			}
-			if(size_ > histMaxSize_)
-			{
-				delete historyItem_;
-				i_.remove();
-			}
+			this->removeOldestHistoryDelta();
 		}
 	}
 }
@@ -620,24 +881,12 @@ Entry* Entry::clone(
 	);
 	if(flags & this->CloneIncludeHistory)
 	{
-		for(const Entry* historyItem_: history)
-		{
-			Entry* historyItemClone_ = historyItem_->clone(
-				flags & ~this->CloneIncludeHistory & ~this->CloneNewUuid
-			);
-			historyItemClone_->setUpdateTimeinfo(
-				false
-			);
-			historyItemClone_->setUUID(
-				entry_->getUUID()
-			);
-			historyItemClone_->setUpdateTimeinfo(
-				true
-			);
-			entry_->addHistoryItem(
-				historyItemClone_
-			);
-		}
+		// the deltas don't hold the uuid, so they can be shared as they are
+		entry_->historyDeltas = this->historyDeltas;
+		entry_->historyAttributesSize = this->historyAttributesSize;
+		entry_->historyAttachmentsSize = this->historyAttachmentsSize;
+		entry_->historyAttachmentCounts = this->historyAttachmentCounts;
+		entry_->acquireHistoryAttachments();
 	}
 	entry_->setUpdateTimeinfo(
 		true
@@ -709,27 +958,17 @@ bool Entry::endUpdate()
 	};
 	if(this->modifiedSinceBegin)
 	{
-		this->tmpHistoryItem->setUpdateTimeinfo(
-			true
-		);
-		this->addHistoryItem(
+		this->appendHistoryItem(
 			this->tmpHistoryItem
 		);
+		this->notifyModified();
 		this->truncateHistory();
 	}
-	else
-	{
-		delete this->tmpHistoryItem;
-	}
+	delete this->tmpHistoryItem;
 	this->tmpHistoryItem = nullptr;
 	return this->modifiedSinceBegin;
 }
 
-void Entry::do_updateModifiedSinceBegin()
-{
-	this->modifiedSinceBegin = true;
-}
-
 Group* Entry::getGroup()
 {
 	return this->group;
@@ -782,9 +1021,6 @@ void Entry::setGroup(
 	group->addEntry(
 		this
 	);
-	setParent(
-		group
-	);
 	if(this->updateTimeinfo)
 	{
 		this->data.timeInfo.setLocationChanged(
@@ -793,13 +1029,39 @@ void Entry::setGroup(
 	}
 }
 
-void Entry::do_emitDataChanged()
+void Entry::setAttachmentStore(
+	AttachmentStore* store
+)
 {
-	 sig_dataChanged(
-		this
+	if(this->attachments->getStore() != store)
+	{
+		// the deltas hold one reference per attachment
+		this->releaseHistoryAttachments();
+		this->attachments->setStore(
+			store
+		);
+		this->acquireHistoryAttachments();
+	}
+}
+
+void Entry::setStringPool(
+	StringPool* pool
+)
+{
+	this->attributes->setStringPool(
+		pool
 	);
 }
 
+Database* Entry::getGroupDatabase() const
+{
+	if(this->group)
+	{
+		return this->group->getDatabase();
+	}
+	return nullptr;
+}
+
 const Database* Entry::getDatabase() const
 {
 	if(this->group)
@@ -816,32 +1078,9 @@ QString Entry::resolvePlaceholders(
 	const QString &str
 ) const
 {
-	QString result_ = str;
-	result_.replace(
-		"{TITLE}",
-		this->getTitle(),
-		Qt::CaseInsensitive
-	);
-	result_.replace(
-		"{USERNAME}",
-		this->getUsername(),
-		Qt::CaseInsensitive
-	);
-	result_.replace(
-		"{URL}",
-		this->getURL(),
-		Qt::CaseInsensitive
-	);
-	result_.replace(
-		"{PASSWORD}",
-		this->getPassword(),
-		Qt::CaseInsensitive
-	);
-	result_.replace(
-		"{NOTES}",
-		this->getNotes(),
-		Qt::CaseInsensitive
-	);
-	// TODO: lots of other placeholders missing
-	return result_;
+	return PlaceholderTemplate::compile(
+		str
+	).resolve(
+		this
+	);
 }
@@ -17,32 +17,30 @@
 #ifndef KEEPASSX_ENTRY_H
 #define KEEPASSX_ENTRY_H
 #include <QColor>
+#include <QMetaType>
 #include <QPixmap>
 #include <QPointer>
 #include <QUrl>
 #include "core/EntryAttachments.h"
 #include "core/EntryAttributes.h"
+#include "core/EntryDelta.h"
 #include "core/TimeInfo.h"
 #include "core/UUID.h"
 class Database;
 class Group;
 
-struct EntryData
+/**
+* Entries are plain records, a database may hold a great many of them.
+* Their changes are reported through the EntryDispatcher of the database.
+*/
+class Entry final
 {
-	int iconNumber;
-	UUID customIcon;
-	QColor foregroundColor;
-	QColor backgroundColor;
-	QString overrideUrl;
-	QString tags;
-	TimeInfo timeInfo;
-};
-
-class Entry final:public QObject
-{
-	Q_OBJECT public:
+	friend class EntryAttachments;
+	friend class EntryAttributes;
+	friend class EntryDelta;
+public:
 	Entry();
-	virtual ~Entry() override;
+	~Entry();
 	UUID getUUID() const;
 	QImage getIcon() const;
 	QPixmap getIconPixmap() const;
@@ -110,14 +108,44 @@ class Entry final:public QObject
 	void setExpiryTime(
 		const QDateTime &dateTime
 	);
-	QList<Entry*> getHistoryItems();
-	const QList<Entry*> &getHistoryItems() const;
+	int getHistoryCount() const;
+	/**
+	* Custom icons of the history items.
+	*/
+	QSet<UUID> getHistoryCustomIcons() const;
+	/**
+	* Digests and values of the attachments of the history items.
+	*/
+	QList<QPair<QByteArray, QByteArray>> getHistoryAttachments() const;
+	/**
+	* Rebuilds the history items, oldest first, as new entries owned by the
+	* caller. The history itself is only stored as deltas.
+	*/
+	QList<Entry*> buildHistoryItems() const;
+	/**
+	* Appends entry as the newest history item and deletes it.
+	*/
 	void addHistoryItem(
 		Entry* entry
 	);
+	/**
+	* Removes the history items at the given positions, oldest first like
+	* buildHistoryItems().
+	*/
 	void removeHistoryItems(
-		const QList<Entry*> &historyEntries
+		const QList<int> &indexes
+	);
+	void clearHistory();
+	/**
+	* Resets the history items that use the custom icon uuid to the default
+	* icon.
+	*/
+	void resetHistoryCustomIcon(
+		const UUID &uuid
 	);
+	/**
+	* Drops the oldest history items beyond the limits of the database.
+	*/
 	void truncateHistory();
 
 	enum CloneFlag: u_int8_t
@@ -163,20 +191,67 @@ class Entry final:public QObject
 	void setUpdateTimeinfo(
 		bool value
 	);
-Q_SIGNALS:
 	/**
-	* Emitted when a default attribute has been changed.
+	* Shares the attachments of the entry and its history items through
+	* store, usually the one of the database the entry belongs to.
 	*/
-	void sig_dataChanged(
-		Entry* entry
+	void setAttachmentStore(
+		AttachmentStore* store
+	);
+	/**
+	* Interns the attribute keys and unprotected values of the entry and its
+	* history items through pool.
+	*/
+	void setStringPool(
+		StringPool* pool
 	);
-	void sig_modified();
-private Q_SLOTS:
-	void do_emitDataChanged();
-	void do_updateTimeinfo();
-	void do_updateModifiedSinceBegin();
 private:
 	const Database* getDatabase() const;
+	Database* getGroupDatabase() const;
+	/**
+	* Updates the modification time and reports the change to the
+	* dispatcher of the database, replaces per entry signal connections.
+	* Inside a transaction the change is recorded for the commit instead.
+	*/
+	void notifyModified();
+	/**
+	* Reports a change of a default attribute or the icon.
+	*/
+	void notifyDataChanged();
+	Entry* buildHistoryItem(
+		const EntryDelta &delta,
+		const Entry* newer
+	) const;
+	/**
+	* Stores item as the newest history item, the previous newest one is
+	* stored against it from then on.
+	*/
+	void appendHistoryItem(
+		const Entry* item
+	);
+	/**
+	* Appends delta as the newest history item, the running size of the
+	* delta encoded history is kept up to date by these methods.
+	*/
+	void appendHistoryDelta(
+		const EntryDelta &delta
+	);
+	void replaceNewestHistoryDelta(
+		const EntryDelta &delta
+	);
+	void removeOldestHistoryDelta();
+	void clearHistoryDeltas();
+	/**
+	* The delta encoded history holds one reference in the attachment store
+	* per digest in historyAttachmentCounts.
+	*/
+	void acquireHistoryAttachments() const;
+	void releaseHistoryAttachments() const;
+	/**
+	* Size of the delta encoded history in bytes. Attachments the entry holds
+	* itself aren't counted, each other attachment is counted once.
+	*/
+	int getHistoryDeltasSize() const;
 	template<class T> bool set(
 		T &property,
 		const T &value
@@ -185,7 +260,12 @@ private:
 	EntryData data;
 	EntryAttributes* const attributes;
 	EntryAttachments* const attachments;
-	QList<Entry*> history;
+	QList<EntryDelta> historyDeltas;
+	// attribute values of all deltas but the newest one, which is measured
+	// against the entry, and the attachments of all deltas by digest
+	int historyAttributesSize;
+	int historyAttachmentsSize;
+	QHash<QByteArray, int> historyAttachmentCounts;
 	Entry* tmpHistoryItem;
 	bool modifiedSinceBegin;
 	QPointer<Group> group;
@@ -195,4 +275,7 @@ private:
 Q_DECLARE_OPERATORS_FOR_FLAGS(
 	Entry::CloneFlags
 )
+Q_DECLARE_METATYPE(
+	Entry*
+)
 #endif // KEEPASSX_ENTRY_H
@@ -15,16 +15,25 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "EntryAttachments.h"
+#include "core/AttachmentStore.h"
+#include "core/Entry.h"
+#include "core/Global.h"
 
-EntryAttachments::EntryAttachments(
-	QObject* parent
-)
-	: QObject(
-		parent
+EntryAttachments::EntryAttachments()
+	: owner(
+		nullptr
+	),
+	observer(
+		nullptr
 	)
 {
 }
 
+EntryAttachments::~EntryAttachments()
+{
+	this->releaseAll();
+}
+
 QList<QString> EntryAttachments::getKeys() const
 {
 	return this->attachments.keys();
@@ -53,10 +62,39 @@ QByteArray EntryAttachments::getValue(
 	);
 }
 
+QByteArray EntryAttachments::getDigest(
+	const QString &key
+) const
+{
+	return this->digests.value(
+		key
+	);
+}
+
+QList<QByteArray> EntryAttachments::getDigests() const
+{
+	return this->digests.values();
+}
+
 void EntryAttachments::set(
 	const QString &key,
 	const QByteArray &value
 )
+{
+	this->setWithDigest(
+		key,
+		value,
+		AttachmentStore::digest(
+			value
+		)
+	);
+}
+
+void EntryAttachments::setWithDigest(
+	const QString &key,
+	const QByteArray &value,
+	const QByteArray &digest
+)
 {
 	auto emitModified_ = false;
 	const bool addAttachment_ = !this->attachments.contains(
@@ -64,35 +102,69 @@ void EntryAttachments::set(
 	);
 	if(addAttachment_)
 	{
-		 sig_aboutToBeAdded(
-			key
-		);
+		if(this->observer)
+		{
+			this->observer->aboutToBeAdded(
+				key
+			);
+		}
 	}
-	if(addAttachment_ || this->attachments.value(
+	if(addAttachment_ || this->digests.value(
 		key
-	) != value)
+	) != digest)
 	{
-		this->attachments.insert(
+		if(this->store)
+		{
+			if(!addAttachment_)
+			{
+				this->store->release(
+					this->digests.value(
+						key
+					)
+				);
+			}
+			this->attachments.insert(
+				key,
+				this->store->acquire(
+					digest,
+					value
+				)
+			);
+		}
+		else
+		{
+			this->attachments.insert(
+				key,
+				value
+			);
+		}
+		this->digests.insert(
 			key,
-			value
+			digest
 		);
 		emitModified_ = true;
 	}
 	if(addAttachment_)
 	{
-		 sig_added(
-			key
-		);
+		if(this->observer)
+		{
+			this->observer->added(
+				key
+			);
+		}
 	}
 	else
 	{
-		 sig_keyModified(
-			key
-		);
+		if(this->observer)
+		{
+			this->observer->keyModified(
+				key
+			);
+		}
 	}
 	if(emitModified_)
 	{
-		 sig_modified();
+		this->emitModified();
 	}
 }
 
@@ -112,16 +184,33 @@ void EntryAttachments::remove(
 	{
 		return;
 	}
-	 sig_aboutToBeRemoved(
-		key
-	);
+	if(this->observer)
+	{
+		this->observer->aboutToBeRemoved(
+			key
+		);
+	}
+	if(this->store)
+	{
+		this->store->release(
+			this->digests.value(
+				key
+			)
+		);
+	}
 	this->attachments.remove(
 		key
 	);
-	 sig_removed(
+	this->digests.remove(
 		key
 	);
-	 sig_modified();
+	if(this->observer)
+	{
+		this->observer->removed(
+			key
+		);
+	}
+	this->emitModified();
 }
 
 void EntryAttachments::clear()
@@ -130,10 +219,18 @@ void EntryAttachments::clear()
 	{
 		return;
 	}
-	 sig_aboutToBeReset();
+	if(this->observer)
+	{
+		this->observer->aboutToBeReset();
+	}
+	this->releaseAll();
 	this->attachments.clear();
-	 sig_reset();
-	 sig_modified();
+	this->digests.clear();
+	if(this->observer)
+	{
+		this->observer->reset();
+	}
+	this->emitModified();
 }
 
 void EntryAttachments::copyDataFrom(
@@ -142,10 +239,19 @@ void EntryAttachments::copyDataFrom(
 {
 	if(*this != *other)
 	{
-		 sig_aboutToBeReset();
+		if(this->observer)
+		{
+			this->observer->aboutToBeReset();
+		}
+		this->releaseAll();
 		this->attachments = other->attachments;
-		 sig_reset();
-		 sig_modified();
+		this->digests = other->digests;
+		this->acquireAll();
+		if(this->observer)
+		{
+			this->observer->reset();
+		}
+		this->emitModified();
 	}
 }
 
@@ -153,12 +259,82 @@ bool EntryAttachments::operator==(
 	const EntryAttachments &other
 ) const
 {
-	return this->attachments == other.attachments;
+	return this->digests == other.digests;
 }
 
 bool EntryAttachments::operator!=(
 	const EntryAttachments &other
 ) const
 {
-	return this->attachments != other.attachments;
+	return this->digests != other.digests;
+}
+
+AttachmentStore* EntryAttachments::getStore() const
+{
+	return this->store;
+}
+
+void EntryAttachments::setStore(
+	AttachmentStore* store
+)
+{
+	if(this->store == store)
+	{
+		return;
+	}
+	this->releaseAll();
+	this->store = store;
+	this->acquireAll();
+}
+
+void EntryAttachments::setObserver(
+	EntryAttachmentsObserver* observer
+)
+{
+	this->observer = observer;
+}
+
+void EntryAttachments::acquireAll()
+{
+	if(!this->store)
+	{
+		return;
+	}
+	for(auto i_ = this->attachments.begin(); i_ != this->attachments.end(); ++i_)
+	{
+		i_.value() = this->store->acquire(
+			this->digests.value(
+				i_.key()
+			),
+			i_.value()
+		);
+	}
+}
+
+void EntryAttachments::releaseAll()
+{
+	if(!this->store)
+	{
+		return;
+	}
+	for(const QByteArray &digest_: asConst(
+			this->digests
+		))
+	{
+		this->store->release(
+			digest_
+		);
+	}
+}
+
+void EntryAttachments::emitModified()
+{
+	if(this->observer)
+	{
+		this->observer->modified();
+	}
+	if(this->owner)
+	{
+		this->owner->notifyModified();
+	}
 }
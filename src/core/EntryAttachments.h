@@ -17,14 +17,91 @@
 #ifndef KEEPASSX_ENTRYATTACHMENTS_H
 #define KEEPASSX_ENTRYATTACHMENTS_H
 #include <QMap>
-#include <QObject>
+#include <QPointer>
+class AttachmentStore;
+class Entry;
 
-class EntryAttachments final:public QObject
+/**
+* Told about the changes of an EntryAttachments object it is set on, see
+* EntryAttachments::setObserver(). The entry owning the attachments is
+* notified directly instead.
+*/
+class EntryAttachmentsObserver
 {
-	Q_OBJECT public:
-	explicit EntryAttachments(
-		QObject* parent = nullptr
-	);
+public:
+	virtual ~EntryAttachmentsObserver()
+	{
+	}
+
+	virtual void modified()
+	{
+	}
+
+	virtual void keyModified(
+		const QString &key
+	)
+	{
+		Q_UNUSED(
+			key
+		);
+	}
+
+	virtual void aboutToBeAdded(
+		const QString &key
+	)
+	{
+		Q_UNUSED(
+			key
+		);
+	}
+
+	virtual void added(
+		const QString &key
+	)
+	{
+		Q_UNUSED(
+			key
+		);
+	}
+
+	virtual void aboutToBeRemoved(
+		const QString &key
+	)
+	{
+		Q_UNUSED(
+			key
+		);
+	}
+
+	virtual void removed(
+		const QString &key
+	)
+	{
+		Q_UNUSED(
+			key
+		);
+	}
+
+	virtual void aboutToBeReset()
+	{
+	}
+
+	virtual void reset()
+	{
+	}
+};
+
+/**
+* The attachments of an entry. A plain class rather than a QObject, so an
+* entry doesn't pay for a QObject per container. Changes are reported to
+* the owning entry and to at most one observer.
+*/
+class EntryAttachments final
+{
+	friend class Entry;
+public:
+	EntryAttachments();
+	~EntryAttachments();
 	QList<QString> getKeys() const;
 	bool hasKey(
 		const QString &key
@@ -33,10 +110,27 @@ class EntryAttachments final:public QObject
 	QByteArray getValue(
 		const QString &key
 	) const;
+	/**
+	* Returns the SHA-256 digest of the attachment, it is computed once
+	* when the value is set.
+	*/
+	QByteArray getDigest(
+		const QString &key
+	) const;
+	QList<QByteArray> getDigests() const;
 	void set(
 		const QString &key,
 		const QByteArray &value
 	);
+	/**
+	* Same as set() for a value whose SHA-256 digest is already known, e.g.
+	* when a history item is rebuilt, so it isn't hashed again.
+	*/
+	void setWithDigest(
+		const QString &key,
+		const QByteArray &value,
+		const QByteArray &digest
+	);
 	void remove(
 		const QString &key
 	);
@@ -50,26 +144,32 @@ class EntryAttachments final:public QObject
 	bool operator!=(
 		const EntryAttachments &other
 	) const;
-Q_SIGNALS:
-	void sig_modified();
-	void sig_keyModified(
-		const QString &key
+	AttachmentStore* getStore() const;
+	/**
+	* Moves the references of all attachments to store, values are replaced
+	* by the shared copies kept there.
+	*/
+	void setStore(
+		AttachmentStore* store
 	);
-	void sig_aboutToBeAdded(
-		const QString &key
-	);
-	void sig_added(
-		const QString &key
-	);
-	void sig_aboutToBeRemoved(
-		const QString &key
-	);
-	void sig_removed(
-		const QString &key
+	/**
+	* Reports the changes to observer, nullptr stops it.
+	*/
+	void setObserver(
+		EntryAttachmentsObserver* observer
 	);
-	void sig_aboutToBeReset();
-	void sig_reset();
 private:
+	void acquireAll();
+	void releaseAll();
+	void emitModified();
 	QMap<QString, QByteArray> attachments;
+	QMap<QString, QByteArray> digests;
+	QPointer<AttachmentStore> store;
+	// the entry the attachments belong to, notified without a connection
+	Entry* owner;
+	EntryAttachmentsObserver* observer;
+	Q_DISABLE_COPY(
+		EntryAttachments
+	)
 };
 #endif // KEEPASSX_ENTRYATTACHMENTS_H
@@ -15,6 +15,9 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "EntryAttributes.h"
+#include <algorithm>
+#include "core/Entry.h"
+#include "core/StringPool.h"
 const QString EntryAttributes::TitleKey = "Title";
 const QString EntryAttributes::UserNameKey = "UserName";
 const QString EntryAttributes::PasswordKey = "Password";
@@ -24,12 +27,20 @@ const QStringList EntryAttributes::DefaultAttributes(
 	QStringList() << TitleKey << UserNameKey << PasswordKey << URLKey <<
 	NotesKey
 );
+const QStringList EntryAttributes::SortedDefaultAttributes(
+	QStringList() << NotesKey << PasswordKey << TitleKey << URLKey <<
+	UserNameKey
+);
 
-EntryAttributes::EntryAttributes(
-	QObject* parent
-)
-	: QObject(
-		parent
+EntryAttributes::EntryAttributes()
+	: standardProtected(
+		0
+	),
+	owner(
+		nullptr
+	),
+	observer(
+		nullptr
 	)
 {
 	this->clear();
@@ -37,32 +48,62 @@ EntryAttributes::EntryAttributes(
 
 QList<QString> EntryAttributes::getKeys() const
 {
-	return this->attributes.keys();
+	// merge the standard keys into the sorted custom keys
+	QList<QString> keys_;
+	keys_.reserve(
+		StandardKeyCount + this->customAttributes.size()
+	);
+	const QStringList &standardKeys_ = SortedDefaultAttributes;
+	auto standard_ = 0;
+	for(const CustomAttribute &attribute_: this->customAttributes)
+	{
+		while(standard_ < StandardKeyCount && standardKeys_.at(
+			standard_
+		) < attribute_.key)
+		{
+			keys_.append(
+				standardKeys_.at(
+					standard_++
+				)
+			);
+		}
+		keys_.append(
+			attribute_.key
+		);
+	}
+	while(standard_ < StandardKeyCount)
+	{
+		keys_.append(
+			standardKeys_.at(
+				standard_++
+			)
+		);
+	}
+	return keys_;
 }
 
 bool EntryAttributes::hasKey(
 	const QString &key
 ) const
 {
-	return this->attributes.keys().contains(
+	return this->standardIndex(
 		key
-	);
+	) != -1 || this->indexOf(
+		key
+	) != -1;
 }
 
 QList<QString> EntryAttributes::getCustomKeys() const
 {
 	QList<QString> customKeys_;
-	const QList<QString> keyList_ = this->getKeys();
-	for(const QString &key_: keyList_)
+	customKeys_.reserve(
+		this->customAttributes.size()
+	);
+	for(const CustomAttribute &attribute_: this->customAttributes)
 	{
-		if(!this->isDefaultAttribute(
-			key_
-		))
-		{
-			customKeys_.append(
-				key_
-			);
-		}
+		customKeys_.append(
+			attribute_.key
+		);
 	}
 	return customKeys_;
 }
@@ -71,18 +112,53 @@ QString EntryAttributes::getValue(
 	const QString &key
 ) const
 {
-	return this->attributes.value(
+	if(const int standard_ = this->standardIndex(
 		key
 	);
+		standard_ != -1)
+	{
+		return this->standardValues[standard_];
+	}
+	if(const qsizetype index_ = this->indexOf(
+		key
+	);
+		index_ != -1)
+	{
+		return this->customAttributes.at(
+			index_
+		).value;
+	}
+	return QString();
+}
+
+const QString &EntryAttributes::getValue(
+	const StandardKey key
+) const
+{
+	return this->standardValues[key];
 }
 
 bool EntryAttributes::isProtected(
 	const QString &key
 ) const
 {
-	return this->protectedAttributes.contains(
+	if(const int standard_ = this->standardIndex(
+		key
+	);
+		standard_ != -1)
+	{
+		return this->standardProtected & (1 << standard_);
+	}
+	if(const qsizetype index_ = this->indexOf(
 		key
 	);
+		index_ != -1)
+	{
+		return this->customAttributes.at(
+			index_
+		).isProtected;
+	}
+	return false;
 }
 
 void EntryAttributes::set(
@@ -92,69 +168,115 @@ void EntryAttributes::set(
 )
 {
 	auto emitModified_ = false;
-	const bool addAttribute_ = !this->attributes.contains(
+	const int standard_ = this->standardIndex(
 		key
 	);
-	const bool changeValue_ = !addAttribute_ && (this->attributes.value(
-		key
-	) != value);
-	const bool defaultAttribute_ = this->isDefaultAttribute(
+	const bool defaultAttribute_ = standard_ != -1;
+	const qsizetype index_ = defaultAttribute_ ? -1 : this->lowerBound(
 		key
 	);
-	if(addAttribute_ && !defaultAttribute_)
+	const bool addAttribute_ = !defaultAttribute_ && (index_ == this->
+		customAttributes.size() || this->customAttributes.at(
+			index_
+		).key != key);
+	const bool changeValue_ = !addAttribute_ && (defaultAttribute_ ? this->
+		standardValues[standard_] : this->customAttributes.at(
+			index_
+		).value) != value;
+	if(addAttribute_)
 	{
-		sig_aboutToBeAdded(
-			key
+		if(this->observer)
+		{
+			this->observer->aboutToBeAdded(
+				key
+			);
+		}
+		const CustomAttribute attribute_{
+			this->intern(
+				key,
+				false
+			),
+			this->intern(
+				value,
+				protect
+			),
+			false
+		};
+		this->customAttributes.insert(
+			index_,
+			attribute_
 		);
+		emitModified_ = true;
 	}
-	if(addAttribute_ || changeValue_)
+	else if(changeValue_)
 	{
-		this->attributes.insert(
-			key,
-			value
-		);
+		if(defaultAttribute_)
+		{
+			this->standardValues[standard_] = this->intern(
+				value,
+				protect
+			);
+		}
+		else
+		{
+			this->customAttributes[index_].value = this->intern(
+				value,
+				protect
+			);
+		}
 		emitModified_ = true;
 	}
-	if(protect)
+	bool wasProtected_;
+	if(defaultAttribute_)
 	{
-		if(!this->protectedAttributes.contains(
-			key
-		))
+		wasProtected_ = this->standardProtected & (1 << standard_);
+		if(protect)
 		{
-			emitModified_ = true;
+			this->standardProtected |= (1 << standard_);
+		}
+		else
+		{
+			this->standardProtected &= ~(1 << standard_);
 		}
-		this->protectedAttributes.insert(
-			key
-		);
 	}
-	else if(this->protectedAttributes.remove(
-		key
-	))
+	else
+	{
+		wasProtected_ = this->customAttributes.at(
+			index_
+		).isProtected;
+		this->customAttributes[index_].isProtected = protect;
+	}
+	if(protect != wasProtected_)
 	{
 		emitModified_ = true;
 	}
 	if(emitModified_)
 	{
-		sig_modified();
+		this->emitModified();
 	}
 	if(defaultAttribute_ && changeValue_)
 	{
-		sig_defaultKeyModified();
+		this->emitDefaultKeyModified();
 	}
 	else if(addAttribute_)
 	{
-		sig_added(
-			key
-		);
+		if(this->observer)
+		{
+			this->observer->added(
+				key
+			);
+		}
 	}
 	else if(emitModified_)
 	{
-		sig_customKeyModified(
-			key
-		);
+		if(this->observer)
+		{
+			this->observer->customKeyModified(
+				key
+			);
+		}
 	}
 }
-
 void EntryAttributes::remove(
 	const QString &key
 )
@@ -165,25 +287,29 @@ void EntryAttributes::remove(
 	{
 		return;
 	};
-	if(!this->attributes.contains(
+	const qsizetype index_ = this->indexOf(
 		key
-	))
+	);
+	if(index_ == -1)
 	{
 		return;
 	}
-	sig_aboutToBeRemoved(
-		key
-	);
-	this->attributes.remove(
-		key
-	);
-	this->protectedAttributes.remove(
-		key
-	);
-	sig_removed(
-		key
+	if(this->observer)
+	{
+		this->observer->aboutToBeRemoved(
+			key
+		);
+	}
+	this->customAttributes.removeAt(
+		index_
 	);
-	sig_modified();
+	if(this->observer)
+	{
+		this->observer->removed(
+			key
+		);
+	}
+	this->emitModified();
 }
 
 void EntryAttributes::rename(
@@ -203,61 +329,64 @@ void EntryAttributes::rename(
 	{
 		return;
 	};
-	if(this->attributes.contains(
+	if(this->hasKey(
 		oldKey
 	))
 	{
 		return;
 	};
-	if(!this->attributes.contains(
+	if(!this->hasKey(
 		oldKey
 	))
 	{
 		return;
 	}
-	if(!this->attributes.contains(
+	if(!this->hasKey(
 		newKey
 	))
 	{
 		return;
 	};
-	if(this->attributes.contains(
+	if(this->hasKey(
 		newKey
 	))
 	{
 		return;
 	}
-	const QString data_ = this->getValue(
-		oldKey
-	);
-	const bool protect_ = this->isProtected(
+	const qsizetype oldIndex_ = this->indexOf(
 		oldKey
 	);
-	sig_aboutToRename(
-		oldKey,
-		newKey
+	CustomAttribute attribute_ = this->customAttributes.at(
+		oldIndex_
 	);
-	this->attributes.remove(
-		oldKey
+	if(this->observer)
+	{
+		this->observer->aboutToRename(
+			oldKey,
+			newKey
+		);
+	}
+	this->customAttributes.removeAt(
+		oldIndex_
 	);
-	this->attributes.insert(
+	attribute_.key = this->intern(
 		newKey,
-		data_
+		false
 	);
-	if(protect_)
+	this->customAttributes.insert(
+		this->lowerBound(
+			newKey
+		),
+		attribute_
+	);
+	this->emitModified();
+	if(this->observer)
 	{
-		this->protectedAttributes.remove(
-			oldKey
-		);
-		this->protectedAttributes.insert(
+		this->observer->renamed(
+			oldKey,
 			newKey
 		);
 	}
-	sig_modified();
-	sig_renamed(
-		oldKey,
-		newKey
-	);
 }
 
 void EntryAttributes::copyCustomKeysFrom(
@@ -270,48 +399,17 @@ void EntryAttributes::copyCustomKeysFrom(
 	{
 		return;
 	}
-	sig_aboutToBeReset();
-	// remove all non-default keys
-	const QList<QString> keyList_ = this->getKeys();
-	for(const QString &key_: keyList_)
+	if(this->observer)
 	{
-		if(!this->isDefaultAttribute(
-			key_
-		))
-		{
-			this->attributes.remove(
-				key_
-			);
-			this->protectedAttributes.remove(
-				key_
-			);
-		}
+		this->observer->aboutToBeReset();
 	}
-	const QList<QString> otherKeyList_ = other->getKeys();
-	for(const QString &key_: otherKeyList_)
+	this->customAttributes = other->customAttributes;
+	this->internAll();
+	if(this->observer)
 	{
-		if(!this->isDefaultAttribute(
-			key_
-		))
-		{
-			this->attributes.insert(
-				key_,
-				other->getValue(
-					key_
-				)
-			);
-			if(other->isProtected(
-				key_
-			))
-			{
-				this->protectedAttributes.insert(
-					key_
-				);
-			}
-		}
+		this->observer->reset();
 	}
-	sig_reset();
-	sig_modified();
+	this->emitModified();
 }
 
 bool EntryAttributes::areCustomKeysDifferent(
@@ -322,33 +420,7 @@ bool EntryAttributes::areCustomKeysDifferent(
 	{
 		return true;
 	}
-	if(this->getKeys() != other->getKeys())
-	{
-		return true;
-	}
-	const QList<QString> keyList_ = this->getKeys();
-	for(const QString &key_: keyList_)
-	{
-		if(this->isDefaultAttribute(
-			key_
-		))
-		{
-			continue;
-		}
-		if(this->isProtected(
-			key_
-		) != other->isProtected(
-			key_
-		) || this->getValue(
-			key_
-		) != other->getValue(
-			key_
-		))
-		{
-			return true;
-		}
-	}
-	return false;
+	return this->customAttributes != other->customAttributes;
 }
 
 void EntryAttributes::copyDataFrom(
@@ -357,11 +429,19 @@ void EntryAttributes::copyDataFrom(
 {
 	if(*this != *other)
 	{
-		sig_aboutToBeReset();
-		this->attributes = other->attributes;
-		this->protectedAttributes = other->protectedAttributes;
-		sig_reset();
-		sig_modified();
+		if(this->observer)
+		{
+			this->observer->aboutToBeReset();
+		}
+		this->standardValues = other->standardValues;
+		this->standardProtected = other->standardProtected;
+		this->customAttributes = other->customAttributes;
+		this->internAll();
+		if(this->observer)
+		{
+			this->observer->reset();
+		}
+		this->emitModified();
 	}
 }
 
@@ -369,44 +449,64 @@ bool EntryAttributes::operator==(
 	const EntryAttributes &other
 ) const
 {
-	return (this->attributes == other.attributes && this->protectedAttributes ==
-		other.protectedAttributes);
+	return (this->standardValues == other.standardValues && this->
+		standardProtected == other.standardProtected && this->customAttributes
+		== other.customAttributes);
 }
 
 bool EntryAttributes::operator!=(
 	const EntryAttributes &other
 ) const
 {
-	return (this->attributes != other.attributes || this->protectedAttributes !=
-		other.protectedAttributes);
+	return !(*this == other);
 }
 
 void EntryAttributes::clear()
 {
-	sig_aboutToBeReset();
-	this->attributes.clear();
-	this->protectedAttributes.clear();
-	for(const QString &key_: this->DefaultAttributes)
-	{
-		this->attributes.insert(
-			key_,
-			""
-		);
+	if(this->observer)
+	{
+		this->observer->aboutToBeReset();
+	}
+	this->customAttributes.clear();
+	this->standardProtected = 0;
+	for(QString &value_: this->standardValues)
+	{
+		value_ = "";
+	}
+	if(this->observer)
+	{
+		this->observer->reset();
 	}
-	sig_reset();
-	sig_modified();
+	this->emitModified();
+}
+
+StringPool* EntryAttributes::getStringPool() const
+{
+	return this->pool;
+}
+
+void EntryAttributes::setStringPool(
+	StringPool* pool
+)
+{
+	if(this->pool == pool)
+	{
+		return;
+	}
+	this->pool = pool;
+	this->internAll();
 }
 
 int EntryAttributes::getAttributesSize() const
 {
 	auto size_ = 0;
-	QMapIterator i_(
-		this->attributes
-	);
-	while(i_.hasNext())
+	for(const QString &value_: this->standardValues)
 	{
-		i_.next();
-		size_ += static_cast<int>(i_.value().toUtf8().size());
+		size_ += static_cast<int>(value_.toUtf8().size());
+	}
+	for(const CustomAttribute &attribute_: this->customAttributes)
+	{
+		size_ += static_cast<int>(attribute_.value.toUtf8().size());
 	}
 	return size_;
 }
@@ -415,7 +515,141 @@ bool EntryAttributes::isDefaultAttribute(
 	const QString &key
 )
 {
-	return DefaultAttributes.contains(
+	return standardIndex(
 		key
+	) != -1;
+}
+
+void EntryAttributes::setObserver(
+	EntryAttributesObserver* observer
+)
+{
+	this->observer = observer;
+}
+
+bool EntryAttributes::CustomAttribute::operator==(
+	const CustomAttribute &other
+) const
+{
+	return this->key == other.key && this->value == other.value && this->
+		isProtected == other.isProtected;
+}
+
+int EntryAttributes::standardIndex(
+	const QString &key
+)
+{
+	// the standard keys differ in length or first letter, so this rarely
+	// compares more than the sizes
+	for(auto i_ = 0; i_ < StandardKeyCount; i_++)
+	{
+		if(key == DefaultAttributes.at(
+			i_
+		))
+		{
+			return i_;
+		}
+	}
+	return -1;
+}
+
+bool EntryAttributes::isKeyLess(
+	const CustomAttribute &attribute,
+	const QString &key
+)
+{
+	return attribute.key < key;
+}
+
+qsizetype EntryAttributes::lowerBound(
+	const QString &key
+) const
+{
+	return std::lower_bound(
+		this->customAttributes.cbegin(),
+		this->customAttributes.cend(),
+		key,
+		&EntryAttributes::isKeyLess
+	) - this->customAttributes.cbegin();
+}
+
+qsizetype EntryAttributes::indexOf(
+	const QString &key
+) const
+{
+	const qsizetype index_ = this->lowerBound(
+		key
+	);
+	if(index_ < this->customAttributes.size() && this->customAttributes.at(
+		index_
+	).key == key)
+	{
+		return index_;
+	}
+	return -1;
+}
+
+QString EntryAttributes::intern(
+	const QString &value,
+	const bool protect
+) const
+{
+	// protected values stay out of the pool so they don't outlive the entry
+	if(protect || !this->pool)
+	{
+		return value;
+	}
+	return this->pool->intern(
+		value
 	);
 }
+
+void EntryAttributes::internAll()
+{
+	if(!this->pool)
+	{
+		return;
+	}
+	for(int i_ = 0; i_ < StandardKeyCount; ++i_)
+	{
+		this->standardValues[i_] = this->intern(
+			this->standardValues[i_],
+			this->standardProtected & (1 << i_)
+		);
+	}
+	for(CustomAttribute &attribute_: this->customAttributes)
+	{
+		attribute_.key = this->intern(
+			attribute_.key,
+			false
+		);
+		attribute_.value = this->intern(
+			attribute_.value,
+			attribute_.isProtected
+		);
+	}
+}
+
+void EntryAttributes::emitModified()
+{
+	if(this->observer)
+	{
+		this->observer->modified();
+	}
+	if(this->owner)
+	{
+		this->owner->notifyModified();
+	}
+}
+
+void EntryAttributes::emitDefaultKeyModified()
+{
+	if(this->observer)
+	{
+		this->observer->defaultKeyModified();
+	}
+	if(this->owner)
+	{
+		this->owner->notifyDataChanged();
+	}
+}
@@ -16,16 +16,136 @@
  */
 #ifndef KEEPASSX_ENTRYATTRIBUTES_H
 #define KEEPASSX_ENTRYATTRIBUTES_H
-#include <QMap>
-#include <QObject>
-#include <QSet>
+#include <QList>
+#include <QPointer>
+#include <QStringList>
+#include <array>
+class Entry;
+class StringPool;
 
-class EntryAttributes:public QObject
+/**
+* Told about the changes of an EntryAttributes object it is set on, see
+* EntryAttributes::setObserver(). The entry owning the attributes is
+* notified directly instead.
+*/
+class EntryAttributesObserver
 {
-	Q_OBJECT public:
-	explicit EntryAttributes(
-		QObject* parent = nullptr
-	);
+public:
+	virtual ~EntryAttributesObserver()
+	{
+	}
+
+	virtual void modified()
+	{
+	}
+
+	virtual void defaultKeyModified()
+	{
+	}
+
+	virtual void customKeyModified(
+		const QString &key
+	)
+	{
+		Q_UNUSED(
+			key
+		);
+	}
+
+	virtual void aboutToBeAdded(
+		const QString &key
+	)
+	{
+		Q_UNUSED(
+			key
+		);
+	}
+
+	virtual void added(
+		const QString &key
+	)
+	{
+		Q_UNUSED(
+			key
+		);
+	}
+
+	virtual void aboutToBeRemoved(
+		const QString &key
+	)
+	{
+		Q_UNUSED(
+			key
+		);
+	}
+
+	virtual void removed(
+		const QString &key
+	)
+	{
+		Q_UNUSED(
+			key
+		);
+	}
+
+	virtual void aboutToRename(
+		const QString &oldKey,
+		const QString &newKey
+	)
+	{
+		Q_UNUSED(
+			oldKey
+		);
+		Q_UNUSED(
+			newKey
+		);
+	}
+
+	virtual void renamed(
+		const QString &oldKey,
+		const QString &newKey
+	)
+	{
+		Q_UNUSED(
+			oldKey
+		);
+		Q_UNUSED(
+			newKey
+		);
+	}
+
+	virtual void aboutToBeReset()
+	{
+	}
+
+	virtual void reset()
+	{
+	}
+};
+
+/**
+* The attributes of an entry. A plain class rather than a QObject, so an
+* entry doesn't pay for a QObject per container. Changes are reported to
+* the owning entry and to at most one observer.
+*/
+class EntryAttributes
+{
+	friend class Entry;
+public:
+	/**
+	* The standard attributes in the order of DefaultAttributes.
+	*/
+	enum StandardKey: u_int8_t
+	{
+		Title = 0,
+		UserName = 1,
+		Password = 2,
+		URL = 3,
+		Notes = 4
+	};
+
+	static constexpr int StandardKeyCount = Notes + 1;
+	EntryAttributes();
 	QList<QString> getKeys() const;
 	bool hasKey(
 		const QString &key
@@ -34,6 +154,12 @@ class EntryAttributes:public QObject
 	QString getValue(
 		const QString &key
 	) const;
+	/**
+	* Same as getValue() for a standard attribute, but without a key lookup.
+	*/
+	const QString &getValue(
+		StandardKey key
+	) const;
 	bool isProtected(
 		const QString &key
 	) const;
@@ -66,6 +192,14 @@ class EntryAttributes:public QObject
 	bool operator!=(
 		const EntryAttributes &other
 	) const;
+	StringPool* getStringPool() const;
+	/**
+	* Interns the keys and the unprotected values through pool, usually the
+	* one of the database the entry belongs to.
+	*/
+	void setStringPool(
+		StringPool* pool
+	);
 	static const QString TitleKey;
 	static const QString UserNameKey;
 	static const QString PasswordKey;
@@ -75,36 +209,56 @@ class EntryAttributes:public QObject
 	static bool isDefaultAttribute(
 		const QString &key
 	);
-Q_SIGNALS:
-	void sig_modified();
-	void sig_defaultKeyModified();
-	void sig_customKeyModified(
-		const QString &key
+	/**
+	* Reports the changes to observer, nullptr stops it.
+	*/
+	void setObserver(
+		EntryAttributesObserver* observer
 	);
-	void sig_aboutToBeAdded(
+private:
+	struct CustomAttribute
+	{
+		QString key;
+		QString value;
+		bool isProtected;
+
+		bool operator==(
+			const CustomAttribute &other
+		) const;
+	};
+
+	// DefaultAttributes in the order of getKeys()
+	static const QStringList SortedDefaultAttributes;
+	static int standardIndex(
 		const QString &key
 	);
-	void sig_added(
+	static bool isKeyLess(
+		const CustomAttribute &attribute,
 		const QString &key
 	);
-	void sig_aboutToBeRemoved(
+	qsizetype lowerBound(
 		const QString &key
-	);
-	void sig_removed(
+	) const;
+	qsizetype indexOf(
 		const QString &key
-	);
-	void sig_aboutToRename(
-		const QString &oldKey,
-		const QString &newKey
-	);
-	void sig_renamed(
-		const QString &oldKey,
-		const QString &newKey
-	);
-	void sig_aboutToBeReset();
-	void sig_reset();
-private:
-	QMap<QString, QString> attributes;
-	QSet<QString> protectedAttributes;
+	) const;
+	QString intern(
+		const QString &value,
+		bool protect
+	) const;
+	void internAll();
+	void emitModified();
+	void emitDefaultKeyModified();
+	// the standard attributes always exist, the custom ones are sorted by key
+	std::array<QString, StandardKeyCount> standardValues;
+	quint8 standardProtected;
+	QList<CustomAttribute> customAttributes;
+	QPointer<StringPool> pool;
+	// the entry the attributes belong to, notified without a connection
+	Entry* owner;
+	EntryAttributesObserver* observer;
+	Q_DISABLE_COPY(
+		EntryAttributes
+	)
 };
 #endif // KEEPASSX_ENTRYATTRIBUTES_H
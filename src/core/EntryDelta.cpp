@@ -0,0 +1,328 @@
+/*
+ *  Copyright (C) 2026 The cpp-password-manager contributors
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "EntryDelta.h"
+#include "core/AttachmentStore.h"
+#include "core/Entry.h"
+#include "core/Global.h"
+
+EntryDelta EntryDelta::diff(
+	const Entry* item,
+	const Entry* newer
+)
+{
+	EntryDelta delta_;
+	delta_.data = item->data;
+	const EntryAttributes* attributes_ = item->attributes;
+	const EntryAttributes* newerAttributes_ = newer ? newer->attributes :
+		nullptr;
+	const QList<QString> keys_ = attributes_->getKeys();
+	for(const QString &key_: keys_)
+	{
+		const QString value_ = attributes_->getValue(
+			key_
+		);
+		const bool isProtected_ = attributes_->isProtected(
+			key_
+		);
+		if(newerAttributes_ && newerAttributes_->hasKey(
+			key_
+		) && newerAttributes_->getValue(
+			key_
+		) == value_ && newerAttributes_->isProtected(
+			key_
+		) == isProtected_)
+		{
+			continue;
+		}
+		const Attribute attribute_{
+			key_,
+			value_,
+			isProtected_,
+			false
+		};
+		delta_.attributes.append(
+			attribute_
+		);
+	}
+	if(newerAttributes_)
+	{
+		const QList<QString> newerKeys_ = newerAttributes_->getCustomKeys();
+		for(const QString &key_: newerKeys_)
+		{
+			if(!attributes_->hasKey(
+				key_
+			))
+			{
+				const Attribute attribute_{
+					key_,
+					QString(),
+					false,
+					true
+				};
+				delta_.attributes.append(
+					attribute_
+				);
+			}
+		}
+	}
+	const EntryAttachments* attachments_ = item->attachments;
+	const EntryAttachments* newerAttachments_ = newer ? newer->attachments :
+		nullptr;
+	const QList<QString> attachmentKeys_ = attachments_->getKeys();
+	for(const QString &key_: attachmentKeys_)
+	{
+		const QByteArray digest_ = attachments_->getDigest(
+			key_
+		);
+		if(newerAttachments_ && newerAttachments_->hasKey(
+			key_
+		) && newerAttachments_->getDigest(
+			key_
+		) == digest_)
+		{
+			continue;
+		}
+		const Attachment attachment_{
+			key_,
+			attachments_->getValue(
+				key_
+			),
+			digest_,
+			false
+		};
+		delta_.attachments.append(
+			attachment_
+		);
+	}
+	if(newerAttachments_)
+	{
+		const QList<QString> newerKeys_ = newerAttachments_->getKeys();
+		for(const QString &key_: newerKeys_)
+		{
+			if(!attachments_->hasKey(
+				key_
+			))
+			{
+				const Attachment attachment_{
+					key_,
+					QByteArray(),
+					QByteArray(),
+					true
+				};
+				delta_.attachments.append(
+					attachment_
+				);
+			}
+		}
+	}
+	delta_.attributesSize = 0;
+	for(const Attribute &attribute_: asConst(
+			delta_.attributes
+		))
+	{
+		if(!attribute_.removed)
+		{
+			delta_.attributesSize += static_cast<int>(attribute_.value.toUtf8().
+				size());
+		}
+	}
+	return delta_;
+}
+
+void EntryDelta::apply(
+	Entry* entry
+) const
+{
+	entry->data = this->data;
+	for(const Attribute &attribute_: this->attributes)
+	{
+		if(attribute_.removed)
+		{
+			entry->attributes->remove(
+				attribute_.key
+			);
+		}
+		else
+		{
+			entry->attributes->set(
+				attribute_.key,
+				attribute_.value,
+				attribute_.isProtected
+			);
+		}
+	}
+	for(const Attachment &attachment_: this->attachments)
+	{
+		if(attachment_.removed)
+		{
+			entry->attachments->remove(
+				attachment_.key
+			);
+		}
+		else
+		{
+			entry->attachments->setWithDigest(
+				attachment_.key,
+				attachment_.value,
+				attachment_.digest
+			);
+		}
+	}
+}
+
+const EntryData &EntryDelta::getData() const
+{
+	return this->data;
+}
+
+void EntryDelta::resetCustomIcon(
+	const UUID &uuid
+)
+{
+	if(this->data.customIcon == uuid)
+	{
+		this->data.iconNumber = 0;
+		this->data.customIcon = UUID();
+	}
+}
+
+QList<QPair<QByteArray, QByteArray>> EntryDelta::getAttachments() const
+{
+	QList<QPair<QByteArray, QByteArray>> attachments_;
+	for(const Attachment &attachment_: this->attachments)
+	{
+		if(!attachment_.removed)
+		{
+			attachments_.append(
+				qMakePair(
+					attachment_.digest,
+					attachment_.value
+				)
+			);
+		}
+	}
+	return attachments_;
+}
+
+int EntryDelta::getAttributesSize(
+	const EntryAttributes* base
+) const
+{
+	if(!base)
+	{
+		return this->attributesSize;
+	}
+	auto size_ = 0;
+	for(const Attribute &attribute_: this->attributes)
+	{
+		if(attribute_.removed || (base->hasKey(
+			attribute_.key
+		) && base->getValue(
+			attribute_.key
+		) == attribute_.value))
+		{
+			continue;
+		}
+		size_ += static_cast<int>(attribute_.value.toUtf8().size());
+	}
+	return size_;
+}
+
+int EntryDelta::getAttachmentsSize(
+	QSet<QByteArray>* counted
+) const
+{
+	auto size_ = 0;
+	for(const Attachment &attachment_: this->attachments)
+	{
+		if(attachment_.removed || counted->contains(
+			attachment_.digest
+		))
+		{
+			continue;
+		}
+		size_ += static_cast<int>(attachment_.value.size());
+		counted->insert(
+			attachment_.digest
+		);
+	}
+	return size_;
+}
+
+int EntryDelta::countAttachments(
+	QHash<QByteArray, int>* counts,
+	AttachmentStore* store
+) const
+{
+	auto size_ = 0;
+	for(const Attachment &attachment_: this->attachments)
+	{
+		if(attachment_.removed)
+		{
+			continue;
+		}
+		int &count_ = (*counts)[attachment_.digest];
+		if(count_++ == 0)
+		{
+			size_ += static_cast<int>(attachment_.value.size());
+			if(store)
+			{
+				store->acquire(
+					attachment_.digest,
+					attachment_.value
+				);
+			}
+		}
+	}
+	return size_;
+}
+
+int EntryDelta::uncountAttachments(
+	QHash<QByteArray, int>* counts,
+	AttachmentStore* store
+) const
+{
+	auto size_ = 0;
+	for(const Attachment &attachment_: this->attachments)
+	{
+		if(attachment_.removed)
+		{
+			continue;
+		}
+		const auto i_ = counts->find(
+			attachment_.digest
+		);
+		if(i_ == counts->end())
+		{
+			continue;
+		}
+		if(--i_.value() == 0)
+		{
+			size_ += static_cast<int>(attachment_.value.size());
+			counts->erase(
+				i_
+			);
+			if(store)
+			{
+				store->release(
+					attachment_.digest
+				);
+			}
+		}
+	}
+	return size_;
+}
@@ -0,0 +1,132 @@
+/*
+ *  Copyright (C) 2026 The cpp-password-manager contributors
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef KEEPASSX_ENTRYDELTA_H
+#define KEEPASSX_ENTRYDELTA_H
+#include <QColor>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QSet>
+#include "core/TimeInfo.h"
+#include "core/UUID.h"
+class AttachmentStore;
+class Entry;
+class EntryAttributes;
+
+struct EntryData
+{
+	int iconNumber;
+	UUID customIcon;
+	QColor foregroundColor;
+	QColor backgroundColor;
+	QString overrideUrl;
+	QString tags;
+	TimeInfo timeInfo;
+};
+
+/**
+* A history item stored as the attributes and attachments that differ from
+* the next newer history item. The newest item of a history is stored
+* against an empty entry, i.e. with all of its fields.
+*/
+class EntryDelta final
+{
+public:
+	/**
+	* Records the fields of item that differ from newer, all fields if newer
+	* is nullptr.
+	*/
+	static EntryDelta diff(
+		const Entry* item,
+		const Entry* newer
+	);
+	/**
+	* Turns entry, holding the state of the next newer item, into the item.
+	*/
+	void apply(
+		Entry* entry
+	) const;
+	/**
+	* The data of the item, which the delta always carries in full.
+	*/
+	const EntryData &getData() const;
+	/**
+	* Sets the default icon if the item uses the custom icon uuid.
+	*/
+	void resetCustomIcon(
+		const UUID &uuid
+	);
+	/**
+	* Digests and values of the attachments the delta carries.
+	*/
+	QList<QPair<QByteArray, QByteArray>> getAttachments() const;
+	/**
+	* Size in bytes of the attribute values the delta carries, skipping the
+	* ones that are equal in base.
+	*/
+	int getAttributesSize(
+		const EntryAttributes* base = nullptr
+	) const;
+	/**
+	* Size in bytes of the attachments the delta carries whose digest isn't
+	* in counted yet, the digests are added to counted.
+	*/
+	int getAttachmentsSize(
+		QSet<QByteArray>* counted
+	) const;
+	/**
+	* Adds the attachments the delta carries to counts, keyed by digest, and
+	* returns the size of the ones that weren't counted before. A reference
+	* to each of those is taken in store.
+	*/
+	int countAttachments(
+		QHash<QByteArray, int>* counts,
+		AttachmentStore* store
+	) const;
+	/**
+	* Removes the attachments the delta carries from counts and returns the
+	* size of the ones that are no longer counted, their references in store
+	* are released.
+	*/
+	int uncountAttachments(
+		QHash<QByteArray, int>* counts,
+		AttachmentStore* store
+	) const;
+private:
+	struct Attribute
+	{
+		QString key;
+		QString value;
+		bool isProtected;
+		bool removed;
+	};
+
+	struct Attachment
+	{
+		QString key;
+		QByteArray value;
+		QByteArray digest;
+		bool removed;
+	};
+
+	EntryData data;
+	QList<Attribute> attributes;
+	QList<Attachment> attachments;
+	// size of the attribute values, fixed once the delta is built
+	int attributesSize;
+};
+#endif // KEEPASSX_ENTRYDELTA_H
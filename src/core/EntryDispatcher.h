@@ -0,0 +1,53 @@
+/*
+ *  Copyright (C) 2026 The cpp-password-manager contributors
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef KEEPASSX_ENTRYDISPATCHER_H
+#define KEEPASSX_ENTRYDISPATCHER_H
+#include <QObject>
+class Entry;
+
+/**
+* Routes the change notifications of all entries of a database. Entries
+* report their changes here instead of carrying signal connections of
+* their own, models and the database subscribe once per database.
+*/
+class EntryDispatcher final:public QObject
+{
+	Q_OBJECT public:
+	explicit EntryDispatcher(
+		QObject* parent = nullptr
+	);
+	void dispatchModified(
+		Entry* entry
+	);
+	void dispatchDataChanged(
+		Entry* entry
+	);
+Q_SIGNALS:
+	/**
+	* Emitted when an entry, its attributes or its attachments change.
+	*/
+	void sig_entryModified(
+		Entry* entry
+	);
+	/**
+	* Emitted when a default attribute or the icon of an entry changes.
+	*/
+	void sig_entryDataChanged(
+		Entry* entry
+	);
+};
+#endif // KEEPASSX_ENTRYDISPATCHER_H
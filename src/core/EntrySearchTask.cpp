@@ -0,0 +1,420 @@
+/*
+ *  Copyright (C) 2026 The cpp-password-manager contributors
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "EntrySearchTask.h"
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QtConcurrent>
+#include <algorithm>
+#include "core/Database.h"
+#include "core/Group.h"
+// matches collected before the worker hands them over
+static const int BatchSize = 1024;
+// longest time in milliseconds the worker keeps matches back
+static const qint64 BatchInterval = 30;
+// items matched between two checks for cancellation
+static const qsizetype CancelCheckInterval = 256;
+// items matched in parallel between two checks for cancellation
+static const qsizetype ParallelStep = 65536;
+
+EntrySearchTask::EntrySearchTask(
+	QObject* parent
+)
+	: QObject(
+		parent
+	),
+	generation(
+		0
+	),
+	searcher(
+		new EntrySearcher(
+			this
+		)
+	),
+	restartTimer(
+		new QTimer(
+			this
+		)
+	),
+	caseSensitivity(
+		Qt::CaseInsensitive
+	),
+	limit(
+		0
+	),
+	more(
+		false
+	),
+	running(
+		false
+	),
+	delivered(
+		false
+	)
+{
+	this->query.caseSensitivity = Qt::CaseInsensitive;
+	this->restartTimer->setSingleShot(
+		true
+	);
+	this->restartTimer->setInterval(
+		0
+	);
+	this->connect(
+		this->restartTimer,
+		&QTimer::timeout,
+		this,
+		&EntrySearchTask::do_restart
+	);
+	this->connect(
+		this,
+		&EntrySearchTask::sig_batchFound,
+		this,
+		&EntrySearchTask::do_batchFound,
+		Qt::QueuedConnection
+	);
+	this->connect(
+		this,
+		&EntrySearchTask::sig_batchesDone,
+		this,
+		&EntrySearchTask::do_batchesDone,
+		Qt::QueuedConnection
+	);
+}
+
+EntrySearchTask::~EntrySearchTask()
+{
+	this->stop();
+	this->future.waitForFinished();
+}
+
+void EntrySearchTask::start(
+	const QString &searchTerm,
+	Group* group,
+	const Qt::CaseSensitivity caseSensitivity,
+	const int limit
+)
+{
+	this->searchTerm = searchTerm;
+	this->group = group;
+	this->caseSensitivity = caseSensitivity;
+	this->limit = limit;
+	this->deliveredEntries.clear();
+	this->launch();
+}
+
+void EntrySearchTask::fetchMore()
+{
+	if(this->running || !this->more)
+	{
+		return;
+	}
+	if(!this->group)
+	{
+		this->more = false;
+		return;
+	}
+	this->limit *= 2;
+	this->launch();
+}
+
+void EntrySearchTask::setParallelThreshold(
+	const int threshold
+)
+{
+	this->searcher->setParallelThreshold(
+		threshold
+	);
+}
+
+bool EntrySearchTask::hasMore() const
+{
+	return this->more;
+}
+
+void EntrySearchTask::launch()
+{
+	this->stop();
+	this->running = true;
+	this->more = false;
+	// a following page appends to the matches shown already
+	this->delivered = !this->deliveredEntries.isEmpty();
+	this->db = this->group ? this->group->getDatabase() : nullptr;
+	if(this->db)
+	{
+		this->connect(
+			this->db,
+			&Database::sig_modifiedImmediate,
+			this,
+			&EntrySearchTask::do_databaseModified
+		);
+	}
+	this->query = EntrySearcher::parseQuery(
+		this->searchTerm,
+		this->caseSensitivity
+	);
+	SearchScope scope_;
+	scope_.collected = true;
+	if(this->group)
+	{
+		scope_ = this->searcher->collectScope(
+			this->query,
+			this->group
+		);
+	}
+	this->future = QtConcurrent::run(
+		&EntrySearchTask::run,
+		this,
+		this->generation.loadRelaxed(),
+		scope_,
+		this->query,
+		this->limit,
+		this->searcher->getParallelThreshold()
+	);
+}
+
+void EntrySearchTask::cancel()
+{
+	this->stop();
+	this->running = false;
+	this->more = false;
+	this->deliveredEntries.clear();
+}
+
+bool EntrySearchTask::isRunning() const
+{
+	return this->running;
+}
+
+void EntrySearchTask::do_batchFound(
+	const int generation,
+	const QList<Entry*> &entries
+)
+{
+	// batches of a cancelled search may still be queued
+	if(generation != this->generation.loadRelaxed())
+	{
+		return;
+	}
+	// ranked matches arrive by score and skip the ones shown already
+	QList<Entry*> found_;
+	if(this->limit > 0)
+	{
+		for(Entry* entry_: entries)
+		{
+			if(!this->deliveredEntries.contains(
+				entry_
+			))
+			{
+				this->deliveredEntries.insert(
+					entry_
+				);
+				found_.append(
+					entry_
+				);
+			}
+		}
+	}
+	else
+	{
+		found_ = entries;
+	}
+	const bool replace_ = !this->delivered;
+	if(found_.isEmpty() && !replace_)
+	{
+		return;
+	}
+	this->delivered = true;
+	this->sig_entriesFound(
+		found_,
+		replace_
+	);
+}
+
+void EntrySearchTask::do_batchesDone(
+	const int generation,
+	const qsizetype matchCount,
+	const QList<SearchItem> &matches
+)
+{
+	if(generation != this->generation.loadRelaxed())
+	{
+		return;
+	}
+	this->stop();
+	this->running = false;
+	this->more = this->limit > 0 && matchCount > this->deliveredEntries.size();
+	// ranked searches aren't cached
+	if(this->group && this->limit == 0)
+	{
+		this->searcher->cacheMatches(
+			this->query,
+			this->group,
+			matches
+		);
+	}
+	if(!this->delivered)
+	{
+		this->delivered = true;
+		this->sig_entriesFound(
+			QList<Entry*>(),
+			true
+		);
+	}
+	this->sig_finished();
+}
+
+void EntrySearchTask::do_databaseModified()
+{
+	// the entries of the running search may be gone, so its results are
+	// dropped right away. The tree may be in the middle of a change, the
+	// search starts over from the event loop
+	this->stop();
+	this->restartTimer->start();
+}
+
+void EntrySearchTask::do_restart()
+{
+	if(!this->running)
+	{
+		return;
+	}
+	if(!this->group)
+	{
+		this->running = false;
+		this->sig_entriesFound(
+			QList<Entry*>(),
+			true
+		);
+		this->sig_finished();
+		return;
+	}
+	// a ranked search starts over with the matches shown so far
+	this->deliveredEntries.clear();
+	this->launch();
+}
+
+void EntrySearchTask::stop()
+{
+	this->generation.fetchAndAddRelaxed(
+		1
+	);
+	this->restartTimer->stop();
+	if(this->db)
+	{
+		this->disconnect(
+			this->db,
+			&Database::sig_modifiedImmediate,
+			this,
+			&EntrySearchTask::do_databaseModified
+		);
+	}
+}
+
+void EntrySearchTask::run(
+	EntrySearchTask* task,
+	const int generation,
+	const SearchScope &scope,
+	const SearchQuery &query,
+	const int limit,
+	const int parallelThreshold
+)
+{
+	const QList<SearchItem> items_ = EntrySearcher::buildItems(
+		query,
+		scope
+	);
+	const bool parallel_ = parallelThreshold > 0 && items_.size() >=
+		parallelThreshold;
+	// the items are matched in steps, the search is cancelled in between
+	const qsizetype step_ = parallel_ ? ParallelStep : CancelCheckInterval;
+	SearchRanking ranking_(
+		limit
+	);
+	qsizetype matchCount_ = 0;
+	QList<Entry*> batch_;
+	// handed to the task to be cached, in the order of the items
+	QList<SearchItem> matches_;
+	QElapsedTimer timer_;
+	timer_.start();
+	for(qsizetype begin_ = 0; begin_ < items_.size(); begin_ += step_)
+	{
+		if(task->generation.loadRelaxed() != generation)
+		{
+			return;
+		}
+		for(const qsizetype i_: EntrySearcher::matchItems(
+				query,
+				items_,
+				begin_,
+				std::min(
+					begin_ + step_,
+					items_.size()
+				),
+				parallel_
+			))
+		{
+			const SearchItem &item_ = items_.at(
+				i_
+			);
+			if(limit > 0)
+			{
+				ranking_.add(
+					item_.entry,
+					EntrySearcher::scoreItem(
+						query,
+						item_
+					)
+				);
+				continue;
+			}
+			matchCount_++;
+			batch_.append(
+				item_.entry
+			);
+			matches_.append(
+				item_
+			);
+			if(batch_.size() >= BatchSize || timer_.elapsed() >= BatchInterval)
+			{
+				task->sig_batchFound(
+					generation,
+					batch_
+				);
+				batch_.clear();
+				timer_.restart();
+			}
+		}
+	}
+	if(limit > 0)
+	{
+		// ranked searches report their matches at once, best first. The
+		// task skips the ones it reported already
+		matchCount_ = ranking_.count();
+		batch_ = ranking_.takeEntries();
+	}
+	if(!batch_.isEmpty())
+	{
+		task->sig_batchFound(
+			generation,
+			batch_
+		);
+	}
+	task->sig_batchesDone(
+		generation,
+		matchCount_,
+		matches_
+	);
+}
@@ -0,0 +1,134 @@
+/*
+ *  Copyright (C) 2026 The cpp-password-manager contributors
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef KEEPASSX_ENTRYSEARCHTASK_H
+#define KEEPASSX_ENTRYSEARCHTASK_H
+#include <QAtomicInt>
+#include <QFuture>
+#include <QObject>
+#include <QPointer>
+#include <QSet>
+#include "core/EntrySearcher.h"
+class Database;
+class Group;
+class QTimer;
+
+/**
+* Runs an EntrySearcher search on a worker thread. The calling thread only
+* takes shared copies of the search index, see EntrySearcher::collectScope(),
+* the worker builds the items from them, matches them and reports the
+* matches in batches. Finished searches are cached by the
+* searcher, so typing on refines the last result. Starting a new search, cancelling or
+* modifying the database drops the results of the running search, a
+* modification starts it over.
+*
+* A search with a limit is ranked: the worker keeps the best limit matches
+* and reports them at once, best first. fetchMore() reports the following
+* ones, skipping the entries reported already. Large searches are matched on the thread pool, see
+* EntrySearcher::setParallelThreshold().
+*/
+class EntrySearchTask final:public QObject
+{
+	Q_OBJECT public:
+	explicit EntrySearchTask(
+		QObject* parent = nullptr
+	);
+	virtual ~EntrySearchTask() override;
+	void start(
+		const QString &searchTerm,
+		Group* group,
+		Qt::CaseSensitivity caseSensitivity,
+		int limit = 0
+	);
+	/**
+	* Ranks the last search again with twice the limit and reports the
+	* matches it didn't report yet as a batch that doesn't replace. Entries
+	* that moved up since are reported once.
+	*/
+	void fetchMore();
+	/**
+	* Returns whether the last ranked search dropped matches.
+	*/
+	bool hasMore() const;
+	/**
+	* See EntrySearcher::setParallelThreshold().
+	*/
+	void setParallelThreshold(
+		int threshold
+	);
+	void cancel();
+	bool isRunning() const;
+Q_SIGNALS:
+	/**
+	* Emitted for every batch of matches. The first batch of a search has
+	* replace set and is emitted even if nothing matched.
+	*/
+	void sig_entriesFound(
+		const QList<Entry*> &entries,
+		bool replace
+	);
+	void sig_finished();
+	// emitted on the worker thread, received on the thread of the task
+	void sig_batchFound(
+		int generation,
+		const QList<Entry*> &entries
+	);
+	void sig_batchesDone(
+		int generation,
+		qsizetype matchCount,
+		const QList<SearchItem> &matches
+	);
+private Q_SLOTS:
+	void do_batchFound(
+		int generation,
+		const QList<Entry*> &entries
+	);
+	void do_batchesDone(
+		int generation,
+		qsizetype matchCount,
+		const QList<SearchItem> &matches
+	);
+	void do_databaseModified();
+	void do_restart();
+private:
+	void launch();
+	void stop();
+	static void run(
+		EntrySearchTask* task,
+		int generation,
+		const SearchScope &scope,
+		const SearchQuery &query,
+		int limit,
+		int parallelThreshold
+	);
+	QAtomicInt generation;
+	QFuture<void> future;
+	EntrySearcher* const searcher;
+	QPointer<Group> group;
+	QPointer<Database> db;
+	QTimer* restartTimer;
+	QString searchTerm;
+	SearchQuery query;
+	Qt::CaseSensitivity caseSensitivity;
+	// ranked searches report the matches up to limit that weren't reported
+	// yet, the ranking may have changed since the last page
+	int limit;
+	QSet<const Entry*> deliveredEntries;
+	bool more;
+	bool running;
+	bool delivered;
+};
+#endif // KEEPASSX_ENTRYSEARCHTASK_H
@@ -15,7 +15,291 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "EntrySearcher.h"
+#include <QDateTime>
+#include <QRegularExpression>
+#include <QSet>
+#include <QThread>
+#include <QtConcurrent>
+#include <algorithm>
+#include "core/Database.h"
+#include "core/Global.h"
 #include "core/Group.h"
+// fields in SearchItem::fieldStarts
+static const int FieldCount = 4;
+// score of a word found in the title, username, URL and notes
+static const double FieldWeights[] = {
+	40.0,
+	20.0,
+	15.0,
+	5.0
+};
+// protected fields are only searched as a whole, not by position
+static const double ProtectedWeight = 5.0;
+// added when a word starts a field or follows a non-alphanumeric character
+static const double FieldStartBonus = 10.0;
+static const double WordStartBonus = 5.0;
+// score of an entry modified just now, it halves after RecencyDays days
+static const double RecencyWeight = 10.0;
+static const double RecencyDays = 30.0;
+static const double MSecsPerDay = 86400000.0;
+// ranges per thread of a parallel match, more than one evens out the load
+static const int RangesPerThread = 4;
+// ranges aren't split below this many items
+static const qsizetype MinRangeSize = 256;
+
+/**
+* Items of a parallel match handed to one thread.
+*/
+struct ItemRange
+{
+	const SearchQuery* query;
+	const QList<SearchItem>* items;
+	qsizetype begin;
+	qsizetype end;
+};
+
+static QList<qsizetype> matchRange(
+	const ItemRange &range
+)
+{
+	QList<qsizetype> matches_;
+	for(qsizetype i_ = range.begin; i_ < range.end; i_++)
+	{
+		if(EntrySearcher::matchItem(
+			*range.query,
+			range.items->at(
+				i_
+			)
+		))
+		{
+			matches_.append(
+				i_
+			);
+		}
+	}
+	return matches_;
+}
+
+static QString unquote(
+	const QString &word
+)
+{
+	return QString(
+		word
+	).remove(
+		'"'
+	);
+}
+
+/**
+* Finds the span of field in the text of item. Returns false for a
+* protected field.
+*/
+static bool getFieldSpan(
+	const SearchItem &item,
+	const int field,
+	qsizetype* start,
+	qsizetype* end
+)
+{
+	if(item.fieldStarts[field] < 0)
+	{
+		return false;
+	}
+	*start = item.fieldStarts[field];
+	// the field ends before the separator of the next unprotected one
+	*end = item.text.size();
+	for(int i_ = field + 1; i_ < FieldCount; i_++)
+	{
+		if(item.fieldStarts[i_] >= 0)
+		{
+			*end = item.fieldStarts[i_] - 1;
+			break;
+		}
+	}
+	return true;
+}
+
+/**
+* Returns the value of the protected field of item.
+*/
+static QString getProtectedField(
+	const SearchItem &item,
+	const int field
+)
+{
+	// the protected values are kept in the order of the fields
+	qsizetype index_ = 0;
+	for(int i_ = 0; i_ < field; i_++)
+	{
+		if(item.fieldStarts[i_] < 0)
+		{
+			index_++;
+		}
+	}
+	return item.protectedValues.value(
+		index_
+	);
+}
+
+/**
+* Returns the relative cost of matching predicate, the details of the
+* entries are cheaper to compare than their text.
+*/
+static int getPredicateCost(
+	const SearchPredicate &predicate
+)
+{
+	switch(predicate.kind)
+	{
+		case SearchPredicate::Expired:
+		case SearchPredicate::Modified:
+			return 0;
+		case SearchPredicate::Tag:
+		case SearchPredicate::GroupName:
+			return 1;
+		case SearchPredicate::Field:
+			return 2;
+		case SearchPredicate::Word:
+			return 3;
+		default:
+			return 4;
+	}
+}
+
+SearchRanking::SearchRanking(
+	const int limit
+)
+	: limit(
+		limit
+	),
+	matchCount(
+		0
+	)
+{
+	this->heap.reserve(
+		limit
+	);
+}
+
+void SearchRanking::add(
+	Entry* entry,
+	const double score
+)
+{
+	const Match match_{
+		score,
+		this->matchCount++,
+		entry
+	};
+	if(this->heap.size() < this->limit)
+	{
+		this->heap.append(
+			match_
+		);
+		std::push_heap(
+			this->heap.begin(),
+			this->heap.end(),
+			isBetter
+		);
+		return;
+	}
+	if(this->heap.isEmpty() || !isBetter(
+		match_,
+		this->heap.first()
+	))
+	{
+		return;
+	}
+	std::pop_heap(
+		this->heap.begin(),
+		this->heap.end(),
+		isBetter
+	);
+	this->heap.last() = match_;
+	std::push_heap(
+		this->heap.begin(),
+		this->heap.end(),
+		isBetter
+	);
+}
+
+qsizetype SearchRanking::count() const
+{
+	return this->matchCount;
+}
+
+QList<Entry*> SearchRanking::takeEntries()
+{
+	std::sort_heap(
+		this->heap.begin(),
+		this->heap.end(),
+		isBetter
+	);
+	QList<Entry*> entries_;
+	entries_.reserve(
+		this->heap.size()
+	);
+	for(const Match &match_: asConst(
+			this->heap
+		))
+	{
+		entries_.append(
+			match_.entry
+		);
+	}
+	this->heap.clear();
+	return entries_;
+}
+
+bool SearchRanking::isBetter(
+	const Match &a,
+	const Match &b
+)
+{
+	// equal scores keep the order of the tree
+	if(a.score != b.score)
+	{
+		return a.score > b.score;
+	}
+	return a.order < b.order;
+}
+
+EntrySearcher::EntrySearcher(
+	QObject* parent
+)
+	: QObject(
+		parent
+	),
+	cachedGroup(
+		nullptr
+	),
+	parallelThreshold(
+		DefaultParallelThreshold
+	)
+{
+	this->cachedQuery.caseSensitivity = Qt::CaseInsensitive;
+}
+
+void EntrySearcher::setParallelThreshold(
+	const int threshold
+)
+{
+	this->parallelThreshold = threshold;
+}
+
+int EntrySearcher::getParallelThreshold() const
+{
+	return this->parallelThreshold;
+}
+
+bool EntrySearcher::isParallel(
+	const qsizetype itemCount
+) const
+{
+	return this->parallelThreshold > 0 && itemCount >= this->
+		parallelThreshold;
+}
 
 QList<Entry*> EntrySearcher::search(
 	const QString &searchTerm,
@@ -23,32 +307,767 @@ QList<Entry*> EntrySearcher::search(
 	const Qt::CaseSensitivity caseSensitivity
 )
 {
-	if(!group->isResolveSearchingEnabled())
+	const SearchQuery query_ = parseQuery(
+		searchTerm,
+		caseSensitivity
+	);
+	const QList<SearchItem> items_ = this->collectItems(
+		query_,
+		group
+	);
+	QList<SearchItem> matches_;
+	QList<Entry*> searchResult_;
+	for(const qsizetype i_: matchItems(
+			query_,
+			items_,
+			0,
+			items_.size(),
+			this->isParallel(
+				items_.size()
+			)
+		))
 	{
-		return QList<Entry*>();
+		const SearchItem &item_ = items_.at(
+			i_
+		);
+		matches_.append(
+			item_
+		);
+		searchResult_.append(
+			item_.entry
+		);
 	}
-	return this->searchEntries(
-		searchTerm,
+	this->cacheMatches(
+		query_,
 		group,
-		caseSensitivity
+		matches_
 	);
+	return searchResult_;
 }
 
-QList<Entry*> EntrySearcher::searchEntries(
+QList<Entry*> EntrySearcher::searchRanked(
 	const QString &searchTerm,
 	const Group* group,
+	const Qt::CaseSensitivity caseSensitivity,
+	const int limit,
+	qsizetype* matchCount
+)
+{
+	const SearchQuery query_ = parseQuery(
+		searchTerm,
+		caseSensitivity
+	);
+	const QList<SearchItem> items_ = this->collectItems(
+		query_,
+		group
+	);
+	QList<SearchItem> matches_;
+	SearchRanking ranking_(
+		limit
+	);
+	for(const qsizetype i_: matchItems(
+			query_,
+			items_,
+			0,
+			items_.size(),
+			this->isParallel(
+				items_.size()
+			)
+		))
+	{
+		const SearchItem &item_ = items_.at(
+			i_
+		);
+		matches_.append(
+			item_
+		);
+		ranking_.add(
+			item_.entry,
+			scoreItem(
+				query_,
+				item_
+			)
+		);
+	}
+	this->cacheMatches(
+		query_,
+		group,
+		matches_
+	);
+	if(matchCount)
+	{
+		*matchCount = ranking_.count();
+	}
+	return ranking_.takeEntries();
+}
+
+SearchQuery EntrySearcher::parseQuery(
+	const QString &searchTerm,
 	const Qt::CaseSensitivity caseSensitivity
 )
 {
-	QList<Entry*> searchResult_;
+	SearchQuery query_;
+	query_.caseSensitivity = caseSensitivity;
+	query_.now = QDateTime::currentMSecsSinceEpoch();
+	query_.needsTags = false;
+	query_.needsGroup = false;
+	query_.needsExpiry = false;
+	for(const QString &token_: splitSearchTerm(
+			searchTerm
+		))
+	{
+		SearchPredicate predicate_;
+		predicate_.negated = false;
+		predicate_.field = -1;
+		predicate_.flag = false;
+		predicate_.time = 0;
+		QString word_ = token_;
+		if(word_.size() > 1 && word_.startsWith(
+			'-'
+		))
+		{
+			predicate_.negated = true;
+			word_.remove(
+				0,
+				1
+			);
+		}
+		// a quoted colon is part of the word
+		const qsizetype colon_ = word_.indexOf(
+			':'
+		);
+		const qsizetype quote_ = word_.indexOf(
+			'"'
+		);
+		if(colon_ <= 0 || (quote_ != -1 && quote_ < colon_) || !
+			parseQualified(
+				word_.left(
+					colon_
+				).toLower(),
+				unquote(
+					word_.mid(
+						colon_ + 1
+					)
+				),
+				query_.now,
+				&predicate_
+			))
+		{
+			predicate_.kind = SearchPredicate::Word;
+			predicate_.value = unquote(
+				word_
+			);
+			if(predicate_.value.isEmpty())
+			{
+				continue;
+			}
+		}
+		predicate_.foldedValue = caseSensitivity == Qt::CaseInsensitive ?
+			SearchIndex::fold(
+				predicate_.value
+			) : predicate_.value;
+		switch(predicate_.kind)
+		{
+			case SearchPredicate::Word:
+			case SearchPredicate::Field:
+				if(!predicate_.negated)
+				{
+					query_.words.append(
+						predicate_.value
+					);
+					if(caseSensitivity == Qt::CaseInsensitive)
+					{
+						query_.foldedWords.append(
+							predicate_.foldedValue
+						);
+					}
+				}
+				break;
+			case SearchPredicate::Attribute:
+				if(!query_.attributeNames.contains(
+					predicate_.name
+				))
+				{
+					query_.attributeNames.append(
+						predicate_.name
+					);
+				}
+				break;
+			case SearchPredicate::Tag:
+				query_.needsTags = true;
+				break;
+			case SearchPredicate::GroupName:
+				query_.needsGroup = true;
+				break;
+			case SearchPredicate::Expired:
+				query_.needsExpiry = true;
+				break;
+			default:
+				break;
+		}
+		query_.plan.append(
+			predicate_
+		);
+	}
+	std::stable_sort(
+		query_.plan.begin(),
+		query_.plan.end(),
+		isCheaper
+	);
+	return query_;
+}
+
+QStringList EntrySearcher::splitSearchTerm(
+	const QString &searchTerm
+)
+{
+	// the quotes are kept, they tell a prefix from a quoted colon
+	QStringList tokens_;
+	QString token_;
+	bool quoted_ = false;
+	for(const QChar c_: searchTerm)
+	{
+		if(c_ == '"')
+		{
+			quoted_ = !quoted_;
+		}
+		else if(!quoted_ && c_.isSpace())
+		{
+			if(!token_.isEmpty())
+			{
+				tokens_.append(
+					token_
+				);
+				token_.clear();
+			}
+			continue;
+		}
+		token_ += c_;
+	}
+	if(!token_.isEmpty())
+	{
+		tokens_.append(
+			token_
+		);
+	}
+	return tokens_;
+}
+
+bool EntrySearcher::parseQualified(
+	const QString &prefix,
+	const QString &value,
+	const qint64 now,
+	SearchPredicate* predicate
+)
+{
+	static const QStringList fields_ = {
+		"title",
+		"user",
+		"url",
+		"notes"
+	};
+	static const QStringList yes_ = {
+		"yes",
+		"true",
+		"1"
+	};
+	static const QStringList no_ = {
+		"no",
+		"false",
+		"0"
+	};
+	static const QRegularExpression age_(
+		"^([<>])(\\d{1,6})d$"
+	);
+	if(const qsizetype field_ = fields_.indexOf(
+		prefix
+	); field_ != -1)
+	{
+		if(value.isEmpty())
+		{
+			return false;
+		}
+		predicate->kind = SearchPredicate::Field;
+		predicate->field = static_cast<int>(field_);
+		predicate->value = value;
+		return true;
+	}
+	if(prefix == "attr")
+	{
+		// attr:Name only asks for the attribute
+		const qsizetype equals_ = value.indexOf(
+			'='
+		);
+		const QString name_ = equals_ == -1 ? value : value.left(
+			equals_
+		);
+		if(name_.isEmpty())
+		{
+			return false;
+		}
+		predicate->kind = SearchPredicate::Attribute;
+		predicate->name = name_;
+		predicate->value = equals_ == -1 ? QString() : value.mid(
+			equals_ + 1
+		);
+		return true;
+	}
+	if(prefix == "tag" || prefix == "group")
+	{
+		if(value.isEmpty())
+		{
+			return false;
+		}
+		predicate->kind = prefix == "tag" ? SearchPredicate::Tag :
+			SearchPredicate::GroupName;
+		predicate->value = value;
+		return true;
+	}
+	if(prefix == "expired")
+	{
+		const QString lower_ = value.toLower();
+		if(!yes_.contains(
+			lower_
+		) && !no_.contains(
+			lower_
+		))
+		{
+			return false;
+		}
+		predicate->kind = SearchPredicate::Expired;
+		predicate->flag = yes_.contains(
+			lower_
+		);
+		predicate->value = value;
+		return true;
+	}
+	if(prefix == "modified")
+	{
+		const QRegularExpressionMatch match_ = age_.match(
+			value
+		);
+		if(!match_.hasMatch())
+		{
+			return false;
+		}
+		predicate->kind = SearchPredicate::Modified;
+		predicate->flag = match_.captured(
+			1
+		) == "<";
+		predicate->time = now - static_cast<qint64>(match_.captured(
+			2
+		).toInt() * MSecsPerDay);
+		predicate->value = value;
+		return true;
+	}
+	return false;
+}
+
+bool EntrySearcher::isCheaper(
+	const SearchPredicate &a,
+	const SearchPredicate &b
+)
+{
+	const int costA_ = getPredicateCost(
+		a
+	);
+	const int costB_ = getPredicateCost(
+		b
+	);
+	if(costA_ != costB_)
+	{
+		return costA_ < costB_;
+	}
+	// a long word rules out more entries than a short or a negated one
+	if(a.negated != b.negated)
+	{
+		return !a.negated;
+	}
+	return a.value.size() > b.value.size();
+}
+
+bool EntrySearcher::implies(
+	const SearchPredicate &predicate,
+	const SearchPredicate &cachedPredicate
+)
+{
+	if(predicate.kind != cachedPredicate.kind || predicate.negated !=
+		cachedPredicate.negated || predicate.field != cachedPredicate.field
+		|| predicate.name != cachedPredicate.name)
+	{
+		return false;
+	}
+	switch(predicate.kind)
+	{
+		case SearchPredicate::Tag:
+			return predicate.foldedValue == cachedPredicate.foldedValue;
+		case SearchPredicate::Expired:
+			return predicate.flag == cachedPredicate.flag;
+		case SearchPredicate::Modified:
+			// a shorter span of time only drops entries
+			return predicate.flag == cachedPredicate.flag && (predicate.flag
+				? predicate.time >= cachedPredicate.time : predicate.time <=
+				cachedPredicate.time);
+		default:
+			// a longer word only drops entries, a shorter one only when it
+			// is negated
+			if(predicate.negated)
+			{
+				return cachedPredicate.foldedValue.contains(
+					predicate.foldedValue,
+					Qt::CaseSensitive
+				);
+			}
+			return predicate.foldedValue.contains(
+				cachedPredicate.foldedValue,
+				Qt::CaseSensitive
+			);
+	}
+}
+
+QList<SearchItem> EntrySearcher::collectItems(
+	const SearchQuery &query,
+	const Group* group
+)
+{
+	QList<SearchItem> items_;
+	if(!group->isResolveSearchingEnabled())
+	{
+		return items_;
+	}
+	if(this->isRefinement(
+		query,
+		group
+	))
+	{
+		return this->cachedMatches;
+	}
+	const Database* db_ = group->getDatabase();
+	SearchIndex* index_ = db_ ? db_->getSearchIndex() : nullptr;
+	QSet<Entry*> candidates_;
+	if(!index_ || !index_->findCandidates(
+		query.words,
+		&candidates_
+	))
+	{
+		this->collectEntries(
+			query,
+			group,
+			index_,
+			&items_
+		);
+		return items_;
+	}
+	// the candidates are sorted by their position within their group, then
+	// the groups are walked in the order collectEntries() visits them
+	QHash<const Group*, QMap<int, Entry*>> byGroup_;
+	for(Entry* entry_: asConst(
+			candidates_
+		))
+	{
+		const Group* group_ = entry_->getGroup();
+		byGroup_[group_].insert(
+			group_->indexOfEntry(
+				entry_
+			),
+			entry_
+		);
+	}
+	this->collectCandidates(
+		query,
+		group,
+		index_,
+		&byGroup_,
+		&items_
+	);
+	return items_;
+}
+
+SearchScope EntrySearcher::collectScope(
+	const SearchQuery &query,
+	const Group* group
+)
+{
+	SearchScope scope_;
+	scope_.collected = true;
+	if(!group->isResolveSearchingEnabled())
+	{
+		return scope_;
+	}
+	const Database* db_ = group->getDatabase();
+	SearchIndex* index_ = db_ ? db_->getSearchIndex() : nullptr;
+	// the cached matches and the details the index doesn't keep are only
+	// read on this thread
+	if(!index_ || this->isRefinement(
+		query,
+		group
+	) || query.needsTags || query.needsGroup || query.needsExpiry || !query.
+		attributeNames.isEmpty())
+	{
+		scope_.items = this->collectItems(
+			query,
+			group
+		);
+		return scope_;
+	}
+	scope_.collected = false;
+	scope_.snapshot = index_->snapshot();
+	collectGroupEntries(
+		group,
+		&scope_.groupEntries
+	);
+	return scope_;
+}
+
+QList<SearchItem> EntrySearcher::buildItems(
+	const SearchQuery &query,
+	const SearchScope &scope
+)
+{
+	if(scope.collected)
+	{
+		return scope.items;
+	}
+	QSet<Entry*> candidates_;
+	const bool narrowed_ = SearchIndex::findCandidates(
+		scope.snapshot,
+		query.words,
+		&candidates_
+	);
+	QList<SearchItem> items_;
+	for(const QList<Entry*> &entries_: scope.groupEntries)
+	{
+		for(Entry* entry_: entries_)
+		{
+			if(narrowed_ && !candidates_.contains(
+				entry_
+			))
+			{
+				continue;
+			}
+			SearchItem item_;
+			if(SearchIndex::getItem(
+				scope.snapshot,
+				entry_,
+				&item_
+			))
+			{
+				items_.append(
+					item_
+				);
+			}
+		}
+	}
+	return items_;
+}
+
+void EntrySearcher::cacheMatches(
+	const SearchQuery &query,
+	const Group* group,
+	const QList<SearchItem> &matches
+)
+{
+	this->do_clearCache();
+	// without a database nothing reports the changes of the entries
+	const Database* db_ = group->getDatabase();
+	if(!db_)
+	{
+		return;
+	}
+	this->cachedGroup = group;
+	this->cachedDatabase = db_;
+	this->cachedQuery = query;
+	this->cachedMatches = matches;
+	this->connect(
+		db_,
+		&Database::sig_modifiedImmediate,
+		this,
+		&EntrySearcher::do_clearCache
+	);
+}
+
+bool EntrySearcher::hasCachedMatches() const
+{
+	return this->cachedGroup && this->cachedDatabase;
+}
+
+bool EntrySearcher::matchItem(
+	const SearchQuery &query,
+	const SearchItem &item
+)
+{
+	for(const SearchPredicate &predicate_: query.plan)
+	{
+		if(matchPredicate(
+			query,
+			predicate_,
+			item
+		) == predicate_.negated)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+QList<qsizetype> EntrySearcher::matchItems(
+	const SearchQuery &query,
+	const QList<SearchItem> &items,
+	const qsizetype begin,
+	const qsizetype end,
+	const bool parallel
+)
+{
+	const qsizetype rangeCount_ = parallel ? std::min(
+		(end - begin) / MinRangeSize,
+		static_cast<qsizetype>(QThread::idealThreadCount()) * RangesPerThread
+	) : 1;
+	if(rangeCount_ <= 1)
+	{
+		return matchRange(
+			ItemRange{
+				&query,
+				&items,
+				begin,
+				end
+			}
+		);
+	}
+	const qsizetype rangeSize_ = (end - begin + rangeCount_ - 1) /
+		rangeCount_;
+	QList<ItemRange> ranges_;
+	for(qsizetype i_ = begin; i_ < end; i_ += rangeSize_)
+	{
+		ranges_.append(
+			ItemRange{
+				&query,
+				&items,
+				i_,
+				std::min(
+					i_ + rangeSize_,
+					end
+				)
+			}
+		);
+	}
+	// the results of the ranges come back in the order of the ranges
+	QList<qsizetype> matches_;
+	for(const QList<qsizetype> &rangeMatches_: QtConcurrent::blockingMapped(
+			ranges_,
+			matchRange
+		))
+	{
+		matches_.append(
+			rangeMatches_
+		);
+	}
+	return matches_;
+}
+
+double EntrySearcher::scoreItem(
+	const SearchQuery &query,
+	const SearchItem &item
+)
+{
+	double score_ = 0.0;
+	for(qsizetype i_ = 0; i_ < query.words.size(); i_++)
+	{
+		score_ += scoreWord(
+			query,
+			i_,
+			item
+		);
+	}
+	const double age_ = std::max(
+		static_cast<double>(query.now - item.lastModified),
+		0.0
+	) / MSecsPerDay;
+	return score_ + RecencyWeight / (1.0 + age_ / RecencyDays);
+}
+
+void EntrySearcher::do_clearCache()
+{
+	if(this->cachedDatabase)
+	{
+		this->disconnect(
+			this->cachedDatabase,
+			&Database::sig_modifiedImmediate,
+			this,
+			&EntrySearcher::do_clearCache
+		);
+	}
+	this->cachedGroup = nullptr;
+	this->cachedDatabase = nullptr;
+	this->cachedQuery.words.clear();
+	this->cachedQuery.foldedWords.clear();
+	this->cachedMatches.clear();
+}
+
+bool EntrySearcher::isRefinement(
+	const SearchQuery &query,
+	const Group* group
+) const
+{
+	if(!this->hasCachedMatches() || this->cachedGroup != group || this
+		->cachedQuery.caseSensitivity != query.caseSensitivity)
+	{
+		return false;
+	}
+	// the cached items only carry the details the cached query looked at
+	if((query.needsTags && !this->cachedQuery.needsTags) || (query.
+		needsGroup && !this->cachedQuery.needsGroup) || (query.needsExpiry &&
+		!this->cachedQuery.needsExpiry))
+	{
+		return false;
+	}
+	for(const QString &name_: query.attributeNames)
+	{
+		if(!this->cachedQuery.attributeNames.contains(
+			name_
+		))
+		{
+			return false;
+		}
+	}
+	// every entry matching the query matches the cached query if each
+	// cached predicate is implied by one of the predicates
+	for(const SearchPredicate &cachedPredicate_: this->cachedQuery.plan)
+	{
+		bool implied_ = false;
+		for(const SearchPredicate &predicate_: query.plan)
+		{
+			if(implies(
+				predicate_,
+				cachedPredicate_
+			))
+			{
+				implied_ = true;
+				break;
+			}
+		}
+		if(!implied_)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void EntrySearcher::collectEntries(
+	const SearchQuery &query,
+	const Group* group,
+	const SearchIndex* index,
+	QList<SearchItem>* items
+)
+{
 	const QList<Entry*> &entryList_ = group->getEntries();
 	for(Entry* entry_: entryList_)
 	{
-		searchResult_.append(
-			matchEntry(
-				searchTerm,
+		items->append(
+			makeItem(
+				query,
 				entry_,
-				caseSensitivity
+				index
 			)
 		);
 	}
@@ -57,61 +1076,307 @@ QList<Entry*> EntrySearcher::searchEntries(
 	{
 		if(childGroup_->isSearchingEnabled() != Group::Disable)
 		{
-			searchResult_.append(
-				this->searchEntries(
-					searchTerm,
-					childGroup_,
-					caseSensitivity
-				)
+			this->collectEntries(
+				query,
+				childGroup_,
+				index,
+				items
 			);
 		}
 	}
-	return searchResult_;
 }
 
-QList<Entry*> EntrySearcher::matchEntry(
-	const QString &searchTerm,
+void EntrySearcher::collectGroupEntries(
+	const Group* group,
+	QList<QList<Entry*>>* groupEntries
+)
+{
+	groupEntries->append(
+		group->getEntries()
+	);
+	const QList<Group*> &children_ = group->getChildren();
+	for(const Group* childGroup_: children_)
+	{
+		if(childGroup_->isSearchingEnabled() != Group::Disable)
+		{
+			collectGroupEntries(
+				childGroup_,
+				groupEntries
+			);
+		}
+	}
+}
+
+void EntrySearcher::collectCandidates(
+	const SearchQuery &query,
+	const Group* group,
+	const SearchIndex* index,
+	QHash<const Group*, QMap<int, Entry*>>* candidates,
+	QList<SearchItem>* items
+)
+{
+	if(candidates->isEmpty())
+	{
+		return;
+	}
+	for(Entry* entry_: candidates->take(
+			group
+		))
+	{
+		items->append(
+			makeItem(
+				query,
+				entry_,
+				index
+			)
+		);
+	}
+	const QList<Group*> &children_ = group->getChildren();
+	for(const Group* childGroup_: children_)
+	{
+		if(childGroup_->isSearchingEnabled() != Group::Disable)
+		{
+			this->collectCandidates(
+				query,
+				childGroup_,
+				index,
+				candidates,
+				items
+			);
+		}
+	}
+}
+
+SearchItem EntrySearcher::makeItem(
+	const SearchQuery &query,
 	Entry* entry,
-	const Qt::CaseSensitivity caseSensitivity
-) const
+	const SearchIndex* index
+)
 {
-	const QStringList wordList_ = searchTerm.split(
-		QRegularExpression(
-			"\\s"
-		),
-		Qt::SkipEmptyParts
+	static const QRegularExpression tagSeparator_(
+		"[;,]"
 	);
-	for(const QString &word_: wordList_)
+	SearchItem item_;
+	if(!index || !index->getItem(
+		entry,
+		&item_
+	))
 	{
-		if(!this->wordMatch(
-			word_,
-			entry,
-			caseSensitivity
+		item_ = SearchIndex::makeItem(
+			entry
+		);
+	}
+	if(query.needsTags)
+	{
+		for(const QString &tag_: entry->getTags().split(
+				tagSeparator_,
+				Qt::SkipEmptyParts
+			))
+		{
+			if(const QString trimmed_ = tag_.trimmed(); !trimmed_.isEmpty())
+			{
+				item_.tags.append(
+					trimmed_
+				);
+			}
+		}
+	}
+	if(query.needsGroup && entry->getGroup())
+	{
+		item_.groupName = entry->getGroup()->getName();
+	}
+	if(query.needsExpiry)
+	{
+		item_.expired = entry->isExpired();
+	}
+	const EntryAttributes* attributes_ = entry->getAttributes();
+	for(const QString &name_: query.attributeNames)
+	{
+		// passwords are never searched
+		if(name_ != EntryAttributes::PasswordKey && attributes_->hasKey(
+			name_
 		))
 		{
-			return QList<Entry*>();
+			item_.attributes.insert(
+				name_,
+				attributes_->getValue(
+					name_
+				)
+			);
 		}
 	}
-	return QList<Entry*>() << entry;
+	return item_;
 }
 
-bool EntrySearcher::wordMatch(
-	const QString &word,
-	const Entry* entry,
-	const Qt::CaseSensitivity caseSensitivity
+bool EntrySearcher::matchPredicate(
+	const SearchQuery &query,
+	const SearchPredicate &predicate,
+	const SearchItem &item
 )
 {
-	return entry->getTitle().contains(
-		word,
-		caseSensitivity
-	) || entry->getUsername().contains(
-		word,
-		caseSensitivity
-	) || entry->getURL().contains(
-		word,
-		caseSensitivity
-	) || entry->getNotes().contains(
-		word,
-		caseSensitivity
+	// the folded text only has to be compared as is, which QString does
+	// with vectorized code
+	const QString &text_ = query.caseSensitivity == Qt::CaseInsensitive ?
+		item.foldedText : item.text;
+	switch(predicate.kind)
+	{
+		case SearchPredicate::Word:
+			if(text_.contains(
+				predicate.foldedValue,
+				Qt::CaseSensitive
+			))
+			{
+				return true;
+			}
+			for(const QString &value_: item.protectedValues)
+			{
+				if(value_.contains(
+					predicate.value,
+					query.caseSensitivity
+				))
+				{
+					return true;
+				}
+			}
+			return false;
+		case SearchPredicate::Field:
+		{
+			qsizetype start_;
+			qsizetype end_;
+			if(!getFieldSpan(
+				item,
+				predicate.field,
+				&start_,
+				&end_
+			))
+			{
+				return getProtectedField(
+					item,
+					predicate.field
+				).contains(
+					predicate.value,
+					query.caseSensitivity
+				);
+			}
+			const qsizetype pos_ = text_.indexOf(
+				predicate.foldedValue,
+				start_,
+				Qt::CaseSensitive
+			);
+			return pos_ != -1 && pos_ + predicate.foldedValue.size() <= end_;
+		}
+		case SearchPredicate::Attribute:
+		{
+			const auto value_ = item.attributes.constFind(
+				predicate.name
+			);
+			return value_ != item.attributes.constEnd() && value_.value().
+				contains(
+					predicate.value,
+					query.caseSensitivity
+				);
+		}
+		case SearchPredicate::Tag:
+			for(const QString &tag_: item.tags)
+			{
+				if(tag_.compare(
+					predicate.value,
+					query.caseSensitivity
+				) == 0)
+				{
+					return true;
+				}
+			}
+			return false;
+		case SearchPredicate::GroupName:
+			return item.groupName.contains(
+				predicate.value,
+				query.caseSensitivity
+			);
+		case SearchPredicate::Expired:
+			return item.expired == predicate.flag;
+		case SearchPredicate::Modified:
+			return predicate.flag ? item.lastModified >= predicate.time : item
+				.lastModified < predicate.time;
+		default:
+			return false;
+	}
+}
+
+double EntrySearcher::scoreWord(
+	const SearchQuery &query,
+	const qsizetype word,
+	const SearchItem &item
+)
+{
+	const bool folded_ = query.caseSensitivity == Qt::CaseInsensitive;
+	const QString &text_ = folded_ ? item.foldedText : item.text;
+	const QString &word_ = folded_ ? query.foldedWords.at(
+		word
+	) : query.words.at(
+		word
 	);
+	double best_ = 0.0;
+	for(int i_ = 0; i_ < FieldCount; i_++)
+	{
+		qsizetype start_;
+		qsizetype end_;
+		if(FieldWeights[i_] + FieldStartBonus <= best_ || !getFieldSpan(
+			item,
+			i_,
+			&start_,
+			&end_
+		))
+		{
+			continue;
+		}
+		qsizetype pos_ = text_.indexOf(
+			word_,
+			start_,
+			Qt::CaseSensitive
+		);
+		while(pos_ != -1 && pos_ + word_.size() <= end_)
+		{
+			double score_ = FieldWeights[i_];
+			if(pos_ == start_)
+			{
+				score_ += FieldStartBonus;
+			}
+			else if(!text_.at(
+				pos_ - 1
+			).isLetterOrNumber())
+			{
+				score_ += WordStartBonus;
+			}
+			best_ = std::max(
+				best_,
+				score_
+			);
+			if(score_ >= FieldWeights[i_] + WordStartBonus)
+			{
+				break;
+			}
+			pos_ = text_.indexOf(
+				word_,
+				pos_ + 1,
+				Qt::CaseSensitive
+			);
+		}
+	}
+	if(best_ == 0.0)
+	{
+		for(const QString &value_: item.protectedValues)
+		{
+			if(value_.contains(
+				query.words.at(
+					word
+				),
+				query.caseSensitivity
+			))
+			{
+				return ProtectedWeight;
+			}
+		}
+	}
+	return best_;
 }
@@ -16,34 +16,306 @@
  */
 #ifndef KEEPASSX_ENTRYSEARCHER_H
 #define KEEPASSX_ENTRYSEARCHER_H
-#include <QRegularExpression>
+#include <QHash>
+#include <QMap>
+#include <QList>
+#include <QObject>
+#include <QPointer>
 #include <QString>
+#include <QStringList>
+#include "core/SearchIndex.h"
+class Database;
 class Group;
 class Entry;
 
-class EntrySearcher
+/**
+* One condition of a search term, like a word, title:word or -tag:name.
+*/
+struct SearchPredicate
+{
+	enum Kind: u_int8_t
+	{
+		Word = 0,
+		Field = 1,
+		Attribute = 2,
+		Tag = 3,
+		GroupName = 4,
+		Expired = 5,
+		Modified = 6
+	};
+
+	Kind kind;
+	bool negated;
+	// index into SearchItem::fieldStarts for Field
+	int field;
+	// attribute name for Attribute
+	QString name;
+	QString value;
+	// value folded like the folded text, for case insensitive searches
+	QString foldedValue;
+	// expired:yes for Expired, modified:< for Modified
+	bool flag;
+	// modification boundary in milliseconds since the epoch for Modified
+	qint64 time;
+};
+
+/**
+* A search term parsed into the predicates an entry has to match, cheapest
+* first. The words are the text an entry has to contain, they narrow the
+* entries down through the search index and rank the matches.
+*/
+struct SearchQuery
+{
+	QList<SearchPredicate> plan;
+	QStringList words;
+	QStringList foldedWords;
+	Qt::CaseSensitivity caseSensitivity;
+	// milliseconds since the epoch the recency of the matches is scored
+	// against
+	qint64 now;
+	// the details of the entries the plan looks at besides their text
+	bool needsTags;
+	bool needsGroup;
+	bool needsExpiry;
+	QStringList attributeNames;
+};
+
+/**
+* What a search below a group matches, taken on the thread of the group by
+* EntrySearcher::collectScope(). Either the items are collected already or
+* a snapshot of the search index and the entry lists of the searched
+* groups are kept, which EntrySearcher::buildItems() turns into items on
+* any thread.
+*/
+struct SearchScope
+{
+	bool collected;
+	QList<SearchItem> items;
+	SearchSnapshot snapshot;
+	// in the order collectItems() walks the groups
+	QList<QList<Entry*>> groupEntries;
+};
+
+/**
+* Keeps the best scored matches of a ranked search in a heap of at most
+* limit entries, so scanning a large database only sorts a few of them.
+*/
+class SearchRanking final
 {
 public:
+	explicit SearchRanking(
+		int limit
+	);
+	void add(
+		Entry* entry,
+		double score
+	);
+	/**
+	* Returns the number of matches added, including the dropped ones.
+	*/
+	qsizetype count() const;
+	/**
+	* Returns the kept entries, best first, and empties the ranking.
+	*/
+	QList<Entry*> takeEntries();
+private:
+	struct Match
+	{
+		double score;
+		qsizetype order;
+		Entry* entry;
+	};
+	static bool isBetter(
+		const Match &a,
+		const Match &b
+	);
+	int limit;
+	qsizetype matchCount;
+	// the worst kept match is on top
+	QList<Match> heap;
+};
+
+/**
+* Searches the entries of a group tree. The matches of the last search in a
+* database are kept until the database is modified, a search for a query
+* that only adds characters or words to the last one just filters them.
+*/
+class EntrySearcher final:public QObject
+{
+	Q_OBJECT public:
+	static constexpr int DefaultParallelThreshold = 20000;
+	explicit EntrySearcher(
+		QObject* parent = nullptr
+	);
+	/**
+	* Sets the number of items from which a search matches them on the
+	* thread pool, 0 turns it off.
+	*/
+	void setParallelThreshold(
+		int threshold
+	);
+	int getParallelThreshold() const;
+	bool isParallel(
+		qsizetype itemCount
+	) const;
+	/**
+	* Returns the entries below group that match searchTerm, see
+	* parseQuery(). Plain words are searched in the title, username, URL
+	* and notes. Groups of a database are searched through its
+	* SearchIndex.
+	*/
 	QList<Entry*> search(
 		const QString &searchTerm,
 		const Group* group,
 		Qt::CaseSensitivity caseSensitivity
 	);
-private:
-	QList<Entry*> searchEntries(
+	/**
+	* Returns the limit best matches of search() by scoreItem(), best
+	* first. matchCount receives the number of all matches.
+	*/
+	QList<Entry*> searchRanked(
 		const QString &searchTerm,
 		const Group* group,
-		Qt::CaseSensitivity caseSensitivity
+		Qt::CaseSensitivity caseSensitivity,
+		int limit,
+		qsizetype* matchCount = nullptr
 	);
-	QList<Entry*> matchEntry(
+	/**
+	* Parses searchTerm. Words are separated by whitespace unless quoted,
+	* a leading - negates a word. Prefixed words only match a detail of
+	* the entries: title:, user:, url:, notes:, attr:Name=value, tag:,
+	* group:, expired:yes or expired:no and modified:<30d or
+	* modified:>365d. Words with an unknown prefix are plain words.
+	*/
+	static SearchQuery parseQuery(
 		const QString &searchTerm,
-		Entry* entry,
 		Qt::CaseSensitivity caseSensitivity
+	);
+	/**
+	* Returns the entries a search for query below group has to match, in
+	* the order search() returns them. These are the cached matches if the
+	* query refines the last search, otherwise the group tree is only
+	* walked if the search index can't narrow down the entries.
+	*/
+	QList<SearchItem> collectItems(
+		const SearchQuery &query,
+		const Group* group
+	);
+	/**
+	* Takes what buildItems() needs to return the items of collectItems()
+	* on another thread. Only shared copies of the search index columns and
+	* of the entry lists of the groups are taken, unless the query refines
+	* the last search or looks at details of the entries the index doesn't
+	* keep, then the items are collected right away.
+	*/
+	SearchScope collectScope(
+		const SearchQuery &query,
+		const Group* group
+	);
+	/**
+	* Returns the items of scope without looking at the entries, can be
+	* called on any thread.
+	*/
+	static QList<SearchItem> buildItems(
+		const SearchQuery &query,
+		const SearchScope &scope
+	);
+	/**
+	* Keeps matches as the result of searching query below group, for
+	* searches that match outside of search().
+	*/
+	void cacheMatches(
+		const SearchQuery &query,
+		const Group* group,
+		const QList<SearchItem> &matches
+	);
+	bool hasCachedMatches() const;
+	static bool matchItem(
+		const SearchQuery &query,
+		const SearchItem &item
+	);
+	/**
+	* Returns the indexes of the items from begin to end that match query,
+	* in order. In parallel the items are split into ranges matched on the
+	* global thread pool, the calling thread matches one of them too.
+	*/
+	static QList<qsizetype> matchItems(
+		const SearchQuery &query,
+		const QList<SearchItem> &items,
+		qsizetype begin,
+		qsizetype end,
+		bool parallel
+	);
+	/**
+	* Scores a match of query. Each word counts with the best field it is
+	* found in, title before username, URL and notes, more so at the start
+	* of the field or of a word. Recently modified entries score higher.
+	*/
+	static double scoreItem(
+		const SearchQuery &query,
+		const SearchItem &item
+	);
+public Q_SLOTS:
+	void do_clearCache();
+private:
+	static QStringList splitSearchTerm(
+		const QString &searchTerm
+	);
+	static bool parseQualified(
+		const QString &prefix,
+		const QString &value,
+		qint64 now,
+		SearchPredicate* predicate
+	);
+	static bool isCheaper(
+		const SearchPredicate &a,
+		const SearchPredicate &b
+	);
+	static bool implies(
+		const SearchPredicate &predicate,
+		const SearchPredicate &cachedPredicate
+	);
+	bool isRefinement(
+		const SearchQuery &query,
+		const Group* group
 	) const;
-	static bool wordMatch(
-		const QString &word,
-		const Entry* entry,
-		Qt::CaseSensitivity caseSensitivity
+	void collectEntries(
+		const SearchQuery &query,
+		const Group* group,
+		const SearchIndex* index,
+		QList<SearchItem>* items
+	);
+	static void collectGroupEntries(
+		const Group* group,
+		QList<QList<Entry*>>* groupEntries
+	);
+	void collectCandidates(
+		const SearchQuery &query,
+		const Group* group,
+		const SearchIndex* index,
+		QHash<const Group*, QMap<int, Entry*>>* candidates,
+		QList<SearchItem>* items
+	);
+	static SearchItem makeItem(
+		const SearchQuery &query,
+		Entry* entry,
+		const SearchIndex* index
+	);
+	static bool matchPredicate(
+		const SearchQuery &query,
+		const SearchPredicate &predicate,
+		const SearchItem &item
+	);
+	static double scoreWord(
+		const SearchQuery &query,
+		qsizetype word,
+		const SearchItem &item
 	);
+	// the group is only compared, the database reports its deletion
+	const Group* cachedGroup;
+	QPointer<const Database> cachedDatabase;
+	SearchQuery cachedQuery;
+	QList<SearchItem> cachedMatches;
+	int parallelThreshold;
 };
 #endif // KEEPASSX_ENTRYSEARCHER_H
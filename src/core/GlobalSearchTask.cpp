@@ -0,0 +1,286 @@
+/*
+ *  Copyright (C) 2026 The cpp-password-manager contributors
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "GlobalSearchTask.h"
+#include <algorithm>
+#include "core/Database.h"
+#include "core/EntrySearchTask.h"
+#include "core/Global.h"
+#include "core/Group.h"
+#include "core/SearchIndex.h"
+
+GlobalSearchTask::GlobalSearchTask(
+	QObject* parent
+)
+	: QObject(
+		parent
+	),
+	limit(
+		0
+	),
+	parallelThreshold(
+		EntrySearcher::DefaultParallelThreshold
+	),
+	running(
+		false
+	)
+{
+	this->query.caseSensitivity = Qt::CaseInsensitive;
+}
+
+GlobalSearchTask::~GlobalSearchTask()
+{
+	this->clearTasks();
+}
+
+void GlobalSearchTask::start(
+	const QString &searchTerm,
+	const QList<Database*> &databases,
+	const Qt::CaseSensitivity caseSensitivity,
+	const int limit
+)
+{
+	this->clearTasks();
+	this->query = EntrySearcher::parseQuery(
+		searchTerm,
+		caseSensitivity
+	);
+	this->limit = limit;
+	this->running = true;
+	if(databases.isEmpty())
+	{
+		this->running = false;
+		this->sig_entriesFound(
+			QList<Entry*>()
+		);
+		this->sig_finished();
+		return;
+	}
+	for(Database* db_: databases)
+	{
+		const auto task_ = new EntrySearchTask(
+			this
+		);
+		task_->setParallelThreshold(
+			this->parallelThreshold
+		);
+		this->connect(
+			task_,
+			&EntrySearchTask::sig_entriesFound,
+			this,
+			&GlobalSearchTask::do_entriesFound
+		);
+		this->connect(
+			task_,
+			&EntrySearchTask::sig_finished,
+			this,
+			&GlobalSearchTask::do_taskFinished
+		);
+		this->tasks.append(
+			task_
+		);
+		// every task only takes shared copies of the search index of its
+		// database on this thread, the items are built on a worker
+		task_->start(
+			searchTerm,
+			db_->getRootGroup(),
+			caseSensitivity,
+			limit
+		);
+	}
+}
+
+void GlobalSearchTask::setParallelThreshold(
+	const int threshold
+)
+{
+	this->parallelThreshold = threshold;
+	for(EntrySearchTask* task_: asConst(
+			this->tasks
+		))
+	{
+		task_->setParallelThreshold(
+			threshold
+		);
+	}
+}
+
+void GlobalSearchTask::cancel()
+{
+	this->clearTasks();
+	this->running = false;
+}
+
+bool GlobalSearchTask::isRunning() const
+{
+	return this->running;
+}
+
+qsizetype GlobalSearchTask::getDatabaseCount() const
+{
+	return this->tasks.size();
+}
+
+qsizetype GlobalSearchTask::getFinishedCount() const
+{
+	return this->finishedTasks.size();
+}
+
+void GlobalSearchTask::do_entriesFound(
+	const QList<Entry*> &entries,
+	const bool replace
+)
+{
+	const auto task_ = static_cast<EntrySearchTask*>(this->sender());
+	const int database_ = static_cast<int>(this->tasks.indexOf(
+		task_
+	));
+	if(database_ == -1)
+	{
+		return;
+	}
+	QList<Match> &matches_ = this->matches[task_];
+	if(replace)
+	{
+		matches_.clear();
+	}
+	// the matches are scored again here to compare them across databases,
+	// a ranked task reports at most limit of them
+	for(Entry* entry_: entries)
+	{
+		Match match_;
+		match_.entry = entry_;
+		match_.db = entry_->getGroup()->getDatabase();
+		match_.uuid = entry_->getUUID();
+		match_.score = EntrySearcher::scoreItem(
+			this->query,
+			SearchIndex::makeItem(
+				entry_
+			)
+		);
+		match_.database = database_;
+		match_.position = static_cast<int>(matches_.size());
+		matches_.append(
+			match_
+		);
+	}
+}
+
+void GlobalSearchTask::do_taskFinished()
+{
+	const auto task_ = static_cast<EntrySearchTask*>(this->sender());
+	if(!this->tasks.contains(
+		task_
+	))
+	{
+		return;
+	}
+	// a task whose database was modified reports again, its new matches
+	// replace the old ones
+	this->finishedTasks.insert(
+		task_
+	);
+	this->sig_entriesFound(
+		this->merge()
+	);
+	if(this->running && this->finishedTasks.size() == this->tasks.size())
+	{
+		this->running = false;
+		this->sig_finished();
+	}
+}
+
+bool GlobalSearchTask::isBetter(
+	const Match &match,
+	const Match &other
+)
+{
+	if(match.score != other.score)
+	{
+		return match.score > other.score;
+	}
+	if(match.database != other.database)
+	{
+		return match.database < other.database;
+	}
+	return match.position < other.position;
+}
+
+QList<Entry*> GlobalSearchTask::merge() const
+{
+	QList<Match> merged_;
+	for(const EntrySearchTask* task_: this->finishedTasks)
+	{
+		for(const Match &match_: this->matches.value(
+				task_
+			))
+		{
+			// entries deleted since they were reported are left out
+			if(match_.db && match_.db->containsEntry(
+				match_.uuid,
+				match_.entry
+			))
+			{
+				merged_.append(
+					match_
+				);
+			}
+		}
+	}
+	std::sort(
+		merged_.begin(),
+		merged_.end(),
+		&GlobalSearchTask::isBetter
+	);
+	if(this->limit > 0 && merged_.size() > this->limit)
+	{
+		merged_.resize(
+			this->limit
+		);
+	}
+	QList<Entry*> entries_;
+	entries_.reserve(
+		merged_.size()
+	);
+	for(const Match &match_: asConst(
+			merged_
+		))
+	{
+		entries_.append(
+			match_.entry
+		);
+	}
+	return entries_;
+}
+
+void GlobalSearchTask::clearTasks()
+{
+	for(EntrySearchTask* task_: asConst(
+			this->tasks
+		))
+	{
+		task_->disconnect(
+			this
+		);
+		task_->cancel();
+		// the task may be the sender of the signal that started this
+		// search
+		task_->deleteLater();
+	}
+	this->tasks.clear();
+	this->matches.clear();
+	this->finishedTasks.clear();
+}
@@ -0,0 +1,113 @@
+/*
+ *  Copyright (C) 2026 The cpp-password-manager contributors
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef KEEPASSX_GLOBALSEARCHTASK_H
+#define KEEPASSX_GLOBALSEARCHTASK_H
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QSet>
+#include "core/EntrySearcher.h"
+#include "core/UUID.h"
+class Database;
+class Entry;
+class EntrySearchTask;
+
+/**
+* Runs one ranked search in several databases at once. Each database is
+* searched by an EntrySearchTask of its own, so a large database doesn't
+* hold back the results of the others. Whenever one of them finishes, the
+* matches found so far are merged by EntrySearcher::scoreItem() and
+* reported, best first.
+*/
+class GlobalSearchTask final:public QObject
+{
+	Q_OBJECT public:
+	explicit GlobalSearchTask(
+		QObject* parent = nullptr
+	);
+	virtual ~GlobalSearchTask() override;
+	/**
+	* Searches the root groups of databases and keeps the limit best
+	* matches of all of them.
+	*/
+	void start(
+		const QString &searchTerm,
+		const QList<Database*> &databases,
+		Qt::CaseSensitivity caseSensitivity,
+		int limit
+	);
+	/**
+	* See EntrySearcher::setParallelThreshold().
+	*/
+	void setParallelThreshold(
+		int threshold
+	);
+	void cancel();
+	bool isRunning() const;
+	/**
+	* Returns the number of databases the last search was started in.
+	*/
+	qsizetype getDatabaseCount() const;
+	/**
+	* Returns the number of databases that have reported their matches.
+	*/
+	qsizetype getFinishedCount() const;
+Q_SIGNALS:
+	/**
+	* Emitted with the merged matches of the finished databases every time
+	* one of them finishes.
+	*/
+	void sig_entriesFound(
+		const QList<Entry*> &entries
+	);
+	void sig_finished();
+private Q_SLOTS:
+	void do_entriesFound(
+		const QList<Entry*> &entries,
+		bool replace
+	);
+	void do_taskFinished();
+private:
+	struct Match
+	{
+		// entries aren't QObjects, the database tells whether one is still
+		// there
+		Entry* entry;
+		QPointer<Database> db;
+		UUID uuid;
+		double score;
+		// ties go to the earlier database, then to the better rank in it
+		int database;
+		int position;
+	};
+
+	static bool isBetter(
+		const Match &match,
+		const Match &other
+	);
+	QList<Entry*> merge() const;
+	void clearTasks();
+	QList<EntrySearchTask*> tasks;
+	QHash<const EntrySearchTask*, QList<Match>> matches;
+	QSet<const EntrySearchTask*> finishedTasks;
+	SearchQuery query;
+	int limit;
+	int parallelThreshold;
+	bool running;
+};
+#endif // KEEPASSX_GLOBALSEARCHTASK_H
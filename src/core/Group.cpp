@@ -15,6 +15,7 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "Group.h"
+#include "core/AttachmentStore.h"
 #include "core/Config.h"
 #include "core/Global.h"
 #include "core/DatabaseIcons.h"
@@ -46,6 +47,12 @@ Group::~Group()
 	{
 		delete group_;
 	}
+	if(this->db)
+	{
+		this->db->unindexGroup(
+			this
+		);
+	}
 	if(this->db && this->parent)
 	{
 		DeletedObject delGroup_;
@@ -56,6 +63,12 @@ Group::~Group()
 		);
 	}
 	this->cleanupParent();
+	if(this->isBatched())
+	{
+		this->db->forgetGroup(
+			this
+		);
+	}
 }
 
 Group* Group::createRecycleBin()
@@ -87,7 +100,7 @@ template<class P, class V> bool Group::set(
 	{
 		property = value;
 		this->getUpdateTimeinfo();
-		sig_modified();
+		this->emitModified();
 		return true;
 	}
 	return false;
@@ -219,7 +232,13 @@ Group::TriState Group::isSearchingEnabled() const
 
 Entry* Group::getLastTopVisibleEntry() const
 {
-	return this->lastTopVisibleEntry;
+	if(!this->db || this->lastTopVisibleEntry.isNull())
+	{
+		return nullptr;
+	}
+	return this->db->resolveEntry(
+		this->lastTopVisibleEntry
+	);
 }
 
 bool Group::isExpired() const
@@ -232,10 +251,22 @@ void Group::setUuid(
 	const UUID &uuid
 )
 {
+	if(this->db)
+	{
+		this->db->unindexGroup(
+			this
+		);
+	}
 	this->set(
 		this->uuid,
 		uuid
 	);
+	if(this->db)
+	{
+		this->db->indexGroup(
+			this
+		);
+	}
 }
 
 void Group::setName(
@@ -247,9 +278,7 @@ void Group::setName(
 		name
 	))
 	{
-		sig_dataChanged(
-			this
-		);
+		this->emitDataChanged();
 	}
 }
 
@@ -276,10 +305,8 @@ void Group::setIcon(
 		this->data.iconNumber = iconNumber;
 		this->data.customIcon = UUID();
 		this->getUpdateTimeinfo();
-		sig_modified();
-		sig_dataChanged(
-			this
-		);
+		this->emitModified();
+		this->emitDataChanged();
 	}
 }
 
@@ -296,10 +323,8 @@ void Group::setIcon(
 		this->data.customIcon = uuid;
 		this->data.iconNumber = 0;
 		this->getUpdateTimeinfo();
-		sig_modified();
-		sig_dataChanged(
-			this
-		);
+		this->emitModified();
+		this->emitDataChanged();
 	}
 }
 
@@ -318,7 +343,7 @@ void Group::setExpanded(
 	{
 		this->data.isExpanded = expanded;
 		this->getUpdateTimeinfo();
-		sig_modified();
+		this->emitModified();
 	}
 }
 
@@ -338,7 +363,7 @@ void Group::setLastTopVisibleEntry(
 {
 	this->set(
 		this->lastTopVisibleEntry,
-		entry
+		entry ? entry->getUUID() : UUID()
 	);
 }
 
@@ -352,7 +377,7 @@ void Group::setExpires(
 			value
 		);
 		this->getUpdateTimeinfo();
-		sig_modified();
+		this->emitModified();
 	}
 }
 
@@ -366,7 +391,7 @@ void Group::setExpiryTime(
 			dateTime
 		);
 		this->getUpdateTimeinfo();
-		sig_modified();
+		this->emitModified();
 	}
 }
 
@@ -408,7 +433,7 @@ void Group::setParent(
 			index--;
 		}
 	}
-	if(this->parent == parent && parent->getChildren().indexOf(
+	if(this->parent == parent && parent->indexOfChild(
 		this
 	) == index)
 	{
@@ -444,27 +469,33 @@ void Group::setParent(
 		QObject::setParent(
 			this->parent
 		);
-		sig_aboutToAdd(
-			this,
-			index
-		);
+		if(!this->isBatched())
+		{
+			sig_aboutToAdd(
+				this,
+				index
+			);
+		}
 		if(index > this->parent->children.size())
 		{
 			return;
 		};
-		this->parent->children.insert(
+		this->parent->insertChild(
 			index,
 			this
 		);
 	}
 	else
 	{
-		sig_aboutToMove(
-			this,
-			parent,
-			index
-		);
-		parent->children.removeAll(
+		if(!this->isBatched())
+		{
+			sig_aboutToMove(
+				this,
+				parent,
+				index
+			);
+		}
+		parent->removeChild(
 			this
 		);
 		this->parent = parent;
@@ -475,7 +506,7 @@ void Group::setParent(
 		{
 			return;
 		}
-		this->parent->children.insert(
+		this->parent->insertChild(
 			index,
 			this
 		);
@@ -486,8 +517,17 @@ void Group::setParent(
 			QDateTime::currentDateTimeUtc()
 		);
 	}
-	sig_modified();
-	if(!moveWithinDatabase_)
+	this->emitModified();
+	if(this->isBatched())
+	{
+		if(!moveWithinDatabase_)
+		{
+			this->db->recordGroupAdded(
+				this
+			);
+		}
+	}
+	else if(!moveWithinDatabase_)
 	{
 		sig_added();
 	}
@@ -549,93 +589,165 @@ const QList<Entry*> &Group::getEntries() const
 	return this->entries;
 }
 
-QList<Entry*> Group::getEntriesRecursive(
-	const bool includeHistoryItems
+int Group::indexOfChild(
+	const Group* child
 ) const
 {
-	QList<Entry*> entryList_;
-	entryList_.append(
-		entries
-	);
-	if(includeHistoryItems)
+	if(this->childPositions.size() != this->children.size())
 	{
-		for(Entry* entry_: this->entries)
+		this->childPositions.clear();
+		for(auto i_ = 0; i_ < this->children.size(); i_++)
 		{
-			entryList_.append(
-				entry_->getHistoryItems()
+			this->childPositions.insert(
+				this->children.at(
+					i_
+				),
+				i_
 			);
 		}
 	}
-	for(const Group* group_: this->children)
-	{
-		entryList_.append(
-			group_->getEntriesRecursive(
-				includeHistoryItems
-			)
-		);
-	}
-	return entryList_;
+	return this->childPositions.value(
+		child,
+		-1
+	);
 }
 
-QList<const Group*> Group::getGroupsRecursive(
-	const bool includeSelf
+int Group::indexOfEntry(
+	const Entry* entry
 ) const
 {
-	QList<const Group*> groupList_;
-	if(includeSelf)
+	if(this->entryPositions.size() != this->entries.size())
 	{
-		groupList_.append(
-			this
-		);
-	}
-	for(const Group* group_: children)
-	{
-		groupList_.append(
-			group_->getGroupsRecursive(
-				true
-			)
-		);
+		this->entryPositions.clear();
+		for(auto i_ = 0; i_ < this->entries.size(); i_++)
+		{
+			this->entryPositions.insert(
+				this->entries.at(
+					i_
+				),
+				i_
+			);
+		}
 	}
-	return groupList_;
+	return this->entryPositions.value(
+		entry,
+		-1
+	);
 }
 
-QList<Group*> Group::getGroupsRecursive(
-	const bool includeSelf
+GroupRange<Group> Group::groupsRecursive(
+	const bool includeSelf,
+	const TraversalOrder order
 )
 {
-	QList<Group*> groupList_;
-	if(includeSelf)
-	{
-		groupList_.append(
-			this
-		);
-	}
-	for(Group* group_: asConst(
-			children
+	return GroupRange<Group>(
+		this,
+		includeSelf,
+		order
+	);
+}
+
+GroupRange<const Group> Group::groupsRecursive(
+	const bool includeSelf,
+	const TraversalOrder order
+) const
+{
+	return GroupRange<const Group>(
+		this,
+		includeSelf,
+		order
+	);
+}
+
+EntryRange Group::entriesRecursive(
+	const bool includeHistoryItems
+) const
+{
+	return EntryRange(
+		this,
+		includeHistoryItems
+	);
+}
+
+bool Group::accept(
+	GroupVisitor* visitor,
+	const TraversalOrder order,
+	const bool includeHistoryItems
+)
+{
+	for(Group* group_: this->groupsRecursive(
+			true,
+			order
 		))
 	{
-		groupList_.append(
-			group_->getGroupsRecursive(
-				true
-			)
-		);
+		if(order == PreOrder && !visitor->visitGroup(
+			group_
+		))
+		{
+			return false;
+		}
+		for(Entry* entry_: asConst(
+				group_->entries
+			))
+		{
+			if(!visitor->visitEntry(
+				entry_
+			))
+			{
+				return false;
+			}
+			if(!includeHistoryItems)
+			{
+				continue;
+			}
+			// the items are built for the visit and deleted after it
+			const QList<Entry*> items_ = entry_->buildHistoryItems();
+			bool accepted_ = true;
+			for(Entry* item_: items_)
+			{
+				if(!visitor->visitEntry(
+					item_
+				))
+				{
+					accepted_ = false;
+					break;
+				}
+			}
+			qDeleteAll(
+				items_
+			);
+			if(!accepted_)
+			{
+				return false;
+			}
+		}
+		if(order == PostOrder && !visitor->visitGroup(
+			group_
+		))
+		{
+			return false;
+		}
 	}
-	return groupList_;
+	return true;
 }
 
 QSet<UUID> Group::getCustomIconsRecursive() const
 {
 	QSet<UUID> result_;
-	if(!this->getIconUUID().isNull())
+	for(const Group* group_: this->groupsRecursive(
+			true
+		))
 	{
-		result_.insert(
-			this->getIconUUID()
-		);
+		if(!group_->getIconUUID().isNull())
+		{
+			result_.insert(
+				group_->getIconUUID()
+			);
+		}
 	}
-	const QList<Entry*> entryList_ = this->getEntriesRecursive(
-		true
-	);
-	for(const Entry* entry_: entryList_)
+	// the icons of the history are read from the deltas without building
+	// the items
+	for(const Entry* entry_: this->entriesRecursive())
 	{
 		if(!entry_->getIconUUID().isNull())
 		{
@@ -643,11 +755,8 @@ QSet<UUID> Group::getCustomIconsRecursive() const
 				entry_->getIconUUID()
 			);
 		}
-	}
-	for(const Group* group_: children)
-	{
 		result_.unite(
-			group_->getCustomIconsRecursive()
+			entry_->getHistoryCustomIcons()
 		);
 	}
 	return result_;
@@ -726,29 +835,48 @@ void Group::addEntry(
 	{
 		return;
 	}
-	sig_entryAboutToAdd(
-		entry
-	);
+	const bool batched_ = this->isBatched();
+	if(!batched_)
+	{
+		sig_entryAboutToAdd(
+			entry
+		);
+	}
+	// appending keeps all cached positions valid
+	if(this->entryPositions.size() == this->entries.size())
+	{
+		this->entryPositions.insert(
+			entry,
+			static_cast<int>(this->entries.size())
+		);
+	}
 	this->entries << entry;
-	this->connect(
-		entry,
-		&Entry::sig_dataChanged,
-		this,
-		&Group::sig_entryDataChanged
+	entry->setAttachmentStore(
+		this->db ? this->db->getAttachmentStore() : nullptr
 	);
+	entry->setStringPool(
+		this->db ? this->db->getStringPool() : nullptr
+	);
+	// changes of the entry reach the database through its dispatcher
 	if(this->db)
 	{
-		this->connect(
-			entry,
-			&Entry::sig_modified,
-			this->db,
-			&Database::sig_modifiedImmediate
+		this->db->indexEntry(
+			entry
+		);
+	}
+	this->emitModified();
+	if(batched_)
+	{
+		this->db->recordEntryAdded(
+			entry
+		);
+	}
+	else
+	{
+		sig_entryAdded(
+			entry
 		);
 	}
-	sig_modified();
-	sig_entryAdded(
-		entry
-	);
 }
 
 void Group::removeEntry(
@@ -761,31 +889,48 @@ void Group::removeEntry(
 	{
 		return;
 	}
-	sig_entryAboutToRemove(
-		entry
-	);
-	entry->disconnect(
-		this
-	);
+	const bool batched_ = this->isBatched();
+	if(!batched_)
+	{
+		sig_entryAboutToRemove(
+			entry
+		);
+	}
 	if(this->db)
 	{
-		entry->disconnect(
-			this->db
+		this->db->unindexEntry(
+			entry
 		);
 	}
 	this->entries.removeAll(
 		entry
 	);
-	sig_modified();
-	sig_entryRemoved(
-		entry
-	);
+	this->entryPositions.clear();
+	this->emitModified();
+	if(batched_)
+	{
+		this->db->recordEntryRemoved(
+			entry
+		);
+	}
+	else
+	{
+		sig_entryRemoved(
+			entry
+		);
+	}
 }
 
 void Group::recSetDatabase(
 	Database* db
 )
 {
+	if(this->db != db && this->isBatched())
+	{
+		this->db->forgetGroup(
+			this
+		);
+	}
 	if(db)
 	{
 		this->disconnect(
@@ -836,24 +981,33 @@ void Group::recSetDatabase(
 			db,
 			nullptr
 		);
+		this->disconnect(
+			this,
+			&Group::sig_entryAdded,
+			db,
+			nullptr
+		);
 	}
-	for(const Entry* entry_: asConst(
+	for(Entry* entry_: asConst(
 			this->entries
 		))
 	{
+		entry_->setAttachmentStore(
+			db ? db->getAttachmentStore() : nullptr
+		);
+		entry_->setStringPool(
+			db ? db->getStringPool() : nullptr
+		);
 		if(this->db)
 		{
-			entry_->disconnect(
-				this->db
+			this->db->unindexEntry(
+				entry_
 			);
 		}
 		if(db)
 		{
-			this->connect(
-				entry_,
-				&Entry::sig_modified,
-				db,
-				&Database::sig_modifiedImmediate
+			db->indexEntry(
+				entry_
 			);
 		}
 	}
@@ -907,8 +1061,32 @@ void Group::recSetDatabase(
 			db,
 			&Database::sig_modifiedImmediate
 		);
+		this->connect(
+			this,
+			&Group::sig_modified,
+			db,
+			&Database::do_groupModified
+		);
+		this->connect(
+			this,
+			&Group::sig_entryAdded,
+			db,
+			&Database::sig_entryAdded
+		);
+	}
+	if(this->db)
+	{
+		this->db->unindexGroup(
+			this
+		);
 	}
 	this->db = db;
+	if(this->db)
+	{
+		this->db->indexGroup(
+			this
+		);
+	}
 	for(Group* group_: asConst(
 			this->children
 		))
@@ -919,42 +1097,112 @@ void Group::recSetDatabase(
 	}
 }
 
+void Group::insertChild(
+	const int index,
+	Group* child
+)
+{
+	if(index == this->children.size() && this->childPositions.size() == this->
+		children.size())
+	{
+		this->childPositions.insert(
+			child,
+			index
+		);
+	}
+	else
+	{
+		this->childPositions.clear();
+	}
+	this->children.insert(
+		index,
+		child
+	);
+}
+
+void Group::removeChild(
+	Group* child
+)
+{
+	this->children.removeAll(
+		child
+	);
+	this->childPositions.clear();
+}
+
 void Group::cleanupParent()
 {
 	if(this->parent)
 	{
-		sig_aboutToRemove(
+		const bool batched_ = this->isBatched();
+		if(!batched_)
+		{
+			sig_aboutToRemove(
+				this
+			);
+		}
+		this->parent->removeChild(
 			this
 		);
-		this->parent->children.removeAll(
+		this->emitModified();
+		if(!batched_)
+		{
+			sig_removed();
+		}
+	}
+}
+
+bool Group::isBatched() const
+{
+	return this->db && this->db->isInTransaction();
+}
+
+void Group::emitModified()
+{
+	if(this->isBatched())
+	{
+		this->db->recordGroupModified(
 			this
 		);
-		sig_modified();
-		sig_removed();
+		return;
+	}
+	sig_modified();
+}
+
+void Group::emitDataChanged()
+{
+	// the layout change at commit refreshes the data of all groups
+	if(this->isBatched())
+	{
+		return;
 	}
+	sig_dataChanged(
+		this
+	);
 }
 
 void Group::recCreateDelObjects()
 {
 	if(this->db)
 	{
-		for(const Entry* entry_: asConst(
-				this->entries
+		// post-order keeps every group after its entries and children
+		for(const Group* group_: asConst(
+				*this
+			).groupsRecursive(
+				true,
+				PostOrder
 			))
 		{
+			for(const Entry* entry_: group_->entries)
+			{
+				this->db->addDeletedObject(
+					entry_->getUUID()
+				);
+			}
 			this->db->addDeletedObject(
-				entry_->getUUID()
+				group_->uuid
 			);
 		}
-		for(Group* group_: asConst(
-				this->children
-			))
-		{
-			group_->recCreateDelObjects();
-		}
-		this->db->addDeletedObject(
-			this->uuid
-		);
 	}
 }
 
@@ -16,10 +16,13 @@
  */
 #ifndef KEEPASSX_GROUP_H
 #define KEEPASSX_GROUP_H
+#include <QHash>
 #include <QImage>
 #include <QPixmapCache>
+#include <QSet>
 #include "core/Database.h"
 #include "core/Entry.h"
+#include "core/GroupTraversal.h"
 #include "core/TimeInfo.h"
 #include "core/UUID.h"
 
@@ -111,14 +114,47 @@ class Group final:public QObject
 	const QList<Group*> &getChildren() const;
 	QList<Entry*> getEntries();
 	const QList<Entry*> &getEntries() const;
-	QList<Entry*> getEntriesRecursive(
-		bool includeHistoryItems = false
+	/**
+	* Returns the position of child in getChildren() or -1. The positions
+	* are cached, so this is O(1) unless the children changed.
+	*/
+	int indexOfChild(
+		const Group* child
+	) const;
+	/**
+	* Returns the position of entry in getEntries() or -1, see indexOfChild().
+	*/
+	int indexOfEntry(
+		const Entry* entry
 	) const;
-	QList<const Group*> getGroupsRecursive(
-		bool includeSelf
+	/**
+	* Returns the groups of this subtree for a range-based for loop.
+	*/
+	GroupRange<Group> groupsRecursive(
+		bool includeSelf,
+		TraversalOrder order = PreOrder
+	);
+	GroupRange<const Group> groupsRecursive(
+		bool includeSelf,
+		TraversalOrder order = PreOrder
+	) const;
+	/**
+	* Returns the entries of this subtree for a range-based for loop. History
+	* items are copies that live until the iterator leaves their entry.
+	*/
+	EntryRange entriesRecursive(
+		bool includeHistoryItems = false
 	) const;
-	QList<Group*> getGroupsRecursive(
-		bool includeSelf
+	/**
+	* Calls visitor for every group of this subtree, each followed by its
+	* entries in pre-order or preceded by them in post-order. Returns false
+	* if the visitor stopped the traversal. History items are copies built
+	* for the visit, changes to them are lost.
+	*/
+	bool accept(
+		GroupVisitor* visitor,
+		TraversalOrder order = PreOrder,
+		bool includeHistoryItems = false
 	);
 	QSet<UUID> getCustomIconsRecursive() const;
 	/**
@@ -169,9 +205,6 @@ Q_SIGNALS:
 	void sig_entryRemoved(
 		Entry* entry
 	);
-	void sig_entryDataChanged(
-		Entry* entry
-	);
 	void sig_modified();
 private:
 	template<class P, class V> bool set(
@@ -192,13 +225,30 @@ private:
 	);
 	void cleanupParent();
 	void recCreateDelObjects();
+	void insertChild(
+		int index,
+		Group* child
+	);
+	void removeChild(
+		Group* child
+	);
 	void getUpdateTimeinfo();
+	/**
+	* Whether the database holds back the change signals for a transaction.
+	*/
+	bool isBatched() const;
+	void emitModified();
+	void emitDataChanged();
 	QPointer<Database> db;
 	UUID uuid;
 	GroupData data;
-	QPointer<Entry> lastTopVisibleEntry;
+	// the entry is looked up in the database, it may be gone
+	UUID lastTopVisibleEntry;
 	QList<Group*> children;
 	QList<Entry*> entries;
+	// row caches for the models, rebuilt when their size doesn't match
+	mutable QHash<const Group*, int> childPositions;
+	mutable QHash<const Entry*, int> entryPositions;
 	QPointer<Group> parent;
 	bool updateTimeinfo;
 	friend void Database::setRootGroup(
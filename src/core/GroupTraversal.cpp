@@ -0,0 +1,404 @@
+/*
+ *  Copyright (C) 2026 The cpp-password-manager contributors
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "GroupTraversal.h"
+#include "core/Entry.h"
+#include "core/Global.h"
+#include "core/Group.h"
+
+template<class G> GroupIterator<G>::GroupIterator()
+	: current(
+		nullptr
+	),
+	includeSelf(
+		false
+	),
+	order(
+		PreOrder
+	)
+{
+}
+
+template<class G> GroupIterator<G>::GroupIterator(
+	G* root,
+	const bool includeSelf,
+	const TraversalOrder order
+)
+	: current(
+		nullptr
+	),
+	includeSelf(
+		includeSelf
+	),
+	order(
+		order
+	)
+{
+	if(!root)
+	{
+		return;
+	}
+	this->stack.append(
+		{
+			root,
+			0
+		}
+	);
+	if(this->order == PostOrder)
+	{
+		this->descend();
+	}
+	else if(this->includeSelf)
+	{
+		this->current = root;
+	}
+	else
+	{
+		this->advance();
+	}
+}
+
+template<class G> G* GroupIterator<G>::operator*() const
+{
+	return this->current;
+}
+
+template<class G> GroupIterator<G> &GroupIterator<G>::operator++()
+{
+	if(this->order == PostOrder)
+	{
+		// the current group is on top, all of its children are done
+		this->stack.removeLast();
+		if(this->stack.isEmpty())
+		{
+			this->current = nullptr;
+		}
+		else
+		{
+			this->descend();
+		}
+	}
+	else
+	{
+		this->advance();
+	}
+	return *this;
+}
+
+template<class G> bool GroupIterator<G>::operator!=(
+	const GroupIterator &other
+) const
+{
+	return this->current != other.current;
+}
+
+template<class G> int GroupIterator<G>::depth() const
+{
+	return static_cast<int>(this->stack.size()) - 1;
+}
+
+template<class G> void GroupIterator<G>::advance()
+{
+	while(!this->stack.isEmpty())
+	{
+		Frame &top_ = this->stack.last();
+		const QList<Group*> &children_ = asConst(
+			*top_.group
+		).getChildren();
+		if(top_.next < children_.size())
+		{
+			G* child_ = children_.at(
+				top_.next++
+			);
+			this->stack.append(
+				{
+					child_,
+					0
+				}
+			);
+			this->current = child_;
+			return;
+		}
+		this->stack.removeLast();
+	}
+	this->current = nullptr;
+}
+
+template<class G> void GroupIterator<G>::descend()
+{
+	while(true)
+	{
+		Frame &top_ = this->stack.last();
+		const QList<Group*> &children_ = asConst(
+			*top_.group
+		).getChildren();
+		if(top_.next < children_.size())
+		{
+			G* child_ = children_.at(
+				top_.next++
+			);
+			this->stack.append(
+				{
+					child_,
+					0
+				}
+			);
+			continue;
+		}
+		if(this->stack.size() == 1 && !this->includeSelf)
+		{
+			this->stack.clear();
+			this->current = nullptr;
+			return;
+		}
+		this->current = top_.group;
+		return;
+	}
+}
+
+template<class G> GroupRange<G>::GroupRange(
+	G* root,
+	const bool includeSelf,
+	const TraversalOrder order
+)
+	: root(
+		root
+	),
+	includeSelf(
+		includeSelf
+	),
+	order(
+		order
+	)
+{
+}
+
+template<class G> GroupIterator<G> GroupRange<G>::begin() const
+{
+	return GroupIterator<G>(
+		this->root,
+		this->includeSelf,
+		this->order
+	);
+}
+
+template<class G> GroupIterator<G> GroupRange<G>::end() const
+{
+	return GroupIterator<G>();
+}
+
+template class GroupIterator<Group>;
+template class GroupIterator<const Group>;
+template class GroupRange<Group>;
+template class GroupRange<const Group>;
+
+EntryIterator::EntryIterator()
+	: entryIndex(
+		0
+	),
+	historyIndex(
+		0
+	),
+	historyEntry(
+		nullptr
+	),
+	inHistory(
+		false
+	),
+	includeHistoryItems(
+		false
+	),
+	current(
+		nullptr
+	)
+{
+}
+
+EntryIterator::EntryIterator(
+	const Group* root,
+	const bool includeHistoryItems
+)
+	: groups(
+		root,
+		true,
+		PreOrder
+	),
+	entryIndex(
+		0
+	),
+	historyIndex(
+		0
+	),
+	historyEntry(
+		nullptr
+	),
+	inHistory(
+		false
+	),
+	includeHistoryItems(
+		includeHistoryItems
+	),
+	current(
+		nullptr
+	)
+{
+	this->settle();
+}
+
+Entry* EntryIterator::operator*() const
+{
+	return this->current;
+}
+
+EntryIterator &EntryIterator::operator++()
+{
+	if(this->inHistory)
+	{
+		this->historyIndex++;
+	}
+	else
+	{
+		this->entryIndex++;
+	}
+	this->settle();
+	return *this;
+}
+
+bool EntryIterator::operator!=(
+	const EntryIterator &other
+) const
+{
+	return this->current != other.current;
+}
+
+void EntryIterator::settle()
+{
+	while(const Group* group_ = *this->groups)
+	{
+		const QList<Entry*> &entries_ = group_->getEntries();
+		if(!this->inHistory)
+		{
+			if(this->entryIndex < entries_.size())
+			{
+				this->current = entries_.at(
+					this->entryIndex
+				);
+				return;
+			}
+			if(this->includeHistoryItems)
+			{
+				this->inHistory = true;
+				this->entryIndex = 0;
+				this->historyIndex = 0;
+				continue;
+			}
+		}
+		else if(this->entryIndex < entries_.size())
+		{
+			const Entry* entry_ = entries_.at(
+				this->entryIndex
+			);
+			// entries without history don't allocate anything
+			if(entry_->getHistoryCount() == 0)
+			{
+				this->entryIndex++;
+				this->historyIndex = 0;
+				continue;
+			}
+			if(entry_ != this->historyEntry)
+			{
+				this->historyItems.reset(
+					new QList<Entry*>(
+						entry_->buildHistoryItems()
+					),
+					&EntryIterator::deleteHistoryItems
+				);
+				this->historyEntry = entry_;
+			}
+			if(this->historyIndex < this->historyItems->size())
+			{
+				this->current = this->historyItems->at(
+					this->historyIndex
+				);
+				return;
+			}
+			this->entryIndex++;
+			this->historyIndex = 0;
+			continue;
+		}
+		++this->groups;
+		this->entryIndex = 0;
+		this->historyIndex = 0;
+		this->inHistory = false;
+	}
+	this->current = nullptr;
+}
+
+void EntryIterator::deleteHistoryItems(
+	QList<Entry*>* items
+)
+{
+	qDeleteAll(
+		*items
+	);
+	delete items;
+}
+
+EntryRange::EntryRange(
+	const Group* root,
+	const bool includeHistoryItems
+)
+	: root(
+		root
+	),
+	includeHistoryItems(
+		includeHistoryItems
+	)
+{
+}
+
+EntryIterator EntryRange::begin() const
+{
+	return EntryIterator(
+		this->root,
+		this->includeHistoryItems
+	);
+}
+
+EntryIterator EntryRange::end() const
+{
+	return EntryIterator();
+}
+
+bool GroupVisitor::visitGroup(
+	Group* group
+)
+{
+	Q_UNUSED(
+		group
+	);
+	return true;
+}
+
+bool GroupVisitor::visitEntry(
+	Entry* entry
+)
+{
+	Q_UNUSED(
+		entry
+	);
+	return true;
+}
@@ -0,0 +1,152 @@
+/*
+ *  Copyright (C) 2026 The cpp-password-manager contributors
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef KEEPASSX_GROUPTRAVERSAL_H
+#define KEEPASSX_GROUPTRAVERSAL_H
+#include <QList>
+#include <QSharedPointer>
+#include <QVarLengthArray>
+class Entry;
+class Group;
+
+enum TraversalOrder: u_int8_t
+{
+	PreOrder = 0,
+	PostOrder = 1
+};
+
+/**
+* Walks a group subtree without building intermediate lists. The path to
+* the current group is kept on a stack that only allocates for trees
+* deeper than 32 levels. The tree must not be modified while iterating.
+*/
+template<class G> class GroupIterator final
+{
+public:
+	GroupIterator();
+	GroupIterator(
+		G* root,
+		bool includeSelf,
+		TraversalOrder order
+	);
+	G* operator*() const;
+	GroupIterator &operator++();
+	bool operator!=(
+		const GroupIterator &other
+	) const;
+	/**
+	* Returns the depth of the current group below the root, which has 0.
+	*/
+	int depth() const;
+private:
+	struct Frame
+	{
+		G* group;
+		qsizetype next;
+	};
+
+	void advance();
+	void descend();
+	QVarLengthArray<Frame, 32> stack;
+	G* current;
+	bool includeSelf;
+	TraversalOrder order;
+};
+
+template<class G> class GroupRange final
+{
+public:
+	GroupRange(
+		G* root,
+		bool includeSelf,
+		TraversalOrder order
+	);
+	GroupIterator<G> begin() const;
+	GroupIterator<G> end() const;
+private:
+	G* root;
+	bool includeSelf;
+	TraversalOrder order;
+};
+
+/**
+* Walks all entries of a group subtree in pre-order. The entries of a group
+* come before their history items, if those are included. The history items
+* are built for the walk, so the histories stay delta encoded. They are
+* deleted once the iterator leaves their entry.
+*/
+class EntryIterator final
+{
+public:
+	EntryIterator();
+	EntryIterator(
+		const Group* root,
+		bool includeHistoryItems
+	);
+	Entry* operator*() const;
+	EntryIterator &operator++();
+	bool operator!=(
+		const EntryIterator &other
+	) const;
+private:
+	void settle();
+	static void deleteHistoryItems(
+		QList<Entry*>* items
+	);
+	GroupIterator<const Group> groups;
+	qsizetype entryIndex;
+	qsizetype historyIndex;
+	// the history items of historyEntry, shared by copies of the iterator
+	QSharedPointer<QList<Entry*>> historyItems;
+	const Entry* historyEntry;
+	bool inHistory;
+	bool includeHistoryItems;
+	Entry* current;
+};
+
+class EntryRange final
+{
+public:
+	EntryRange(
+		const Group* root,
+		bool includeHistoryItems
+	);
+	EntryIterator begin() const;
+	EntryIterator end() const;
+private:
+	const Group* root;
+	bool includeHistoryItems;
+};
+
+/**
+* Callback interface for Group::accept(). Returning false from a visit
+* stops the traversal.
+*/
+class GroupVisitor
+{
+public:
+	virtual ~GroupVisitor()
+	{
+	}
+
+	virtual bool visitGroup(
+		Group* group
+	);
+	virtual bool visitEntry(
+		Entry* entry
+	);
+};
+#endif // KEEPASSX_GROUPTRAVERSAL_H
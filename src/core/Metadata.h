@@ -21,6 +21,7 @@
 #include <QHash>
 #include <QPixmapCache>
 #include <QPointer>
+#include <QSet>
 #include "core/UUID.h"
 class Database;
 class Group;
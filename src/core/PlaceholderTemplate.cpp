@@ -0,0 +1,390 @@
+/*
+ *  Copyright (C) 2026 The cpp-password-manager contributors
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "PlaceholderTemplate.h"
+#include <QMutexLocker>
+#include "core/Database.h"
+#include "core/Entry.h"
+
+QCache<QString, PlaceholderTemplate> PlaceholderTemplate::cache(
+	1024
+);
+QMutex PlaceholderTemplate::cacheMutex;
+
+PlaceholderTemplate::PlaceholderTemplate(
+	const QString &str
+)
+	: placeholders(
+		false
+	)
+{
+	qsizetype pos_ = 0;
+	while(pos_ < str.size())
+	{
+		const qsizetype close_ = str.indexOf(
+			'}',
+			pos_
+		);
+		if(close_ == -1)
+		{
+			break;
+		}
+		// the last brace before the closing one starts the placeholder
+		const qsizetype open_ = str.lastIndexOf(
+			'{',
+			close_
+		);
+		if(open_ < pos_)
+		{
+			this->appendLiteral(
+				str.mid(
+					pos_,
+					close_ + 1 - pos_
+				)
+			);
+			pos_ = close_ + 1;
+			continue;
+		}
+		this->appendLiteral(
+			str.mid(
+				pos_,
+				open_ - pos_
+			)
+		);
+		if(!this->appendPlaceholder(
+			str.mid(
+				open_ + 1,
+				close_ - open_ - 1
+			)
+		))
+		{
+			this->appendLiteral(
+				str.mid(
+					open_,
+					close_ + 1 - open_
+				)
+			);
+		}
+		pos_ = close_ + 1;
+	}
+	this->appendLiteral(
+		str.mid(
+			pos_
+		)
+	);
+}
+
+PlaceholderTemplate PlaceholderTemplate::compile(
+	const QString &str
+)
+{
+	if(!str.contains(
+		'{'
+	))
+	{
+		return PlaceholderTemplate(
+			str
+		);
+	}
+	QMutexLocker locker_(
+		&cacheMutex
+	);
+	if(const PlaceholderTemplate* cached_ = cache.object(
+		str
+	))
+	{
+		return *cached_;
+	}
+	const auto compiled_ = new PlaceholderTemplate(
+		str
+	);
+	const PlaceholderTemplate result_ = *compiled_;
+	cache.insert(
+		str,
+		compiled_
+	);
+	return result_;
+}
+
+bool PlaceholderTemplate::hasPlaceholders() const
+{
+	return this->placeholders;
+}
+
+QString PlaceholderTemplate::resolve(
+	const Entry* entry
+) const
+{
+	return this->resolve(
+		entry,
+		0
+	);
+}
+
+void PlaceholderTemplate::appendLiteral(
+	const QString &text
+)
+{
+	if(text.isEmpty())
+	{
+		return;
+	}
+	if(!this->tokens.isEmpty() && this->tokens.last().type == Literal)
+	{
+		this->tokens.last().text += text;
+		return;
+	}
+	Token token_;
+	token_.type = Literal;
+	token_.text = text;
+	this->tokens.append(
+		token_
+	);
+}
+
+bool PlaceholderTemplate::appendPlaceholder(
+	const QString &name
+)
+{
+	const QString upper_ = name.toUpper();
+	Token token_;
+	token_.type = Field;
+	token_.placeholder = "{" + name + "}";
+	if(upper_ == "TITLE")
+	{
+		token_.text = EntryAttributes::TitleKey;
+	}
+	else if(upper_ == "USERNAME")
+	{
+		token_.text = EntryAttributes::UserNameKey;
+	}
+	else if(upper_ == "URL")
+	{
+		token_.text = EntryAttributes::URLKey;
+	}
+	else if(upper_ == "PASSWORD")
+	{
+		token_.text = EntryAttributes::PasswordKey;
+	}
+	else if(upper_ == "NOTES")
+	{
+		token_.text = EntryAttributes::NotesKey;
+	}
+	else if(upper_.startsWith(
+		"S:"
+	) && upper_.size() > 2)
+	{
+		token_.text = name.mid(
+			2
+		);
+	}
+	else if(upper_.startsWith(
+		"REF:"
+	) && upper_.size() > 8 && upper_.at(
+		5
+	) == '@' && upper_.at(
+		7
+	) == ':')
+	{
+		token_.type = Reference;
+		token_.wanted = upper_.at(
+			4
+		);
+		token_.searchIn = upper_.at(
+			6
+		);
+		token_.text = name.mid(
+			8
+		);
+		if(!QStringLiteral("TUPANI").contains(
+			token_.wanted
+		) || !QStringLiteral("TUPANIO").contains(
+			token_.searchIn
+		))
+		{
+			return false;
+		}
+	}
+	else
+	{
+		return false;
+	}
+	this->tokens.append(
+		token_
+	);
+	this->placeholders = true;
+	return true;
+}
+
+QString PlaceholderTemplate::resolve(
+	const Entry* entry,
+	const int depth
+) const
+{
+	if(!this->placeholders)
+	{
+		return this->tokens.isEmpty() ? QString() : this->tokens.first().text;
+	}
+	QString result_;
+	for(const Token &token_: this->tokens)
+	{
+		switch(token_.type)
+		{
+			case Literal:
+				result_ += token_.text;
+				break;
+			case Field:
+				if(!entry->getAttributes()->hasKey(
+					token_.text
+				))
+				{
+					result_ += token_.placeholder;
+					break;
+				}
+				result_ += resolveValue(
+					entry->getAttributes()->getValue(
+						token_.text
+					),
+					entry,
+					depth
+				);
+				break;
+			case Reference:
+				if(const Entry* referenced_ = findReference(
+					entry,
+					token_
+				))
+				{
+					result_ += resolveValue(
+						getReferenceField(
+							referenced_,
+							token_.wanted
+						),
+						referenced_,
+						depth
+					);
+				}
+				else
+				{
+					result_ += token_.placeholder;
+				}
+				break;
+		}
+	}
+	return result_;
+}
+
+QString PlaceholderTemplate::resolveValue(
+	const QString &value,
+	const Entry* entry,
+	const int depth
+)
+{
+	// values are compiled without the cache, they may be secrets
+	if(depth + 1 >= MaxDepth || !value.contains(
+		'{'
+	))
+	{
+		return value;
+	}
+	return PlaceholderTemplate(
+		value
+	).resolve(
+		entry,
+		depth + 1
+	);
+}
+
+QString PlaceholderTemplate::getReferenceField(
+	const Entry* entry,
+	const QChar field
+)
+{
+	switch(field.unicode())
+	{
+		case 'T':
+			return entry->getTitle();
+		case 'U':
+			return entry->getUsername();
+		case 'P':
+			return entry->getPassword();
+		case 'A':
+			return entry->getURL();
+		case 'N':
+			return entry->getNotes();
+		case 'I':
+			return entry->getUUID().toHex();
+		default:
+			return QString();
+	}
+}
+
+const Entry* PlaceholderTemplate::findReference(
+	const Entry* entry,
+	const Token &token
+)
+{
+	const Database* db_ = entry->getDatabase();
+	if(!db_)
+	{
+		return nullptr;
+	}
+	if(token.searchIn == 'I')
+	{
+		const QByteArray data_ = QByteArray::fromHex(
+			token.text.toLatin1()
+		);
+		if(data_.size() != UUID::Length)
+		{
+			return nullptr;
+		}
+		return db_->resolveEntry(
+			UUID(
+				data_
+			)
+		);
+	}
+	for(const Entry* candidate_: db_->getRootGroup()->entriesRecursive())
+	{
+		if(token.searchIn == 'O')
+		{
+			const EntryAttributes* attributes_ = candidate_->getAttributes();
+			for(const QString &key_: attributes_->getCustomKeys())
+			{
+				if(attributes_->getValue(
+					key_
+				).contains(
+					token.text,
+					Qt::CaseInsensitive
+				))
+				{
+					return candidate_;
+				}
+			}
+		}
+		else if(getReferenceField(
+			candidate_,
+			token.searchIn
+		).contains(
+			token.text,
+			Qt::CaseInsensitive
+		))
+		{
+			return candidate_;
+		}
+	}
+	return nullptr;
+}
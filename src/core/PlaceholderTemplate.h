@@ -0,0 +1,98 @@
+/*
+ *  Copyright (C) 2026 The cpp-password-manager contributors
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef KEEPASSX_PLACEHOLDERTEMPLATE_H
+#define KEEPASSX_PLACEHOLDERTEMPLATE_H
+#include <QCache>
+#include <QList>
+#include <QMutex>
+#include <QString>
+class Entry;
+
+/**
+* A string with placeholders such as {USERNAME}, {S:custom key} or
+* {REF:U@I:<uuid hex>}, tokenized once and substituted in a single pass.
+* Placeholders in the substituted values are resolved as well, up to
+* MaxDepth levels deep. Unknown placeholders are kept as they are.
+*/
+class PlaceholderTemplate final
+{
+public:
+	static constexpr int MaxDepth = 10;
+	explicit PlaceholderTemplate(
+		const QString &str
+	);
+	/**
+	* Returns the compiled template for str from a cache shared by all
+	* entries. Only pass templates such as URLs here, never passwords or
+	* other protected values, the cache keeps them in memory.
+	*/
+	static PlaceholderTemplate compile(
+		const QString &str
+	);
+	bool hasPlaceholders() const;
+	QString resolve(
+		const Entry* entry
+	) const;
+private:
+	enum TokenType: u_int8_t
+	{
+		Literal = 0,
+		Field = 1,
+		Reference = 2
+	};
+
+	struct Token
+	{
+		TokenType type;
+		// literal text, attribute key or the text a reference searches for
+		QString text;
+		// the placeholder as written, used when it can't be resolved
+		QString placeholder;
+		// field letters of a reference, e.g. U@I
+		QChar wanted;
+		QChar searchIn;
+	};
+
+	void appendLiteral(
+		const QString &text
+	);
+	bool appendPlaceholder(
+		const QString &name
+	);
+	QString resolve(
+		const Entry* entry,
+		int depth
+	) const;
+	static QString resolveValue(
+		const QString &value,
+		const Entry* entry,
+		int depth
+	);
+	static QString getReferenceField(
+		const Entry* entry,
+		QChar field
+	);
+	static const Entry* findReference(
+		const Entry* entry,
+		const Token &token
+	);
+	QList<Token> tokens;
+	bool placeholders;
+	static QCache<QString, PlaceholderTemplate> cache;
+	static QMutex cacheMutex;
+};
+#endif // KEEPASSX_PLACEHOLDERTEMPLATE_H
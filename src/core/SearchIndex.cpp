@@ -0,0 +1,949 @@
+/*
+ *  Copyright (C) 2026 The cpp-password-manager contributors
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "SearchIndex.h"
+#include <QTimer>
+#include <QtConcurrent>
+#include <algorithm>
+#include "core/Entry.h"
+#include "core/Global.h"
+
+// fields in SearchItem::fieldStarts
+static const int FieldCount = 4;
+static bool postingSizeLess(
+	const QSet<Entry*>* a,
+	const QSet<Entry*>* b
+)
+{
+	return a->size() < b->size();
+}
+
+SearchIndex::SearchIndex(
+	QObject* parent
+)
+	: QObject(
+		parent
+	),
+	indexing(
+		false
+	),
+	watcher(
+		new QFutureWatcher<SearchIndexBatch>(
+			this
+		)
+	),
+	timer(
+		new QTimer(
+			this
+		)
+	)
+{
+	this->timer->setSingleShot(
+		true
+	);
+	this->timer->setInterval(
+		0
+	);
+	this->connect(
+		this->timer,
+		&QTimer::timeout,
+		this,
+		&SearchIndex::do_indexPending
+	);
+	this->connect(
+		this->watcher,
+		&QFutureWatcher<SearchIndexBatch>::finished,
+		this,
+		&SearchIndex::do_batchIndexed
+	);
+}
+
+void SearchIndex::insert(
+	Entry* entry
+)
+{
+	if(!this->slots.contains(
+		entry
+	))
+	{
+		this->slots.insert(
+			entry,
+			this->slotEntries.size()
+		);
+		this->slotEntries.append(
+			entry
+		);
+		this->texts.append(
+			QString()
+		);
+		this->foldedTexts.append(
+			QString()
+		);
+		this->slotTrigrams.append(
+			QList<quint64>()
+		);
+		this->slotProtected.append(
+			false
+		);
+		this->slotFieldStarts.append(
+			QList<int>(
+				FieldCount,
+				-1
+			)
+		);
+		this->slotLastModified.append(
+			0
+		);
+	}
+	this->pending.insert(
+		entry
+	);
+	if(this->indexing)
+	{
+		this->stale.insert(
+			entry
+		);
+	}
+	if(!this->timer->isActive())
+	{
+		this->timer->start();
+	}
+}
+
+void SearchIndex::remove(
+	Entry* entry
+)
+{
+	const auto slot_ = this->slots.constFind(
+		entry
+	);
+	if(slot_ == this->slots.constEnd())
+	{
+		return;
+	}
+	const qsizetype removed_ = slot_.value();
+	this->slots.erase(
+		slot_
+	);
+	this->unindexEntry(
+		removed_
+	);
+	const qsizetype last_ = this->slotEntries.size() - 1;
+	if(removed_ != last_)
+	{
+		this->slotEntries[removed_] = this->slotEntries.at(
+			last_
+		);
+		this->texts[removed_].swap(
+			this->texts[last_]
+		);
+		this->foldedTexts[removed_].swap(
+			this->foldedTexts[last_]
+		);
+		this->slotTrigrams[removed_].swap(
+			this->slotTrigrams[last_]
+		);
+		this->slotProtected[removed_] = this->slotProtected.at(
+			last_
+		);
+		for(int i_ = 0; i_ < FieldCount; i_++)
+		{
+			this->slotFieldStarts[removed_ * FieldCount + i_] = this->
+				slotFieldStarts.at(
+					last_ * FieldCount + i_
+				);
+		}
+		this->slotLastModified[removed_] = this->slotLastModified.at(
+			last_
+		);
+		this->slots.insert(
+			this->slotEntries.at(
+				removed_
+			),
+			removed_
+		);
+	}
+	this->slotEntries.removeLast();
+	this->texts.removeLast();
+	this->foldedTexts.removeLast();
+	this->slotTrigrams.removeLast();
+	this->slotProtected.removeLast();
+	this->slotFieldStarts.resize(
+		this->slotEntries.size() * FieldCount
+	);
+	this->slotLastModified.removeLast();
+	this->protectedEntries.remove(
+		entry
+	);
+	this->protectedValues.remove(
+		entry
+	);
+	this->pending.remove(
+		entry
+	);
+	if(this->indexing)
+	{
+		this->stale.insert(
+			entry
+		);
+	}
+}
+
+void SearchIndex::clear()
+{
+	this->postings.clear();
+	this->slots.clear();
+	this->slotEntries.clear();
+	this->texts.clear();
+	this->foldedTexts.clear();
+	this->slotTrigrams.clear();
+	this->slotProtected.clear();
+	this->slotFieldStarts.clear();
+	this->slotLastModified.clear();
+	this->protectedEntries.clear();
+	this->protectedValues.clear();
+	this->pending.clear();
+	// the worker only reads its batch, its results are dropped
+	this->stale.clear();
+	this->indexing = false;
+	this->timer->stop();
+}
+
+void SearchIndex::update()
+{
+	if(this->indexing)
+	{
+		this->watcher->waitForFinished();
+		this->applyBatch(
+			this->watcher->result()
+		);
+	}
+	for(Entry* entry_: asConst(
+			this->pending
+		))
+	{
+		this->indexEntry(
+			entry_
+		);
+	}
+	this->pending.clear();
+	this->timer->stop();
+}
+
+bool SearchIndex::isUpToDate() const
+{
+	return this->pending.isEmpty() && !this->indexing;
+}
+
+int SearchIndex::count() const
+{
+	return static_cast<int>(this->slotEntries.size());
+}
+
+bool SearchIndex::findCandidates(
+	const QStringList &words,
+	QSet<Entry*>* candidates
+)
+{
+	this->update();
+	return intersectPostings(
+		this->postings,
+		this->protectedEntries,
+		words,
+		candidates
+	);
+}
+
+bool SearchIndex::findCandidates(
+	const SearchSnapshot &snapshot,
+	const QStringList &words,
+	QSet<Entry*>* candidates
+)
+{
+	return intersectPostings(
+		snapshot.postings,
+		snapshot.protectedEntries,
+		words,
+		candidates
+	);
+}
+
+bool SearchIndex::getItem(
+	Entry* entry,
+	SearchItem* item
+) const
+{
+	const qsizetype slot_ = this->slots.value(
+		entry,
+		-1
+	);
+	if(slot_ == -1 || this->pending.contains(
+		entry
+	))
+	{
+		return false;
+	}
+	item->entry = entry;
+	item->text = this->texts.at(
+		slot_
+	);
+	item->foldedText = this->foldedTexts.at(
+		slot_
+	);
+	item->protectedValues = this->protectedValues.value(
+		entry
+	);
+	for(int i_ = 0; i_ < FieldCount; i_++)
+	{
+		item->fieldStarts[i_] = this->slotFieldStarts.at(
+			slot_ * FieldCount + i_
+		);
+	}
+	item->lastModified = entry->getTimeInfo().getLastModificationTime().
+		toMSecsSinceEpoch();
+	item->expired = false;
+	return true;
+}
+
+bool SearchIndex::getItem(
+	const SearchSnapshot &snapshot,
+	Entry* entry,
+	SearchItem* item
+)
+{
+	const qsizetype slot_ = snapshot.slots.value(
+		entry,
+		-1
+	);
+	if(slot_ == -1)
+	{
+		return false;
+	}
+	item->entry = entry;
+	item->text = snapshot.texts.at(
+		slot_
+	);
+	item->foldedText = snapshot.foldedTexts.at(
+		slot_
+	);
+	item->protectedValues = snapshot.protectedValues.value(
+		entry
+	);
+	for(int i_ = 0; i_ < FieldCount; i_++)
+	{
+		item->fieldStarts[i_] = snapshot.fieldStarts.at(
+			slot_ * FieldCount + i_
+		);
+	}
+	item->lastModified = snapshot.lastModified.at(
+		slot_
+	);
+	item->expired = false;
+	return true;
+}
+
+SearchSnapshot SearchIndex::snapshot()
+{
+	this->update();
+	SearchSnapshot snapshot_;
+	snapshot_.postings = this->postings;
+	snapshot_.protectedEntries = this->protectedEntries;
+	snapshot_.slots = this->slots;
+	snapshot_.texts = this->texts;
+	snapshot_.foldedTexts = this->foldedTexts;
+	snapshot_.fieldStarts = this->slotFieldStarts;
+	snapshot_.lastModified = this->slotLastModified;
+	snapshot_.protectedValues = this->protectedValues;
+	return snapshot_;
+}
+
+SearchItem SearchIndex::makeItem(
+	Entry* entry
+)
+{
+	SearchItem item_;
+	item_.entry = entry;
+	item_.text = getSearchedText(
+		entry,
+		&item_.protectedValues,
+		item_.fieldStarts
+	);
+	item_.foldedText = fold(
+		item_.text
+	);
+	item_.lastModified = entry->getTimeInfo().getLastModificationTime().
+		toMSecsSinceEpoch();
+	item_.expired = false;
+	return item_;
+}
+
+QString SearchIndex::getSearchedText(
+	const Entry* entry,
+	QStringList* protectedValues,
+	int* fieldStarts
+)
+{
+	static const QStringList keys_ = {
+		EntryAttributes::TitleKey,
+		EntryAttributes::UserNameKey,
+		EntryAttributes::URLKey,
+		EntryAttributes::NotesKey
+	};
+	const EntryAttributes* attributes_ = entry->getAttributes();
+	QString text_;
+	bool first_ = true;
+	for(int i_ = 0; i_ < FieldCount; i_++)
+	{
+		const QString &key_ = keys_.at(
+			i_
+		);
+		const QString value_ = attributes_->getValue(
+			key_
+		);
+		if(attributes_->isProtected(
+			key_
+		))
+		{
+			protectedValues->append(
+				value_
+			);
+			fieldStarts[i_] = -1;
+			continue;
+		}
+		if(!first_)
+		{
+			text_ += '\n';
+		}
+		first_ = false;
+		fieldStarts[i_] = static_cast<int>(text_.size());
+		text_ += value_;
+	}
+	return text_;
+}
+
+QString SearchIndex::fold(
+	const QString &text
+)
+{
+	QString folded_(
+		text
+	);
+	const qsizetype size_ = folded_.size();
+	QChar* data_ = folded_.data();
+	for(qsizetype i_ = 0; i_ < size_; i_++)
+	{
+		if(data_[i_].isHighSurrogate() && i_ + 1 < size_ && data_[i_ + 1].
+			isLowSurrogate())
+		{
+			// folding keeps characters outside the BMP outside of it
+			const char32_t c_ = QChar::toCaseFolded(
+				QChar::surrogateToUcs4(
+					data_[i_],
+					data_[i_ + 1]
+				)
+			);
+			data_[i_] = QChar::highSurrogate(
+				c_
+			);
+			data_[i_ + 1] = QChar::lowSurrogate(
+				c_
+			);
+			i_++;
+			continue;
+		}
+		data_[i_] = data_[i_].toCaseFolded();
+	}
+	return folded_;
+}
+
+void SearchIndex::do_entryModified(
+	Entry* entry
+)
+{
+	if(this->slots.contains(
+		entry
+	))
+	{
+		this->insert(
+			entry
+		);
+	}
+}
+
+void SearchIndex::do_indexPending()
+{
+	// the entries queued meanwhile follow once the worker is done
+	if(this->indexing || this->pending.isEmpty())
+	{
+		return;
+	}
+	SearchIndexBatch batch_;
+	batch_.entries = this->pending.values();
+	this->pending.clear();
+	const qsizetype size_ = batch_.entries.size();
+	batch_.texts.reserve(
+		size_
+	);
+	batch_.fieldStarts.resize(
+		size_ * FieldCount
+	);
+	batch_.lastModified.reserve(
+		size_
+	);
+	// the entries are only read here, on the thread that modifies them
+	for(qsizetype i_ = 0; i_ < size_; i_++)
+	{
+		const Entry* entry_ = batch_.entries.at(
+			i_
+		);
+		QStringList protectedValues_;
+		batch_.texts.append(
+			getSearchedText(
+				entry_,
+				&protectedValues_,
+				batch_.fieldStarts.data() + i_ * FieldCount
+			)
+		);
+		batch_.lastModified.append(
+			entry_->getTimeInfo().getLastModificationTime().
+			toMSecsSinceEpoch()
+		);
+		if(!protectedValues_.isEmpty())
+		{
+			batch_.protectedValues.insert(
+				entry_,
+				protectedValues_
+			);
+		}
+	}
+	this->indexing = true;
+	this->watcher->setFuture(
+		QtConcurrent::run(
+			&SearchIndex::indexBatch,
+			batch_
+		)
+	);
+}
+
+void SearchIndex::do_batchIndexed()
+{
+	// update() may have taken the results already, or clear() dropped them
+	if(!this->indexing)
+	{
+		return;
+	}
+	this->applyBatch(
+		this->watcher->result()
+	);
+}
+
+SearchIndexBatch SearchIndex::indexBatch(
+	SearchIndexBatch batch
+)
+{
+	const qsizetype size_ = batch.entries.size();
+	batch.foldedTexts.reserve(
+		size_
+	);
+	batch.trigrams.reserve(
+		size_
+	);
+	for(qsizetype i_ = 0; i_ < size_; i_++)
+	{
+		Entry* entry_ = batch.entries.at(
+			i_
+		);
+		batch.foldedTexts.append(
+			fold(
+				batch.texts.at(
+					i_
+				)
+			)
+		);
+		QSet<quint64> trigrams_;
+		addTrigrams(
+			batch.foldedTexts.last(),
+			&trigrams_
+		);
+		QList<quint64> entryTrigrams_;
+		entryTrigrams_.reserve(
+			trigrams_.size()
+		);
+		for(const quint64 trigram_: asConst(
+				trigrams_
+			))
+		{
+			batch.postings[trigram_].insert(
+				entry_
+			);
+			entryTrigrams_.append(
+				trigram_
+			);
+		}
+		batch.trigrams.append(
+			entryTrigrams_
+		);
+	}
+	return batch;
+}
+
+void SearchIndex::applyBatch(
+	const SearchIndexBatch &batch
+)
+{
+	this->indexing = false;
+	QSet<Entry*> skipped_;
+	skipped_.swap(
+		this->stale
+	);
+	const qsizetype size_ = batch.entries.size();
+	// the earlier trigrams of the entries go first, the new ones are merged
+	// below
+	for(qsizetype i_ = 0; i_ < size_; i_++)
+	{
+		Entry* entry_ = batch.entries.at(
+			i_
+		);
+		if(skipped_.contains(
+			entry_
+		))
+		{
+			continue;
+		}
+		this->unindexEntry(
+			this->slots.value(
+				entry_
+			)
+		);
+	}
+	if(this->postings.isEmpty())
+	{
+		// the first batch after opening a database takes the postings as
+		// they are
+		this->postings = batch.postings;
+	}
+	else
+	{
+		for(auto it_ = batch.postings.constBegin(); it_ != batch.postings.
+			constEnd(); ++it_)
+		{
+			QSet<Entry*> &posting_ = this->postings[it_.key()];
+			if(posting_.isEmpty())
+			{
+				posting_ = it_.value();
+			}
+			else
+			{
+				posting_.unite(
+					it_.value()
+				);
+			}
+		}
+	}
+	for(qsizetype i_ = 0; i_ < size_; i_++)
+	{
+		Entry* entry_ = batch.entries.at(
+			i_
+		);
+		const QList<quint64> &trigrams_ = batch.trigrams.at(
+			i_
+		);
+		if(skipped_.contains(
+			entry_
+		))
+		{
+			// removed, or queued again and indexed later
+			for(const quint64 trigram_: trigrams_)
+			{
+				const auto posting_ = this->postings.find(
+					trigram_
+				);
+				if(posting_ == this->postings.end())
+				{
+					continue;
+				}
+				posting_.value().remove(
+					entry_
+				);
+				if(posting_.value().isEmpty())
+				{
+					this->postings.erase(
+						posting_
+					);
+				}
+			}
+			continue;
+		}
+		const qsizetype slot_ = this->slots.value(
+			entry_
+		);
+		this->slotTrigrams[slot_] = trigrams_;
+		this->texts[slot_] = batch.texts.at(
+			i_
+		);
+		this->foldedTexts[slot_] = batch.foldedTexts.at(
+			i_
+		);
+		for(int j_ = 0; j_ < FieldCount; j_++)
+		{
+			this->slotFieldStarts[slot_ * FieldCount + j_] = batch.
+				fieldStarts.at(
+					i_ * FieldCount + j_
+				);
+		}
+		this->slotLastModified[slot_] = batch.lastModified.at(
+			i_
+		);
+		const auto protected_ = batch.protectedValues.constFind(
+			entry_
+		);
+		this->slotProtected[slot_] = protected_ != batch.protectedValues.
+			constEnd();
+		if(this->slotProtected.at(
+			slot_
+		))
+		{
+			this->protectedEntries.insert(
+				entry_
+			);
+			this->protectedValues.insert(
+				entry_,
+				protected_.value()
+			);
+		}
+		else
+		{
+			this->protectedEntries.remove(
+				entry_
+			);
+			this->protectedValues.remove(
+				entry_
+			);
+		}
+	}
+	if(!this->pending.isEmpty())
+	{
+		this->timer->start();
+	}
+}
+
+void SearchIndex::indexEntry(
+	Entry* entry
+)
+{
+	const qsizetype slot_ = this->slots.value(
+		entry,
+		-1
+	);
+	if(slot_ == -1)
+	{
+		return;
+	}
+	this->unindexEntry(
+		slot_
+	);
+	QStringList protectedValues_;
+	int fieldStarts_[FieldCount];
+	const QString text_ = getSearchedText(
+		entry,
+		&protectedValues_,
+		fieldStarts_
+	);
+	const QString folded_ = fold(
+		text_
+	);
+	QSet<quint64> trigrams_;
+	addTrigrams(
+		folded_,
+		&trigrams_
+	);
+	QList<quint64> &slotTrigrams_ = this->slotTrigrams[slot_];
+	slotTrigrams_.reserve(
+		trigrams_.size()
+	);
+	for(const quint64 trigram_: asConst(
+			trigrams_
+		))
+	{
+		this->postings[trigram_].insert(
+			entry
+		);
+		slotTrigrams_.append(
+			trigram_
+		);
+	}
+	this->texts[slot_] = text_;
+	this->foldedTexts[slot_] = folded_;
+	this->slotProtected[slot_] = !protectedValues_.isEmpty();
+	for(int i_ = 0; i_ < FieldCount; i_++)
+	{
+		this->slotFieldStarts[slot_ * FieldCount + i_] = fieldStarts_[i_];
+	}
+	this->slotLastModified[slot_] = entry->getTimeInfo().
+		getLastModificationTime().toMSecsSinceEpoch();
+	if(this->slotProtected.at(
+		slot_
+	))
+	{
+		this->protectedEntries.insert(
+			entry
+		);
+		this->protectedValues.insert(
+			entry,
+			protectedValues_
+		);
+	}
+	else
+	{
+		this->protectedEntries.remove(
+			entry
+		);
+		this->protectedValues.remove(
+			entry
+		);
+	}
+}
+
+void SearchIndex::unindexEntry(
+	const qsizetype slot
+)
+{
+	Entry* entry_ = this->slotEntries.at(
+		slot
+	);
+	for(const quint64 trigram_: asConst(
+			this->slotTrigrams.at(
+				slot
+			)
+		))
+	{
+		const auto posting_ = this->postings.find(
+			trigram_
+		);
+		if(posting_ == this->postings.end())
+		{
+			continue;
+		}
+		posting_.value().remove(
+			entry_
+		);
+		if(posting_.value().isEmpty())
+		{
+			this->postings.erase(
+				posting_
+			);
+		}
+	}
+	this->slotTrigrams[slot].clear();
+}
+
+void SearchIndex::addTrigrams(
+	const QString &text,
+	QSet<quint64>* trigrams
+)
+{
+	for(qsizetype i_ = 0; i_ + 2 < text.size(); i_++)
+	{
+		trigrams->insert(
+			static_cast<quint64>(text.at(
+				i_
+			).unicode()) << 32 | static_cast<quint64>(text.at(
+				i_ + 1
+			).unicode()) << 16 | text.at(
+				i_ + 2
+			).unicode()
+		);
+	}
+}
+
+bool SearchIndex::intersectPostings(
+	const QHash<quint64, QSet<Entry*>> &postings,
+	const QSet<Entry*> &protectedEntries,
+	const QStringList &words,
+	QSet<Entry*>* candidates
+)
+{
+	candidates->clear();
+	QList<const QSet<Entry*>*> lists_;
+	bool missing_ = false;
+	for(const QString &word_: words)
+	{
+		QSet<quint64> trigrams_;
+		addTrigrams(
+			fold(
+				word_
+			),
+			&trigrams_
+		);
+		for(const quint64 trigram_: asConst(
+				trigrams_
+			))
+		{
+			const auto posting_ = postings.constFind(
+				trigram_
+			);
+			if(posting_ == postings.constEnd())
+			{
+				missing_ = true;
+				break;
+			}
+			lists_.append(
+				&posting_.value()
+			);
+		}
+	}
+	if(lists_.isEmpty() && !missing_)
+	{
+		return false;
+	}
+	if(!missing_)
+	{
+		std::sort(
+			lists_.begin(),
+			lists_.end(),
+			postingSizeLess
+		);
+		*candidates = *lists_.first();
+		for(qsizetype i_ = 1; i_ < lists_.size() && !candidates->isEmpty();
+			i_++)
+		{
+			const QSet<Entry*>* list_ = lists_.at(
+				i_
+			);
+			auto it_ = candidates->begin();
+			while(it_ != candidates->end())
+			{
+				if(list_->contains(
+					*it_
+				))
+				{
+					++it_;
+				}
+				else
+				{
+					it_ = candidates->erase(
+						it_
+					);
+				}
+			}
+		}
+	}
+	// the protected fields aren't indexed, they may hold any word
+	candidates->unite(
+		protectedEntries
+	);
+	return true;
+}
@@ -0,0 +1,239 @@
+/*
+ *  Copyright (C) 2026 The cpp-password-manager contributors
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef KEEPASSX_SEARCHINDEX_H
+#define KEEPASSX_SEARCHINDEX_H
+#include <QFutureWatcher>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+class Entry;
+class QTimer;
+
+/**
+* The searched text of an entry, see SearchIndex::getSearchedText(). The
+* strings are copies, so an item can be matched on another thread while
+* the entry changes.
+*/
+struct SearchItem
+{
+	Entry* entry;
+	QString text;
+	QString foldedText;
+	QStringList protectedValues;
+	// offsets of the title, username, URL and notes in text, -1 for the
+	// protected ones
+	int fieldStarts[4];
+	// last modification in milliseconds since the epoch
+	qint64 lastModified;
+	// only filled for the queries that look at them
+	QStringList tags;
+	QString groupName;
+	QHash<QString, QString> attributes;
+	bool expired;
+};
+
+/**
+* Implicitly shared copies of the columns of a SearchIndex, taken in
+* constant time. Items are built from it on another thread without looking
+* at the entries, see SearchIndex::getItem().
+*/
+struct SearchSnapshot
+{
+	QHash<quint64, QSet<Entry*>> postings;
+	QSet<Entry*> protectedEntries;
+	QHash<const Entry*, qsizetype> slots;
+	QList<QString> texts;
+	QList<QString> foldedTexts;
+	QList<int> fieldStarts;
+	QList<qint64> lastModified;
+	// the protected values of the entries that have some, kept aside by
+	// the index
+	QHash<const Entry*, QStringList> protectedValues;
+};
+
+/**
+* Entries of a SearchIndex indexed on a worker thread. Their texts are read
+* on the thread of the index, the worker folds them and collects their
+* trigrams without looking at the entries.
+*/
+struct SearchIndexBatch
+{
+	QList<Entry*> entries;
+	QList<QString> texts;
+	QList<QString> foldedTexts;
+	QList<QList<quint64>> trigrams;
+	// four offsets per entry, see SearchItem::fieldStarts
+	QList<int> fieldStarts;
+	QList<qint64> lastModified;
+	QHash<const Entry*, QStringList> protectedValues;
+	QHash<quint64, QSet<Entry*>> postings;
+};
+
+/**
+* Search data of the entries of a database. For each entry it keeps the
+* searched fields, title, username, URL and notes, joined into one text and
+* a case folded copy of it, stored column by column. A trigram index over
+* the folded text narrows down the entries to match. Protected fields are
+* not indexed, entries with protected fields are always candidates. Their
+* values are kept aside, they share the strings of the entries.
+* Added and modified entries are queued. From the event loop the queued
+* entries are indexed on a worker thread, before the next lookup the rest
+* is indexed right away.
+*/
+class SearchIndex final:public QObject
+{
+	Q_OBJECT public:
+	explicit SearchIndex(
+		QObject* parent = nullptr
+	);
+	void insert(
+		Entry* entry
+	);
+	void remove(
+		Entry* entry
+	);
+	void clear();
+	/**
+	* Indexes all queued entries, waiting for the worker if it is running.
+	*/
+	void update();
+	bool isUpToDate() const;
+	int count() const;
+	/**
+	* Stores the entries that may contain all words in candidates. Returns
+	* false if the words are too short to narrow down the entries, then
+	* every entry is a candidate.
+	*/
+	bool findCandidates(
+		const QStringList &words,
+		QSet<Entry*>* candidates
+	);
+	/**
+	* Same as the member function for the index snapshot was taken of, can
+	* be called on any thread.
+	*/
+	static bool findCandidates(
+		const SearchSnapshot &snapshot,
+		const QStringList &words,
+		QSet<Entry*>* candidates
+	);
+	/**
+	* Fills item from the indexed text of entry. Returns false if the entry
+	* isn't indexed or has changed since.
+	*/
+	bool getItem(
+		Entry* entry,
+		SearchItem* item
+	) const;
+	/**
+	* Fills item from snapshot without looking at entry, so it can be called
+	* on any thread. Returns false if the entry isn't in the snapshot.
+	*/
+	static bool getItem(
+		const SearchSnapshot &snapshot,
+		Entry* entry,
+		SearchItem* item
+	);
+	/**
+	* Indexes all queued entries and returns a snapshot of the index. A
+	* change of the index while the snapshot is held copies the changed
+	* columns once.
+	*/
+	SearchSnapshot snapshot();
+	/**
+	* Returns the item of entry without looking at the index.
+	*/
+	static SearchItem makeItem(
+		Entry* entry
+	);
+	/**
+	* Returns the unprotected searched fields of entry separated by
+	* newlines, which no search word contains. The protected ones are
+	* added to protectedValues. fieldStarts receives the offsets of the
+	* four fields, -1 for the protected ones.
+	*/
+	static QString getSearchedText(
+		const Entry* entry,
+		QStringList* protectedValues,
+		int* fieldStarts
+	);
+	/**
+	* Folds the case of text code point by code point, the way
+	* QString::contains() compares ignoring case. The length doesn't change.
+	*/
+	static QString fold(
+		const QString &text
+	);
+public Q_SLOTS:
+	void do_entryModified(
+		Entry* entry
+	);
+private Q_SLOTS:
+	void do_indexPending();
+	void do_batchIndexed();
+private:
+	static SearchIndexBatch indexBatch(
+		SearchIndexBatch batch
+	);
+	/**
+	* Moves the results of the worker into the index, leaving out the
+	* entries that changed since it started.
+	*/
+	void applyBatch(
+		const SearchIndexBatch &batch
+	);
+	void indexEntry(
+		Entry* entry
+	);
+	void unindexEntry(
+		qsizetype slot
+	);
+	static void addTrigrams(
+		const QString &text,
+		QSet<quint64>* trigrams
+	);
+	static bool intersectPostings(
+		const QHash<quint64, QSet<Entry*>> &postings,
+		const QSet<Entry*> &protectedEntries,
+		const QStringList &words,
+		QSet<Entry*>* candidates
+	);
+	// sets, so removing an entry from the common trigrams stays cheap
+	QHash<quint64, QSet<Entry*>> postings;
+	// the columns, each entry has the same slot in all of them. Removing an
+	// entry moves the last one into its slot
+	QHash<const Entry*, qsizetype> slots;
+	QList<Entry*> slotEntries;
+	QList<QString> texts;
+	QList<QString> foldedTexts;
+	QList<QList<quint64>> slotTrigrams;
+	QList<bool> slotProtected;
+	// four offsets per slot, see SearchItem::fieldStarts
+	QList<int> slotFieldStarts;
+	QList<qint64> slotLastModified;
+	QSet<Entry*> protectedEntries;
+	QHash<const Entry*, QStringList> protectedValues;
+	QSet<Entry*> pending;
+	// entries added, modified or removed while the worker runs
+	QSet<Entry*> stale;
+	bool indexing;
+	QFutureWatcher<SearchIndexBatch>* watcher;
+	QTimer* timer;
+};
+#endif // KEEPASSX_SEARCHINDEX_H
@@ -0,0 +1,138 @@
+/*
+ *  Copyright (C) 2026 The cpp-password-manager contributors
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "StringPool.h"
+
+StringPool::StringPool(
+	QObject* parent
+)
+	: QObject(
+		parent
+	),
+	totalSize(
+		0
+	),
+	lookups(
+		0
+	),
+	hits(
+		0
+	),
+	savedSize(
+		0
+	)
+{
+}
+
+QString StringPool::intern(
+	const QString &value
+)
+{
+	if(value.isEmpty())
+	{
+		return value;
+	}
+	this->lookups++;
+	if(const auto i_ = this->strings.constFind(
+			value
+		);
+		i_ != this->strings.constEnd())
+	{
+		// interning an already shared copy saves nothing
+		if(i_->constData() != value.constData())
+		{
+			this->hits++;
+			this->savedSize += this->sizeOf(
+				value
+			);
+		}
+		return *i_;
+	}
+	this->strings.insert(
+		value
+	);
+	this->totalSize += this->sizeOf(
+		value
+	);
+	return value;
+}
+
+bool StringPool::contains(
+	const QString &value
+) const
+{
+	return this->strings.contains(
+		value
+	);
+}
+
+void StringPool::squeeze()
+{
+	for(auto i_ = this->strings.begin(); i_ != this->strings.end();)
+	{
+		if(i_->isDetached())
+		{
+			this->totalSize -= this->sizeOf(
+				*i_
+			);
+			i_ = this->strings.erase(
+				i_
+			);
+		}
+		else
+		{
+			++i_;
+		}
+	}
+}
+
+void StringPool::clear()
+{
+	this->strings.clear();
+	this->totalSize = 0;
+}
+
+int StringPool::count() const
+{
+	return static_cast<int>(this->strings.size());
+}
+
+qint64 StringPool::getTotalSize() const
+{
+	return this->totalSize;
+}
+
+int StringPool::getLookups() const
+{
+	return this->lookups;
+}
+
+int StringPool::getHits() const
+{
+	return this->hits;
+}
+
+qint64 StringPool::getSavedSize() const
+{
+	return this->savedSize;
+}
+
+qint64 StringPool::sizeOf(
+	const QString &value
+)
+{
+	return value.size() * static_cast<qint64>(sizeof(QChar));
+}
@@ -0,0 +1,71 @@
+/*
+ *  Copyright (C) 2026 The cpp-password-manager contributors
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef KEEPASSX_STRINGPOOL_H
+#define KEEPASSX_STRINGPOOL_H
+#include <QObject>
+#include <QSet>
+
+/**
+* Database wide table of interned field values. Equal strings handed to
+* intern() come back as copies of one shared buffer, so the usernames, URLs
+* and custom keys repeated across entries and history items are stored once.
+* Protected values must never be interned, the pool keeps its strings until
+* squeeze() finds them unused.
+*/
+class StringPool final:public QObject
+{
+	Q_OBJECT public:
+	explicit StringPool(
+		QObject* parent = nullptr
+	);
+	/**
+	* Returns the pooled copy of value, adding value if it isn't pooled yet.
+	*/
+	QString intern(
+		const QString &value
+	);
+	bool contains(
+		const QString &value
+	) const;
+	/**
+	* Drops the strings that are no longer referenced outside of the pool.
+	*/
+	void squeeze();
+	void clear();
+	int count() const;
+	/**
+	* Size in bytes of the character data held by the pool.
+	*/
+	qint64 getTotalSize() const;
+	int getLookups() const;
+	int getHits() const;
+	/**
+	* Bytes that didn't have to be allocated because intern() returned a
+	* shared copy instead of keeping a duplicate.
+	*/
+	qint64 getSavedSize() const;
+private:
+	static qint64 sizeOf(
+		const QString &value
+	);
+	QSet<QString> strings;
+	qint64 totalSize;
+	int lookups;
+	int hits;
+	qint64 savedSize;
+};
+#endif // KEEPASSX_STRINGPOOL_H
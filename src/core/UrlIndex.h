@@ -0,0 +1,140 @@
+/*
+ *  Copyright (C) 2026 The cpp-password-manager contributors
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef KEEPASSX_URLINDEX_H
+#define KEEPASSX_URLINDEX_H
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+class Entry;
+
+/**
+* An entry UrlIndex::lookup() found and how its URL matched.
+*/
+struct UrlMatch
+{
+	enum Kind: u_int8_t
+	{
+		// the entry has the host itself
+		Host = 0,
+		// a parent domain of the host, down to its registrable domain
+		ParentDomain = 1,
+		// another host of the registrable domain
+		Domain = 2
+	};
+
+	Entry* entry;
+	Kind kind;
+};
+
+/**
+* Entries of a database by the host of their URL. The hosts are kept in a
+* trie of their labels in reverse order, com, example, www for
+* www.example.com, so looking up a host walks its labels once and passes
+* the entries of its parent domains on the way.
+* Added and modified entries are queued and indexed before the next
+* lookup.
+*/
+class UrlIndex final:public QObject
+{
+	Q_OBJECT public:
+	explicit UrlIndex(
+		QObject* parent = nullptr
+	);
+	void insert(
+		Entry* entry
+	);
+	void remove(
+		Entry* entry
+	);
+	void clear();
+	/**
+	* Indexes all queued entries.
+	*/
+	void update();
+	/**
+	* Returns the entries for the host of url, best first: the ones with
+	* the host, the ones with its parent domains, nearest first, then the
+	* ones with other hosts of its registrable domain, sharing more labels
+	* with the host first. The time only depends on the length of url and
+	* the number of matches.
+	*/
+	QList<UrlMatch> lookup(
+		const QString &url
+	);
+	/**
+	* Returns the lower case host of url, which may lack a scheme. IPv6
+	* addresses keep their brackets.
+	*/
+	static QString getHost(
+		const QString &url
+	);
+	/**
+	* Returns the labels of host, the top level domain first. An IP address
+	* is a single label.
+	*/
+	static QStringList getLabels(
+		const QString &host
+	);
+	/**
+	* Returns how many of labels belong to the registrable domain, like
+	* example.com or example.co.uk. Public suffixes of more than one label
+	* are only known for the usual second levels below country codes.
+	*/
+	static qsizetype getDomainLabelCount(
+		const QStringList &labels
+	);
+public Q_SLOTS:
+	void do_entryModified(
+		Entry* entry
+	);
+private:
+	struct Node
+	{
+		QHash<QString, int> children;
+		QList<Entry*> entries;
+		int parent;
+		QString label;
+	};
+
+	void indexEntry(
+		Entry* entry
+	);
+	void unindexEntry(
+		Entry* entry
+	);
+	int addNode(
+		int parent,
+		const QString &label
+	);
+	void collectSubtree(
+		int node,
+		int skippedChild,
+		QList<UrlMatch>* matches
+	) const;
+	// the root is the first node, removed nodes are reused
+	QList<Node> nodes;
+	QList<int> freeNodes;
+	// the node of each indexed entry, -1 for entries without a host
+	QHash<const Entry*, int> entryNodes;
+	// the position of each entry in the entries of its node, an entry is
+	// removed by moving the last one of the node into its place
+	QHash<const Entry*, qsizetype> entryPositions;
+	QSet<Entry*> pending;
+};
+#endif // KEEPASSX_URLINDEX_H
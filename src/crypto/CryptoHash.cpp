@@ -26,7 +26,8 @@ public:
 };
 
 CryptoHash::CryptoHash(
-	const Algorithm algo
+	const Algorithm algo,
+	const bool hmac
 )
 	: d_ptr(
 		new CryptoHashPrivate()
@@ -45,13 +46,16 @@ CryptoHash::CryptoHash(
 		case Sha256:
 			algoGcrypt_ = GCRY_MD_SHA256;
 			break;
+		case Sha512:
+			algoGcrypt_ = GCRY_MD_SHA512;
+			break;
 		default:
 			break;
 	}
 	const gcry_error_t error_ = gcry_md_open(
 		&d->ctx,
 		algoGcrypt_,
-		0
+		hmac ? GCRY_MD_FLAG_HMAC : 0
 	);
 	if(error_ != 0)
 	{
@@ -73,6 +77,29 @@ CryptoHash::~CryptoHash()
 	delete this->d_ptr;
 }
 
+void CryptoHash::setKey(
+	const QByteArray &data
+) const
+{
+	Q_D(
+		const CryptoHash
+	);
+	if(const gcry_error_t error_ = gcry_md_setkey(
+			d->ctx,
+			data.constData(),
+			data.size()
+		);
+		error_ != 0)
+	{
+		qWarning(
+			"Unable to set HMAC key: %s",
+			gcry_strerror(
+				error_
+			)
+		);
+	}
+}
+
 void CryptoHash::addData(
 	const QByteArray &data
 )
@@ -130,3 +157,22 @@ QByteArray CryptoHash::hash(
 	);
 	return cryptoHash_.getResult();
 }
+
+QByteArray CryptoHash::hmac(
+	const QByteArray &data,
+	const QByteArray &key,
+	const Algorithm algo
+)
+{
+	CryptoHash cryptoHash_(
+		algo,
+		true
+	);
+	cryptoHash_.setKey(
+		key
+	);
+	cryptoHash_.addData(
+		data
+	);
+	return cryptoHash_.getResult();
+}
@@ -24,13 +24,21 @@ class CryptoHash
 public:
 	enum Algorithm: uint8_t
 	{
-		Sha256
+		Sha256,
+		Sha512
 	};
 
 	explicit CryptoHash(
-		Algorithm algo
+		Algorithm algo,
+		bool hmac = false
 	);
 	~CryptoHash();
+	/**
+	* Sets the key of a hash that has been created in HMAC mode.
+	*/
+	void setKey(
+		const QByteArray &data
+	) const;
 	void addData(
 		const QByteArray &data
 	);
@@ -40,6 +48,11 @@ public:
 		const QByteArray &data,
 		Algorithm algo
 	);
+	static QByteArray hmac(
+		const QByteArray &data,
+		const QByteArray &key,
+		Algorithm algo
+	);
 private:
 	CryptoHashPrivate* const d_ptr;
 	Q_DECLARE_PRIVATE(
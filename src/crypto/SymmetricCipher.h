@@ -28,7 +28,8 @@ public:
 	{
 		Aes256,
 		Twofish,
-		Salsa20
+		Salsa20,
+		ChaCha20
 	};
 
 	enum Mode: uint8_t
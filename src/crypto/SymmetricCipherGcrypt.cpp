@@ -64,6 +64,8 @@ int SymmetricCipherGcrypt::gcryptAlgo(
 			return GCRY_CIPHER_TWOFISH;
 		case SymmetricCipher::Salsa20:
 			return GCRY_CIPHER_SALSA20;
+		case SymmetricCipher::ChaCha20:
+			return GCRY_CIPHER_CHACHA20;
 		default:
 			return -1;
 	}
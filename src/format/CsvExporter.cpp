@@ -17,6 +17,7 @@
  */
 #include "CsvExporter.h"
 #include <QFile>
+#include <QStringList>
 #include "core/Database.h"
 #include "core/Group.h"
 
@@ -81,10 +82,41 @@ bool CsvExporter::exportDatabase(
 		this->error = device->errorString();
 		return false;
 	}
-	return this->writeGroup(
-		device,
-		db->getRootGroup()
-	);
+	// the paths of the current group and its ancestors, one per level
+	QStringList groupPaths_;
+	const GroupRange<const Group> groups_ = db->getRootGroup()->
+		groupsRecursive(
+			true
+		);
+	for(auto i_ = groups_.begin(); i_ != groups_.end(); ++i_)
+	{
+		groupPaths_.resize(
+			i_.depth()
+		);
+		QString groupPath_ = groupPaths_.isEmpty() ? QString() : groupPaths_.
+			last();
+		if(!groupPath_.isEmpty())
+		{
+			groupPath_.append(
+				"/"
+			);
+		}
+		groupPath_.append(
+			(*i_)->getName()
+		);
+		if(!this->writeGroup(
+			device,
+			*i_,
+			groupPath_
+		))
+		{
+			return false;
+		}
+		groupPaths_.append(
+			groupPath_
+		);
+	}
+	return true;
 }
 
 QString CsvExporter::getErrorString() const
@@ -95,18 +127,9 @@ QString CsvExporter::getErrorString() const
 bool CsvExporter::writeGroup(
 	QIODevice* device,
 	const Group* group,
-	QString groupPath
+	const QString &groupPath
 )
 {
-	if(!groupPath.isEmpty())
-	{
-		groupPath.append(
-			"/"
-		);
-	}
-	groupPath.append(
-		group->getName()
-	);
 	const QList<Entry*> &entryList_ = group->getEntries();
 	for(const Entry* entry_: entryList_)
 	{
@@ -146,18 +169,6 @@ bool CsvExporter::writeGroup(
 			return false;
 		}
 	}
-	const QList<Group*> &children_ = group->getChildren();
-	for(const Group* child_: children_)
-	{
-		if(!this->writeGroup(
-			device,
-			child_,
-			groupPath
-		))
-		{
-			return false;
-		}
-	}
 	return true;
 }
 
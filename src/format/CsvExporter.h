@@ -38,7 +38,7 @@ private:
 	bool writeGroup(
 		QIODevice* device,
 		const Group* group,
-		QString groupPath = QString()
+		const QString &groupPath
 	);
 	static void addColumn(
 		QString &str,
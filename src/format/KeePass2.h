@@ -16,6 +16,7 @@
  */
 #ifndef KEEPASSX_KEEPASS2_H
 #define KEEPASSX_KEEPASS2_H
+#include <QString>
 #include <QtGlobal>
 #include "core/UUID.h"
 
@@ -23,7 +24,11 @@ namespace KeePass2
 {
 	constexpr auto SIGNATURE_1 = 0x9AA2D903;
 	constexpr auto SIGNATURE_2 = 0xB54BFB67;
-	constexpr quint32 FILE_VERSION = 0x00030001;
+	constexpr quint32 FILE_VERSION_3_1 = 0x00030001;
+	constexpr quint32 FILE_VERSION_4 = 0x00040000;
+	// written for new databases, older clients can't open KDBX 4
+	constexpr quint32 FILE_VERSION = FILE_VERSION_3_1;
+	constexpr quint32 FILE_VERSION_MAX = FILE_VERSION_4;
 	constexpr quint32 FILE_VERSION_MIN = 0x00020000;
 	constexpr auto FILE_VERSION_CRITICAL_MASK = 0xFFFF0000;
 	constexpr QSysInfo::Endian BYTEORDER = QSysInfo::LittleEndian;
@@ -32,9 +37,29 @@ namespace KeePass2
 			"31c1f2e6bf714350be5805216afc5aff"
 		)
 	);
+	const auto KDF_AES = UUID(
+		QByteArray::fromHex(
+			"c9d9f39a628a4460bf740d08c18a4fea"
+		)
+	);
 	const QByteArray INNER_STREAM_SALSA20_IV(
 		"\xE8\x30\x09\x4B\x97\x20\x5D\x2A"
 	);
+	const QString KDFPARAM_UUID(
+		"$UUID"
+	);
+	const QString KDFPARAM_AES_ROUNDS(
+		"R"
+	);
+	const QString KDFPARAM_AES_SEED(
+		"S"
+	);
+	constexpr quint16 VARIANTMAP_VERSION = 0x0100;
+	constexpr quint16 VARIANTMAP_CRITICAL_MASK = 0xFF00;
+	// key index of the header HMAC in KDBX 4
+	constexpr quint64 HEADER_HMAC_INDEX = Q_UINT64_C(0xFFFFFFFFFFFFFFFF);
+	constexpr quint32 JOURNAL_SIGNATURE = 0x4C4E524A;
+	constexpr quint32 JOURNAL_VERSION = 0x00000001;
 
 	enum HeaderFieldID: u_int8_t
 	{
@@ -48,13 +73,41 @@ namespace KeePass2
 		EncryptionIV = 7,
 		ProtectedStreamKey = 8,
 		StreamStartBytes = 9,
-		InnerRandomStreamID = 10
+		InnerRandomStreamID = 10,
+		KdfParameters = 11,
+		PublicCustomData = 12
+	};
+
+	enum InnerHeaderFieldID: u_int8_t
+	{
+		InnerHeaderEnd = 0,
+		InnerHeaderRandomStreamID = 1,
+		InnerHeaderRandomStreamKey = 2,
+		InnerHeaderBinary = 3
+	};
+
+	enum InnerBinaryFlags: u_int8_t
+	{
+		BinaryProtected = 0x01
+	};
+
+	enum VariantMapFieldType: u_int8_t
+	{
+		VariantMapEnd = 0x00,
+		VariantMapUInt32 = 0x04,
+		VariantMapUInt64 = 0x05,
+		VariantMapBool = 0x08,
+		VariantMapInt32 = 0x0C,
+		VariantMapInt64 = 0x0D,
+		VariantMapString = 0x18,
+		VariantMapByteArray = 0x42
 	};
 
 	enum ProtectedStreamAlgo: u_int8_t
 	{
 		ArcFourVariant = 1,
-		Salsa20 = 2
+		Salsa20 = 2,
+		ChaCha20 = 3
 	};
 }
 #endif // KEEPASSX_KEEPASS2_H
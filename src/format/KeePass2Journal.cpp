@@ -0,0 +1,1154 @@
+/*
+ *  Copyright (C) 2026 The cpp-password-manager contributors
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "KeePass2Journal.h"
+#include <QDataStream>
+#include <QDebug>
+#include "core/DurableSaveFile.h"
+#include "core/Endian.h"
+#include "core/Global.h"
+#include "core/Group.h"
+#include "core/ListDeleter.h"
+#include "core/Metadata.h"
+#include "crypto/CryptoHash.h"
+#include "crypto/Random.h"
+#include "crypto/SymmetricCipher.h"
+#include "format/KeePass2.h"
+const qint64 KeePass2Journal::DefaultMaxSize = 1024 * 1024;
+
+KeePass2Journal::KeePass2Journal(
+	Database* db,
+	QObject* parent
+)
+	: QObject(
+		parent
+	),
+	db(
+		db
+	),
+	compressionAlgo(
+		Database::CompressionNone
+	),
+	transformRounds(
+		0
+	),
+	deletedObjectCount(
+		0
+	),
+	metadataModified(
+		false
+	),
+	recordCount(
+		0
+	),
+	maxSize(
+		DefaultMaxSize
+	),
+	error(
+		false
+	)
+{
+}
+
+KeePass2Journal::~KeePass2Journal()
+{
+	this->file.close();
+}
+
+QString KeePass2Journal::getJournalPath(
+	const QString &filename
+)
+{
+	return filename + ".journal";
+}
+
+bool KeePass2Journal::open(
+	const QString &filename,
+	const QByteArray &headerHash
+)
+{
+	this->error = false;
+	this->errorStr.clear();
+	if(!this->db || this->db->transformedMasterKey().isEmpty())
+	{
+		this->raiseError(
+			"No transformed master key"
+		);
+		return false;
+	}
+	this->file.close();
+	this->file.setFileName(
+		this->getJournalPath(
+			filename
+		)
+	);
+	if(!this->file.open(
+		QIODevice::WriteOnly | QIODevice::Truncate
+	))
+	{
+		this->raiseError(
+			this->file.errorString()
+		);
+		return false;
+	}
+	const QByteArray seed_ = Random::getInstance()->getRandomArray(
+		32
+	);
+	this->deriveKeys(
+		seed_
+	);
+	QByteArray header_;
+	header_.append(
+		Endian::int32ToBytes(
+			KeePass2::JOURNAL_SIGNATURE,
+			KeePass2::BYTEORDER
+		)
+	);
+	header_.append(
+		Endian::int32ToBytes(
+			KeePass2::JOURNAL_VERSION,
+			KeePass2::BYTEORDER
+		)
+	);
+	header_.append(
+		headerHash
+	);
+	header_.append(
+		seed_
+	);
+	header_.append(
+		CryptoHash::hmac(
+			header_,
+			this->macKey,
+			CryptoHash::Sha256
+		)
+	);
+	if(this->file.write(
+		header_
+	) != header_.size() || !DurableSaveFile::syncFile(
+		&this->file
+	))
+	{
+		this->raiseError(
+			this->file.errorString()
+		);
+		this->file.close();
+		return false;
+	}
+	this->transformedMasterKey = this->db->transformedMasterKey();
+	this->cipher = this->db->getCipher();
+	this->compressionAlgo = this->db->getCompressionAlgo();
+	this->transformRounds = this->db->transformRounds();
+	this->modifiedGroups.clear();
+	this->modifiedEntries.clear();
+	this->deletedObjectCount = static_cast<int>(this->db->getDeletedObjects().
+		size());
+	this->metadataModified = false;
+	this->recordCount = 0;
+	this->db->disconnect(
+		this
+	);
+	this->db->getMetadata()->disconnect(
+		this
+	);
+	this->connect(
+		this->db,
+		&Database::sig_groupModified,
+		this,
+		&KeePass2Journal::do_groupModified
+	);
+	this->connect(
+		this->db,
+		&Database::sig_groupAboutToAdd,
+		this,
+		&KeePass2Journal::do_groupAboutToAdd
+	);
+	this->connect(
+		this->db,
+		&Database::sig_entryAdded,
+		this,
+		&KeePass2Journal::do_entryModified
+	);
+	this->connect(
+		this->db,
+		&Database::sig_entryModified,
+		this,
+		&KeePass2Journal::do_entryModified
+	);
+	this->connect(
+		this->db->getMetadata(),
+		&Metadata::sig_modified,
+		this,
+		&KeePass2Journal::do_metadataModified
+	);
+	return true;
+}
+
+bool KeePass2Journal::flush()
+{
+	if(!this->file.isOpen() || !this->db)
+	{
+		this->raiseError(
+			"Journal is not open"
+		);
+		return false;
+	}
+	if(!this->hasPendingChanges())
+	{
+		return true;
+	}
+	// groups are written in tree order so parents precede their children
+	// and siblings are restored in ascending index order
+	for(const Group* group_: asConst(
+			*this->db->getRootGroup()
+		).groupsRecursive(
+			true
+		))
+	{
+		if(!this->modifiedGroups.contains(
+			group_->getUUID()
+		))
+		{
+			continue;
+		}
+		QByteArray data_;
+		QDataStream stream_(
+			&data_,
+			QIODevice::WriteOnly
+		);
+		stream_.setVersion(
+			QDataStream::Qt_6_0
+		);
+		stream_ << static_cast<quint8>(RecordGroup);
+		this->writeGroup(
+			stream_,
+			group_
+		);
+		if(!this->appendRecord(
+			data_
+		))
+		{
+			return false;
+		}
+	}
+	for(const UUID &uuid_: asConst(
+			this->modifiedEntries
+		))
+	{
+		const Entry* entry_ = this->db->resolveEntry(
+			uuid_
+		);
+		if(!entry_ || !entry_->getGroup())
+		{
+			continue;
+		}
+		QByteArray data_;
+		QDataStream stream_(
+			&data_,
+			QIODevice::WriteOnly
+		);
+		stream_.setVersion(
+			QDataStream::Qt_6_0
+		);
+		stream_ << static_cast<quint8>(RecordEntry);
+		stream_ << entry_->getGroup()->getUUID();
+		this->writeEntry(
+			stream_,
+			entry_
+		);
+		QList<Entry*> history_ = entry_->buildHistoryItems();
+		const ListDeleter<Entry*> deleter_(
+			&history_
+		);
+		stream_ << static_cast<qint32>(history_.size());
+		for(const Entry* historyItem_: history_)
+		{
+			this->writeEntry(
+				stream_,
+				historyItem_
+			);
+		}
+		if(!this->appendRecord(
+			data_
+		))
+		{
+			return false;
+		}
+	}
+	const QList<DeletedObject> deletedObjects_ = this->db->getDeletedObjects();
+	for(int i_ = this->deletedObjectCount; i_ < deletedObjects_.size(); ++i_)
+	{
+		QByteArray data_;
+		QDataStream stream_(
+			&data_,
+			QIODevice::WriteOnly
+		);
+		stream_.setVersion(
+			QDataStream::Qt_6_0
+		);
+		stream_ << static_cast<quint8>(RecordDeletedObject);
+		stream_ << deletedObjects_.at(
+			i_
+		).uuid;
+		stream_ << deletedObjects_.at(
+			i_
+		).deletionTime;
+		if(!this->appendRecord(
+			data_
+		))
+		{
+			return false;
+		}
+	}
+	if(!DurableSaveFile::syncFile(
+		&this->file
+	))
+	{
+		this->raiseError(
+			this->file.errorString()
+		);
+		return false;
+	}
+	this->modifiedGroups.clear();
+	this->modifiedEntries.clear();
+	this->deletedObjectCount = static_cast<int>(deletedObjects_.size());
+	return true;
+}
+
+bool KeePass2Journal::replay(
+	const QString &filename,
+	const QByteArray &headerHash
+)
+{
+	this->error = false;
+	this->errorStr.clear();
+	QFile journal_(
+		this->getJournalPath(
+			filename
+		)
+	);
+	if(!journal_.exists())
+	{
+		return true;
+	}
+	if(!this->db || this->db->transformedMasterKey().isEmpty())
+	{
+		this->raiseError(
+			"No transformed master key"
+		);
+		return false;
+	}
+	if(!journal_.open(
+		QIODevice::ReadOnly
+	))
+	{
+		this->raiseError(
+			journal_.errorString()
+		);
+		return false;
+	}
+	const QByteArray header_ = journal_.read(
+		72
+	);
+	const QByteArray headerMac_ = journal_.read(
+		32
+	);
+	if(header_.size() != 72 || headerMac_.size() != 32 || Endian::
+		bytesToUInt32(
+			header_.left(
+				4
+			),
+			KeePass2::BYTEORDER
+		) != KeePass2::JOURNAL_SIGNATURE)
+	{
+		this->raiseError(
+			this->tr(
+				"Not a KeePass journal."
+			)
+		);
+		return false;
+	}
+	if(Endian::bytesToUInt32(
+		header_.mid(
+			4,
+			4
+		),
+		KeePass2::BYTEORDER
+	) != KeePass2::JOURNAL_VERSION)
+	{
+		this->raiseError(
+			this->tr(
+				"Unsupported KeePass journal version."
+			)
+		);
+		return false;
+	}
+	// the database file has been rewritten since the journal was started
+	if(header_.mid(
+		8,
+		32
+	) != headerHash)
+	{
+		return true;
+	}
+	this->deriveKeys(
+		header_.mid(
+			40,
+			32
+		)
+	);
+	if(CryptoHash::hmac(
+		header_,
+		this->macKey,
+		CryptoHash::Sha256
+	) != headerMac_)
+	{
+		this->raiseError(
+			this->tr(
+				"Wrong key or journal file is corrupt."
+			)
+		);
+		return false;
+	}
+	this->recordCount = 0;
+	auto ok_ = true;
+	while(!journal_.atEnd())
+	{
+		const QByteArray data_ = this->readRecord(
+			&journal_,
+			&ok_
+		);
+		if(!ok_)
+		{
+			qWarning(
+				"KeePass2Journal::replay: ignoring incomplete record %u",
+				this->recordCount
+			);
+			break;
+		}
+		this->applyRecord(
+			data_
+		);
+	}
+	return true;
+}
+
+void KeePass2Journal::remove()
+{
+	if(this->db)
+	{
+		this->db->disconnect(
+			this
+		);
+		this->db->getMetadata()->disconnect(
+			this
+		);
+	}
+	if(!this->file.fileName().isEmpty())
+	{
+		this->file.close();
+		this->file.remove();
+	}
+	this->modifiedGroups.clear();
+	this->modifiedEntries.clear();
+	this->recordCount = 0;
+}
+
+bool KeePass2Journal::isOpen() const
+{
+	return this->file.isOpen();
+}
+
+bool KeePass2Journal::hasPendingChanges() const
+{
+	return !this->modifiedGroups.isEmpty() || !this->modifiedEntries.isEmpty()
+		|| (this->db && this->db->getDeletedObjects().size() != this->
+			deletedObjectCount);
+}
+
+bool KeePass2Journal::needsFullSave() const
+{
+	if(!this->db || !this->file.isOpen())
+	{
+		return true;
+	}
+	return this->metadataModified || this->getSize() > this->maxSize || this->
+		transformedMasterKey != this->db->transformedMasterKey() || this->cipher
+		!= this->db->getCipher() || this->compressionAlgo != this->db->
+		getCompressionAlgo() || this->transformRounds != this->db->
+		transformRounds();
+}
+
+qint64 KeePass2Journal::getSize() const
+{
+	return this->file.size();
+}
+
+int KeePass2Journal::getRecordCount() const
+{
+	return static_cast<int>(this->recordCount);
+}
+
+void KeePass2Journal::setMaxSize(
+	const qint64 size
+)
+{
+	this->maxSize = size;
+}
+
+bool KeePass2Journal::hasError() const
+{
+	return this->error;
+}
+
+QString KeePass2Journal::getErrorString() const
+{
+	return this->errorStr;
+}
+
+void KeePass2Journal::do_groupModified(
+	Group* group
+)
+{
+	this->modifiedGroups.insert(
+		group->getUUID()
+	);
+}
+
+void KeePass2Journal::do_groupAboutToAdd(
+	Group* group
+)
+{
+	// a group added to the database brings its whole subtree along
+	for(const Group* group_: group->groupsRecursive(
+			true
+		))
+	{
+		this->modifiedGroups.insert(
+			group_->getUUID()
+		);
+		for(const Entry* entry_: group_->getEntries())
+		{
+			this->modifiedEntries.insert(
+				entry_->getUUID()
+			);
+		}
+	}
+}
+
+void KeePass2Journal::do_entryModified(
+	Entry* entry
+)
+{
+	this->modifiedEntries.insert(
+		entry->getUUID()
+	);
+}
+
+void KeePass2Journal::do_metadataModified()
+{
+	this->metadataModified = true;
+}
+
+void KeePass2Journal::deriveKeys(
+	const QByteArray &seed
+)
+{
+	const QByteArray masterKey_ = this->db->transformedMasterKey();
+	this->encryptionKey = CryptoHash::hmac(
+		seed + QByteArray(
+			1,
+			'\x01'
+		),
+		masterKey_,
+		CryptoHash::Sha256
+	);
+	this->macKey = CryptoHash::hmac(
+		seed + QByteArray(
+			1,
+			'\x02'
+		),
+		masterKey_,
+		CryptoHash::Sha256
+	);
+}
+
+bool KeePass2Journal::appendRecord(
+	const QByteArray &data
+)
+{
+	const QByteArray nonce_ = Random::getInstance()->getRandomArray(
+		8
+	);
+	SymmetricCipher cipher_(
+		SymmetricCipher::Salsa20,
+		SymmetricCipher::Stream,
+		SymmetricCipher::Encrypt
+	);
+	if(!cipher_.init(
+		this->encryptionKey,
+		nonce_
+	))
+	{
+		this->raiseError(
+			cipher_.getErrorString()
+		);
+		return false;
+	}
+	bool ok_;
+	const QByteArray cipherText_ = cipher_.process(
+		data,
+		&ok_
+	);
+	if(!ok_)
+	{
+		this->raiseError(
+			cipher_.getErrorString()
+		);
+		return false;
+	}
+	QByteArray record_;
+	record_.append(
+		Endian::int32ToBytes(
+			static_cast<qint32>(this->recordCount),
+			KeePass2::BYTEORDER
+		)
+	);
+	record_.append(
+		Endian::int32ToBytes(
+			static_cast<qint32>(cipherText_.size()),
+			KeePass2::BYTEORDER
+		)
+	);
+	record_.append(
+		nonce_
+	);
+	record_.append(
+		cipherText_
+	);
+	record_.append(
+		CryptoHash::hmac(
+			record_,
+			this->macKey,
+			CryptoHash::Sha256
+		)
+	);
+	if(this->file.write(
+		record_
+	) != record_.size())
+	{
+		this->raiseError(
+			this->file.errorString()
+		);
+		return false;
+	}
+	this->recordCount++;
+	return true;
+}
+
+QByteArray KeePass2Journal::readRecord(
+	QIODevice* device,
+	bool* ok
+)
+{
+	*ok = false;
+	QByteArray record_ = device->read(
+		16
+	);
+	if(record_.size() != 16)
+	{
+		return QByteArray();
+	}
+	if(Endian::bytesToUInt32(
+		record_.left(
+			4
+		),
+		KeePass2::BYTEORDER
+	) != this->recordCount)
+	{
+		return QByteArray();
+	}
+	const quint32 size_ = Endian::bytesToUInt32(
+		record_.mid(
+			4,
+			4
+		),
+		KeePass2::BYTEORDER
+	);
+	if(size_ > static_cast<quint32>(device->bytesAvailable()))
+	{
+		return QByteArray();
+	}
+	record_.append(
+		device->read(
+			size_
+		)
+	);
+	const QByteArray mac_ = device->read(
+		32
+	);
+	if(record_.size() != static_cast<qsizetype>(16 + size_) || mac_.size() !=
+		32 || CryptoHash::hmac(
+			record_,
+			this->macKey,
+			CryptoHash::Sha256
+		) != mac_)
+	{
+		return QByteArray();
+	}
+	SymmetricCipher cipher_(
+		SymmetricCipher::Salsa20,
+		SymmetricCipher::Stream,
+		SymmetricCipher::Decrypt
+	);
+	if(!cipher_.init(
+		this->encryptionKey,
+		record_.mid(
+			8,
+			8
+		)
+	))
+	{
+		return QByteArray();
+	}
+	const QByteArray data_ = cipher_.process(
+		record_.mid(
+			16
+		),
+		ok
+	);
+	if(*ok)
+	{
+		this->recordCount++;
+	}
+	return data_;
+}
+
+void KeePass2Journal::applyRecord(
+	const QByteArray &data
+)
+{
+	QDataStream stream_(
+		data
+	);
+	stream_.setVersion(
+		QDataStream::Qt_6_0
+	);
+	quint8 type_;
+	stream_ >> type_;
+	switch(type_)
+	{
+		case RecordGroup:
+		{
+			UUID uuid_;
+			UUID parentUuid_;
+			qint32 index_;
+			QString name_;
+			QString notes_;
+			qint32 iconNumber_;
+			UUID customIcon_;
+			stream_ >> uuid_ >> parentUuid_ >> index_ >> name_ >> notes_ >>
+				iconNumber_ >> customIcon_;
+			const TimeInfo timeInfo_ = this->readTimeInfo(
+				stream_
+			);
+			bool expanded_;
+			quint8 searchingEnabled_;
+			stream_ >> expanded_ >> searchingEnabled_;
+			if(stream_.status() != QDataStream::Ok)
+			{
+				qWarning() << "KeePass2Journal: invalid group record";
+				return;
+			}
+			Group* group_ = this->db->resolveGroup(
+				uuid_
+			);
+			Group* parent_ = parentUuid_.isNull() ? nullptr : this->db->
+				resolveGroup(
+					parentUuid_
+				);
+			if(!group_)
+			{
+				if(!parent_)
+				{
+					return;
+				}
+				group_ = new Group();
+				group_->setUuid(
+					uuid_
+				);
+			}
+			group_->setUpdateTimeinfo(
+				false
+			);
+			if(parent_ && parent_ != group_)
+			{
+				const auto maxIndex_ = static_cast<qint32>(parent_->getChildren().
+					size()) - (group_->getParentGroup() == parent_ ? 1 : 0);
+				group_->setParent(
+					parent_,
+					qBound(
+						0,
+						index_,
+						maxIndex_
+					)
+				);
+			}
+			group_->setName(
+				name_
+			);
+			group_->setNotes(
+				notes_
+			);
+			if(customIcon_.isNull())
+			{
+				group_->setIcon(
+					iconNumber_
+				);
+			}
+			else
+			{
+				group_->setIcon(
+					customIcon_
+				);
+			}
+			group_->setExpanded(
+				expanded_
+			);
+			group_->setSearchingEnabled(
+				static_cast<Group::TriState>(searchingEnabled_)
+			);
+			group_->setTimeInfo(
+				timeInfo_
+			);
+			group_->setUpdateTimeinfo(
+				true
+			);
+			break;
+		}
+		case RecordEntry:
+		{
+			UUID groupUuid_;
+			stream_ >> groupUuid_;
+			Entry* entry_ = this->readEntry(
+				stream_
+			);
+			qint32 historyCount_ = 0;
+			stream_ >> historyCount_;
+			QList<Entry*> history_;
+			for(qint32 i_ = 0; i_ < historyCount_ && stream_.status() ==
+				QDataStream::Ok; ++i_)
+			{
+				history_.append(
+					this->readEntry(
+						stream_
+					)
+				);
+			}
+			Group* group_ = this->db->resolveGroup(
+				groupUuid_
+			);
+			if(stream_.status() != QDataStream::Ok || !group_)
+			{
+				qWarning() << "KeePass2Journal: invalid entry record";
+				qDeleteAll(
+					history_
+				);
+				delete entry_;
+				return;
+			}
+			Entry* target_ = this->db->resolveEntry(
+				entry_->getUUID()
+			);
+			if(!target_)
+			{
+				target_ = entry_;
+				entry_ = nullptr;
+			}
+			target_->setUpdateTimeinfo(
+				false
+			);
+			target_->setGroup(
+				group_
+			);
+			target_->clearHistory();
+			for(Entry* historyItem_: asConst(
+					history_
+				))
+			{
+				target_->addHistoryItem(
+					historyItem_
+				);
+			}
+			if(entry_)
+			{
+				target_->copyDataFrom(
+					entry_
+				);
+				delete entry_;
+			}
+			target_->setUpdateTimeinfo(
+				true
+			);
+			break;
+		}
+		case RecordDeletedObject:
+		{
+			DeletedObject deletedObject_;
+			stream_ >> deletedObject_.uuid >> deletedObject_.deletionTime;
+			if(stream_.status() != QDataStream::Ok)
+			{
+				qWarning() << "KeePass2Journal: invalid deleted object record";
+				return;
+			}
+			if(const Entry* entry_ = this->db->resolveEntry(
+				deletedObject_.uuid
+			))
+			{
+				delete entry_;
+				// the tombstone keeps the time of the journaled deletion
+				this->db->setDeletionTime(
+					deletedObject_.uuid,
+					deletedObject_.deletionTime
+				);
+			}
+			else if(const Group* group_ = this->db->resolveGroup(
+					deletedObject_.uuid
+				);
+				group_ && group_ != this->db->getRootGroup())
+			{
+				delete group_;
+				this->db->setDeletionTime(
+					deletedObject_.uuid,
+					deletedObject_.deletionTime
+				);
+			}
+			else
+			{
+				this->db->addDeletedObject(
+					deletedObject_
+				);
+			}
+			break;
+		}
+		default:
+			qWarning() << "KeePass2Journal: unknown record type" << type_;
+			break;
+	}
+}
+
+void KeePass2Journal::writeEntry(
+	QDataStream &stream,
+	const Entry* entry
+)
+{
+	stream << entry->getUUID();
+	stream << static_cast<qint32>(entry->getIconNumber());
+	stream << entry->getIconUUID();
+	stream << entry->getForegroundColor();
+	stream << entry->getBackgroundColor();
+	stream << entry->getOverrideURL();
+	stream << entry->getTags();
+	writeTimeInfo(
+		stream,
+		entry->getTimeInfo()
+	);
+	const EntryAttributes* attributes_ = entry->getAttributes();
+	const QList<QString> attributeKeys_ = attributes_->getKeys();
+	stream << static_cast<qint32>(attributeKeys_.size());
+	for(const QString &key_: attributeKeys_)
+	{
+		stream << key_;
+		stream << attributes_->getValue(
+			key_
+		);
+		stream << attributes_->isProtected(
+			key_
+		);
+	}
+	const EntryAttachments* attachments_ = entry->getAttachments();
+	const QList<QString> attachmentKeys_ = attachments_->getKeys();
+	stream << static_cast<qint32>(attachmentKeys_.size());
+	for(const QString &key_: attachmentKeys_)
+	{
+		stream << key_;
+		stream << attachments_->getValue(
+			key_
+		);
+	}
+}
+
+Entry* KeePass2Journal::readEntry(
+	QDataStream &stream
+)
+{
+	const auto entry_ = new Entry();
+	entry_->setUpdateTimeinfo(
+		false
+	);
+	UUID uuid_;
+	qint32 iconNumber_;
+	UUID customIcon_;
+	QColor foregroundColor_;
+	QColor backgroundColor_;
+	QString overrideUrl_;
+	QString tags_;
+	stream >> uuid_ >> iconNumber_ >> customIcon_ >> foregroundColor_ >>
+		backgroundColor_ >> overrideUrl_ >> tags_;
+	const TimeInfo timeInfo_ = readTimeInfo(
+		stream
+	);
+	entry_->setUUID(
+		uuid_
+	);
+	if(customIcon_.isNull())
+	{
+		entry_->setIcon(
+			iconNumber_
+		);
+	}
+	else
+	{
+		entry_->setIcon(
+			customIcon_
+		);
+	}
+	entry_->setForegroundColor(
+		foregroundColor_
+	);
+	entry_->setBackgroundColor(
+		backgroundColor_
+	);
+	entry_->setOverrideURL(
+		overrideUrl_
+	);
+	entry_->setTags(
+		tags_
+	);
+	qint32 count_ = 0;
+	stream >> count_;
+	for(qint32 i_ = 0; i_ < count_ && stream.status() == QDataStream::Ok; ++i_)
+	{
+		QString key_;
+		QString value_;
+		bool protect_;
+		stream >> key_ >> value_ >> protect_;
+		entry_->getAttributes()->set(
+			key_,
+			value_,
+			protect_
+		);
+	}
+	count_ = 0;
+	stream >> count_;
+	for(qint32 i_ = 0; i_ < count_ && stream.status() == QDataStream::Ok; ++i_)
+	{
+		QString key_;
+		QByteArray value_;
+		stream >> key_ >> value_;
+		entry_->getAttachments()->set(
+			key_,
+			value_
+		);
+	}
+	entry_->setTimeInfo(
+		timeInfo_
+	);
+	return entry_;
+}
+
+void KeePass2Journal::writeGroup(
+	QDataStream &stream,
+	const Group* group
+)
+{
+	const Group* parent_ = group->getParentGroup();
+	stream << group->getUUID();
+	stream << (parent_ ? parent_->getUUID() : UUID());
+	stream << static_cast<qint32>(parent_ ? parent_->indexOfChild(
+		group
+	) : 0);
+	stream << group->getName();
+	stream << group->getNotes();
+	stream << static_cast<qint32>(group->getIconNumber());
+	stream << group->getIconUUID();
+	writeTimeInfo(
+		stream,
+		group->getTimeInfo()
+	);
+	stream << group->isExpanded();
+	stream << static_cast<quint8>(group->isSearchingEnabled());
+}
+
+void KeePass2Journal::writeTimeInfo(
+	QDataStream &stream,
+	const TimeInfo &timeInfo
+)
+{
+	stream << timeInfo.getCreationTime();
+	stream << timeInfo.getLastModificationTime();
+	stream << timeInfo.getLastAccessTime();
+	stream << timeInfo.getExpiryTime();
+	stream << timeInfo.getExpires();
+	stream << static_cast<qint32>(timeInfo.getUsageCount());
+	stream << timeInfo.getLocationChanged();
+}
+
+TimeInfo KeePass2Journal::readTimeInfo(
+	QDataStream &stream
+)
+{
+	QDateTime creationTime_;
+	QDateTime lastModificationTime_;
+	QDateTime lastAccessTime_;
+	QDateTime expiryTime_;
+	bool expires_;
+	qint32 usageCount_;
+	QDateTime locationChanged_;
+	stream >> creationTime_ >> lastModificationTime_ >> lastAccessTime_ >>
+		expiryTime_ >> expires_ >> usageCount_ >> locationChanged_;
+	TimeInfo timeInfo_;
+	timeInfo_.setCreationTime(
+		creationTime_
+	);
+	timeInfo_.setLastModificationTime(
+		lastModificationTime_
+	);
+	timeInfo_.setLastAccessTime(
+		lastAccessTime_
+	);
+	timeInfo_.setExpiryTime(
+		expiryTime_
+	);
+	timeInfo_.setExpires(
+		expires_
+	);
+	timeInfo_.setUsageCount(
+		usageCount_
+	);
+	timeInfo_.setLocationChanged(
+		locationChanged_
+	);
+	return timeInfo_;
+}
+
+void KeePass2Journal::raiseError(
+	const QString &errorMessage
+)
+{
+	this->error = true;
+	this->errorStr = errorMessage;
+}
@@ -0,0 +1,155 @@
+/*
+ *  Copyright (C) 2026 The cpp-password-manager contributors
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef KEEPASSX_KEEPASS2JOURNAL_H
+#define KEEPASSX_KEEPASS2JOURNAL_H
+#include <QFile>
+#include <QPointer>
+#include <QSet>
+#include "core/Database.h"
+#include "core/TimeInfo.h"
+#include "core/UUID.h"
+class Entry;
+class Group;
+
+/**
+* Append-only sidecar of a KeePass 2 database file.
+* Records contain snapshots of the groups and entries that have been
+* modified since the database file was written, they are encrypted with
+* Salsa20 and authenticated with HMAC-SHA256 using keys derived from the
+* transformed master key. The journal is bound to the header hash of the
+* database file it extends and ignored once that file is rewritten.
+*/
+class KeePass2Journal final:public QObject
+{
+	Q_OBJECT public:
+	enum RecordType: u_int8_t
+	{
+		RecordGroup = 1,
+		RecordEntry = 2,
+		RecordDeletedObject = 3
+	};
+
+	static const qint64 DefaultMaxSize;
+	explicit KeePass2Journal(
+		Database* db,
+		QObject* parent = nullptr
+	);
+	virtual ~KeePass2Journal() override;
+	static QString getJournalPath(
+		const QString &filename
+	);
+	/**
+	* Starts a new, empty journal for filename, which must have just been
+	* written with the given header hash, and begins to track changes.
+	*/
+	bool open(
+		const QString &filename,
+		const QByteArray &headerHash
+	);
+	/**
+	* Appends records for all changes made since the last call and syncs
+	* them to disk.
+	*/
+	bool flush();
+	/**
+	* Applies the records of the journal next to filename to the database.
+	* Journals that don't belong to the header hash are ignored, replay stops
+	* at the first incomplete or corrupt record.
+	*/
+	bool replay(
+		const QString &filename,
+		const QByteArray &headerHash
+	);
+	void remove();
+	bool isOpen() const;
+	bool hasPendingChanges() const;
+	/**
+	* Returns true if changes can't be journaled (metadata, key or database
+	* settings changed) or the journal exceeds its maximum size.
+	*/
+	bool needsFullSave() const;
+	qint64 getSize() const;
+	int getRecordCount() const;
+	void setMaxSize(
+		qint64 size
+	);
+	bool hasError() const;
+	QString getErrorString() const;
+private Q_SLOTS:
+	void do_groupModified(
+		Group* group
+	);
+	void do_groupAboutToAdd(
+		Group* group
+	);
+	void do_entryModified(
+		Entry* entry
+	);
+	void do_metadataModified();
+private:
+	void deriveKeys(
+		const QByteArray &seed
+	);
+	bool appendRecord(
+		const QByteArray &data
+	);
+	QByteArray readRecord(
+		QIODevice* device,
+		bool* ok
+	);
+	void applyRecord(
+		const QByteArray &data
+	);
+	static void writeEntry(
+		QDataStream &stream,
+		const Entry* entry
+	);
+	static Entry* readEntry(
+		QDataStream &stream
+	);
+	static void writeGroup(
+		QDataStream &stream,
+		const Group* group
+	);
+	static void writeTimeInfo(
+		QDataStream &stream,
+		const TimeInfo &timeInfo
+	);
+	static TimeInfo readTimeInfo(
+		QDataStream &stream
+	);
+	void raiseError(
+		const QString &errorMessage
+	);
+	QPointer<Database> db;
+	QFile file;
+	QByteArray encryptionKey;
+	QByteArray macKey;
+	QByteArray transformedMasterKey;
+	UUID cipher;
+	Database::CompressionAlgorithm compressionAlgo;
+	quint64 transformRounds;
+	QSet<UUID> modifiedGroups;
+	QSet<UUID> modifiedEntries;
+	int deletedObjectCount;
+	bool metadataModified;
+	quint32 recordCount;
+	qint64 maxSize;
+	bool error;
+	QString errorStr;
+};
+#endif // KEEPASSX_KEEPASS2JOURNAL_H
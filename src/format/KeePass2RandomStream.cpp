@@ -16,10 +16,15 @@
  */
 #include "KeePass2RandomStream.h"
 #include "crypto/CryptoHash.h"
-#include "format/KeePass2.h"
 
-KeePass2RandomStream::KeePass2RandomStream()
-	: cipher(
+KeePass2RandomStream::KeePass2RandomStream(
+	const KeePass2::ProtectedStreamAlgo algo
+)
+	: algo(
+		algo
+	),
+	cipher(
+		algo == KeePass2::ChaCha20 ? SymmetricCipher::ChaCha20 :
 		SymmetricCipher::Salsa20,
 		SymmetricCipher::Stream,
 		SymmetricCipher::Encrypt
@@ -34,6 +39,23 @@ bool KeePass2RandomStream::init(
 	const QByteArray &key
 )
 {
+	if(this->algo == KeePass2::ChaCha20)
+	{
+		// KDBX 4 derives both key and nonce from the inner stream key
+		const QByteArray hash_ = CryptoHash::hash(
+			key,
+			CryptoHash::Sha512
+		);
+		return this->cipher.init(
+			hash_.left(
+				32
+			),
+			hash_.mid(
+				32,
+				12
+			)
+		);
+	}
 	return this->cipher.init(
 		CryptoHash::hash(
 			key,
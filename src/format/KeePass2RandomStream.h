@@ -18,11 +18,14 @@
 #define KEEPASSX_KEEPASS2RANDOMSTREAM_H
 #include <QByteArray>
 #include "crypto/SymmetricCipher.h"
+#include "format/KeePass2.h"
 
 class KeePass2RandomStream
 {
 public:
-	KeePass2RandomStream();
+	explicit KeePass2RandomStream(
+		KeePass2::ProtectedStreamAlgo algo = KeePass2::Salsa20
+	);
 	bool init(
 		const QByteArray &key
 	);
@@ -40,6 +43,7 @@ public:
 	QString getErrorString() const;
 private:
 	bool loadBlock();
+	const KeePass2::ProtectedStreamAlgo algo;
 	SymmetricCipher cipher;
 	QByteArray buffer;
 	int offset;
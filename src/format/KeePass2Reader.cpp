@@ -18,6 +18,7 @@
 #include <QBuffer>
 #include <QFile>
 #include <QIODevice>
+#include <memory>
 #include "core/Database.h"
 #include "core/Endian.h"
 #include "crypto/CryptoHash.h"
@@ -25,6 +26,7 @@
 #include "format/KeePass2RandomStream.h"
 #include "format/KeePass2XmlReader.h"
 #include "streams/HashedBlockStream.h"
+#include "streams/HmacBlockStream.h"
 #include "streams/QtIOCompressor"
 #include "streams/StoreDataStream.h"
 #include "streams/SymmetricCipherStream.h"
@@ -47,6 +49,12 @@ KeePass2Reader::KeePass2Reader()
 	),
 	db(
 		nullptr
+	),
+	fileVersion(
+		0
+	),
+	streamAlgo(
+		KeePass2::Salsa20
 	)
 {
 }
@@ -75,6 +83,9 @@ Database* KeePass2Reader::readDatabase(
 	this->encryptionIV.clear();
 	this->streamStartBytes.clear();
 	this->protectedStreamKey.clear();
+	this->streamAlgo = KeePass2::Salsa20;
+	this->binaries.clear();
+	this->headerHash.clear();
 	StoreDataStream headerStream_(
 		this->device
 	);
@@ -111,12 +122,13 @@ Database* KeePass2Reader::readDatabase(
 		);
 		return nullptr;
 	}
-	quint32 version_ = Endian::readUInt32(
+	this->fileVersion = Endian::readUInt32(
 		this->headerStream,
 		KeePass2::BYTEORDER,
 		&ok_
-	) & KeePass2::FILE_VERSION_CRITICAL_MASK;
-	if(quint32 maxVersion_ = KeePass2::FILE_VERSION &
+	);
+	quint32 version_ = this->fileVersion & KeePass2::FILE_VERSION_CRITICAL_MASK;
+	if(quint32 maxVersion_ = KeePass2::FILE_VERSION_MAX &
 			KeePass2::FILE_VERSION_CRITICAL_MASK;
 		!ok_ || version_ < KeePass2::FILE_VERSION_MIN || version_ > maxVersion_)
 	{
@@ -131,6 +143,11 @@ Database* KeePass2Reader::readDatabase(
 	{
 	}
 	headerStream_.close();
+	const QByteArray headerData_ = headerStream_.getStoredData();
+	this->headerHash = CryptoHash::hash(
+		headerData_,
+		CryptoHash::Sha256
+	);
 	if(this->hasError())
 	{
 		this->raiseError(
@@ -140,10 +157,17 @@ Database* KeePass2Reader::readDatabase(
 		);
 		return nullptr;
 	}
-	// check if all required headers were present
+	const bool formatV4_ = version_ >= KeePass2::FILE_VERSION_4;
+	// saving writes the database back in the format it was read in
+	this->db->setFormatVersion(
+		formatV4_ ? KeePass2::FILE_VERSION_4 : KeePass2::FILE_VERSION_3_1
+	);
+	// check if all required headers were present, KDBX 4 moved the stream
+	// key to the inner header and authenticates with HMACs instead
 	if(this->masterSeed.isEmpty() || this->transformSeed.isEmpty() || this->
-		encryptionIV.isEmpty() || this->streamStartBytes.isEmpty() || this->
-		protectedStreamKey.isEmpty() || this->db->getCipher().isNull())
+		encryptionIV.isEmpty() || this->db->getCipher().isNull() || (!formatV4_
+			&& (this->streamStartBytes.isEmpty() || this->protectedStreamKey.
+				isEmpty())))
 	{
 		this->raiseError(
 			"missing database headers"
@@ -173,8 +197,74 @@ Database* KeePass2Reader::readDatabase(
 		this->db->transformedMasterKey()
 	);
 	QByteArray finalKey_ = hash_.getResult();
+	std::unique_ptr<HmacBlockStream> hmacStream_;
+	QIODevice* cipherBaseDevice_ = device;
+	if(formatV4_)
+	{
+		if(device->read(
+			32
+		) != this->headerHash)
+		{
+			this->raiseError(
+				this->tr(
+					"Header doesn't match hash"
+				)
+			);
+			return nullptr;
+		}
+		const QByteArray hmacKey_ = HmacBlockStream::getHmacKey(
+			this->masterSeed,
+			this->db->transformedMasterKey()
+		);
+		if(device->read(
+			32
+		) != CryptoHash::hmac(
+			headerData_,
+			HmacBlockStream::getBlockKey(
+				KeePass2::HEADER_HMAC_INDEX,
+				hmacKey_
+			),
+			CryptoHash::Sha256
+		))
+		{
+			this->raiseError(
+				this->tr(
+					"Wrong key or database file is corrupt."
+				)
+			);
+			return nullptr;
+		}
+		hmacStream_.reset(
+			new HmacBlockStream(
+				device,
+				hmacKey_
+			)
+		);
+		if(!hmacStream_->open(
+			QIODevice::ReadOnly
+		))
+		{
+			this->raiseError(
+				hmacStream_->errorString()
+			);
+			return nullptr;
+		}
+		// authenticate every block up front so nothing forged is decrypted
+		if(!hmacStream_->authenticate())
+		{
+			this->raiseError(
+				this->tr(
+					"Database file is corrupt: %1"
+				).arg(
+					hmacStream_->errorString()
+				)
+			);
+			return nullptr;
+		}
+		cipherBaseDevice_ = hmacStream_.get();
+	}
 	SymmetricCipherStream cipherStream_(
-		device,
+		cipherBaseDevice_,
 		SymmetricCipher::Aes256,
 		SymmetricCipher::Cbc,
 		SymmetricCipher::Decrypt
@@ -198,40 +288,46 @@ Database* KeePass2Reader::readDatabase(
 		);
 		return nullptr;
 	}
-	if(QByteArray realStart_ = cipherStream_.read(
-			32
-		);
-		realStart_ != this->streamStartBytes)
+	QIODevice* payloadDevice_ = &cipherStream_;
+	std::unique_ptr<HashedBlockStream> hashedStream_;
+	if(!formatV4_)
 	{
-		this->raiseError(
-			this->tr(
-				"Wrong key or database file is corrupt."
+		if(QByteArray realStart_ = cipherStream_.read(
+				32
+			);
+			realStart_ != this->streamStartBytes)
+		{
+			this->raiseError(
+				this->tr(
+					"Wrong key or database file is corrupt."
+				)
+			);
+			return nullptr;
+		}
+		hashedStream_.reset(
+			new HashedBlockStream(
+				&cipherStream_
 			)
 		);
-		return nullptr;
-	}
-	auto hashedStream_ = new HashedBlockStream(
-		&cipherStream_
-	);
-	if(!hashedStream_->open(
-		QIODevice::ReadOnly
-	))
-	{
-		this->raiseError(
-			hashedStream_->errorString()
-		);
-		delete hashedStream_;
-		return nullptr;
-	}
-	QIODevice* xmlDevice_ = nullptr;
-	if(this->db->getCompressionAlgo() == Database::CompressionNone)
-	{
-		xmlDevice_ = hashedStream_;
+		if(!hashedStream_->open(
+			QIODevice::ReadOnly
+		))
+		{
+			this->raiseError(
+				hashedStream_->errorString()
+			);
+			return nullptr;
+		}
+		payloadDevice_ = hashedStream_.get();
 	}
-	else
+	QIODevice* xmlDevice_ = payloadDevice_;
+	std::unique_ptr<QtIOCompressor> ioCompressor_;
+	if(this->db->getCompressionAlgo() != Database::CompressionNone)
 	{
-		const auto ioCompressor_ = new QtIOCompressor(
-			hashedStream_
+		ioCompressor_.reset(
+			new QtIOCompressor(
+				payloadDevice_
+			)
 		);
 		ioCompressor_->setStreamFormat(
 			QtIOCompressor::GzipFormat
@@ -243,13 +339,19 @@ Database* KeePass2Reader::readDatabase(
 			this->raiseError(
 				ioCompressor_->errorString()
 			);
-			delete ioCompressor_;
-			delete hashedStream_;
 			return nullptr;
 		}
-		xmlDevice_ = ioCompressor_;
+		xmlDevice_ = ioCompressor_.get();
+	}
+	if(formatV4_ && !this->readInnerHeader(
+		xmlDevice_
+	))
+	{
+		return nullptr;
 	}
-	KeePass2RandomStream randomStream_;
+	KeePass2RandomStream randomStream_(
+		this->streamAlgo
+	);
 	if(!randomStream_.init(
 		this->protectedStreamKey
 	))
@@ -257,10 +359,15 @@ Database* KeePass2Reader::readDatabase(
 		this->raiseError(
 			randomStream_.getErrorString()
 		);
-		delete xmlDevice_;
 		return nullptr;
 	}
 	KeePass2XmlReader xmlReader_;
+	if(formatV4_)
+	{
+		xmlReader_.setBinaryPool(
+			this->binaries
+		);
+	}
 	if(this->saveXml)
 	{
 		this->xmlData = xmlDevice_->readAll();
@@ -295,16 +402,11 @@ Database* KeePass2Reader::readDatabase(
 			delete this->db;
 			this->db = nullptr;
 		}
-		delete xmlDevice_;
 		return this->db;
 	}
 	if(!xmlReader_.getHeaderHash().isEmpty())
 	{
-		if(QByteArray headerHash_ = CryptoHash::hash(
-				headerStream_.getStoredData(),
-				CryptoHash::Sha256
-			);
-			headerHash_ != xmlReader_.getHeaderHash())
+		if(this->headerHash != xmlReader_.getHeaderHash())
 		{
 			this->raiseError(
 				"Header doesn't match hash"
@@ -316,7 +418,13 @@ Database* KeePass2Reader::readDatabase(
 			}
 		}
 	}
-	delete xmlDevice_;
+	if(this->db)
+	{
+		// lets the journal of the file be matched with the database
+		this->db->setHeaderHash(
+			this->headerHash
+		);
+	}
 	return this->db;
 }
 
@@ -373,6 +481,11 @@ void KeePass2Reader::setSaveXml(
 	this->saveXml = save;
 }
 
+QByteArray KeePass2Reader::getHeaderHash() const
+{
+	return this->headerHash;
+}
+
 QByteArray KeePass2Reader::getXMLData()
 {
 	return this->xmlData;
@@ -383,6 +496,16 @@ QByteArray KeePass2Reader::getStreamKey()
 	return this->protectedStreamKey;
 }
 
+KeePass2::ProtectedStreamAlgo KeePass2Reader::getStreamAlgo() const
+{
+	return this->streamAlgo;
+}
+
+QList<QByteArray> KeePass2Reader::getBinaries() const
+{
+	return this->binaries;
+}
+
 void KeePass2Reader::raiseError(
 	const QString &errorMessage
 )
@@ -408,11 +531,23 @@ bool KeePass2Reader::readHeaderField()
 		0
 	);
 	bool ok_;
-	const quint16 fieldLen_ = Endian::readUInt16(
-		this->headerStream,
-		KeePass2::BYTEORDER,
-		&ok_
-	);
+	qint64 fieldLen_;
+	if(this->fileVersion >= KeePass2::FILE_VERSION_4)
+	{
+		fieldLen_ = Endian::readUInt32(
+			this->headerStream,
+			KeePass2::BYTEORDER,
+			&ok_
+		);
+	}
+	else
+	{
+		fieldLen_ = Endian::readUInt16(
+			this->headerStream,
+			KeePass2::BYTEORDER,
+			&ok_
+		);
+	}
 	if(!ok_)
 	{
 		this->raiseError(
@@ -484,6 +619,13 @@ bool KeePass2Reader::readHeaderField()
 				fieldData_
 			);
 			break;
+		case KeePass2::KdfParameters:
+			this->setKdfParameters(
+				fieldData_
+			);
+			break;
+		case KeePass2::PublicCustomData:
+			break;
 		default: qWarning(
 				"Unknown header field read: id=%d",
 				fieldID_
@@ -678,11 +820,312 @@ void KeePass2Reader::setInnerRandomStreamID(
 				data,
 				KeePass2::BYTEORDER
 			);
-			id_ != KeePass2::Salsa20)
+			id_ != KeePass2::Salsa20 && id_ != KeePass2::ChaCha20)
 		{
 			this->raiseError(
 				"Unsupported random stream algorithm"
 			);
 		}
+		else
+		{
+			this->streamAlgo = static_cast<KeePass2::ProtectedStreamAlgo>(id_);
+		}
+	}
+}
+
+void KeePass2Reader::setKdfParameters(
+	const QByteArray &data
+)
+{
+	QVariantMap parameters_;
+	if(!this->readVariantMap(
+		data,
+		parameters_
+	))
+	{
+		this->raiseError(
+			"Invalid KDF parameters"
+		);
+		return;
+	}
+	// Argon2 isn't available, only the AES-KDF of KDBX 3.1
+	if(UUID(
+		parameters_.value(
+			KeePass2::KDFPARAM_UUID
+		).toByteArray()
+	) != KeePass2::KDF_AES)
+	{
+		this->raiseError(
+			this->tr(
+				"Unsupported key derivation function"
+			)
+		);
+		return;
+	}
+	const QByteArray seed_ = parameters_.value(
+		KeePass2::KDFPARAM_AES_SEED
+	).toByteArray();
+	bool ok_;
+	const quint64 rounds_ = parameters_.value(
+		KeePass2::KDFPARAM_AES_ROUNDS
+	).toULongLong(
+		&ok_
+	);
+	if(!ok_)
+	{
+		this->raiseError(
+			"Invalid transform rounds size"
+		);
+		return;
+	}
+	this->setTransformSeed(
+		seed_
+	);
+	if(!this->db->setTransformRounds(
+		rounds_
+	))
+	{
+		this->raiseError(
+			this->tr(
+				"Unable to calculate master key"
+			)
+		);
 	}
 }
+
+bool KeePass2Reader::readVariantMap(
+	const QByteArray &data,
+	QVariantMap &map
+)
+{
+	QBuffer buffer_;
+	buffer_.setData(
+		data
+	);
+	buffer_.open(
+		QIODevice::ReadOnly
+	);
+	bool ok_;
+	if(const quint16 version_ = Endian::readUInt16(
+			&buffer_,
+			KeePass2::BYTEORDER,
+			&ok_
+		);
+		!ok_ || (version_ & KeePass2::VARIANTMAP_CRITICAL_MASK) > (
+			KeePass2::VARIANTMAP_VERSION & KeePass2::VARIANTMAP_CRITICAL_MASK))
+	{
+		return false;
+	}
+	while(true)
+	{
+		const QByteArray type_ = buffer_.read(
+			1
+		);
+		if(type_.size() != 1)
+		{
+			return false;
+		}
+		if(type_.at(
+			0
+		) == KeePass2::VariantMapEnd)
+		{
+			return true;
+		}
+		const qint32 nameLen_ = Endian::readInt32(
+			&buffer_,
+			KeePass2::BYTEORDER,
+			&ok_
+		);
+		if(!ok_ || nameLen_ < 0)
+		{
+			return false;
+		}
+		const QByteArray name_ = buffer_.read(
+			nameLen_
+		);
+		const qint32 valueLen_ = Endian::readInt32(
+			&buffer_,
+			KeePass2::BYTEORDER,
+			&ok_
+		);
+		if(name_.size() != nameLen_ || !ok_ || valueLen_ < 0)
+		{
+			return false;
+		}
+		const QByteArray value_ = buffer_.read(
+			valueLen_
+		);
+		if(value_.size() != valueLen_)
+		{
+			return false;
+		}
+		const QString key_ = QString::fromUtf8(
+			name_
+		);
+		switch(static_cast<quint8>(type_.at(
+			0
+		)))
+		{
+			case KeePass2::VariantMapUInt32:
+			case KeePass2::VariantMapInt32:
+				if(valueLen_ != 4)
+				{
+					return false;
+				}
+				map.insert(
+					key_,
+					Endian::bytesToUInt32(
+						value_,
+						KeePass2::BYTEORDER
+					)
+				);
+				break;
+			case KeePass2::VariantMapUInt64:
+			case KeePass2::VariantMapInt64:
+				if(valueLen_ != 8)
+				{
+					return false;
+				}
+				map.insert(
+					key_,
+					Endian::bytesToUInt64(
+						value_,
+						KeePass2::BYTEORDER
+					)
+				);
+				break;
+			case KeePass2::VariantMapBool:
+				if(valueLen_ != 1)
+				{
+					return false;
+				}
+				map.insert(
+					key_,
+					value_.at(
+						0
+					) != 0
+				);
+				break;
+			case KeePass2::VariantMapString:
+				map.insert(
+					key_,
+					QString::fromUtf8(
+						value_
+					)
+				);
+				break;
+			case KeePass2::VariantMapByteArray:
+				map.insert(
+					key_,
+					value_
+				);
+				break;
+			default: qWarning(
+					"Unknown variant map type read: %d",
+					type_.at(
+						0
+					)
+				);
+				break;
+		}
+	}
+}
+
+bool KeePass2Reader::readInnerHeader(
+	QIODevice* device
+)
+{
+	while(true)
+	{
+		const QByteArray fieldID_ = device->read(
+			1
+		);
+		bool ok_;
+		const qint32 fieldLen_ = Endian::readInt32(
+			device,
+			KeePass2::BYTEORDER,
+			&ok_
+		);
+		if(fieldID_.size() != 1 || !ok_ || fieldLen_ < 0)
+		{
+			this->raiseError(
+				"Invalid inner header"
+			);
+			return false;
+		}
+		QByteArray fieldData_;
+		if(fieldLen_ != 0)
+		{
+			// read in one go, attachments are sliced off the flags byte below
+			fieldData_.resize(
+				fieldLen_
+			);
+			if(device->read(
+				fieldData_.data(),
+				fieldLen_
+			) != fieldLen_)
+			{
+				this->raiseError(
+					"Invalid inner header data length"
+				);
+				return false;
+			}
+		}
+		switch(static_cast<quint8>(fieldID_.at(
+			0
+		)))
+		{
+			case KeePass2::InnerHeaderEnd:
+				if(this->protectedStreamKey.isEmpty())
+				{
+					this->raiseError(
+						"missing database headers"
+					);
+					return false;
+				}
+				return true;
+			case KeePass2::InnerHeaderRandomStreamID:
+				this->setInnerRandomStreamID(
+					fieldData_
+				);
+				break;
+			case KeePass2::InnerHeaderRandomStreamKey:
+				if(fieldData_.isEmpty())
+				{
+					this->raiseError(
+						"Invalid stream key size"
+					);
+				}
+				this->protectedStreamKey = fieldData_;
+				break;
+			case KeePass2::InnerHeaderBinary:
+				if(fieldData_.isEmpty())
+				{
+					this->raiseError(
+						"Invalid binary size"
+					);
+					return false;
+				}
+				// the first byte holds the flags, the memory protection flag
+				// isn't tracked for attachments
+				this->binaries.append(
+					fieldData_.mid(
+						1
+					)
+				);
+				break;
+			default: qWarning(
+					"Unknown inner header field read: id=%d",
+					fieldID_.at(
+						0
+					)
+				);
+				break;
+		}
+		if(this->hasError())
+		{
+			return false;
+		}
+	}
+}
+
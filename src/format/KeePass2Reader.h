@@ -17,6 +17,8 @@
 #ifndef KEEPASSX_KEEPASS2READER_H
 #define KEEPASSX_KEEPASS2READER_H
 #include <QCoreApplication>
+#include <QVariantMap>
+#include "format/KeePass2.h"
 #include "keys/CompositeKey.h"
 class Database;
 class QIODevice;
@@ -42,8 +44,17 @@ public:
 	void setSaveXml(
 		bool save
 	);
+	/**
+	* Returns the SHA-256 hash of the header of the last database read.
+	*/
+	QByteArray getHeaderHash() const;
 	QByteArray getXMLData();
 	QByteArray getStreamKey();
+	KeePass2::ProtectedStreamAlgo getStreamAlgo() const;
+	/**
+	* Returns the attachments of a KDBX 4 inner header.
+	*/
+	QList<QByteArray> getBinaries() const;
 private:
 	void raiseError(
 		const QString &errorMessage
@@ -76,6 +87,16 @@ private:
 	void setInnerRandomStreamID(
 		const QByteArray &data
 	);
+	void setKdfParameters(
+		const QByteArray &data
+	);
+	static bool readVariantMap(
+		const QByteArray &data,
+		QVariantMap &map
+	);
+	bool readInnerHeader(
+		QIODevice* device
+	);
 	QIODevice* device;
 	QIODevice* headerStream;
 	bool error;
@@ -84,10 +105,14 @@ private:
 	bool saveXml;
 	QByteArray xmlData;
 	Database* db;
+	quint32 fileVersion;
+	KeePass2::ProtectedStreamAlgo streamAlgo;
+	QList<QByteArray> binaries;
 	QByteArray masterSeed;
 	QByteArray transformSeed;
 	QByteArray encryptionIV;
 	QByteArray streamStartBytes;
 	QByteArray protectedStreamKey;
+	QByteArray headerHash;
 };
 #endif // KEEPASSX_KEEPASS2READER_H
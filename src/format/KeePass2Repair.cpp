@@ -111,11 +111,16 @@ KeePass2Repair::RepairResult KeePass2Repair::repairDatabase(
 		delete db_;
 		return RepairFailed;
 	}
-	KeePass2RandomStream randomStream_;
+	KeePass2RandomStream randomStream_(
+		reader_.getStreamAlgo()
+	);
 	randomStream_.init(
 		reader_.getStreamKey()
 	);
 	KeePass2XmlReader xmlReader_;
+	xmlReader_.setBinaryPool(
+		reader_.getBinaries()
+	);
 	QBuffer buffer_(
 		&xmlData_
 	);
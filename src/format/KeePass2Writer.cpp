@@ -18,6 +18,7 @@
 #include <QBuffer>
 #include <QFile>
 #include <QIODevice>
+#include <memory>
 #include "core/Database.h"
 #include "core/Endian.h"
 #include "crypto/CryptoHash.h"
@@ -25,6 +26,7 @@
 #include "format/KeePass2RandomStream.h"
 #include "format/KeePass2XmlWriter.h"
 #include "streams/HashedBlockStream.h"
+#include "streams/HmacBlockStream.h"
 #include "streams/QtIOCompressor"
 #include "streams/SymmetricCipherStream.h"
 #define CHECK_RETURN(x) if (!(x)) return;
@@ -34,6 +36,9 @@ KeePass2Writer::KeePass2Writer()
 	: device(
 		nullptr
 	),
+	formatVersion(
+		KeePass2::FILE_VERSION
+	),
 	error(
 		false
 	)
@@ -61,6 +66,9 @@ void KeePass2Writer::writeDatabase(
 	}
 	this->error = false;
 	this->errorStr.clear();
+	this->headerHash.clear();
+	this->formatVersion = db->getFormatVersion();
+	const bool formatV4_ = this->formatVersion >= KeePass2::FILE_VERSION_4;
 	QByteArray masterSeed_ = Random::getInstance()->getRandomArray(
 		32
 	);
@@ -68,7 +76,7 @@ void KeePass2Writer::writeDatabase(
 		16
 	);
 	QByteArray protectedStreamKey_ = Random::getInstance()->getRandomArray(
-		32
+		formatV4_ ? 64 : 32
 	);
 	QByteArray startBytes_ = Random::getInstance()->getRandomArray(
 		32
@@ -105,7 +113,7 @@ void KeePass2Writer::writeDatabase(
 			BYTEORDER))
 	);
 	CHECK_RETURN(
-		this->writeData(Endian::int32ToBytes(KeePass2::FILE_VERSION, KeePass2::
+		this->writeData(Endian::int32ToBytes(this->formatVersion, KeePass2::
 			BYTEORDER))
 	);
 	CHECK_RETURN(
@@ -119,27 +127,40 @@ void KeePass2Writer::writeDatabase(
 	CHECK_RETURN(
 		this->writeHeaderField(KeePass2::MasterSeed, masterSeed_)
 	);
-	CHECK_RETURN(
-		this->writeHeaderField(KeePass2::TransformSeed, db->transformSeed())
-	);
-	CHECK_RETURN(
-		this->writeHeaderField(KeePass2::TransformRounds, Endian::int64ToBytes(
-			db-> transformRounds(), KeePass2::BYTEORDER))
-	);
-	CHECK_RETURN(
-		this->writeHeaderField(KeePass2::EncryptionIV, encryptionIV_)
-	);
-	CHECK_RETURN(
-		this->writeHeaderField(KeePass2::ProtectedStreamKey, protectedStreamKey_
-		)
-	);
-	CHECK_RETURN(
-		this->writeHeaderField(KeePass2::StreamStartBytes, startBytes_)
-	);
-	CHECK_RETURN(
-		this->writeHeaderField(KeePass2::InnerRandomStreamID, Endian::
-			int32ToBytes( KeePass2::Salsa20, KeePass2::BYTEORDER))
-	);
+	if(formatV4_)
+	{
+		CHECK_RETURN(
+			this->writeHeaderField(KeePass2::EncryptionIV, encryptionIV_)
+		);
+		CHECK_RETURN(
+			this->writeHeaderField(KeePass2::KdfParameters, this->
+				getKdfParameters(db))
+		);
+	}
+	else
+	{
+		CHECK_RETURN(
+			this->writeHeaderField(KeePass2::TransformSeed, db->transformSeed())
+		);
+		CHECK_RETURN(
+			this->writeHeaderField(KeePass2::TransformRounds, Endian::int64ToBytes(
+				db-> transformRounds(), KeePass2::BYTEORDER))
+		);
+		CHECK_RETURN(
+			this->writeHeaderField(KeePass2::EncryptionIV, encryptionIV_)
+		);
+		CHECK_RETURN(
+			this->writeHeaderField(KeePass2::ProtectedStreamKey,
+				protectedStreamKey_)
+		);
+		CHECK_RETURN(
+			this->writeHeaderField(KeePass2::StreamStartBytes, startBytes_)
+		);
+		CHECK_RETURN(
+			this->writeHeaderField(KeePass2::InnerRandomStreamID, Endian::
+				int32ToBytes( KeePass2::Salsa20, KeePass2::BYTEORDER))
+		);
+	}
 	CHECK_RETURN(
 		this->writeHeaderField(KeePass2::EndOfHeader, endOfHeader_)
 	);
@@ -149,11 +170,46 @@ void KeePass2Writer::writeDatabase(
 		header_.data(),
 		CryptoHash::Sha256
 	);
+	this->headerHash = headerHash_;
 	CHECK_RETURN(
 		this->writeData(header_.data())
 	);
+	std::unique_ptr<HmacBlockStream> hmacStream_;
+	QIODevice* cipherBaseDevice_ = device;
+	if(formatV4_)
+	{
+		// the header is authenticated right after it, the payload per block
+		const QByteArray hmacKey_ = HmacBlockStream::getHmacKey(
+			masterSeed_,
+			db->transformedMasterKey()
+		);
+		CHECK_RETURN(
+			this->writeData(headerHash_)
+		);
+		CHECK_RETURN(
+			this->writeData(CryptoHash::hmac(header_.data(), HmacBlockStream::
+				getBlockKey(KeePass2::HEADER_HMAC_INDEX, hmacKey_), CryptoHash::
+				Sha256))
+		);
+		hmacStream_.reset(
+			new HmacBlockStream(
+				device,
+				hmacKey_
+			)
+		);
+		if(!hmacStream_->open(
+			QIODevice::WriteOnly
+		))
+		{
+			this->raiseError(
+				hmacStream_->errorString()
+			);
+			return;
+		}
+		cipherBaseDevice_ = hmacStream_.get();
+	}
 	SymmetricCipherStream cipherStream_(
-		device,
+		cipherBaseDevice_,
 		SymmetricCipher::Aes256,
 		SymmetricCipher::Cbc,
 		SymmetricCipher::Encrypt
@@ -172,31 +228,39 @@ void KeePass2Writer::writeDatabase(
 		return;
 	}
 	this->device = &cipherStream_;
-	CHECK_RETURN(
-		this->writeData(startBytes_)
-	);
-	HashedBlockStream hashedStream_(
-		&cipherStream_
-	);
-	if(!hashedStream_.open(
-		QIODevice::WriteOnly
-	))
+	QIODevice* payloadDevice_ = &cipherStream_;
+	std::unique_ptr<HashedBlockStream> hashedStream_;
+	if(!formatV4_)
 	{
-		this->raiseError(
-			hashedStream_.errorString()
+		CHECK_RETURN(
+			this->writeData(startBytes_)
 		);
-		return;
+		hashedStream_.reset(
+			new HashedBlockStream(
+				&cipherStream_
+			)
+		);
+		if(!hashedStream_->open(
+			QIODevice::WriteOnly
+		))
+		{
+			this->raiseError(
+				hashedStream_->errorString()
+			);
+			return;
+		}
+		payloadDevice_ = hashedStream_.get();
 	}
 	std::unique_ptr<QtIOCompressor> ioCompressor_;
 	if(db->getCompressionAlgo() == Database::CompressionNone)
 	{
-		this->device = &hashedStream_;
+		this->device = payloadDevice_;
 	}
 	else
 	{
 		ioCompressor_.reset(
 			new QtIOCompressor(
-				&hashedStream_
+				payloadDevice_
 			)
 		);
 		ioCompressor_->setStreamFormat(
@@ -213,7 +277,20 @@ void KeePass2Writer::writeDatabase(
 		}
 		this->device = ioCompressor_.get();
 	}
-	KeePass2RandomStream randomStream_;
+	KeePass2XmlWriter xmlWriter_;
+	xmlWriter_.setFormatVersion(
+		this->formatVersion
+	);
+	if(formatV4_)
+	{
+		CHECK_RETURN(
+			this->writeInnerHeader(protectedStreamKey_, xmlWriter_.
+				prepareBinaryPool(db))
+		);
+	}
+	KeePass2RandomStream randomStream_(
+		formatV4_ ? KeePass2::ChaCha20 : KeePass2::Salsa20
+	);
 	if(!randomStream_.init(
 		protectedStreamKey_
 	))
@@ -223,12 +300,12 @@ void KeePass2Writer::writeDatabase(
 		);
 		return;
 	}
-	KeePass2XmlWriter xmlWriter_;
+	// KDBX 4 authenticates the header with the HMAC instead
 	xmlWriter_.writeDatabase(
 		this->device,
 		db,
 		&randomStream_,
-		headerHash_
+		formatV4_ ? QByteArray() : headerHash_
 	);
 	// Explicitly close/reset streams so they are flushed and we can detect
 	// errors. QIODevice::close() resets errorString() etc.
@@ -236,10 +313,10 @@ void KeePass2Writer::writeDatabase(
 	{
 		ioCompressor_->close();
 	}
-	if(!hashedStream_.reset())
+	if(hashedStream_ && !hashedStream_->reset())
 	{
 		this->raiseError(
-			hashedStream_.errorString()
+			hashedStream_->errorString()
 		);
 		return;
 	}
@@ -250,6 +327,13 @@ void KeePass2Writer::writeDatabase(
 		);
 		return;
 	}
+	if(hmacStream_ && !hmacStream_->reset())
+	{
+		this->raiseError(
+			hmacStream_->errorString()
+		);
+		return;
+	}
 	if(xmlWriter_.hasError())
 	{
 		this->raiseError(
@@ -279,7 +363,8 @@ bool KeePass2Writer::writeHeaderField(
 	const QByteArray &data
 )
 {
-	if(data.size() > 65535)
+	const bool formatV4_ = this->formatVersion >= KeePass2::FILE_VERSION_4;
+	if(!formatV4_ && data.size() > 65535)
 	{
 		this->raiseError(
 			"Header field too large"
@@ -294,16 +379,157 @@ bool KeePass2Writer::writeHeaderField(
 	CHECK_RETURN_FALSE(
 		this->writeData(fieldIdArr_)
 	);
-	CHECK_RETURN_FALSE(
-		this->writeData(Endian::int16ToBytes(static_cast<quint16>(data.size()),
-			KeePass2::BYTEORDER))
-	);
+	if(formatV4_)
+	{
+		CHECK_RETURN_FALSE(
+			this->writeData(Endian::int32ToBytes(static_cast<qint32>(data.size()),
+				KeePass2::BYTEORDER))
+		);
+	}
+	else
+	{
+		CHECK_RETURN_FALSE(
+			this->writeData(Endian::int16ToBytes(static_cast<quint16>(data.size()),
+				KeePass2::BYTEORDER))
+		);
+	}
 	CHECK_RETURN_FALSE(
 		this->writeData(data)
 	);
 	return true;
 }
 
+bool KeePass2Writer::writeInnerHeaderField(
+	const KeePass2::InnerHeaderFieldID fieldId,
+	const QByteArray &data
+)
+{
+	QByteArray field_;
+	field_.append(
+		static_cast<char>(fieldId)
+	);
+	field_.append(
+		Endian::int32ToBytes(
+			static_cast<qint32>(data.size()),
+			KeePass2::BYTEORDER
+		)
+	);
+	field_.append(
+		data
+	);
+	return this->writeData(
+		field_
+	);
+}
+
+bool KeePass2Writer::writeInnerHeader(
+	const QByteArray &protectedStreamKey,
+	const QList<QByteArray> &binaries
+)
+{
+	CHECK_RETURN_FALSE(
+		this->writeInnerHeaderField(KeePass2::InnerHeaderRandomStreamID, Endian
+			::int32ToBytes(KeePass2::ChaCha20, KeePass2::BYTEORDER))
+	);
+	CHECK_RETURN_FALSE(
+		this->writeInnerHeaderField(KeePass2::InnerHeaderRandomStreamKey,
+			protectedStreamKey)
+	);
+	for(const QByteArray &binary_: binaries)
+	{
+		// raw attachment data, written as is behind the field header
+		QByteArray field_;
+		field_.append(
+			static_cast<char>(KeePass2::InnerHeaderBinary)
+		);
+		field_.append(
+			Endian::int32ToBytes(
+				static_cast<qint32>(binary_.size() + 1),
+				KeePass2::BYTEORDER
+			)
+		);
+		field_.append(
+			'\0'
+		);
+		CHECK_RETURN_FALSE(
+			this->writeData(field_)
+		);
+		CHECK_RETURN_FALSE(
+			this->writeData(binary_)
+		);
+	}
+	return this->writeInnerHeaderField(
+		KeePass2::InnerHeaderEnd,
+		QByteArray()
+	);
+}
+
+QByteArray KeePass2Writer::getKdfParameters(
+	const Database* db
+)
+{
+	QByteArray map_ = Endian::int16ToBytes(
+		KeePass2::VARIANTMAP_VERSION,
+		KeePass2::BYTEORDER
+	);
+	appendVariantMapField(
+		map_,
+		KeePass2::VariantMapByteArray,
+		KeePass2::KDFPARAM_UUID,
+		KeePass2::KDF_AES.toByteArray()
+	);
+	appendVariantMapField(
+		map_,
+		KeePass2::VariantMapUInt64,
+		KeePass2::KDFPARAM_AES_ROUNDS,
+		Endian::int64ToBytes(
+			static_cast<qint64>(db->transformRounds()),
+			KeePass2::BYTEORDER
+		)
+	);
+	appendVariantMapField(
+		map_,
+		KeePass2::VariantMapByteArray,
+		KeePass2::KDFPARAM_AES_SEED,
+		db->transformSeed()
+	);
+	map_.append(
+		static_cast<char>(KeePass2::VariantMapEnd)
+	);
+	return map_;
+}
+
+void KeePass2Writer::appendVariantMapField(
+	QByteArray &map,
+	const KeePass2::VariantMapFieldType type,
+	const QString &name,
+	const QByteArray &value
+)
+{
+	const QByteArray name_ = name.toUtf8();
+	map.append(
+		static_cast<char>(type)
+	);
+	map.append(
+		Endian::int32ToBytes(
+			static_cast<qint32>(name_.size()),
+			KeePass2::BYTEORDER
+		)
+	);
+	map.append(
+		name_
+	);
+	map.append(
+		Endian::int32ToBytes(
+			static_cast<qint32>(value.size()),
+			KeePass2::BYTEORDER
+		)
+	);
+	map.append(
+		value
+	);
+}
+
 void KeePass2Writer::writeDatabase(
 	const QString &filename,
 	Database* db
@@ -337,6 +563,11 @@ QString KeePass2Writer::getErrorString()
 	return this->errorStr;
 }
 
+QByteArray KeePass2Writer::getHeaderHash() const
+{
+	return this->headerHash;
+}
+
 void KeePass2Writer::raiseError(
 	const QString &errorMessage
 )
@@ -35,6 +35,10 @@ public:
 	);
 	bool hasError() const;
 	QString getErrorString();
+	/**
+	* Returns the SHA-256 hash of the header of the last database written.
+	*/
+	QByteArray getHeaderHash() const;
 private:
 	bool writeData(
 		const QByteArray &data
@@ -43,11 +47,30 @@ private:
 		KeePass2::HeaderFieldID fieldId,
 		const QByteArray &data
 	);
+	bool writeInnerHeaderField(
+		KeePass2::InnerHeaderFieldID fieldId,
+		const QByteArray &data
+	);
+	bool writeInnerHeader(
+		const QByteArray &protectedStreamKey,
+		const QList<QByteArray> &binaries
+	);
+	static QByteArray getKdfParameters(
+		const Database* db
+	);
+	static void appendVariantMapField(
+		QByteArray &map,
+		KeePass2::VariantMapFieldType type,
+		const QString &name,
+		const QByteArray &value
+	);
 	void raiseError(
 		const QString &errorMessage
 	);
 	QIODevice* device;
+	quint32 formatVersion;
 	bool error;
 	QString errorStr;
+	QByteArray headerHash;
 };
 #endif // KEEPASSX_KEEPASS2WRITER_H
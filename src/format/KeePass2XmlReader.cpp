@@ -19,9 +19,11 @@
 #include <QFile>
 #include "core/Database.h"
 #include "core/DatabaseIcons.h"
+#include "core/Endian.h"
 #include "core/Global.h"
 #include "core/Group.h"
 #include "core/Metadata.h"
+#include "core/StringPool.h"
 #include "core/Tools.h"
 #include "format/KeePass2RandomStream.h"
 #include "streams/QtIOCompressor"
@@ -56,6 +58,24 @@ void KeePass2XmlReader::setStrictMode(
 	this->strictMode = strictMode;
 }
 
+void KeePass2XmlReader::setBinaryPool(
+	const QList<QByteArray> &binaries
+)
+{
+	this->binaryPool.clear();
+	for(qsizetype i_ = 0; i_ < binaries.size(); ++i_)
+	{
+		this->binaryPool.insert(
+			QString::number(
+				i_
+			),
+			binaries.at(
+				i_
+			)
+		);
+	}
+}
+
 void KeePass2XmlReader::readDatabase(
 	QIODevice* device,
 	Database* db,
@@ -85,6 +105,15 @@ void KeePass2XmlReader::readDatabase(
 	);
 	this->randomStream = randomStream;
 	this->headerHash.clear();
+	for(const auto &[entry_, items_]: asConst(
+			this->histories
+		))
+	{
+		qDeleteAll(
+			items_
+		);
+	}
+	this->histories.clear();
 	this->tmpParent = new Group();
 	auto rootGroupParsed_ = false;
 	if(this->xml.error())
@@ -188,19 +217,24 @@ void KeePass2XmlReader::readDatabase(
 			true
 		);
 	}
+	for(const auto &[entry_, items_]: asConst(
+			this->histories
+		))
+	{
+		for(Entry* historyItem_: items_)
+		{
+			entry_->addHistoryItem(
+				historyItem_
+			);
+		}
+	}
+	this->histories.clear();
 	for(QHash<UUID, Entry*>::const_iterator iEntry_ = this->entries.constBegin()
 		; iEntry_ != this->entries.constEnd(); ++iEntry_)
 	{
 		iEntry_.value()->setUpdateTimeinfo(
 			true
 		);
-		const QList<Entry*> historyItems_ = iEntry_.value()->getHistoryItems();
-		for(Entry* histEntry_: historyItems_)
-		{
-			histEntry_->setUpdateTimeinfo(
-				true
-			);
-		}
 	}
 	delete this->tmpParent;
 }
@@ -823,7 +857,7 @@ Group* KeePass2XmlReader::parseGroup()
 		else if(this->xml.name().toString() == "Name")
 		{
 			group_->setName(
-				this->readString()
+				this->readPooledString()
 			);
 		}
 		else if(this->xml.name().toString() == "Notes")
@@ -1155,13 +1189,13 @@ Entry* KeePass2XmlReader::parseEntry(
 		else if(this->xml.name().toString() == "OverrideURL")
 		{
 			entry_->setOverrideURL(
-				this->readString()
+				this->readPooledString()
 			);
 		}
 		else if(this->xml.name().toString() == "Tags")
 		{
 			entry_->setTags(
-				this->readString()
+				this->readPooledString()
 			);
 		}
 		else if(this->xml.name().toString() == "Times")
@@ -1260,8 +1294,14 @@ Entry* KeePass2XmlReader::parseEntry(
 				);
 			}
 		}
-		entry_->addHistoryItem(
-			historyItem_
+	}
+	if(!historyItems_.isEmpty())
+	{
+		this->histories.append(
+			qMakePair(
+				entry_,
+				historyItems_
+			)
 		);
 	}
 	for(const auto &[fst, snd]: asConst(
@@ -1298,7 +1338,7 @@ void KeePass2XmlReader::parseEntryString(
 	{
 		if(this->xml.name().toString() == "Key")
 		{
-			key_ = this->readString();
+			key_ = this->readPooledString();
 			keySet_ = true;
 		}
 		else if(this->xml.name().toString() == "Value")
@@ -1345,6 +1385,12 @@ void KeePass2XmlReader::parseEntryString(
 				}
 			}
 			protect_ = isProtected_ || protectInMemory_;
+			if(!protect_)
+			{
+				value_ = this->db->getStringPool()->intern(
+					value_
+				);
+			}
 			valueSet_ = true;
 		}
 		else
@@ -1595,6 +1641,13 @@ QString KeePass2XmlReader::readString()
 	return result_;*/
 }
 
+QString KeePass2XmlReader::readPooledString()
+{
+	return this->db->getStringPool()->intern(
+		this->readString()
+	);
+}
+
 bool KeePass2XmlReader::readBool()
 {
 	if(const QString str_ = this->readString();
@@ -1621,10 +1674,43 @@ bool KeePass2XmlReader::readBool()
 QDateTime KeePass2XmlReader::readDateTime()
 {
 	const QString str_ = this->readString();
-	QDateTime dt_ = QDateTime::fromString(
-		str_,
-		Qt::ISODate
-	);
+	QDateTime dt_;
+	// KDBX 4 stores the seconds since 0001-01-01 as base64 encoded int64
+	if(str_.size() == 12)
+	{
+		if(const QByteArray::FromBase64Result secs_ =
+				QByteArray::fromBase64Encoding(
+					str_.toLatin1(),
+					QByteArray::AbortOnBase64DecodingErrors
+				);
+			secs_ && secs_.decoded.size() == 8)
+		{
+			dt_ = QDateTime(
+				QDate(
+					1,
+					1,
+					1
+				),
+				QTime(
+					0,
+					0
+				),
+				Qt::UTC
+			).addSecs(
+				Endian::bytesToInt64(
+					secs_.decoded,
+					QSysInfo::LittleEndian
+				)
+			);
+		}
+	}
+	else
+	{
+		dt_ = QDateTime::fromString(
+			str_,
+			Qt::ISODate
+		);
+	}
 	if(!dt_.isValid())
 	{
 		if(this->strictMode)
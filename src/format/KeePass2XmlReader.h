@@ -55,6 +55,13 @@ public:
 	void setStrictMode(
 		bool strictMode
 	);
+	/**
+	* Sets the attachments read from a KDBX 4 inner header, binary ids are
+	* the indexes in the list.
+	*/
+	void setBinaryPool(
+		const QList<QByteArray> &binaries
+	);
 private:
 	bool parseKeePassFile();
 	void parseMeta();
@@ -80,6 +87,11 @@ private:
 	QList<Entry*> parseEntryHistory();
 	TimeInfo parseTimes();
 	QString readString();
+	/**
+	* Same as readString() but shares equal values through the string pool
+	* of the database, must not be used for protected values.
+	*/
+	QString readPooledString();
 	bool readBool();
 	QDateTime readDateTime();
 	QColor readColor();
@@ -106,6 +118,9 @@ private:
 	QHash<UUID, Entry*> entries;
 	QHash<QString, QByteArray> binaryPool;
 	QMultiHash<QString, QPair<Entry*, QString>> binaryMap;
+	// history items are stored by their entries once their attachments
+	// have been resolved
+	QList<QPair<Entry*, QList<Entry*>>> histories;
 	QByteArray headerHash;
 	bool error;
 	QString errorStr;
@@ -17,7 +17,10 @@
 #include "KeePass2XmlWriter.h"
 #include <QBuffer>
 #include <QFile>
+#include "core/Endian.h"
+#include "core/ListDeleter.h"
 #include "core/Metadata.h"
+#include "format/KeePass2.h"
 #include "format/KeePass2RandomStream.h"
 #include "streams/QtIOCompressor"
 
@@ -31,6 +34,12 @@ KeePass2XmlWriter::KeePass2XmlWriter()
 	randomStream(
 		nullptr
 	),
+	binaryPoolReady(
+		false
+	),
+	formatVersion(
+		KeePass2::FILE_VERSION_3_1
+	),
 	error(
 		false
 	)
@@ -60,11 +69,16 @@ void KeePass2XmlWriter::writeDatabase(
 		qWarning() << "No device";
 		return;
 	}
+	const bool binaryPoolReady_ = this->binaryPoolReady && this->db == db;
+	this->binaryPoolReady = false;
 	this->db = db;
 	this->meta = db->getMetadata();
 	this->randomStream = randomStream;
 	this->headerHash = headerHash;
-	this->generateIdMap();
+	if(!binaryPoolReady_)
+	{
+		this->generateIdMap();
+	}
 	this->xml.setDevice(
 		device
 	);
@@ -116,35 +130,93 @@ QString KeePass2XmlWriter::getErrorString()
 	return this->errorStr;
 }
 
+void KeePass2XmlWriter::setFormatVersion(
+	const quint32 version
+)
+{
+	this->formatVersion = version;
+}
+
+const QList<QByteArray> &KeePass2XmlWriter::prepareBinaryPool(
+	Database* db
+)
+{
+	this->db = db;
+	this->generateIdMap();
+	this->binaryPoolReady = true;
+	return this->binaries;
+}
+
 void KeePass2XmlWriter::generateIdMap()
 {
-	const QList<Entry*> allEntries_ = this->db->getRootGroup()->
-		getEntriesRecursive(
+	this->idMap.clear();
+	this->binaries.clear();
+	// the attachments of delta encoded histories are read from the deltas,
+	// the items are only built once, by writeEntryHistory()
+	for(const Group* group_: this->db->getRootGroup()->groupsRecursive(
 			true
-		);
-	auto nextId_ = 0;
-	for(Entry* entry_: allEntries_)
+		))
 	{
-		const QList<QString> attachmentKeys_ = entry_->getAttachments()->
-			getKeys();
-		for(const QString &key_: attachmentKeys_)
+		const QList<Entry*> &entries_ = group_->getEntries();
+		for(const Entry* entry_: entries_)
 		{
-			if(QByteArray data_ = entry_->getAttachments()->getValue(
-					key_
-				);
-				!this->idMap.contains(
-					data_
-				))
+			this->addBinaries(
+				entry_->getAttachments()
+			);
+		}
+		for(const Entry* entry_: entries_)
+		{
+			const QList<QPair<QByteArray, QByteArray>> historyAttachments_ =
+				entry_->getHistoryAttachments();
+			for(const QPair<QByteArray, QByteArray> &attachment_:
+				historyAttachments_)
 			{
-				this->idMap.insert(
-					data_,
-					nextId_++
+				this->addBinary(
+					attachment_.first,
+					attachment_.second
 				);
 			}
 		}
 	}
 }
 
+void KeePass2XmlWriter::addBinaries(
+	const EntryAttachments* attachments
+)
+{
+	const QList<QString> attachmentKeys_ = attachments->getKeys();
+	for(const QString &key_: attachmentKeys_)
+	{
+		this->addBinary(
+			attachments->getDigest(
+				key_
+			),
+			attachments->getValue(
+				key_
+			)
+		);
+	}
+}
+
+void KeePass2XmlWriter::addBinary(
+	const QByteArray &digest,
+	const QByteArray &value
+)
+{
+	if(!this->idMap.contains(
+		digest
+	))
+	{
+		this->idMap.insert(
+			digest,
+			static_cast<int>(this->binaries.size())
+		);
+		this->binaries.append(
+			value
+		);
+	}
+}
+
 void KeePass2XmlWriter::writeMetadata()
 {
 	this->xml.writeStartElement(
@@ -243,7 +315,10 @@ void KeePass2XmlWriter::writeMetadata()
 		"HistoryMaxSize",
 		this->meta->getHistoryMaxSize()
 	);
-	this->writeBinaries();
+	if(this->formatVersion < KeePass2::FILE_VERSION_4)
+	{
+		this->writeBinaries();
+	}
 	this->writeCustomData();
 	this->xml.writeEndElement();
 }
@@ -332,16 +407,18 @@ void KeePass2XmlWriter::writeBinaries()
 	this->xml.writeStartElement(
 		"Binaries"
 	);
-	for(QHash<QByteArray, int>::const_iterator i_ = this->idMap.constBegin(); i_
-		!= this->idMap.constEnd(); ++i_)
+	for(auto i_ = 0; i_ < this->binaries.size(); ++i_)
 	{
+		const QByteArray &binary_ = this->binaries.at(
+			i_
+		);
 		this->xml.writeStartElement(
 			"Binary"
 		);
 		this->xml.writeAttribute(
 			"ID",
 			QString::number(
-				i_.value()
+				i_
 			)
 		);
 		QByteArray data_;
@@ -365,9 +442,9 @@ void KeePass2XmlWriter::writeBinaries()
 				QIODevice::WriteOnly
 			);
 			if(const qint64 bytesWritten_ = compressor_.write(
-					i_.key()
+					binary_
 				);
-				bytesWritten_ != i_.key().size())
+				bytesWritten_ != binary_.size())
 			{
 				this->error = true;
 				this->errorStr = "Compression error";
@@ -381,7 +458,7 @@ void KeePass2XmlWriter::writeBinaries()
 		}
 		else
 		{
-			data_ = i_.key();
+			data_ = binary_;
 		}
 		if(!data_.isEmpty())
 		{
@@ -726,16 +803,18 @@ void KeePass2XmlWriter::writeEntry(
 		this->xml.writeAttribute(
 			"Ref",
 			QString::number(
-				this->idMap[entry->getAttachments()->getValue(
-					key_
-				)]
+				this->idMap.value(
+					entry->getAttachments()->getDigest(
+						key_
+					)
+				)
 			)
 		);
 		this->xml.writeEndElement();
 		this->xml.writeEndElement();
 	}
 	// write history only for entries that are not history items
-	if(entry->parent())
+	if(entry->getGroup())
 	{
 		this->writeEntryHistory(
 			entry
@@ -751,7 +830,10 @@ void KeePass2XmlWriter::writeEntryHistory(
 	this->xml.writeStartElement(
 		"History"
 	);
-	const QList<Entry*> &historyItems_ = entry->getHistoryItems();
+	QList<Entry*> historyItems_ = entry->buildHistoryItems();
+	const ListDeleter<Entry*> deleter_(
+		&historyItems_
+	);
 	for(const Entry* item_: historyItems_)
 	{
 		this->writeEntry(
@@ -832,6 +914,34 @@ void KeePass2XmlWriter::writeDateTime(
 		qWarning() << "Wrong spec for date time";
 		return;
 	}
+	if(this->formatVersion >= KeePass2::FILE_VERSION_4)
+	{
+		// seconds since 0001-01-01
+		const QDateTime epoch_(
+			QDate(
+				1,
+				1,
+				1
+			),
+			QTime(
+				0,
+				0
+			),
+			Qt::UTC
+		);
+		this->writeString(
+			qualifiedName,
+			QString::fromLatin1(
+				Endian::int64ToBytes(
+					epoch_.secsTo(
+						dateTime
+					),
+					KeePass2::BYTEORDER
+				).toBase64()
+			)
+		);
+		return;
+	}
 	QString dateTimeStr_ = dateTime.toString(
 		Qt::ISODate
 	);
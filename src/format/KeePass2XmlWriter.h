@@ -42,8 +42,29 @@ public:
 	);
 	bool hasError() const;
 	QString getErrorString();
+	/**
+	* KDBX 4 keeps attachments in the inner header instead of Meta/Binaries
+	* and stores times as base64 encoded seconds.
+	*/
+	void setFormatVersion(
+		quint32 version
+	);
+	/**
+	* Builds the attachment pool of the database in binary id order, the
+	* next writeDatabase() call for this database reuses it.
+	*/
+	const QList<QByteArray> &prepareBinaryPool(
+		Database* db
+	);
 private:
 	void generateIdMap();
+	void addBinaries(
+		const EntryAttachments* attachments
+	);
+	void addBinary(
+		const QByteArray &digest,
+		const QByteArray &value
+	);
 	void writeMetadata();
 	void writeMemoryProtection();
 	void writeCustomIcons();
@@ -128,7 +149,11 @@ private:
 	Metadata* meta;
 	KeePass2RandomStream* randomStream;
 	QByteArray headerHash;
+	// attachment digest -> binary pool id
 	QHash<QByteArray, int> idMap;
+	QList<QByteArray> binaries;
+	bool binaryPoolReady;
+	quint32 formatVersion;
 	bool error;
 	QString errorStr;
 };
@@ -234,12 +234,10 @@ void DatabaseSettingsWidget::do_transformRoundsBenchmark() const
 
 void DatabaseSettingsWidget::truncateHistories() const
 {
-	const QList<Entry*> allEntries_ = this->db->getRootGroup()->
-		getEntriesRecursive(
-			false
-		);
-	for(Entry* entry_: allEntries_)
+	this->db->beginTransaction();
+	for(Entry* entry_: this->db->getRootGroup()->entriesRecursive())
 	{
 		entry_->truncateHistory();
 	}
+	this->db->commitTransaction();
 }
@@ -15,14 +15,17 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "DatabaseTabWidget.h"
+#include <QFileInfo>
 #include <QLockFile>
-#include <QSaveFile>
 #include <QTabWidget>
 #include "core/Config.h"
 #include "core/Database.h"
+#include "core/DurableSaveFile.h"
+#include "core/Entry.h"
 #include "core/Group.h"
 #include "core/Metadata.h"
 #include "format/CsvExporter.h"
+#include "format/KeePass2Journal.h"
 #include "gui/Clipboard.h"
 #include "gui/DatabaseWidget.h"
 #include "gui/DatabaseWidgetStateSync.h"
@@ -38,6 +41,9 @@ DatabaseManagerStruct::DatabaseManagerStruct()
 	lockFile(
 		nullptr
 	),
+	journal(
+		nullptr
+	),
 	saveToFilename(
 		false
 	),
@@ -402,6 +408,14 @@ bool DatabaseTabWidget::closeDatabase(
 			return false;
 		}
 	}
+	// journaled changes are folded into the database file on close
+	if(dbStruct_.journal && dbStruct_.journal->getRecordCount() > 0 && !this->
+		saveDatabase(
+			db
+		))
+	{
+		return false;
+	}
 	if(dbStruct_.modified)
 	{
 		if(Config::getInstance()->get(
@@ -471,6 +485,10 @@ void DatabaseTabWidget::deleteDatabase(
 	this->dbList.remove(
 		db
 	);
+	if(dbStruct_.journal)
+	{
+		dbStruct_.journal->remove();
+	}
 	delete dbStruct_.lockFile;
 	delete dbStruct_.dbWidget;
 	delete db;
@@ -501,9 +519,15 @@ bool DatabaseTabWidget::saveDatabase(
 	if(DatabaseManagerStruct &dbStruct_ = this->dbList[db];
 		dbStruct_.saveToFilename)
 	{
-		QSaveFile saveFile_(
+		DurableSaveFile saveFile_(
 			dbStruct_.canonicalFilePath
 		);
+		// the previous size is a close estimate for the preallocation
+		saveFile_.setSizeHint(
+			QFileInfo(
+				dbStruct_.canonicalFilePath
+			).size()
+		);
 		if(saveFile_.open(
 			QIODevice::WriteOnly
 		))
@@ -553,6 +577,9 @@ bool DatabaseTabWidget::saveDatabase(
 			return false;
 		}
 		dbStruct_.modified = false;
+		this->resetJournal(
+			db
+		);
 		this->do_updateTabName(
 			db
 		);
@@ -653,9 +680,14 @@ bool DatabaseTabWidget::saveDatabaseAs(
 				}
 			}
 		}
-		QSaveFile saveFile_(
+		DurableSaveFile saveFile_(
 			fileName_
 		);
+		saveFile_.setSizeHint(
+			QFileInfo(
+				dbStruct_.canonicalFilePath
+			).size()
+		);
 		if(!saveFile_.open(
 			QIODevice::WriteOnly
 		))
@@ -714,6 +746,9 @@ bool DatabaseTabWidget::saveDatabaseAs(
 		);
 		delete dbStruct_.lockFile;
 		dbStruct_.lockFile = lockFile_.release();
+		this->resetJournal(
+			db
+		);
 		this->do_updateTabName(
 			db
 		);
@@ -725,6 +760,99 @@ bool DatabaseTabWidget::saveDatabaseAs(
 	return false;
 }
 
+void DatabaseTabWidget::resetJournal(
+	Database* db
+)
+{
+	DatabaseManagerStruct &dbStruct_ = this->dbList[db];
+	if(!Config::getInstance()->get(
+		"AutoSaveAfterEveryChange"
+	).toBool() || !Config::getInstance()->get(
+		"AutoSaveJournal"
+	).toBool())
+	{
+		if(dbStruct_.journal)
+		{
+			dbStruct_.journal->remove();
+			delete dbStruct_.journal;
+			dbStruct_.journal = nullptr;
+		}
+		// the journal of a previous session no longer matches the file
+		QFile::remove(
+			KeePass2Journal::getJournalPath(
+				dbStruct_.canonicalFilePath
+			)
+		);
+		return;
+	}
+	if(!dbStruct_.journal)
+	{
+		dbStruct_.journal = new KeePass2Journal(
+			db,
+			db
+		);
+	}
+	if(!dbStruct_.journal->open(
+		dbStruct_.canonicalFilePath,
+		this->writer.getHeaderHash()
+	))
+	{
+		qWarning(
+			"Unable to start the journal: %s",
+			qPrintable(
+				dbStruct_.journal->getErrorString()
+			)
+		);
+	}
+}
+
+void DatabaseTabWidget::replayJournal(
+	Database* db
+)
+{
+	// databases that weren't read from the file, e.g. locked ones, have no
+	// journal
+	if(db->getHeaderHash().isEmpty() || !Config::getInstance()->get(
+		"AutoSaveJournal"
+	).toBool())
+	{
+		return;
+	}
+	DatabaseManagerStruct &dbStruct_ = this->dbList[db];
+	KeePass2Journal journal_(
+		db
+	);
+	if(!journal_.replay(
+		dbStruct_.canonicalFilePath,
+		db->getHeaderHash()
+	))
+	{
+		qWarning(
+			"Unable to replay the journal: %s",
+			qPrintable(
+				journal_.getErrorString()
+			)
+		);
+		return;
+	}
+	if(journal_.getRecordCount() == 0)
+	{
+		return;
+	}
+	// the replayed changes are only in the journal until the file is
+	// rewritten, other clients don't see them before
+	if(dbStruct_.saveToFilename && this->saveDatabase(
+		db
+	))
+	{
+		return;
+	}
+	dbStruct_.modified = true;
+	this->do_updateTabName(
+		db
+	);
+}
+
 bool DatabaseTabWidget::do_closeDatabase(
 	int index
 )
@@ -1126,6 +1254,79 @@ bool DatabaseTabWidget::hasLockableDatabases() const
 	return false;
 }
 
+QList<Database*> DatabaseTabWidget::getUnlockedDatabases() const
+{
+	QList<Database*> databases_;
+	for(auto i_ = 0; i_ < count(); i_++)
+	{
+		Database* db_ = this->indexDatabase(
+			i_
+		);
+		if(!db_)
+		{
+			continue;
+		}
+		const DatabaseWidget* dbWidget_ = this->dbList.value(
+			db_
+		).dbWidget;
+		if(const DatabaseWidget::Mode mode_ = dbWidget_->getCurrentMode();
+			(mode_ == DatabaseWidget::ViewMode || mode_ ==
+				DatabaseWidget::EditMode) && dbWidget_->dbHasKey())
+		{
+			databases_.append(
+				db_
+			);
+		}
+	}
+	return databases_;
+}
+
+QString DatabaseTabWidget::getDatabaseName(
+	Database* db
+) const
+{
+	if(!db->getMetadata()->getName().isEmpty())
+	{
+		return db->getMetadata()->getName();
+	}
+	const DatabaseManagerStruct &dbStruct_ = this->dbList.value(
+		db
+	);
+	if(dbStruct_.fileName.isEmpty())
+	{
+		return this->tr(
+			"New database"
+		);
+	}
+	return dbStruct_.fileName;
+}
+
+void DatabaseTabWidget::showEntry(
+	Entry* entry
+)
+{
+	if(!entry->getGroup())
+	{
+		return;
+	}
+	Database* db_ = entry->getGroup()->getDatabase();
+	const int index_ = this->databaseIndex(
+		db_
+	);
+	if(index_ == -1)
+	{
+		return;
+	}
+	this->setCurrentIndex(
+		index_
+	);
+	this->dbList.value(
+		db_
+	).dbWidget->showEntry(
+		entry
+	);
+}
+
 void DatabaseTabWidget::do_lockDatabases()
 {
 	Clipboard::getInstance()->do_clearCopiedText();
@@ -1249,6 +1450,12 @@ void DatabaseTabWidget::do_modified()
 		"AutoSaveAfterEveryChange"
 	).toBool() && dbStruct_.saveToFilename)
 	{
+		// append small changes to the journal instead of rewriting the file
+		if(dbStruct_.journal && dbStruct_.journal->isOpen() && !dbStruct_.
+			journal->needsFullSave() && dbStruct_.journal->flush())
+		{
+			return;
+		}
 		this->saveDatabase(
 			db_
 		);
@@ -1315,7 +1522,9 @@ void DatabaseTabWidget::do_changeDatabase(
 	Database* oldDb_ = this->databaseFromDatabaseWidget(
 		dbWidget_
 	);
-	const DatabaseManagerStruct dbStruct_ = this->dbList[oldDb_];
+	DatabaseManagerStruct dbStruct_ = this->dbList[oldDb_];
+	// the journal belongs to the old database and is deleted along with it
+	dbStruct_.journal = nullptr;
 	this->dbList.remove(
 		oldDb_
 	);
@@ -1326,6 +1535,9 @@ void DatabaseTabWidget::do_changeDatabase(
 	this->do_updateTabName(
 		newDb
 	);
+	this->replayJournal(
+		newDb
+	);
 	this->connectDatabase(
 		newDb,
 		oldDb_
@@ -23,6 +23,7 @@
 class DatabaseWidget;
 class DatabaseWidgetStateSync;
 class DatabaseOpenWidget;
+class KeePass2Journal;
 class QFile;
 class QLockFile;
 
@@ -31,6 +32,7 @@ struct DatabaseManagerStruct
 	DatabaseManagerStruct();
 	DatabaseWidget* dbWidget;
 	QLockFile* lockFile;
+	KeePass2Journal* journal;
 	QString filePath;
 	QString canonicalFilePath;
 	QString fileName;
@@ -58,6 +60,23 @@ class DatabaseTabWidget:public QTabWidget
 	);
 	DatabaseWidget* getCurrentDatabaseWidget();
 	bool hasLockableDatabases() const;
+	/**
+	* Returns the unlocked databases in the order of their tabs.
+	*/
+	QList<Database*> getUnlockedDatabases() const;
+	/**
+	* Returns the name of db without the modified and locked marks of its
+	* tab.
+	*/
+	QString getDatabaseName(
+		Database* db
+	) const;
+	/**
+	* Switches to the tab of the database of entry and selects it there.
+	*/
+	void showEntry(
+		Entry* entry
+	);
 	static const int LastDatabasesCount;
 public Q_SLOTS:
 	void do_newDatabase();
@@ -108,6 +127,20 @@ private:
 	bool saveDatabaseAs(
 		Database* db
 	);
+	/**
+	* Starts a new journal after the database file has been written or
+	* removes the stale one if journaling is disabled.
+	*/
+	void resetJournal(
+		Database* db
+	);
+	/**
+	* Applies the journal left next to the file of a freshly read database
+	* and folds the replayed changes into the file.
+	*/
+	void replayJournal(
+		Database* db
+	);
 	bool closeDatabase(
 		Database* db
 	);
@@ -24,7 +24,7 @@
 #include <QTimer>
 #include "ui_SearchWidget.h"
 #include "core/Config.h"
-#include "core/EntrySearcher.h"
+#include "core/EntrySearchTask.h"
 #include "core/FilePath.h"
 #include "core/Global.h"
 #include "core/Group.h"
@@ -37,9 +37,14 @@
 #include "gui/MessageBox.h"
 #include "gui/UnlockDatabaseWidget.h"
 #include "gui/entry/EditEntryWidget.h"
+#include "gui/entry/EntryModel.h"
 #include "gui/entry/EntryView.h"
 #include "gui/group/EditGroupWidget.h"
 #include "gui/group/GroupView.h"
+// search terms up to this length are ranked and show RankedResultCount
+// entries at first
+static const int RankedTermLength = 2;
+static const int RankedResultCount = 200;
 
 DatabaseWidget::DatabaseWidget(
 	Database* db,
@@ -76,6 +81,14 @@ DatabaseWidget::DatabaseWidget(
 	this->searchTimer->setSingleShot(
 		true
 	);
+	this->searchTask = new EntrySearchTask(
+		this
+	);
+	this->searchTask->setParallelThreshold(
+		Config::getInstance()->get(
+			"search/parallelscanthreshold"
+		).toInt()
+	);
 	this->mainWidget = new QWidget(
 		this
 	);
@@ -395,6 +408,24 @@ DatabaseWidget::DatabaseWidget(
 		this,
 		&DatabaseWidget::do_search
 	);
+	this->connect(
+		this->searchTask,
+		&EntrySearchTask::sig_entriesFound,
+		this,
+		&DatabaseWidget::do_showSearchResults
+	);
+	this->connect(
+		this->searchTask,
+		&EntrySearchTask::sig_finished,
+		this,
+		&DatabaseWidget::do_searchFinished
+	);
+	this->connect(
+		this->entryView->getModel(),
+		&EntryModel::sig_fetchMoreRequested,
+		this,
+		&DatabaseWidget::do_fetchMoreSearchResults
+	);
 	this->connect(
 		closeAction_,
 		&QAction::triggered,
@@ -565,6 +596,7 @@ void DatabaseWidget::replaceDatabase(
 )
 {
 	const Database* oldDb_ = this->db;
+	this->searchTask->cancel();
 	this->db = db;
 	groupView->changeDatabase(
 		this->db
@@ -651,12 +683,14 @@ void DatabaseWidget::do_deleteEntries()
 		}
 		if(result_ == QMessageBox::Yes)
 		{
+			this->db->beginTransaction();
 			for(const Entry* entry_: asConst(
 					selectedEntries_
 				))
 			{
 				delete entry_;
 			}
+			this->db->commitTransaction();
 		}
 	}
 	else
@@ -696,6 +730,7 @@ void DatabaseWidget::do_deleteEntries()
 		{
 			return;
 		}
+		this->db->beginTransaction();
 		for(Entry* entry_: asConst(
 				selectedEntries_
 			))
@@ -704,6 +739,7 @@ void DatabaseWidget::do_deleteEntries()
 				entry_
 			);
 		}
+		this->db->commitTransaction();
 	}
 }
 
@@ -896,14 +932,18 @@ void DatabaseWidget::do_deleteGroup()
 			);
 			result_ == QMessageBox::Yes)
 		{
+			this->db->beginTransaction();
 			delete currentGroup_;
+			this->db->commitTransaction();
 		}
 	}
 	else
 	{
+		this->db->beginTransaction();
 		this->db->recycleGroup(
 			currentGroup_
 		);
+		this->db->commitTransaction();
 	}
 }
 
@@ -1154,10 +1194,9 @@ void DatabaseWidget::do_unlockDatabase(
 	replaceDatabase(
 		static_cast<DatabaseOpenWidget*>(this->sender())->database()
 	);
-	const QList<Group*> groups_ = this->db->getRootGroup()->getGroupsRecursive(
-		true
-	);
-	for(Group* group_: groups_)
+	for(Group* group_: this->db->getRootGroup()->groupsRecursive(
+			true
+		))
 	{
 		if(group_->getUUID() == this->groupBeforeLock)
 		{
@@ -1296,6 +1335,7 @@ void DatabaseWidget::do_closeSearch()
 		this->lastGroup
 	);
 	this->searchTimer->stop();
+	this->searchTask->cancel();
 	this->sig_listModeActivated();
 }
 
@@ -1381,16 +1421,60 @@ void DatabaseWidget::do_search() const
 	{
 		sensitivity_ = Qt::CaseInsensitive;
 	}
-	const QList<Entry*> searchResult_ = EntrySearcher().search(
-		this->searchUi->searchEdit->text(),
+	// the view switches to the results right away, the old results stay
+	// until the first batch of the new search arrives
+	if(!this->isInSearchMode())
+	{
+		this->entryView->setEntryList(
+			QList<Entry*>()
+		);
+	}
+	// short terms match most of a large database, only the best matches
+	// are shown until the view asks for more
+	const QString searchTerm_ = this->searchUi->searchEdit->text();
+	this->searchTask->start(
+		searchTerm_,
 		searchGroup_,
-		sensitivity_
-	);
-	this->entryView->setEntryList(
-		searchResult_
+		sensitivity_,
+		searchTerm_.trimmed().size() <= RankedTermLength ? RankedResultCount
+			: 0
 	);
 }
 
+void DatabaseWidget::do_showSearchResults(
+	const QList<Entry*> &entries,
+	const bool replace
+) const
+{
+	if(replace)
+	{
+		this->entryView->setEntryList(
+			entries
+		);
+	}
+	else
+	{
+		this->entryView->appendEntryList(
+			entries
+		);
+	}
+}
+
+void DatabaseWidget::do_searchFinished() const
+{
+	if(this->isInSearchMode())
+	{
+		this->entryView->getModel()->setMoreAvailable(
+			this->searchTask->hasMore()
+		);
+	}
+}
+
+void DatabaseWidget::do_fetchMoreSearchResults() const
+{
+	this->searchTask->fetchMore();
+}
+
 void DatabaseWidget::do_startSearchTimer() const
 {
 	if(!this->searchTimer->isActive())
@@ -1491,6 +1575,29 @@ void DatabaseWidget::lock()
 	);
 }
 
+void DatabaseWidget::showEntry(
+	Entry* entry
+)
+{
+	Group* group_ = entry->getGroup();
+	if(this->getCurrentMode() != this->ViewMode || !group_ || group_->
+		getDatabase() != this->db)
+	{
+		return;
+	}
+	if(this->isInSearchMode())
+	{
+		this->do_closeSearch();
+	}
+	this->groupView->setCurrentGroup(
+		group_
+	);
+	this->entryView->setCurrentEntry(
+		entry
+	);
+	this->entryView->setFocus();
+}
+
 void DatabaseWidget::updateFilename(
 	const QString &filename
 )
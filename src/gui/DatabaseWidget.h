@@ -27,6 +27,7 @@ class DatabaseSettingsWidget;
 class EditEntryWidget;
 class EditGroupWidget;
 class Entry;
+class EntrySearchTask;
 class EntryView;
 class Group;
 class GroupView;
@@ -71,6 +72,13 @@ class DatabaseWidget final:public QStackedWidget
 	);
 	Mode getCurrentMode() const;
 	void lock();
+	/**
+	* Leaves the search and selects entry in its group, unless an editor
+	* or the unlock dialog is shown.
+	*/
+	void showEntry(
+		Entry* entry
+	);
 	void updateFilename(
 		const QString &filename
 	);
@@ -195,6 +203,12 @@ private Q_SLOTS:
 		const Group* group
 	);
 	void do_search() const;
+	void do_showSearchResults(
+		const QList<Entry*> &entries,
+		bool replace
+	) const;
+	void do_searchFinished() const;
+	void do_fetchMoreSearchResults() const;
 	void do_startSearch() const;
 	void do_startSearchTimer() const;
 	void do_showSearch();
@@ -226,6 +240,7 @@ private:
 	Group* newParent;
 	Group* lastGroup;
 	QTimer* searchTimer;
+	EntrySearchTask* searchTask;
 	QString filename;
 	UUID groupBeforeLock;
 };
@@ -25,6 +25,76 @@
 #include "gui/IconModels.h"
 #include "gui/MessageBox.h"
 
+/**
+* Counts the groups and entries other than the edited item that use a
+* custom icon and collects the history items using it.
+*/
+class CustomIconUsageVisitor final:public GroupVisitor
+{
+public:
+	CustomIconUsageVisitor(
+		const UUID &iconUuid,
+		const UUID &currentUuid
+	);
+	virtual bool visitGroup(
+		Group* group
+	) override;
+	virtual bool visitEntry(
+		Entry* entry
+	) override;
+	const UUID iconUuid;
+	const UUID currentUuid;
+	int usedCount;
+	// entries with history items that use the icon
+	QList<Entry*> historyOwners;
+};
+
+CustomIconUsageVisitor::CustomIconUsageVisitor(
+	const UUID &iconUuid,
+	const UUID &currentUuid
+)
+	: iconUuid(
+		iconUuid
+	),
+	currentUuid(
+		currentUuid
+	),
+	usedCount(
+		0
+	)
+{
+}
+
+bool CustomIconUsageVisitor::visitGroup(
+	Group* group
+)
+{
+	if(this->iconUuid == group->getIconUUID() && this->currentUuid != group->
+		getUUID())
+	{
+		this->usedCount++;
+	}
+	return true;
+}
+
+bool CustomIconUsageVisitor::visitEntry(
+	Entry* entry
+)
+{
+	if(this->iconUuid == entry->getIconUUID() && this->currentUuid != entry->
+		getUUID())
+	{
+		this->usedCount++;
+	}
+	if(entry->getHistoryCustomIcons().contains(
+		this->iconUuid
+	))
+	{
+		this->historyOwners << entry;
+	}
+	return true;
+}
+
 IconStruct::IconStruct()
 	: uuid(
 		UUID()
@@ -280,53 +350,21 @@ void EditWidgetIcons::do_removeCustomIcon()
 			const UUID iconUuid_ = this->customIconModel->uuidFromIndex(
 				index_
 			);
-			auto iconUsedCount_ = 0;
-			const QList<Entry*> allEntries_ = this->database->getRootGroup()->
-				getEntriesRecursive(
-					true
-				);
-			QList<Entry*> historyEntriesWithSameIcon_;
-			for(Entry* entry_: allEntries_)
-			{
-				const bool isHistoryEntry_ = !entry_->getGroup();
-				if(iconUuid_ == entry_->getIconUUID())
-				{
-					if(isHistoryEntry_)
-					{
-						historyEntriesWithSameIcon_ << entry_;
-					}
-					else if(this->currentUUID != entry_->getUUID())
-					{
-						iconUsedCount_++;
-					}
-				}
-			}
-			const QList<Group*> allGroups_ = this->database->getRootGroup()->
-				getGroupsRecursive(
-					true
-				);
-			for(const Group* group_: allGroups_)
-			{
-				if(iconUuid_ == group_->getIconUUID() && this->currentUUID !=
-					group_->getUUID())
-				{
-					iconUsedCount_++;
-				}
-			}
-			if(iconUsedCount_ == 0)
+			CustomIconUsageVisitor usage_(
+				iconUuid_,
+				this->currentUUID
+			);
+			this->database->getRootGroup()->accept(
+				&usage_
+			);
+			if(usage_.usedCount == 0)
 			{
 				for(Entry* entry_: asConst(
-						historyEntriesWithSameIcon_
+						usage_.historyOwners
 					))
 				{
-					entry_->setUpdateTimeinfo(
-						false
-					);
-					entry_->setIcon(
-						0
-					);
-					entry_->setUpdateTimeinfo(
-						true
+					entry_->resetHistoryCustomIcon(
+						iconUuid_
 					);
 				}
 				this->database->getMetadata()->removeCustomIcon(
@@ -360,7 +398,7 @@ void EditWidgetIcons::do_removeCustomIcon()
 					this->tr(
 						"Can't delete icon. Still used by %n item(s).",
 						nullptr,
-						iconUsedCount_
+						usage_.usedCount
 					)
 				);
 			}
@@ -0,0 +1,225 @@
+/*
+ *  Copyright (C) 2026 The cpp-password-manager contributors
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "GlobalSearchDialog.h"
+#include <QTimer>
+#include "ui_GlobalSearchDialog.h"
+#include "core/Config.h"
+#include "core/GlobalSearchTask.h"
+#include "gui/DatabaseTabWidget.h"
+#include "gui/entry/EntryView.h"
+// matches kept over all databases
+static const int ResultCount = 200;
+
+GlobalSearchDialog::GlobalSearchDialog(
+	DatabaseTabWidget* tabWidget,
+	QWidget* parent
+)
+	: QDialog(
+		parent
+	),
+	ui(
+		new Ui::GlobalSearchDialog()
+	),
+	tabWidget(
+		tabWidget
+	),
+	searchTimer(
+		new QTimer(
+			this
+		)
+	),
+	searchTask(
+		new GlobalSearchTask(
+			this
+		)
+	)
+{
+	this->ui->setupUi(
+		this
+	);
+	this->searchTimer->setSingleShot(
+		true
+	);
+	this->searchTask->setParallelThreshold(
+		Config::getInstance()->get(
+			"search/parallelscanthreshold"
+		).toInt()
+	);
+	this->ui->entryView->setEntryList(
+		QList<Entry*>()
+	);
+	this->connect(
+		this->ui->searchEdit,
+		&QLineEdit::textChanged,
+		this,
+		&GlobalSearchDialog::do_startSearchTimer
+	);
+	this->connect(
+		this->ui->searchEdit,
+		&QLineEdit::returnPressed,
+		this->ui->entryView,
+		&EntryView::do_setFocus
+	);
+	this->connect(
+		this->ui->caseSensitiveCheckBox,
+		&QCheckBox::toggled,
+		this,
+		&GlobalSearchDialog::do_search
+	);
+	this->connect(
+		this->searchTimer,
+		&QTimer::timeout,
+		this,
+		&GlobalSearchDialog::do_search
+	);
+	this->connect(
+		this->searchTask,
+		&GlobalSearchTask::sig_entriesFound,
+		this,
+		&GlobalSearchDialog::do_showSearchResults
+	);
+	this->connect(
+		this->searchTask,
+		&GlobalSearchTask::sig_finished,
+		this,
+		&GlobalSearchDialog::do_searchFinished
+	);
+	this->connect(
+		this->ui->entryView,
+		&EntryView::sig_entryActivated,
+		this,
+		&GlobalSearchDialog::do_entryActivated
+	);
+	this->connect(
+		this->ui->buttonBox,
+		&QDialogButtonBox::rejected,
+		this,
+		&GlobalSearchDialog::reject
+	);
+}
+
+GlobalSearchDialog::~GlobalSearchDialog()
+{
+}
+
+void GlobalSearchDialog::openSearch()
+{
+	this->show();
+	this->raise();
+	this->activateWindow();
+	this->ui->searchEdit->selectAll();
+	this->ui->searchEdit->setFocus();
+	this->do_search();
+}
+
+void GlobalSearchDialog::do_search()
+{
+	this->searchTimer->stop();
+	const QString searchTerm_ = this->ui->searchEdit->text();
+	if(searchTerm_.trimmed().isEmpty())
+	{
+		this->searchTask->cancel();
+		this->ui->entryView->setEntryList(
+			QList<Entry*>()
+		);
+		this->ui->statusLabel->clear();
+		return;
+	}
+	const QList<Database*> databases_ = this->tabWidget->
+		getUnlockedDatabases();
+	QHash<const Database*, QString> names_;
+	for(Database* db_: databases_)
+	{
+		names_.insert(
+			db_,
+			this->tabWidget->getDatabaseName(
+				db_
+			)
+		);
+	}
+	this->ui->entryView->getModel()->setDatabaseNames(
+		names_
+	);
+	// the old results stay until the first database reports
+	this->searchTask->start(
+		searchTerm_,
+		databases_,
+		this->ui->caseSensitiveCheckBox->isChecked() ? Qt::CaseSensitive
+			: Qt::CaseInsensitive,
+		ResultCount
+	);
+	this->updateStatus();
+}
+
+void GlobalSearchDialog::do_startSearchTimer() const
+{
+	this->searchTimer->start(
+		100
+	);
+}
+
+void GlobalSearchDialog::do_showSearchResults(
+	const QList<Entry*> &entries
+) const
+{
+	this->ui->entryView->setEntryList(
+		entries
+	);
+	this->updateStatus();
+}
+
+void GlobalSearchDialog::do_searchFinished() const
+{
+	this->updateStatus();
+}
+
+void GlobalSearchDialog::do_entryActivated(
+	Entry* entry,
+	EntryModel::ModelColumn column
+) const
+{
+	Q_UNUSED(column)
+	this->tabWidget->showEntry(
+		entry
+	);
+}
+
+void GlobalSearchDialog::updateStatus() const
+{
+	if(this->searchTask->isRunning())
+	{
+		this->ui->statusLabel->setText(
+			this->tr(
+				"Searched %1 of %2 databases"
+			).arg(
+				this->searchTask->getFinishedCount()
+			).arg(
+				this->searchTask->getDatabaseCount()
+			)
+		);
+	}
+	else
+	{
+		this->ui->statusLabel->setText(
+			this->tr(
+				"Searched %1 databases"
+			).arg(
+				this->searchTask->getDatabaseCount()
+			)
+		);
+	}
+}
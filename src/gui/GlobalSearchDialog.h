@@ -0,0 +1,67 @@
+/*
+ *  Copyright (C) 2026 The cpp-password-manager contributors
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef KEEPASSX_GLOBALSEARCHDIALOG_H
+#define KEEPASSX_GLOBALSEARCHDIALOG_H
+#include <QDialog>
+#include <QScopedPointer>
+#include "gui/entry/EntryModel.h"
+class DatabaseTabWidget;
+class Entry;
+class GlobalSearchTask;
+class QTimer;
+
+namespace Ui
+{
+	class GlobalSearchDialog;
+}
+
+/**
+* Searches all unlocked databases of a DatabaseTabWidget at once and lists
+* the best matches with their database. Activating one shows it in its tab.
+*/
+class GlobalSearchDialog final:public QDialog
+{
+	Q_OBJECT public:
+	explicit GlobalSearchDialog(
+		DatabaseTabWidget* tabWidget,
+		QWidget* parent = nullptr
+	);
+	virtual ~GlobalSearchDialog() override;
+	/**
+	* Shows the dialog and searches again, the open databases may have
+	* changed since the last search.
+	*/
+	void openSearch();
+private Q_SLOTS:
+	void do_search();
+	void do_startSearchTimer() const;
+	void do_showSearchResults(
+		const QList<Entry*> &entries
+	) const;
+	void do_searchFinished() const;
+	void do_entryActivated(
+		Entry* entry,
+		EntryModel::ModelColumn column
+	) const;
+private:
+	void updateStatus() const;
+	const QScopedPointer<Ui::GlobalSearchDialog> ui;
+	DatabaseTabWidget* const tabWidget;
+	QTimer* const searchTimer;
+	GlobalSearchTask* const searchTask;
+};
+#endif // KEEPASSX_GLOBALSEARCHDIALOG_H
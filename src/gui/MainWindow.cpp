@@ -27,6 +27,7 @@
 #include "gui/DatabaseRepairWidget.h"
 #include "gui/DatabaseWidget.h"
 #include "gui/FileDialog.h"
+#include "gui/GlobalSearchDialog.h"
 #include "gui/MessageBox.h"
 const QString MainWindow::BaseWindowTitle = "KeePassX";
 
@@ -36,6 +37,9 @@ MainWindow::MainWindow()
 	),
 	trayIcon(
 		nullptr
+	),
+	globalSearchDialog(
+		nullptr
 	)
 {
 	this->ui->setupUi(
@@ -176,6 +180,12 @@ MainWindow::MainWindow()
 			Qt::Key_F
 		)
 	);
+	this->ui->actionSearchAllDatabases->setShortcut(
+		QKeyCombination(
+			Qt::CTRL | Qt::SHIFT,
+			Qt::Key_F
+		)
+	);
 	this->ui->actionEntryNew->setShortcut(
 		QKeyCombination(
 			Qt::CTRL,
@@ -367,6 +377,12 @@ MainWindow::MainWindow()
 			"system-search"
 		)
 	);
+	this->ui->actionSearchAllDatabases->setIcon(
+		FilePath::getInstance()->getIcon(
+			"actions",
+			"system-search"
+		)
+	);
 	// Connect signals directly to the current database widget
 	this->connect(
 		this->ui->tabWidget,
@@ -578,6 +594,12 @@ MainWindow::MainWindow()
 		this,
 		&MainWindow::do_openSearch
 	);
+	this->connect(
+		this->ui->actionSearchAllDatabases,
+		&QAction::triggered,
+		this,
+		&MainWindow::do_openGlobalSearch
+	);
 	// Initially set menu action state
 	this->do_setMenuActionState();
 }
@@ -976,6 +998,9 @@ void MainWindow::do_setMenuActionState() const
 	this->ui->actionLockDatabases->setEnabled(
 		this->ui->tabWidget->hasLockableDatabases()
 	);
+	this->ui->actionSearchAllDatabases->setEnabled(
+		this->ui->tabWidget->hasLockableDatabases()
+	);
 }
 
 void MainWindow::do_updateWindowTitle()
@@ -1569,3 +1594,15 @@ void MainWindow::do_openSearch() const
 		this->currentDatabaseWidget->do_openSearch();
 	}
 }
+
+void MainWindow::do_openGlobalSearch()
+{
+	if(!this->globalSearchDialog)
+	{
+		this->globalSearchDialog = new GlobalSearchDialog(
+			this->ui->tabWidget,
+			this
+		);
+	}
+	this->globalSearchDialog->openSearch();
+}
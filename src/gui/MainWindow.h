@@ -26,6 +26,7 @@ namespace Ui
 	class MainWindow;
 }
 
+class GlobalSearchDialog;
 class InactivityTimer;
 
 class MainWindow final:public QMainWindow
@@ -103,6 +104,7 @@ private Q_SLOTS:
 	void do_switchToGroupEdit() const;
 	void do_deleteGroup() const;
 	void do_openSearch() const;
+	void do_openGlobalSearch();
 private:
 	static void setShortcut(
 		QAction* action,
@@ -126,6 +128,7 @@ private:
 	int countDefaultAttributes;
 	QSystemTrayIcon* trayIcon;
 	DatabaseWidget* currentDatabaseWidget;
+	GlobalSearchDialog* globalSearchDialog;
 	Q_DISABLE_COPY(
 		MainWindow
 	)
@@ -89,6 +89,12 @@ SettingsWidget::SettingsWidget(
 		this,
 		&SettingsWidget::do_enableAutoSaveOnExit
 	);
+	this->connect(
+		this->generalUi->autoSaveAfterEveryChangeCheckBox,
+		&QCheckBox::toggled,
+		this->generalUi->autoSaveJournalCheckBox,
+		&QCheckBox::setEnabled
+	);
 	this->connect(
 		this->generalUi->systrayShowCheckBox,
 		&QCheckBox::toggled,
@@ -140,6 +146,11 @@ void SettingsWidget::loadSettings()
 			"AutoSaveOnExit"
 		).toBool()
 	);
+	this->generalUi->autoSaveJournalCheckBox->setChecked(
+		Config::getInstance()->get(
+			"AutoSaveJournal"
+		).toBool()
+	);
 	this->generalUi->minimizeOnCopyCheckBox->setChecked(
 		Config::getInstance()->get(
 			"MinimizeOnCopy"
@@ -233,6 +244,10 @@ void SettingsWidget::do_saveSettings()
 		"AutoSaveOnExit",
 		this->generalUi->autoSaveOnExitCheckBox->isChecked()
 	);
+	Config::getInstance()->set(
+		"AutoSaveJournal",
+		this->generalUi->autoSaveJournalCheckBox->isChecked()
+	);
 	Config::getInstance()->set(
 		"MinimizeOnCopy",
 		this->generalUi->minimizeOnCopyCheckBox->isChecked()
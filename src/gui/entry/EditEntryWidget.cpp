@@ -73,9 +73,7 @@ EditEntryWidget::EditEntryWidget(
 		new QWidget()
 	),
 	entryAttachments(
-		new EntryAttachments(
-			this
-		)
+		new EntryAttachments()
 	),
 	attachmentsModel(
 		new EntryAttachmentsModel(
@@ -83,9 +81,7 @@ EditEntryWidget::EditEntryWidget(
 		)
 	),
 	entryAttributes(
-		new EntryAttributes(
-			this
-		)
+		new EntryAttributes()
 	),
 	attributesModel(
 		new EntryAttributesModel(
@@ -124,6 +120,15 @@ EditEntryWidget::EditEntryWidget(
 
 EditEntryWidget::~EditEntryWidget()
 {
+	// the models outlive this destructor, they stop observing first
+	this->attachmentsModel->setEntryAttachments(
+		nullptr
+	);
+	this->attributesModel->setEntryAttributes(
+		nullptr
+	);
+	delete this->entryAttachments;
+	delete this->entryAttributes;
 }
 
 void EditEntryWidget::setupMain()
@@ -680,7 +685,7 @@ void EditEntryWidget::setForms(
 	if(!this->history && !restore)
 	{
 		this->historyModel->setEntries(
-			entry->getHistoryItems()
+			entry->buildHistoryItems()
 		);
 		this->historyUi->historyView->sortByColumn(
 			0,
@@ -746,7 +751,7 @@ void EditEntryWidget::do_saveEntry()
 	// must stand before beginUpdate()
 	// we don't want to create a new history item, if only the history has changed
 	this->entry->removeHistoryItems(
-		this->historyModel->deletedEntries()
+		this->historyModel->deletedIndexes()
 	);
 	if(!this->create)
 	{
@@ -855,7 +860,7 @@ void EditEntryWidget::clear()
 bool EditEntryWidget::hasBeenModified() const
 {
 	// entry has been modified if a history item is to be deleted
-	if(!this->historyModel->deletedEntries().isEmpty())
+	if(!this->historyModel->deletedIndexes().isEmpty())
 	{
 		return true;
 	}
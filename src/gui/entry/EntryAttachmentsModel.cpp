@@ -31,6 +31,16 @@ EntryAttachmentsModel::EntryAttachmentsModel(
 {
 }
 
+EntryAttachmentsModel::~EntryAttachmentsModel()
+{
+	if(this->entryAttachments)
+	{
+		this->entryAttachments->setObserver(
+			nullptr
+		);
+	}
+}
+
 void EntryAttachmentsModel::setEntryAttachments(
 	EntryAttachments* entryAttachments
 )
@@ -38,54 +48,15 @@ void EntryAttachmentsModel::setEntryAttachments(
 	this->beginResetModel();
 	if(this->entryAttachments)
 	{
-		this->entryAttachments->disconnect(
-			this
+		this->entryAttachments->setObserver(
+			nullptr
 		);
 	}
 	this->entryAttachments = entryAttachments;
 	if(this->entryAttachments)
 	{
-		this->connect(
-			this->entryAttachments,
-			&EntryAttachments::sig_keyModified,
-			this,
-			&EntryAttachmentsModel::do_attachmentChange
-		);
-		this->connect(
-			this->entryAttachments,
-			&EntryAttachments::sig_aboutToBeAdded,
-			this,
-			&EntryAttachmentsModel::do_attachmentAboutToAdd
-		);
-		this->connect(
-			this->entryAttachments,
-			&EntryAttachments::sig_added,
-			this,
-			&EntryAttachmentsModel::do_attachmentAdd
-		);
-		this->connect(
-			this->entryAttachments,
-			&EntryAttachments::sig_aboutToBeRemoved,
-			this,
-			&EntryAttachmentsModel::do_attachmentAboutToRemove
-		);
-		this->connect(
-			this->entryAttachments,
-			&EntryAttachments::sig_removed,
-			this,
-			&EntryAttachmentsModel::do_attachmentRemove
-		);
-		this->connect(
-			this->entryAttachments,
-			&EntryAttachments::sig_aboutToBeReset,
-			this,
-			&EntryAttachmentsModel::do_aboutToReset
-		);
-		this->connect(
-			this->entryAttachments,
-			&EntryAttachments::sig_reset,
-			this,
-			&EntryAttachmentsModel::do_reset
+		this->entryAttachments->setObserver(
+			this
 		);
 	}
 	this->endResetModel();
@@ -153,7 +124,7 @@ QString EntryAttachmentsModel::keyByIndex(
 	);
 }
 
-void EntryAttachmentsModel::do_attachmentChange(
+void EntryAttachmentsModel::keyModified(
 	const QString &key
 )
 {
@@ -172,7 +143,7 @@ void EntryAttachmentsModel::do_attachmentChange(
 	);
 }
 
-void EntryAttachmentsModel::do_attachmentAboutToAdd(
+void EntryAttachmentsModel::aboutToBeAdded(
 	const QString &key
 )
 {
@@ -194,12 +165,17 @@ void EntryAttachmentsModel::do_attachmentAboutToAdd(
 	);
 }
 
-void EntryAttachmentsModel::do_attachmentAdd()
+void EntryAttachmentsModel::added(
+	const QString &key
+)
 {
+	Q_UNUSED(
+		key
+	);
 	this->endInsertRows();
 }
 
-void EntryAttachmentsModel::do_attachmentAboutToRemove(
+void EntryAttachmentsModel::aboutToBeRemoved(
 	const QString &key
 )
 {
@@ -213,17 +189,22 @@ void EntryAttachmentsModel::do_attachmentAboutToRemove(
 	);
 }
 
-void EntryAttachmentsModel::do_attachmentRemove()
+void EntryAttachmentsModel::removed(
+	const QString &key
+)
 {
+	Q_UNUSED(
+		key
+	);
 	this->endRemoveRows();
 }
 
-void EntryAttachmentsModel::do_aboutToReset()
+void EntryAttachmentsModel::aboutToBeReset()
 {
 	this->beginResetModel();
 }
 
-void EntryAttachmentsModel::do_reset()
+void EntryAttachmentsModel::reset()
 {
 	this->endResetModel();
 }
@@ -17,14 +17,16 @@
 #ifndef KEEPASSX_ENTRYATTACHMENTSMODEL_H
 #define KEEPASSX_ENTRYATTACHMENTSMODEL_H
 #include <QAbstractListModel>
-class EntryAttachments;
+#include "core/EntryAttachments.h"
 
-class EntryAttachmentsModel final:public QAbstractListModel
+class EntryAttachmentsModel final:public QAbstractListModel,
+	public EntryAttachmentsObserver
 {
 	Q_OBJECT public:
 	explicit EntryAttachmentsModel(
 		QObject* parent = nullptr
 	);
+	virtual ~EntryAttachmentsModel() override;
 	void setEntryAttachments(
 		EntryAttachments* entry
 	);
@@ -41,21 +43,24 @@ class EntryAttachmentsModel final:public QAbstractListModel
 	QString keyByIndex(
 		const QModelIndex &index
 	) const;
-private Q_SLOTS:
-	void do_attachmentChange(
+private:
+	virtual void keyModified(
 		const QString &key
-	);
-	void do_attachmentAboutToAdd(
+	) override;
+	virtual void aboutToBeAdded(
 		const QString &key
-	);
-	void do_attachmentAdd();
-	void do_attachmentAboutToRemove(
+	) override;
+	virtual void added(
 		const QString &key
-	);
-	void do_attachmentRemove();
-	void do_aboutToReset();
-	void do_reset();
-private:
+	) override;
+	virtual void aboutToBeRemoved(
+		const QString &key
+	) override;
+	virtual void removed(
+		const QString &key
+	) override;
+	virtual void aboutToBeReset() override;
+	virtual void reset() override;
 	EntryAttachments* entryAttachments;
 };
 #endif // KEEPASSX_ENTRYATTACHMENTSMODEL_H
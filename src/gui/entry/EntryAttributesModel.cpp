@@ -34,6 +34,16 @@ EntryAttributesModel::EntryAttributesModel(
 {
 }
 
+EntryAttributesModel::~EntryAttributesModel()
+{
+	if(this->entryAttributes)
+	{
+		this->entryAttributes->setObserver(
+			nullptr
+		);
+	}
+}
+
 void EntryAttributesModel::setEntryAttributes(
 	EntryAttributes* entryAttributes
 )
@@ -41,67 +51,16 @@ void EntryAttributesModel::setEntryAttributes(
 	this->beginResetModel();
 	if(this->entryAttributes)
 	{
-		this->entryAttributes->disconnect(
-			this
+		this->entryAttributes->setObserver(
+			nullptr
 		);
 	}
 	this->entryAttributes = entryAttributes;
 	if(this->entryAttributes)
 	{
 		this->updateAttributes();
-		this->connect(
-			this->entryAttributes,
-			&EntryAttributes::sig_customKeyModified,
-			this,
-			&EntryAttributesModel::do_attributeChange
-		);
-		this->connect(
-			this->entryAttributes,
-			&EntryAttributes::sig_aboutToBeAdded,
-			this,
-			&EntryAttributesModel::do_attributeAboutToAdd
-		);
-		this->connect(
-			this->entryAttributes,
-			&EntryAttributes::sig_added,
-			this,
-			&EntryAttributesModel::do_attributeAdd
-		);
-		this->connect(
-			this->entryAttributes,
-			&EntryAttributes::sig_aboutToBeRemoved,
-			this,
-			&EntryAttributesModel::do_attributeAboutToRemove
-		);
-		this->connect(
-			this->entryAttributes,
-			&EntryAttributes::sig_removed,
-			this,
-			&EntryAttributesModel::do_attributeRemove
-		);
-		this->connect(
-			this->entryAttributes,
-			&EntryAttributes::sig_aboutToRename,
-			this,
-			&EntryAttributesModel::do_attributeAboutToRename
-		);
-		this->connect(
-			this->entryAttributes,
-			&EntryAttributes::sig_renamed,
-			this,
-			&EntryAttributesModel::do_attributeRename
-		);
-		this->connect(
-			this->entryAttributes,
-			&EntryAttributes::sig_aboutToBeReset,
-			this,
-			&EntryAttributesModel::do_aboutToReset
-		);
-		this->connect(
-			this->entryAttributes,
-			&EntryAttributes::sig_reset,
-			this,
-			&EntryAttributesModel::do_reset
+		this->entryAttributes->setObserver(
+			this
 		);
 	}
 	this->endResetModel();
@@ -230,7 +189,7 @@ QString EntryAttributesModel::keyByIndex(
 	);
 }
 
-void EntryAttributesModel::do_attributeChange(
+void EntryAttributesModel::customKeyModified(
 	const QString &key
 )
 {
@@ -253,7 +212,7 @@ void EntryAttributesModel::do_attributeChange(
 	);
 }
 
-void EntryAttributesModel::do_attributeAboutToAdd(
+void EntryAttributesModel::aboutToBeAdded(
 	const QString &key
 )
 {
@@ -275,13 +234,18 @@ void EntryAttributesModel::do_attributeAboutToAdd(
 	);
 }
 
-void EntryAttributesModel::do_attributeAdd()
+void EntryAttributesModel::added(
+	const QString &key
+)
 {
+	Q_UNUSED(
+		key
+	);
 	this->updateAttributes();
 	this->endInsertRows();
 }
 
-void EntryAttributesModel::do_attributeAboutToRemove(
+void EntryAttributesModel::aboutToBeRemoved(
 	const QString &key
 )
 {
@@ -295,13 +259,18 @@ void EntryAttributesModel::do_attributeAboutToRemove(
 	);
 }
 
-void EntryAttributesModel::do_attributeRemove()
+void EntryAttributesModel::removed(
+	const QString &key
+)
 {
+	Q_UNUSED(
+		key
+	);
 	this->updateAttributes();
 	this->endRemoveRows();
 }
 
-void EntryAttributesModel::do_attributeAboutToRename(
+void EntryAttributesModel::aboutToRename(
 	const QString &oldKey,
 	const QString &newKey
 )
@@ -346,7 +315,7 @@ void EntryAttributesModel::do_attributeAboutToRename(
 	}
 }
 
-void EntryAttributesModel::do_attributeRename(
+void EntryAttributesModel::renamed(
 	const QString &oldKey,
 	const QString &newKey
 )
@@ -375,12 +344,12 @@ void EntryAttributesModel::do_attributeRename(
 	}
 }
 
-void EntryAttributesModel::do_aboutToReset()
+void EntryAttributesModel::aboutToBeReset()
 {
 	this->beginResetModel();
 }
 
-void EntryAttributesModel::do_reset()
+void EntryAttributesModel::reset()
 {
 	this->updateAttributes();
 	this->endResetModel();
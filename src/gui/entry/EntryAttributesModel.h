@@ -17,14 +17,16 @@
 #ifndef KEEPASSX_ENTRYATTRIBUTESMODEL_H
 #define KEEPASSX_ENTRYATTRIBUTESMODEL_H
 #include <QAbstractListModel>
-class EntryAttributes;
+#include "core/EntryAttributes.h"
 
-class EntryAttributesModel:public QAbstractListModel
+class EntryAttributesModel:public QAbstractListModel,
+	public EntryAttributesObserver
 {
 	Q_OBJECT public:
 	explicit EntryAttributesModel(
 		QObject* parent = nullptr
 	);
+	virtual ~EntryAttributesModel() override;
 	void setEntryAttributes(
 		EntryAttributes* entryAttributes
 	);
@@ -57,29 +59,32 @@ class EntryAttributesModel:public QAbstractListModel
 	QString keyByIndex(
 		const QModelIndex &index
 	) const;
-private Q_SLOTS:
-	void do_attributeChange(
+private:
+	virtual void customKeyModified(
 		const QString &key
-	);
-	void do_attributeAboutToAdd(
+	) override;
+	virtual void aboutToBeAdded(
 		const QString &key
-	);
-	void do_attributeAdd();
-	void do_attributeAboutToRemove(
+	) override;
+	virtual void added(
 		const QString &key
-	);
-	void do_attributeRemove();
-	void do_attributeAboutToRename(
+	) override;
+	virtual void aboutToBeRemoved(
+		const QString &key
+	) override;
+	virtual void removed(
+		const QString &key
+	) override;
+	virtual void aboutToRename(
 		const QString &oldKey,
 		const QString &newKey
-	);
-	void do_attributeRename(
+	) override;
+	virtual void renamed(
 		const QString &oldKey,
 		const QString &newKey
-	);
-	void do_aboutToReset();
-	void do_reset();
-private:
+	) override;
+	virtual void aboutToBeReset() override;
+	virtual void reset() override;
 	void updateAttributes();
 	EntryAttributes* entryAttributes;
 	QList<QString> attributes;
@@ -27,6 +27,13 @@ EntryHistoryModel::EntryHistoryModel(
 {
 }
 
+EntryHistoryModel::~EntryHistoryModel()
+{
+	qDeleteAll(
+		this->entries
+	);
+}
+
 Entry* EntryHistoryModel::entryFromIndex(
 	const QModelIndex &index
 ) const
@@ -145,22 +152,30 @@ void EntryHistoryModel::setEntries(
 )
 {
 	this->beginResetModel();
+	qDeleteAll(
+		this->entries
+	);
+	this->entries = entries;
 	this->historyEntries = entries;
-	this->deletedHistoryEntries.clear();
+	this->deletedHistoryIndexes.clear();
 	this->endResetModel();
 }
 
 void EntryHistoryModel::clear()
 {
 	this->beginResetModel();
+	qDeleteAll(
+		this->entries
+	);
+	this->entries.clear();
 	this->historyEntries.clear();
-	this->deletedHistoryEntries.clear();
+	this->deletedHistoryIndexes.clear();
 	this->endResetModel();
 }
 
-QList<Entry*> EntryHistoryModel::deletedEntries()
+QList<int> EntryHistoryModel::deletedIndexes() const
 {
-	return this->deletedHistoryEntries;
+	return this->deletedHistoryIndexes;
 }
 
 void EntryHistoryModel::deleteIndex(
@@ -184,7 +199,9 @@ void EntryHistoryModel::deleteIndex(
 		this->historyEntries.removeAll(
 			entry_
 		);
-		this->deletedHistoryEntries << entry_;
+		this->deletedHistoryIndexes << static_cast<int>(this->entries.indexOf(
+			entry_
+		));
 		this->endRemoveRows();
 	}
 }
@@ -204,7 +221,9 @@ void EntryHistoryModel::deleteAll()
 			this->historyEntries
 		))
 	{
-		this->deletedHistoryEntries << entry_;
+		this->deletedHistoryIndexes << static_cast<int>(this->entries.indexOf(
+			entry_
+		));
 	}
 	this->historyEntries.clear();
 	this->endRemoveRows();
@@ -25,6 +25,7 @@ class EntryHistoryModel final:public QAbstractTableModel
 	explicit EntryHistoryModel(
 		QObject* parent = nullptr
 	);
+	virtual ~EntryHistoryModel() override;
 	Entry* entryFromIndex(
 		const QModelIndex &index
 	) const;
@@ -43,17 +44,25 @@ class EntryHistoryModel final:public QAbstractTableModel
 		Qt::Orientation orientation,
 		int role
 	) const override;
+	/**
+	* Shows entries, the history items built by Entry::buildHistoryItems(),
+	* and takes ownership of them.
+	*/
 	void setEntries(
 		const QList<Entry*> &entries
 	);
 	void clear();
-	QList<Entry*> deletedEntries();
+	/**
+	* Positions of the deleted items in the list passed to setEntries().
+	*/
+	QList<int> deletedIndexes() const;
 	void deleteIndex(
 		const QModelIndex &index
 	);
 	void deleteAll();
 private:
+	QList<Entry*> entries;
 	QList<Entry*> historyEntries;
-	QList<Entry*> deletedHistoryEntries;
+	QList<int> deletedHistoryIndexes;
 };
 #endif // KEEPASSX_ENTRYHISTORYMODEL_H
@@ -19,7 +19,9 @@
 #include <QIODevice>
 #include <QMimeData>
 #include "core/DatabaseIcons.h"
+#include "core/Database.h"
 #include "core/Entry.h"
+#include "core/EntryDispatcher.h"
 #include "core/Global.h"
 #include "core/Group.h"
 #include "core/Metadata.h"
@@ -32,6 +34,12 @@ EntryModel::EntryModel(
 	),
 	group(
 		nullptr
+	),
+	pendingTransactions(
+		0
+	),
+	moreAvailable(
+		false
 	)
 {
 }
@@ -57,9 +65,9 @@ QModelIndex EntryModel::indexFromEntry(
 	Entry* entry
 ) const
 {
-	const auto row_ = static_cast<int>(this->entries.indexOf(
+	const int row_ = this->rowOf(
 		entry
-	));
+	);
 	if(row_ == -1)
 	{
 		return QModelIndex();
@@ -78,15 +86,21 @@ void EntryModel::do_setGroup(
 	{
 		return;
 	}
+	this->cancelLayoutChange();
 	this->beginResetModel();
 	this->severConnections();
 	this->group = group;
 	this->allGroups.clear();
+	this->moreAvailable = false;
+	this->databaseNames.clear();
 	this->entries = group->getEntries();
 	this->orgEntries.clear();
 	this->makeConnections(
 		this->group
 	);
+	this->connectDatabase(
+		this->group->getDatabase()
+	);
 	this->endResetModel();
 	 this->sig_switchedToGroupMode();
 }
@@ -95,56 +109,99 @@ void EntryModel::setEntryList(
 	const QList<Entry*> &entries
 )
 {
+	this->cancelLayoutChange();
 	this->beginResetModel();
 	this->severConnections();
 	this->group = nullptr;
 	this->allGroups.clear();
+	this->moreAvailable = false;
 	this->entries = entries;
 	this->orgEntries = entries;
-	QSet<Database*> databases_;
-	for(Entry* entry_: asConst(
-			this->entries
-		))
+	this->entryRows.clear();
+	this->connectEntryDatabases(
+		entries
+	);
+	this->endResetModel();
+	 this->sig_switchedToEntryListMode();
+}
+
+void EntryModel::appendEntries(
+	const QList<Entry*> &entries
+)
+{
+	if(this->group || entries.isEmpty())
 	{
-		databases_.insert(
-			entry_->getGroup()->getDatabase()
-		);
+		return;
 	}
-	for(Database* db_: asConst(
-			databases_
-		))
+	this->connectEntryDatabases(
+		entries
+	);
+	const auto first_ = static_cast<int>(this->entries.size());
+	this->beginInsertRows(
+		QModelIndex(),
+		first_,
+		first_ + static_cast<int>(entries.size()) - 1
+	);
+	this->entries.append(
+		entries
+	);
+	this->orgEntries.append(
+		entries
+	);
+	this->endInsertRows();
+}
+
+void EntryModel::setMoreAvailable(
+	const bool moreAvailable
+)
+{
+	this->moreAvailable = moreAvailable && !this->group;
+}
+
+void EntryModel::setDatabaseNames(
+	const QHash<const Database*, QString> &names
+)
+{
+	if(this->group)
 	{
-		if(!db_)
-		{
-			continue;
-		}
-		const QList<Group*> groupList_ = db_->getRootGroup()->
-			getGroupsRecursive(
-				true
-			);
-		for(const Group* group_: groupList_)
-		{
-			this->allGroups.append(
-				group_
-			);
-		}
-		if(db_->getMetadata()->getRecycleBin())
-		{
-			this->allGroups.removeOne(
-				db_->getMetadata()->getRecycleBin()
-			);
-		}
+		return;
 	}
-	for(const Group* group_: asConst(
-			this->allGroups
-		))
+	this->databaseNames = names;
+	if(!this->entries.isEmpty())
 	{
-		this->makeConnections(
-			group_
+		this->dataChanged(
+			this->index(
+				0,
+				ParentGroup
+			),
+			this->index(
+				static_cast<int>(this->entries.size()) - 1,
+				ParentGroup
+			)
 		);
 	}
-	this->endResetModel();
-	 this->sig_switchedToEntryListMode();
+}
+
+bool EntryModel::canFetchMore(
+	const QModelIndex &parent
+) const
+{
+	return !parent.isValid() && this->moreAvailable;
+}
+
+void EntryModel::fetchMore(
+	const QModelIndex &parent
+)
+{
+	if(!this->canFetchMore(
+		parent
+	))
+	{
+		return;
+	}
+	// the rows arrive later through appendEntries()
+	this->moreAvailable = false;
+	this->sig_fetchMoreRequested();
 }
 
 int EntryModel::rowCount(
@@ -185,9 +242,20 @@ QVariant EntryModel::data(
 		switch(index.column())
 		{
 			case ParentGroup:
-				if(entry_->getGroup())
+				if(const Group* group_ = entry_->getGroup())
 				{
-					return entry_->getGroup()->getName();
+					if(const auto name_ = this->databaseNames.constFind(
+						group_->getDatabase()
+					); name_ != this->databaseNames.constEnd())
+					{
+						return QString(
+							"%1 / %2"
+						).arg(
+							name_.value(),
+							group_->getName()
+						);
+					}
+					return group_->getName();
 				}
 				break;
 			case Title:
@@ -396,20 +464,20 @@ void EntryModel::do_entryAboutToRemove(
 	Entry* entry
 )
 {
+	const int row_ = this->rowOf(
+		entry
+	);
 	this->beginRemoveRows(
 		QModelIndex(),
-		static_cast<int>(this->entries.indexOf(
-			entry
-		)),
-		static_cast<int>(this->entries.indexOf(
-			entry
-		))
+		row_,
+		row_
 	);
 	if(!this->group)
 	{
 		this->entries.removeAll(
 			entry
 		);
+		this->entryRows.clear();
 	}
 }
 
@@ -426,9 +494,14 @@ void EntryModel::do_entryDataChanged(
 	Entry* entry
 )
 {
-	const auto row_ = static_cast<int>(this->entries.indexOf(
+	// the dispatcher reports the entries of the whole database
+	const int row_ = this->rowOf(
 		entry
-	));
+	);
+	if(row_ == -1)
+	{
+		return;
+	}
 	 this->dataChanged(
 		index(
 			row_,
@@ -441,6 +514,130 @@ void EntryModel::do_entryDataChanged(
 	);
 }
 
+void EntryModel::do_transactionStarted()
+{
+	if(this->pendingTransactions++ > 0)
+	{
+		return;
+	}
+	this->layoutAboutToBeChanged();
+	this->layoutIndexes = this->persistentIndexList();
+	this->layoutEntries.clear();
+	for(const QModelIndex &index_: asConst(
+			this->layoutIndexes
+		))
+	{
+		this->layoutEntries.append(
+			this->entryFromIndex(
+				index_
+			)
+		);
+	}
+}
+
+void EntryModel::do_transactionCommitted(
+	const DatabaseChanges &changes
+)
+{
+	if(this->pendingTransactions == 0 || --this->pendingTransactions > 0)
+	{
+		return;
+	}
+	if(this->group)
+	{
+		this->entries = this->group->getEntries();
+	}
+	else
+	{
+		// entry list mode, or the group was deleted with the transaction.
+		// removed entries may be deleted, they are only compared by address
+		QList<Entry*> entries_;
+		for(Entry* entry_: asConst(
+				this->orgEntries
+			))
+		{
+			if(changes.addedEntries.contains(
+				entry_
+			))
+			{
+				if(this->allGroups.contains(
+					entry_->getGroup()
+				))
+				{
+					entries_.append(
+						entry_
+					);
+				}
+			}
+			else if(!changes.removedEntries.contains(
+				entry_
+			) && this->rowOf(
+				entry_
+			) != -1)
+			{
+				entries_.append(
+					entry_
+				);
+			}
+		}
+		this->entries = entries_;
+		this->entryRows.clear();
+	}
+	QModelIndexList indexes_;
+	for(auto i_ = 0; i_ < this->layoutIndexes.size(); i_++)
+	{
+		const int row_ = this->rowOf(
+			this->layoutEntries.at(
+				i_
+			)
+		);
+		indexes_.append(
+			row_ == -1 ? QModelIndex() : this->index(
+				row_,
+				this->layoutIndexes.at(
+					i_
+				).column()
+			)
+		);
+	}
+	this->changePersistentIndexList(
+		this->layoutIndexes,
+		indexes_
+	);
+	this->layoutIndexes.clear();
+	this->layoutEntries.clear();
+	this->layoutChanged();
+}
+
+int EntryModel::rowOf(
+	const Entry* entry
+) const
+{
+	if(this->group)
+	{
+		return this->group->indexOfEntry(
+			entry
+		);
+	}
+	if(this->entryRows.size() != this->entries.size())
+	{
+		this->entryRows.clear();
+		for(auto i_ = 0; i_ < this->entries.size(); i_++)
+		{
+			this->entryRows.insert(
+				this->entries.at(
+					i_
+				),
+				i_
+			);
+		}
+	}
+	return this->entryRows.value(
+		entry,
+		-1
+	);
+}
+
 void EntryModel::severConnections()
 {
 	if(this->group)
@@ -463,6 +660,132 @@ void EntryModel::severConnections()
 			nullptr
 		);
 	}
+	for(Database* db_: asConst(
+			this->databases
+		))
+	{
+		if(db_)
+		{
+			this->disconnect(
+				db_,
+				nullptr,
+				this,
+				nullptr
+			);
+			this->disconnect(
+				db_->getEntryDispatcher(),
+				nullptr,
+				this,
+				nullptr
+			);
+		}
+	}
+	this->databases.clear();
+}
+
+void EntryModel::connectDatabase(
+	Database* db
+)
+{
+	if(!db)
+	{
+		return;
+	}
+	this->connect(
+		db->getEntryDispatcher(),
+		&EntryDispatcher::sig_entryDataChanged,
+		this,
+		&EntryModel::do_entryDataChanged
+	);
+	this->connect(
+		db,
+		&Database::sig_transactionStarted,
+		this,
+		&EntryModel::do_transactionStarted
+	);
+	this->connect(
+		db,
+		&Database::sig_transactionCommitted,
+		this,
+		&EntryModel::do_transactionCommitted
+	);
+	this->databases.append(
+		db
+	);
+}
+
+void EntryModel::connectEntryDatabases(
+	const QList<Entry*> &entries
+)
+{
+	QSet<Database*> databases_;
+	for(Entry* entry_: entries)
+	{
+		databases_.insert(
+			entry_->getGroup()->getDatabase()
+		);
+	}
+	for(Database* db_: asConst(
+			databases_
+		))
+	{
+		if(!db_ || this->databases.contains(
+			db_
+		))
+		{
+			continue;
+		}
+		this->connectDatabase(
+			db_
+		);
+		QList<const Group*> groups_;
+		for(const Group* group_: db_->getRootGroup()->groupsRecursive(
+				true
+			))
+		{
+			groups_.append(
+				group_
+			);
+		}
+		if(db_->getMetadata()->getRecycleBin())
+		{
+			groups_.removeOne(
+				db_->getMetadata()->getRecycleBin()
+			);
+		}
+		for(const Group* group_: asConst(
+				groups_
+			))
+		{
+			this->makeConnections(
+				group_
+			);
+		}
+		this->allGroups.append(
+			groups_
+		);
+	}
+}
+
+void EntryModel::cancelLayoutChange()
+{
+	if(this->pendingTransactions == 0)
+	{
+		return;
+	}
+	// the model is reset next, the rows of the layout change are dropped
+	this->pendingTransactions = 0;
+	this->entries.clear();
+	this->entryRows.clear();
+	this->changePersistentIndexList(
+		this->layoutIndexes,
+		QModelIndexList(
+			this->layoutIndexes.size()
+		)
+	);
+	this->layoutIndexes.clear();
+	this->layoutEntries.clear();
+	this->layoutChanged();
 }
 
 void EntryModel::makeConnections(
@@ -493,10 +816,4 @@ void EntryModel::makeConnections(
 		this,
 		&EntryModel::do_entryRemoved
 	);
-	this->connect(
-		group,
-		&Group::sig_entryDataChanged,
-		this,
-		&EntryModel::do_entryDataChanged
-	);
 }
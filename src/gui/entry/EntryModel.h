@@ -17,8 +17,12 @@
 #ifndef KEEPASSX_ENTRYMODEL_H
 #define KEEPASSX_ENTRYMODEL_H
 #include <QAbstractTableModel>
+#include <QHash>
+#include <QPointer>
+class Database;
 class Entry;
 class Group;
+struct DatabaseChanges;
 
 class EntryModel final:public QAbstractTableModel
 {
@@ -67,9 +71,36 @@ class EntryModel final:public QAbstractTableModel
 	void setEntryList(
 		const QList<Entry*> &entries
 	);
+	/**
+	* Adds entries to the end of the list in entry list mode.
+	*/
+	void appendEntries(
+		const QList<Entry*> &entries
+	);
+	/**
+	* Sets whether the entry list has more rows the view may ask for, like
+	* the matches a ranked search left out.
+	*/
+	void setMoreAvailable(
+		bool moreAvailable
+	);
+	/**
+	* Names the databases of the entries in entry list mode, the group
+	* column then shows the name of its database before the group.
+	*/
+	void setDatabaseNames(
+		const QHash<const Database*, QString> &names
+	);
+	virtual bool canFetchMore(
+		const QModelIndex &parent
+	) const override;
+	virtual void fetchMore(
+		const QModelIndex &parent
+	) override;
 Q_SIGNALS:
 	void sig_switchedToEntryListMode();
 	void sig_switchedToGroupMode();
+	void sig_fetchMoreRequested();
 public Q_SLOTS:
 	void do_setGroup(
 		Group* group
@@ -88,14 +119,38 @@ private Q_SLOTS:
 	void do_entryDataChanged(
 		Entry* entry
 	);
+	void do_transactionStarted();
+	void do_transactionCommitted(
+		const DatabaseChanges &changes
+	);
 private:
+	int rowOf(
+		const Entry* entry
+	) const;
 	void severConnections();
 	void makeConnections(
 		const Group* group
 	) const;
-	Group* group;
+	void connectDatabase(
+		Database* db
+	);
+	void connectEntryDatabases(
+		const QList<Entry*> &entries
+	);
+	void cancelLayoutChange();
+	QPointer<Group> group;
 	QList<Entry*> entries;
 	QList<Entry*> orgEntries;
+	// rows in entry list mode, rebuilt when the size doesn't match
+	mutable QHash<const Entry*, int> entryRows;
 	QList<const Group*> allGroups;
+	QList<QPointer<Database>> databases;
+	QHash<const Database*, QString> databaseNames;
+	// open transactions of the databases and the persistent indexes the
+	// layout change started with
+	int pendingTransactions;
+	bool moreAvailable;
+	QModelIndexList layoutIndexes;
+	QList<const Entry*> layoutEntries;
 };
 #endif // KEEPASSX_ENTRYMODEL_H
@@ -141,6 +141,20 @@ void EntryView::setEntryList(
 	this->setFirstEntryActive();
 }
 
+void EntryView::appendEntryList(
+	const QList<Entry*> &entries
+)
+{
+	const bool empty_ = this->model->rowCount() == 0;
+	this->model->appendEntries(
+		entries
+	);
+	if(empty_)
+	{
+		this->setFirstEntryActive();
+	}
+}
+
 void EntryView::setFirstEntryActive()
 {
 	if(this->model->rowCount() > 0)
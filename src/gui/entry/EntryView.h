@@ -42,6 +42,9 @@ class EntryView:public QTreeView
 	void setEntryList(
 		const QList<Entry*> &entries
 	);
+	void appendEntryList(
+		const QList<Entry*> &entries
+	);
 	bool isInEntryListMode() const;
 	qsizetype numberOfSelectedEntries() const;
 	void setFirstEntryActive();
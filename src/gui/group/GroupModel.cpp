@@ -20,6 +20,7 @@
 #include <QMimeData>
 #include "core/Database.h"
 #include "core/DatabaseIcons.h"
+#include "core/Global.h"
 #include "core/Group.h"
 #include "core/Metadata.h"
 #include "core/Tools.h"
@@ -94,6 +95,18 @@ void GroupModel::changeDatabase(
 		this,
 		&GroupModel::do_groupMoved
 	);
+	this->connect(
+		this->db,
+		&Database::sig_transactionStarted,
+		this,
+		&GroupModel::do_transactionStarted
+	);
+	this->connect(
+		this->db,
+		&Database::sig_transactionCommitted,
+		this,
+		&GroupModel::do_transactionCommitted
+	);
 	this->endResetModel();
 }
 
@@ -192,9 +205,9 @@ QModelIndex GroupModel::parent(
 		);
 	}
 	return this->createIndex(
-		static_cast<int>(grandParentGroup_->getChildren().indexOf(
+		grandParentGroup_->indexOfChild(
 			parentGroup_
-		)),
+		),
 		0,
 		parentGroup_
 	);
@@ -269,9 +282,9 @@ QModelIndex GroupModel::index(
 	}
 	else
 	{
-		row_ = static_cast<int>(group->getParentGroup()->getChildren().indexOf(
+		row_ = group->getParentGroup()->indexOfChild(
 			group
-		));
+		);
 	}
 	return this->createIndex(
 		row_,
@@ -413,7 +426,7 @@ bool GroupModel::dropMimeData(
 			return false;
 		}
 		if(parentGroup_ == dragGroup_->getParentGroup() && row > parentGroup_->
-			getChildren().indexOf(
+			indexOfChild(
 				dragGroup_
 			))
 		{
@@ -449,6 +462,12 @@ bool GroupModel::dropMimeData(
 		{
 			return false;
 		}
+		// the entries are moved in one transaction per involved database
+		QList<Database*> databases_;
+		databases_.append(
+			parentGroup_->getDatabase()
+		);
+		parentGroup_->getDatabase()->beginTransaction();
 		while(!stream_.atEnd())
 		{
 			UUID dbUuid_;
@@ -461,6 +480,15 @@ bool GroupModel::dropMimeData(
 			{
 				continue;
 			}
+			if(!databases_.contains(
+				db_
+			))
+			{
+				db_->beginTransaction();
+				databases_.append(
+					db_
+				);
+			}
 			Entry* dragEntry_ = db_->resolveEntry(
 				entryUuid_
 			);
@@ -501,6 +529,12 @@ bool GroupModel::dropMimeData(
 				parentGroup_
 			);
 		}
+		for(Database* db_: asConst(
+				databases_
+			))
+		{
+			db_->commitTransaction();
+		}
 	}
 	return true;
 }
@@ -591,10 +625,9 @@ void GroupModel::do_groupAboutToRemove(
 	{
 		return;
 	}
-	const auto pos_ = static_cast<int>(group->getParentGroup()->getChildren().
-		indexOf(
-			group
-		));
+	const int pos_ = group->getParentGroup()->indexOfChild(
+		group
+	);
 	if(pos_ == -1)
 	{
 		return;
@@ -651,10 +684,9 @@ void GroupModel::do_groupAboutToMove(
 	const QModelIndex newParentIndex_ = this->index(
 		toGroup
 	);
-	const auto oldPos_ = static_cast<int>(group->getParentGroup()->getChildren()
-		.indexOf(
-			group
-		));
+	const int oldPos_ = group->getParentGroup()->indexOfChild(
+		group
+	);
 	if(group->getParentGroup() == toGroup && pos > oldPos_)
 	{
 		// beginMoveRows() has a bit different semantics than Group::setParent() and
@@ -677,3 +709,64 @@ void GroupModel::do_groupMoved()
 {
 	this->endMoveRows();
 }
+
+void GroupModel::do_transactionStarted()
+{
+	this->layoutAboutToBeChanged();
+	this->layoutIndexes = this->persistentIndexList();
+	this->layoutGroups.clear();
+	for(const QModelIndex &index_: asConst(
+			this->layoutIndexes
+		))
+	{
+		this->layoutGroups.append(
+			this->groupFromIndex(
+				index_
+			)
+		);
+	}
+}
+
+void GroupModel::do_transactionCommitted()
+{
+	// groups deleted by the transaction are only compared by address
+	QSet<const Group*> groups_;
+	for(const Group* group_: asConst(
+			*this->db->getRootGroup()
+		).groupsRecursive(
+			true
+		))
+	{
+		groups_.insert(
+			group_
+		);
+	}
+	QModelIndexList indexes_;
+	for(auto i_ = 0; i_ < this->layoutIndexes.size(); i_++)
+	{
+		Group* group_ = this->layoutGroups.at(
+			i_
+		);
+		if(!groups_.contains(
+			group_
+		))
+		{
+			indexes_.append(
+				QModelIndex()
+			);
+			continue;
+		}
+		indexes_.append(
+			this->index(
+				group_
+			)
+		);
+	}
+	this->changePersistentIndexList(
+		this->layoutIndexes,
+		indexes_
+	);
+	this->layoutIndexes.clear();
+	this->layoutGroups.clear();
+	this->layoutChanged();
+}
@@ -97,7 +97,12 @@ private Q_SLOTS:
 		int pos
 	);
 	void do_groupMoved();
+	void do_transactionStarted();
+	void do_transactionCommitted();
 private:
 	Database* db;
+	// persistent indexes the layout change of a transaction started with
+	QModelIndexList layoutIndexes;
+	QList<Group*> layoutGroups;
 };
 #endif // KEEPASSX_GROUPMODEL_H
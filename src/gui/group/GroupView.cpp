@@ -71,6 +71,12 @@ GroupView::GroupView(
 		this,
 		&GroupView::do_modelReset
 	);
+	this->connect(
+		this->model,
+		&GroupModel::layoutChanged,
+		this,
+		&GroupView::do_layoutChanged
+	);
 	this->connect(
 		this->selectionModel(),
 		&QItemSelectionModel::currentChanged,
@@ -251,6 +257,28 @@ void GroupView::setCurrentGroup(
 	);
 }
 
+void GroupView::do_layoutChanged()
+{
+	// groups added by a transaction get their expanded state here
+	this->recInitExpanded(
+		this->model->groupFromIndex(
+			this->model->index(
+				0,
+				0
+			)
+		)
+	);
+	if(!this->currentIndex().isValid())
+	{
+		this->setCurrentIndex(
+			this->model->index(
+				0,
+				0
+			)
+		);
+	}
+}
+
 void GroupView::do_modelReset()
 {
 	this->recInitExpanded(
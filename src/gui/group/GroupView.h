@@ -63,6 +63,7 @@ private Q_SLOTS:
 		int end
 	);
 	void do_modelReset();
+	void do_layoutChanged();
 protected:
 	virtual void dragMoveEvent(
 		QDragMoveEvent* event
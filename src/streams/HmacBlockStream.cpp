@@ -0,0 +1,536 @@
+/*
+ *  Copyright (C) 2026 The cpp-password-manager contributors
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "HmacBlockStream.h"
+#include <QtConcurrent>
+#include <cstring>
+#include "core/Endian.h"
+#include "crypto/CryptoHash.h"
+const QSysInfo::Endian HmacBlockStream::ByteOrder = QSysInfo::LittleEndian;
+
+HmacBlockStream::HmacBlockStream(
+	QIODevice* baseDevice,
+	const QByteArray &key
+)
+	: LayeredStream(
+		baseDevice
+	),
+	key(
+		key
+	),
+	blockSize(
+		1024 * 1024
+	),
+	bufferPos(),
+	blockIndex(),
+	eof(),
+	error(),
+	nextBlock(),
+	authenticated()
+{
+	this->init();
+}
+
+HmacBlockStream::HmacBlockStream(
+	QIODevice* baseDevice,
+	const QByteArray &key,
+	const qint32 blockSize
+)
+	: LayeredStream(
+		baseDevice
+	),
+	key(
+		key
+	),
+	blockSize(
+		blockSize
+	),
+	bufferPos(),
+	blockIndex(),
+	eof(),
+	error(),
+	nextBlock(),
+	authenticated()
+{
+	this->init();
+}
+
+HmacBlockStream::~HmacBlockStream()
+{
+	this->close();
+}
+
+void HmacBlockStream::init()
+{
+	this->buffer.clear();
+	this->bufferPos = 0;
+	this->blockIndex = 0;
+	this->eof = false;
+	this->error = false;
+	this->blocks.clear();
+	this->payload.clear();
+	this->nextBlock = 0;
+	this->authenticated = false;
+}
+
+bool HmacBlockStream::reset()
+{
+	// Write final block(s) only if device is writable and we haven't
+	// already written a final block.
+	if(this->isWritable() && (!this->buffer.isEmpty() || this->blockIndex != 0))
+	{
+		if(!this->buffer.isEmpty())
+		{
+			if(!this->writeHmacBlock())
+			{
+				return false;
+			}
+		}
+		// write empty final block
+		if(!this->writeHmacBlock())
+		{
+			return false;
+		}
+	}
+	this->init();
+	return true;
+}
+
+void HmacBlockStream::close()
+{
+	// Write final block(s) only if device is writable and we haven't
+	// already written a final block.
+	if(this->isWritable() && (!this->buffer.isEmpty() || this->blockIndex != 0))
+	{
+		if(!this->buffer.isEmpty())
+		{
+			this->writeHmacBlock();
+		}
+		// write empty final block
+		this->writeHmacBlock();
+	}
+	LayeredStream::close();
+}
+
+bool HmacBlockStream::atEnd() const
+{
+	// the next block is always read ahead, so stacked streams like
+	// SymmetricCipherStream can tell when they read the last bytes
+	if(this->isReadable())
+	{
+		return this->eof;
+	}
+	return LayeredStream::atEnd();
+}
+
+qint64 HmacBlockStream::bytesAvailable() const
+{
+	return this->buffer.size() - this->bufferPos + LayeredStream::
+		bytesAvailable();
+}
+
+QByteArray HmacBlockStream::getHmacKey(
+	const QByteArray &masterSeed,
+	const QByteArray &transformedMasterKey
+)
+{
+	CryptoHash hash_(
+		CryptoHash::Sha512
+	);
+	hash_.addData(
+		masterSeed
+	);
+	hash_.addData(
+		transformedMasterKey
+	);
+	hash_.addData(
+		QByteArray(
+			1,
+			'\x01'
+		)
+	);
+	return hash_.getResult();
+}
+
+QByteArray HmacBlockStream::getBlockKey(
+	const quint64 blockIndex,
+	const QByteArray &key
+)
+{
+	CryptoHash hash_(
+		CryptoHash::Sha512
+	);
+	hash_.addData(
+		Endian::int64ToBytes(
+			static_cast<qint64>(blockIndex),
+			ByteOrder
+		)
+	);
+	hash_.addData(
+		key
+	);
+	return hash_.getResult();
+}
+
+QByteArray HmacBlockStream::getBlockHmac(
+	const quint64 blockIndex,
+	const QByteArray &key,
+	const QByteArray &data
+)
+{
+	CryptoHash hmac_(
+		CryptoHash::Sha256,
+		true
+	);
+	hmac_.setKey(
+		getBlockKey(
+			blockIndex,
+			key
+		)
+	);
+	hmac_.addData(
+		Endian::int64ToBytes(
+			static_cast<qint64>(blockIndex),
+			ByteOrder
+		)
+	);
+	hmac_.addData(
+		Endian::int32ToBytes(
+			static_cast<qint32>(data.size()),
+			ByteOrder
+		)
+	);
+	hmac_.addData(
+		data
+	);
+	return hmac_.getResult();
+}
+
+bool HmacBlockStream::authenticate()
+{
+	if(this->error)
+	{
+		return false;
+	}
+	this->payload = this->getBaseDevice()->readAll();
+	qint64 pos_ = 0;
+	quint64 blockIndex_ = this->blockIndex;
+	while(true)
+	{
+		if(this->payload.size() - pos_ < 32)
+		{
+			this->error = true;
+			this->setErrorString(
+				"Invalid HMAC size."
+			);
+			return false;
+		}
+		const qint32 blockSize_ = this->payload.size() - pos_ < 36 ? -1 :
+			Endian::bytesToInt32(
+				QByteArray::fromRawData(
+					this->payload.constData() + pos_ + 32,
+					4
+				),
+				this->ByteOrder
+			);
+		if(blockSize_ < 0)
+		{
+			this->error = true;
+			this->setErrorString(
+				"Invalid block size."
+			);
+			return false;
+		}
+		if(this->payload.size() - pos_ - 36 < blockSize_)
+		{
+			this->error = true;
+			this->setErrorString(
+				"Block too short."
+			);
+			return false;
+		}
+		// the blocks only reference the payload, nothing is copied
+		const Block block_{
+			blockIndex_,
+			this->key,
+			QByteArray::fromRawData(
+				this->payload.constData() + pos_,
+				32
+			),
+			QByteArray::fromRawData(
+				this->payload.constData() + pos_ + 36,
+				blockSize_
+			)
+		};
+		this->blocks.append(
+			block_
+		);
+		blockIndex_++;
+		pos_ += 36 + blockSize_;
+		if(blockSize_ == 0)
+		{
+			break;
+		}
+	}
+	// leave anything following the final block to the base device
+	if(!this->getBaseDevice()->isSequential())
+	{
+		this->getBaseDevice()->seek(
+			this->getBaseDevice()->pos() - (this->payload.size() - pos_)
+		);
+	}
+	if(!QtConcurrent::blockingFiltered(
+		this->blocks,
+		&HmacBlockStream::isForged
+	).isEmpty())
+	{
+		this->error = true;
+		this->setErrorString(
+			"Mismatch between HMAC and data."
+		);
+		return false;
+	}
+	this->authenticated = true;
+	return true;
+}
+
+bool HmacBlockStream::isForged(
+	const Block &block
+)
+{
+	return block.hmac != getBlockHmac(
+		block.index,
+		block.key,
+		block.data
+	);
+}
+
+qint64 HmacBlockStream::readData(
+	char* data,
+	const qint64 maxSize
+)
+{
+	if(this->error)
+	{
+		return -1;
+	}
+	if(this->eof)
+	{
+		return 0;
+	}
+	auto bytesRemaining_ = static_cast<qint32>(maxSize);
+	auto offset_ = 0;
+	while(bytesRemaining_ > 0)
+	{
+		if(this->bufferPos == this->buffer.size())
+		{
+			if(!this->readHmacBlock())
+			{
+				if(this->error)
+				{
+					return -1;
+				}
+				return maxSize - bytesRemaining_;
+			}
+		}
+		const qint32 bytesToCopy_ = qMin(
+			bytesRemaining_,
+			static_cast<qint32>(this->buffer.size()) - this->bufferPos
+		);
+		memcpy(
+			data + offset_,
+			this->buffer.constData() + this->bufferPos,
+			bytesToCopy_
+		);
+		offset_ += bytesToCopy_;
+		this->bufferPos += bytesToCopy_;
+		bytesRemaining_ -= bytesToCopy_;
+	}
+	if(this->bufferPos == this->buffer.size())
+	{
+		// read ahead so atEnd() is accurate, errors surface on the next read
+		this->readHmacBlock();
+	}
+	return maxSize;
+}
+
+bool HmacBlockStream::readHmacBlock()
+{
+	if(this->authenticated)
+	{
+		if(this->nextBlock == this->blocks.size())
+		{
+			this->eof = true;
+			return false;
+		}
+		this->buffer = this->blocks.at(
+			this->nextBlock++
+		).data;
+		this->bufferPos = 0;
+		this->blockIndex++;
+		if(this->buffer.isEmpty())
+		{
+			this->eof = true;
+			return false;
+		}
+		return true;
+	}
+	const QByteArray hmac_ = this->getBaseDevice()->read(
+		32
+	);
+	if(hmac_.size() != 32)
+	{
+		this->error = true;
+		this->setErrorString(
+			"Invalid HMAC size."
+		);
+		return false;
+	}
+	bool ok_;
+	const qint32 blockSize_ = Endian::readInt32(
+		this->getBaseDevice(),
+		this->ByteOrder,
+		&ok_
+	);
+	if(!ok_ || blockSize_ < 0)
+	{
+		this->error = true;
+		this->setErrorString(
+			"Invalid block size."
+		);
+		return false;
+	}
+	QByteArray buffer_ = this->getBaseDevice()->read(
+		blockSize_
+	);
+	if(buffer_.size() != blockSize_)
+	{
+		this->error = true;
+		this->setErrorString(
+			"Block too short."
+		);
+		return false;
+	}
+	if(hmac_ != this->getBlockHmac(
+		this->blockIndex,
+		this->key,
+		buffer_
+	))
+	{
+		this->error = true;
+		this->setErrorString(
+			"Mismatch between HMAC and data."
+		);
+		return false;
+	}
+	this->blockIndex++;
+	this->buffer = buffer_;
+	this->bufferPos = 0;
+	if(blockSize_ == 0)
+	{
+		this->eof = true;
+		return false;
+	}
+	return true;
+}
+
+qint64 HmacBlockStream::writeData(
+	const char* data,
+	const qint64 maxSize
+)
+{
+	if(maxSize <= 0)
+	{
+		return 0;
+	}
+	if(this->error)
+	{
+		return -1;
+	}
+	auto bytesRemaining_ = static_cast<qint32>(maxSize);
+	auto offset_ = 0;
+	while(bytesRemaining_ > 0)
+	{
+		const qint32 bytesToCopy_ = qMin(
+			bytesRemaining_,
+			this->blockSize - static_cast<qint32>(this->buffer.size())
+		);
+		this->buffer.append(
+			data + offset_,
+			bytesToCopy_
+		);
+		offset_ += bytesToCopy_;
+		bytesRemaining_ -= bytesToCopy_;
+		if(this->buffer.size() == this->blockSize)
+		{
+			if(!this->writeHmacBlock())
+			{
+				if(this->error)
+				{
+					return -1;
+				}
+				return maxSize - bytesRemaining_;
+			}
+		}
+	}
+	return maxSize;
+}
+
+bool HmacBlockStream::writeHmacBlock()
+{
+	if(this->getBaseDevice()->write(
+		this->getBlockHmac(
+			this->blockIndex,
+			this->key,
+			this->buffer
+		)
+	) != 32)
+	{
+		this->error = true;
+		this->setErrorString(
+			this->getBaseDevice()->errorString()
+		);
+		return false;
+	}
+	this->blockIndex++;
+	if(!Endian::writeInt32(
+		static_cast<qint32>(this->buffer.size()),
+		this->getBaseDevice(),
+		this->ByteOrder
+	))
+	{
+		this->error = true;
+		this->setErrorString(
+			this->getBaseDevice()->errorString()
+		);
+		return false;
+	}
+	if(!this->buffer.isEmpty())
+	{
+		if(this->getBaseDevice()->write(
+			this->buffer
+		) != this->buffer.size())
+		{
+			this->error = true;
+			this->setErrorString(
+				this->getBaseDevice()->errorString()
+			);
+			return false;
+		}
+		this->buffer.clear();
+	}
+	return true;
+}
@@ -0,0 +1,108 @@
+/*
+ *  Copyright (C) 2026 The cpp-password-manager contributors
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef KEEPASSX_HMACBLOCKSTREAM_H
+#define KEEPASSX_HMACBLOCKSTREAM_H
+#include <QList>
+#include <QSysInfo>
+#include "streams/LayeredStream.h"
+
+/**
+* KDBX 4 block stream. Every block carries an HMAC-SHA256 over its index,
+* size and data, keyed with a key derived from the block index so blocks
+* can't be reordered or dropped. An empty block terminates the stream.
+*/
+class HmacBlockStream final:public LayeredStream
+{
+	Q_OBJECT public:
+	HmacBlockStream(
+		QIODevice* baseDevice,
+		const QByteArray &key
+	);
+	HmacBlockStream(
+		QIODevice* baseDevice,
+		const QByteArray &key,
+		qint32 blockSize
+	);
+	virtual ~HmacBlockStream() override;
+	virtual bool reset() override;
+	virtual void close() override;
+	virtual bool atEnd() const override;
+	virtual qint64 bytesAvailable() const override;
+	/**
+	* Derives the key all block keys of a KDBX 4 file are based on.
+	*/
+	static QByteArray getHmacKey(
+		const QByteArray &masterSeed,
+		const QByteArray &transformedMasterKey
+	);
+	/**
+	* Returns the HMAC key of block blockIndex, the header HMAC uses the
+	* index KeePass2::HEADER_HMAC_INDEX.
+	*/
+	static QByteArray getBlockKey(
+		quint64 blockIndex,
+		const QByteArray &key
+	);
+	static QByteArray getBlockHmac(
+		quint64 blockIndex,
+		const QByteArray &key,
+		const QByteArray &data
+	);
+	/**
+	* Reads the remaining blocks and checks all HMACs in parallel before any
+	* data is handed to the stacked streams. The blocks are served from
+	* memory afterwards. Returns false if a block is missing or forged.
+	*/
+	bool authenticate();
+protected:
+	virtual qint64 readData(
+		char* data,
+		qint64 maxSize
+	) override;
+	virtual qint64 writeData(
+		const char* data,
+		qint64 maxSize
+	) override;
+private:
+	struct Block
+	{
+		quint64 index;
+		QByteArray key;
+		QByteArray hmac;
+		QByteArray data;
+	};
+
+	void init();
+	bool readHmacBlock();
+	bool writeHmacBlock();
+	static bool isForged(
+		const Block &block
+	);
+	static const QSysInfo::Endian ByteOrder;
+	const QByteArray key;
+	qint32 blockSize;
+	QByteArray buffer;
+	int bufferPos;
+	quint64 blockIndex;
+	bool eof;
+	bool error;
+	QByteArray payload;
+	QList<Block> blocks;
+	int nextBlock;
+	bool authenticated;
+};
+#endif // KEEPASSX_HMACBLOCKSTREAM_H
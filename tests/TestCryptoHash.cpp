@@ -69,4 +69,48 @@ void TestCryptoHash::test()
 		QByteArray::fromHex(
 			"0b56e5f65263e747af4a833bd7dd7ad26a64d7a4de7c68e52364893dca0766b4")
 	);
+	QCOMPARE(
+		CryptoHash::hash(QByteArray("abc"), CryptoHash::Sha512),
+		QByteArray::fromHex(
+			"ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a"
+			"2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f")
+	);
+}
+
+void TestCryptoHash::testHmac()
+{
+	// RFC 4231 test case 2
+	QByteArray key = QString(
+		"Jefe"
+	).toLatin1();
+	QByteArray data = QString(
+		"what do ya want for nothing?"
+	).toLatin1();
+	QCOMPARE(
+		CryptoHash::hmac(data, key, CryptoHash::Sha256),
+		QByteArray::fromHex(
+			"5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843")
+	);
+	CryptoHash cryptoHash(
+		CryptoHash::Sha256,
+		true
+	);
+	cryptoHash.setKey(
+		key
+	);
+	cryptoHash.addData(
+		data.left(
+			10
+		)
+	);
+	cryptoHash.addData(
+		data.mid(
+			10
+		)
+	);
+	QCOMPARE(
+		cryptoHash.getResult(),
+		QByteArray::fromHex(
+			"5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843")
+	);
 }
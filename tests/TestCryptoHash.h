@@ -23,5 +23,6 @@ class TestCryptoHash:public QObject
 	Q_OBJECT private Q_SLOTS:
 	void initTestCase();
 	void test();
+	void testHmac();
 };
 #endif // KEEPASSX_TESTCRYPTOHASH_H
@@ -0,0 +1,499 @@
+/*
+ *  Copyright (C) 2026 The cpp-password-manager contributors
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "TestDurableSaveFile.h"
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+#include "FailDevice.h"
+QTEST_GUILESS_MAIN(
+	TestDurableSaveFile
+)
+
+void TestDurableSaveFile::do_stageReached(
+	const DurableSaveFile::Stage stage
+)
+{
+	m_stages.append(
+		stage
+	);
+	// the files on disk at this point are what a crash would leave behind
+	if(stage == m_crashStage && m_snapshot.isEmpty())
+	{
+		m_snapshot = readDirectory(
+			m_dirPath
+		);
+	}
+}
+
+void TestDurableSaveFile::init()
+{
+	m_crashStage = -1;
+	m_stages.clear();
+	m_snapshot.clear();
+}
+
+void TestDurableSaveFile::testCommit()
+{
+	QTemporaryDir tempDir;
+	QVERIFY(
+		tempDir.isValid()
+	);
+	m_dirPath = tempDir.path();
+	const QString fileName = m_dirPath + "/test.kdbx";
+	const QByteArray data = pattern(
+		2 * DurableSaveFile::ChunkSize + 1000,
+		'a'
+	);
+	QVERIFY(
+		save(
+			fileName,
+			data,
+			true
+		)
+	);
+	QFile file(
+		fileName
+	);
+	QVERIFY(
+		file.open(
+			QIODevice::ReadOnly
+		)
+	);
+	// the preallocated tail must be gone
+	QCOMPARE(
+		file.readAll(),
+		data
+	);
+	file.close();
+	QCOMPARE(
+		QDir(
+			m_dirPath
+		).entryList(
+			QDir::Files | QDir::Hidden
+		),
+		QStringList() << "test.kdbx"
+	);
+	QCOMPARE(
+		m_stages.first(),
+		DurableSaveFile::TemporaryCreated
+	);
+	QCOMPARE(
+		m_stages.count(
+			DurableSaveFile::ChunkWritten
+		),
+		3
+	);
+	QVERIFY(
+		m_stages.indexOf(
+			DurableSaveFile::DataSynced
+		) < m_stages.indexOf(
+			DurableSaveFile::Renamed
+		)
+	);
+	// overwriting keeps the permissions of the previous file
+	QVERIFY(
+		QFile::setPermissions(
+			fileName,
+			QFile::ReadOwner | QFile::WriteOwner | QFile::ReadGroup
+		)
+	);
+	QVERIFY(
+		save(
+			fileName,
+			pattern(
+				100,
+				'b'
+			)
+		)
+	);
+	QCOMPARE(
+		QFile::permissions(
+			fileName
+		) & (QFile::ReadGroup | QFile::ReadOther),
+		QFile::Permissions(
+			QFile::ReadGroup
+		)
+	);
+}
+
+void TestDurableSaveFile::testCrash_data()
+{
+	QTest::addColumn<int>(
+		"stage"
+	);
+	QTest::newRow(
+		"temporary created"
+	) << static_cast<int>(DurableSaveFile::TemporaryCreated);
+	QTest::newRow(
+		"chunk written"
+	) << static_cast<int>(DurableSaveFile::ChunkWritten);
+	QTest::newRow(
+		"data synced"
+	) << static_cast<int>(DurableSaveFile::DataSynced);
+	QTest::newRow(
+		"renamed"
+	) << static_cast<int>(DurableSaveFile::Renamed);
+#ifdef Q_OS_UNIX
+	QTest::newRow(
+		"directory synced"
+	) << static_cast<int>(DurableSaveFile::DirectorySynced);
+#endif
+}
+
+void TestDurableSaveFile::testCrash()
+{
+	QFETCH(
+		int,
+		stage
+	);
+	QTemporaryDir tempDir;
+	QVERIFY(
+		tempDir.isValid()
+	);
+	m_dirPath = tempDir.path();
+	const QString fileName = m_dirPath + "/test.kdbx";
+	const QByteArray oldData = pattern(
+		3 * DurableSaveFile::ChunkSize,
+		'o'
+	);
+	const QByteArray newData = pattern(
+		2 * DurableSaveFile::ChunkSize + 1000,
+		'n'
+	);
+	QVERIFY(
+		save(
+			fileName,
+			oldData
+		)
+	);
+	m_stages.clear();
+	m_crashStage = stage;
+	QVERIFY(
+		save(
+			fileName,
+			newData,
+			true
+		)
+	);
+	QVERIFY(
+		!m_snapshot.isEmpty()
+	);
+	// restore the files as they were at the crash in a fresh directory
+	QTemporaryDir crashDir;
+	QVERIFY(
+		crashDir.isValid()
+	);
+	for(auto i = m_snapshot.constBegin(); i != m_snapshot.constEnd(); ++i)
+	{
+		QFile file(
+			crashDir.path() + "/" + i.key()
+		);
+		QVERIFY(
+			file.open(
+				QIODevice::WriteOnly
+			)
+		);
+		QCOMPARE(
+			file.write(
+				i.value()
+			),
+			i.value().size()
+		);
+	}
+	QVERIFY(
+		m_snapshot.contains(
+			"test.kdbx"
+		)
+	);
+	if(stage < DurableSaveFile::Renamed)
+	{
+		QCOMPARE(
+			m_snapshot.value(
+				"test.kdbx"
+			),
+			oldData
+		);
+		// the unfinished temporary file is left behind
+		QCOMPARE(
+			m_snapshot.size(),
+			2
+		);
+	}
+	else
+	{
+		QCOMPARE(
+			m_snapshot.value(
+				"test.kdbx"
+			),
+			newData
+		);
+		QCOMPARE(
+			m_snapshot.size(),
+			1
+		);
+	}
+	// a leftover temporary file doesn't get in the way of the next save
+	const QString crashFileName = crashDir.path() + "/test.kdbx";
+	QVERIFY(
+		save(
+			crashFileName,
+			newData
+		)
+	);
+	QCOMPARE(
+		readDirectory(
+			crashDir.path()
+		).value(
+			"test.kdbx"
+		),
+		newData
+	);
+}
+
+void TestDurableSaveFile::testSourceFailure()
+{
+	QTemporaryDir tempDir;
+	QVERIFY(
+		tempDir.isValid()
+	);
+	m_dirPath = tempDir.path();
+	const QString fileName = m_dirPath + "/test.kdbx";
+	const QByteArray oldData = pattern(
+		1000,
+		'o'
+	);
+	QVERIFY(
+		save(
+			fileName,
+			oldData
+		)
+	);
+	// the producer dies after the first chunk reached the temporary file
+	FailDevice source(
+		static_cast<int>(DurableSaveFile::ChunkSize + 100)
+	);
+	source.setData(
+		pattern(
+			2 * DurableSaveFile::ChunkSize,
+			'n'
+		)
+	);
+	QVERIFY(
+		source.open(
+			QIODevice::ReadOnly
+		)
+	);
+	{
+		DurableSaveFile saveFile(
+			fileName
+		);
+		QVERIFY(
+			saveFile.open(
+				QIODevice::WriteOnly
+			)
+		);
+		QByteArray buffer(
+			64 * 1024,
+			'\0'
+		);
+		bool failed = false;
+		while(!source.atEnd())
+		{
+			const qint64 readBytes = source.read(
+				buffer.data(),
+				buffer.size()
+			);
+			if(readBytes < 0)
+			{
+				failed = true;
+				break;
+			}
+			QCOMPARE(
+				saveFile.write(
+					buffer.constData(),
+					readBytes
+				),
+				readBytes
+			);
+		}
+		QVERIFY(
+			failed
+		);
+		QCOMPARE(
+			QDir(
+				m_dirPath
+			).entryList(
+				QDir::Files | QDir::Hidden
+			).size(),
+			2
+		);
+		// destroyed without commit
+	}
+	QHash<QString, QByteArray> files = readDirectory(
+		m_dirPath
+	);
+	QCOMPARE(
+		files.size(),
+		1
+	);
+	QCOMPARE(
+		files.value(
+			"test.kdbx"
+		),
+		oldData
+	);
+}
+
+void TestDurableSaveFile::testCancel()
+{
+	QTemporaryDir tempDir;
+	QVERIFY(
+		tempDir.isValid()
+	);
+	m_dirPath = tempDir.path();
+	const QString fileName = m_dirPath + "/test.kdbx";
+	DurableSaveFile saveFile(
+		fileName
+	);
+	QVERIFY(
+		saveFile.open(
+			QIODevice::WriteOnly
+		)
+	);
+	QCOMPARE(
+		saveFile.write(
+			pattern(
+				100,
+				'a'
+			)
+		),
+		qint64(
+			100
+		)
+	);
+	saveFile.cancelWriting();
+	QVERIFY(
+		!saveFile.isOpen()
+	);
+	QVERIFY(
+		!saveFile.commit()
+	);
+	QVERIFY(
+		QDir(
+			m_dirPath
+		).entryList(
+			QDir::Files | QDir::Hidden
+		).isEmpty()
+	);
+}
+
+QByteArray TestDurableSaveFile::pattern(
+	const int size,
+	const char seed
+)
+{
+	QByteArray data(
+		size,
+		'\0'
+	);
+	for(int i = 0; i < size; i++)
+	{
+		data[i] = static_cast<char>(seed + i % 251);
+	}
+	return data;
+}
+
+QHash<QString, QByteArray> TestDurableSaveFile::readDirectory(
+	const QString &path
+)
+{
+	QHash<QString, QByteArray> files;
+	const QDir dir(
+		path
+	);
+	const QStringList fileNames = dir.entryList(
+		QDir::Files | QDir::Hidden
+	);
+	for(const QString &fileName: fileNames)
+	{
+		QFile file(
+			dir.filePath(
+				fileName
+			)
+		);
+		if(file.open(
+			QIODevice::ReadOnly
+		))
+		{
+			files.insert(
+				fileName,
+				file.readAll()
+			);
+		}
+	}
+	return files;
+}
+
+bool TestDurableSaveFile::save(
+	const QString &fileName,
+	const QByteArray &data,
+	const bool observe
+)
+{
+	DurableSaveFile saveFile(
+		fileName
+	);
+	saveFile.setSizeHint(
+		3 * DurableSaveFile::ChunkSize
+	);
+	if(observe)
+	{
+		this->connect(
+			&saveFile,
+			&DurableSaveFile::sig_stageReached,
+			this,
+			&TestDurableSaveFile::do_stageReached
+		);
+	}
+	if(!saveFile.open(
+		QIODevice::WriteOnly
+	))
+	{
+		return false;
+	}
+	// uneven writes to exercise the chunk buffer
+	qint64 pos = 0;
+	while(pos < data.size())
+	{
+		const qint64 count = qMin(
+			data.size() - pos,
+			qint64(
+				100000
+			)
+		);
+		if(saveFile.write(
+			data.constData() + pos,
+			count
+		) != count)
+		{
+			return false;
+		}
+		pos += count;
+	}
+	return saveFile.commit();
+}
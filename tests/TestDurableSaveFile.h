@@ -0,0 +1,54 @@
+/*
+ *  Copyright (C) 2026 The cpp-password-manager contributors
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef KEEPASSX_TESTDURABLESAVEFILE_H
+#define KEEPASSX_TESTDURABLESAVEFILE_H
+#include <QHash>
+#include <QObject>
+#include "core/DurableSaveFile.h"
+
+class TestDurableSaveFile:public QObject
+{
+	Q_OBJECT public Q_SLOTS:
+	void do_stageReached(
+		DurableSaveFile::Stage stage
+	);
+private Q_SLOTS:
+	void init();
+	void testCommit();
+	void testCrash_data();
+	void testCrash();
+	void testSourceFailure();
+	void testCancel();
+private:
+	static QByteArray pattern(
+		int size,
+		char seed
+	);
+	static QHash<QString, QByteArray> readDirectory(
+		const QString &path
+	);
+	bool save(
+		const QString &fileName,
+		const QByteArray &data,
+		bool observe = false
+	);
+	QString m_dirPath;
+	int m_crashStage;
+	QList<DurableSaveFile::Stage> m_stages;
+	QHash<QString, QByteArray> m_snapshot;
+};
+#endif // KEEPASSX_TESTDURABLESAVEFILE_H
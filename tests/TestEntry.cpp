@@ -15,13 +15,60 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "TestEntry.h"
+#include <QSignalSpy>
 #include <QTest>
+#include "core/AttachmentStore.h"
+#include "core/Database.h"
 #include "core/Entry.h"
+#include "core/EntryDispatcher.h"
+#include "core/Group.h"
+#include "core/ListDeleter.h"
+#include "core/Metadata.h"
+#include "core/PlaceholderTemplate.h"
+#include "core/StringPool.h"
 #include "crypto/Crypto.h"
 QTEST_GUILESS_MAIN(
 	TestEntry
 )
 
+/**
+* An observer that counts the changes of the attributes it is set on.
+*/
+class CountingAttributesObserver final:public EntryAttributesObserver
+{
+public:
+	CountingAttributesObserver()
+		: addedCount(0),
+		modifiedCount(0),
+		defaultKeyModifiedCount(0)
+	{
+	}
+
+	virtual void modified() override
+	{
+		this->modifiedCount++;
+	}
+
+	virtual void defaultKeyModified() override
+	{
+		this->defaultKeyModifiedCount++;
+	}
+
+	virtual void added(
+		const QString &key
+	) override
+	{
+		Q_UNUSED(
+			key
+		);
+		this->addedCount++;
+	}
+
+	int addedCount;
+	int modifiedCount;
+	int defaultKeyModifiedCount;
+};
+
 void TestEntry::initTestCase()
 {
 	QVERIFY(
@@ -32,28 +79,22 @@ void TestEntry::initTestCase()
 void TestEntry::testHistoryItemDeletion()
 {
 	Entry* entry = new Entry();
-	QPointer<Entry> historyEntry = new Entry();
+	Entry* historyEntry = new Entry();
+	// the item is stored as a delta and deleted
 	entry->addHistoryItem(
 		historyEntry
 	);
 	QCOMPARE(
-		entry->getHistoryItems().size(),
+		entry->getHistoryCount(),
 		1
 	);
-	QList<Entry*> historyEntriesToRemove;
-	historyEntriesToRemove.append(
-		historyEntry
-	);
 	entry->removeHistoryItems(
-		historyEntriesToRemove
+		QList<int>() << 0
 	);
 	QCOMPARE(
-		entry->getHistoryItems().size(),
+		entry->getHistoryCount(),
 		0
 	);
-	QVERIFY(
-		historyEntry.isNull()
-	);
 	delete entry;
 }
 
@@ -150,7 +191,7 @@ void TestEntry::testClone()
 		QString("New Title")
 	);
 	QCOMPARE(
-		entryCloneNone->getHistoryItems().size(),
+		entryCloneNone->getHistoryCount(),
 		0
 	);
 	QCOMPARE(
@@ -171,7 +212,7 @@ void TestEntry::testClone()
 		QString("New Title")
 	);
 	QCOMPARE(
-		entryCloneNewUuid->getHistoryItems().size(),
+		entryCloneNewUuid->getHistoryCount(),
 		0
 	);
 	QCOMPARE(
@@ -190,7 +231,7 @@ void TestEntry::testClone()
 		QString("New Title")
 	);
 	QCOMPARE(
-		entryCloneResetTime->getHistoryItems().size(),
+		entryCloneResetTime->getHistoryCount(),
 		0
 	);
 	QVERIFY(
@@ -209,11 +250,15 @@ void TestEntry::testClone()
 		QString("New Title")
 	);
 	QCOMPARE(
-		entryCloneHistory->getHistoryItems().size(),
+		entryCloneHistory->getHistoryCount(),
 		1
 	);
+	QList<Entry*> historyItems = entryCloneHistory->buildHistoryItems();
+	const ListDeleter<Entry*> deleter(
+		&historyItems
+	);
 	QCOMPARE(
-		entryCloneHistory->getHistoryItems().at(0)->getTitle(),
+		historyItems.at(0)->getTitle(),
 		QString("Original Title")
 	);
 	QCOMPARE(
@@ -221,3 +266,829 @@ void TestEntry::testClone()
 		entryOrg->getTimeInfo().getCreationTime()
 	);
 }
+
+void TestEntry::testAttachmentStore()
+{
+	Database* db = new Database();
+	AttachmentStore* store = db->getAttachmentStore();
+	const QByteArray data(
+		"attachment data"
+	);
+	const QByteArray digest = AttachmentStore::digest(
+		data
+	);
+	Entry* entry1 = new Entry();
+	entry1->getAttachments()->set(
+		"a",
+		data
+	);
+	QCOMPARE(
+		store->count(),
+		0
+	);
+	entry1->setGroup(
+		db->getRootGroup()
+	);
+	QCOMPARE(
+		store->count(),
+		1
+	);
+	QCOMPARE(
+		entry1->getAttachments()->getDigest("a"),
+		digest
+	);
+	Entry* entry2 = new Entry();
+	entry2->setGroup(
+		db->getRootGroup()
+	);
+	entry2->getAttachments()->set(
+		"b",
+		data
+	);
+	QCOMPARE(
+		store->count(),
+		1
+	);
+	QCOMPARE(
+		store->getRefCount(digest),
+		2
+	);
+	QCOMPARE(
+		store->getTotalSize(),
+		static_cast<qint64>(data.size())
+	);
+	QVERIFY(
+		entry2->getAttachments()->getValue("b").constData() == entry1->
+		getAttachments()->getValue("a").constData()
+	);
+	entry2->beginUpdate();
+	entry2->getAttachments()->set(
+		"b",
+		"other data"
+	);
+	entry2->endUpdate();
+	// the delta encoded history holds its own reference
+	QCOMPARE(
+		store->getRefCount(digest),
+		2
+	);
+	QCOMPARE(
+		entry2->getHistoryCount(),
+		1
+	);
+	QCOMPARE(
+		store->count(),
+		2
+	);
+	QCOMPARE(
+		store->getRefCount(digest),
+		2
+	);
+	delete entry1;
+	QCOMPARE(
+		store->getRefCount(digest),
+		1
+	);
+	entry2->clearHistory();
+	QVERIFY(
+		!store->contains(digest)
+	);
+	QCOMPARE(
+		store->count(),
+		1
+	);
+	Database* db2 = new Database();
+	entry2->setGroup(
+		db2->getRootGroup()
+	);
+	QCOMPARE(
+		store->count(),
+		0
+	);
+	QCOMPARE(
+		store->getTotalSize(),
+		static_cast<qint64>(0)
+	);
+	QCOMPARE(
+		db2->getAttachmentStore()->count(),
+		1
+	);
+	delete db;
+	delete db2;
+}
+
+void TestEntry::testAttributes()
+{
+	EntryAttributes attributes;
+	QCOMPARE(
+		attributes.getKeys(),
+		QStringList() << "Notes" << "Password" << "Title" << "URL" << "UserName"
+	);
+	QCOMPARE(
+		attributes.getValue(EntryAttributes::Title),
+		QString("")
+	);
+	CountingAttributesObserver observer;
+	attributes.setObserver(
+		&observer
+	);
+	attributes.set(
+		"zzz",
+		"last"
+	);
+	attributes.set(
+		"Aaa",
+		"first",
+		true
+	);
+	attributes.set(
+		"Tx",
+		"between"
+	);
+	attributes.set(
+		EntryAttributes::TitleKey,
+		"title",
+		true
+	);
+	QCOMPARE(
+		observer.addedCount,
+		3
+	);
+	QCOMPARE(
+		observer.defaultKeyModifiedCount,
+		1
+	);
+	QCOMPARE(
+		observer.modifiedCount,
+		4
+	);
+	// the keys stay sorted like the QMap they replaced
+	QCOMPARE(
+		attributes.getKeys(),
+		QStringList() << "Aaa" << "Notes" << "Password" << "Title" << "Tx" <<
+		"URL" << "UserName" << "zzz"
+	);
+	QCOMPARE(
+		attributes.getCustomKeys(),
+		QStringList() << "Aaa" << "Tx" << "zzz"
+	);
+	QCOMPARE(
+		attributes.getValue("Title"),
+		QString("title")
+	);
+	QCOMPARE(
+		attributes.getValue(EntryAttributes::Title),
+		QString("title")
+	);
+	QVERIFY(
+		attributes.isProtected("Title")
+	);
+	QVERIFY(
+		attributes.isProtected("Aaa")
+	);
+	QVERIFY(
+		!attributes.isProtected("Tx")
+	);
+	QVERIFY(
+		attributes.hasKey("Tx")
+	);
+	QVERIFY(
+		!attributes.hasKey("missing")
+	);
+	QVERIFY(
+		attributes.getValue("missing").isNull()
+	);
+	// setting the same value and protection changes nothing
+	attributes.set(
+		"Aaa",
+		"first",
+		true
+	);
+	QCOMPARE(
+		observer.modifiedCount,
+		4
+	);
+	attributes.set(
+		"Aaa",
+		"first",
+		false
+	);
+	QVERIFY(
+		!attributes.isProtected("Aaa")
+	);
+	QCOMPARE(
+		observer.modifiedCount,
+		5
+	);
+	// standard keys can't be removed
+	attributes.remove(
+		EntryAttributes::TitleKey
+	);
+	attributes.remove(
+		"Tx"
+	);
+	QCOMPARE(
+		attributes.getCustomKeys(),
+		QStringList() << "Aaa" << "zzz"
+	);
+	EntryAttributes copy;
+	QVERIFY(
+		copy != attributes
+	);
+	QVERIFY(
+		copy.areCustomKeysDifferent(&attributes)
+	);
+	copy.copyDataFrom(
+		&attributes
+	);
+	QVERIFY(
+		copy == attributes
+	);
+	QVERIFY(
+		!copy.areCustomKeysDifferent(&attributes)
+	);
+	QCOMPARE(
+		copy.getAttributesSize(),
+		attributes.getAttributesSize()
+	);
+	attributes.clear();
+	QCOMPARE(
+		static_cast<int>(attributes.getKeys().size()),
+		EntryAttributes::StandardKeyCount
+	);
+	QVERIFY(
+		!attributes.isProtected("Title")
+	);
+}
+
+void TestEntry::testStringPool()
+{
+	Database* db = new Database();
+	StringPool* pool = db->getStringPool();
+	Entry* entry1 = new Entry();
+	entry1->setGroup(
+		db->getRootGroup()
+	);
+	entry1->setUsername(
+		QString("alice")
+	);
+	entry1->getAttributes()->set(
+		EntryAttributes::PasswordKey,
+		QString("secret"),
+		true
+	);
+	Entry* entry2 = new Entry();
+	entry2->setGroup(
+		db->getRootGroup()
+	);
+	entry2->setUsername(
+		QString("alice")
+	);
+	entry2->getAttributes()->set(
+		EntryAttributes::PasswordKey,
+		QString("secret"),
+		true
+	);
+	entry2->getAttributes()->set(
+		QString("Department"),
+		QString("sales")
+	);
+	QVERIFY(
+		entry1->getUsername().constData() == entry2->getUsername().constData()
+	);
+	QVERIFY(
+		pool->contains("alice")
+	);
+	QVERIFY(
+		pool->contains("Department")
+	);
+	QVERIFY(
+		pool->contains("sales")
+	);
+	// protected values are never pooled
+	QVERIFY(
+		!pool->contains("secret")
+	);
+	QVERIFY(
+		entry1->getPassword().constData() != entry2->getPassword().constData()
+	);
+	QCOMPARE(
+		pool->getHits(),
+		1
+	);
+	QCOMPARE(
+		pool->getSavedSize(),
+		static_cast<qint64>(5 * sizeof(QChar))
+	);
+	// values set before the entry joins the database are interned on the way in
+	Entry* entry3 = new Entry();
+	entry3->setUsername(
+		QString("alice")
+	);
+	entry3->getAttributes()->set(
+		QString("Department"),
+		QString("sales")
+	);
+	QVERIFY(
+		entry3->getUsername().constData() != entry1->getUsername().constData()
+	);
+	entry3->setGroup(
+		db->getRootGroup()
+	);
+	QVERIFY(
+		entry3->getUsername().constData() == entry1->getUsername().constData()
+	);
+	QVERIFY(
+		entry3->getAttributes()->getValue("Department").constData() == entry2->
+		getAttributes()->getValue("Department").constData()
+	);
+	QCOMPARE(
+		pool->getHits(),
+		4
+	);
+	const int count = pool->count();
+	// an entry leaving the database keeps its values but stops interning
+	Group* group = new Group();
+	entry3->setGroup(
+		group
+	);
+	entry3->setUsername(
+		QString("carol")
+	);
+	QVERIFY(
+		!pool->contains("carol")
+	);
+	delete group;
+	// interning a copy that is already shared is not counted as a saving
+	const qint64 saved = pool->getSavedSize();
+	pool->intern(
+		entry2->getUsername()
+	);
+	QCOMPARE(
+		pool->getSavedSize(),
+		saved
+	);
+	QCOMPARE(
+		pool->getHits(),
+		4
+	);
+	entry1->setUsername(
+		QString("bob")
+	);
+	entry2->setUsername(
+		QString("bob")
+	);
+	QCOMPARE(
+		pool->count(),
+		count + 1
+	);
+	pool->squeeze();
+	QVERIFY(
+		!pool->contains("alice")
+	);
+	QVERIFY(
+		pool->contains("bob")
+	);
+	QVERIFY(
+		pool->contains("sales")
+	);
+	QCOMPARE(
+		pool->getTotalSize(),
+		static_cast<qint64>((3 + 10 + 5) * sizeof(QChar))
+	);
+	delete db;
+}
+
+void TestEntry::testHistoryDeltas()
+{
+	Database* db = new Database();
+	db->getMetadata()->setHistoryMaxItems(
+		-1
+	);
+	db->getMetadata()->setHistoryMaxSize(
+		-1
+	);
+	Entry* entry = new Entry();
+	entry->setGroup(
+		db->getRootGroup()
+	);
+	entry->setTitle(
+		"title"
+	);
+	entry->getAttributes()->set(
+		"custom",
+		"value"
+	);
+	entry->getAttachments()->set(
+		"a",
+		QByteArray(
+			"attachment"
+		)
+	);
+	for(int i = 0; i < 10; ++i)
+	{
+		entry->beginUpdate();
+		entry->getAttributes()->set(
+			EntryAttributes::PasswordKey,
+			QString::number(
+				i
+			),
+			true
+		);
+		if(i == 4)
+		{
+			entry->getAttributes()->remove(
+				"custom"
+			);
+			entry->getAttachments()->remove(
+				"a"
+			);
+		}
+		entry->endUpdate();
+	}
+	QCOMPARE(
+		entry->getHistoryCount(),
+		10
+	);
+	QList<Entry*> built = entry->buildHistoryItems();
+	const ListDeleter<Entry*> deleter(
+		&built
+	);
+	QCOMPARE(
+		entry->getHistoryCount(),
+		10
+	);
+	QCOMPARE(
+		built.size(),
+		10
+	);
+	for(int j = 0; j < 10; ++j)
+	{
+		const Entry* item = built.at(
+			j
+		);
+		QCOMPARE(
+			item->getUUID(),
+			entry->getUUID()
+		);
+		QCOMPARE(
+			item->getTitle(),
+			QString("title")
+		);
+		QCOMPARE(
+			item->getPassword(),
+			j == 0 ? QString() : QString::number(j - 1)
+		);
+		QCOMPARE(
+			item->getAttributes()->isProtected(
+				EntryAttributes::PasswordKey
+			),
+			j > 0
+		);
+		QCOMPARE(
+			item->getAttributes()->hasKey(
+				"custom"
+			),
+			j <= 4
+		);
+		QCOMPARE(
+			item->getAttachments()->getValue(
+				"a"
+			),
+			j <= 4 ? QByteArray("attachment") : QByteArray()
+		);
+	}
+	Entry* clone = entry->clone(
+		Entry::CloneIncludeHistory
+	);
+	QCOMPARE(
+		clone->getHistoryCount(),
+		10
+	);
+	QList<Entry*> cloneItems = clone->buildHistoryItems();
+	const ListDeleter<Entry*> cloneDeleter(
+		&cloneItems
+	);
+	QCOMPARE(
+		cloneItems.at(4)->getAttributes()->getValue(
+			"custom"
+		),
+		QString("value")
+	);
+	delete clone;
+	// removing an item stores its newer neighbour against the older one
+	entry->removeHistoryItems(
+		QList<int>() << 4
+	);
+	QCOMPARE(
+		entry->getHistoryCount(),
+		9
+	);
+	QList<Entry*> remaining = entry->buildHistoryItems();
+	const ListDeleter<Entry*> remainingDeleter(
+		&remaining
+	);
+	QCOMPARE(
+		remaining.at(3)->getPassword(),
+		QString("2")
+	);
+	QVERIFY(
+		remaining.at(3)->getAttributes()->hasKey("custom")
+	);
+	QCOMPARE(
+		remaining.at(4)->getPassword(),
+		QString("4")
+	);
+	QVERIFY(
+		!remaining.at(4)->getAttributes()->hasKey("custom")
+	);
+	// truncating a delta encoded history keeps the newer items intact
+	db->getMetadata()->setHistoryMaxItems(
+		3
+	);
+	entry->beginUpdate();
+	entry->setTitle(
+		"new title"
+	);
+	entry->endUpdate();
+	QCOMPARE(
+		entry->getHistoryCount(),
+		3
+	);
+	QList<Entry*> truncated = entry->buildHistoryItems();
+	const ListDeleter<Entry*> truncatedDeleter(
+		&truncated
+	);
+	QCOMPARE(
+		truncated.at(0)->getPassword(),
+		QString("7")
+	);
+	QCOMPARE(
+		truncated.at(2)->getTitle(),
+		QString("title")
+	);
+	delete db;
+}
+
+void TestEntry::testDispatcher()
+{
+	Database* db = new Database();
+	Group* group = new Group();
+	group->setParent(
+		db->getRootGroup()
+	);
+	Entry* entry = new Entry();
+	entry->setGroup(
+		group
+	);
+	QSignalSpy spyModified(
+		db->getEntryDispatcher(),
+		&EntryDispatcher::sig_entryModified
+	);
+	QSignalSpy spyDataChanged(
+		db->getEntryDispatcher(),
+		&EntryDispatcher::sig_entryDataChanged
+	);
+	QSignalSpy spyDatabaseModified(
+		db,
+		&Database::sig_entryModified
+	);
+	entry->setTitle(
+		"title"
+	);
+	QCOMPARE(
+		spyModified.count(),
+		1
+	);
+	QCOMPARE(
+		spyModified.at(0).at(0).value<Entry*>(),
+		entry
+	);
+	QCOMPARE(
+		spyDataChanged.count(),
+		1
+	);
+	QCOMPARE(
+		spyDatabaseModified.count(),
+		1
+	);
+	// custom attributes modify the entry without changing displayed data
+	entry->getAttributes()->set(
+		"custom",
+		"value"
+	);
+	QCOMPARE(
+		spyModified.count(),
+		2
+	);
+	QCOMPARE(
+		spyDataChanged.count(),
+		1
+	);
+	// an entry moved to another database reports there
+	Database* other = new Database();
+	QSignalSpy spyOther(
+		other->getEntryDispatcher(),
+		&EntryDispatcher::sig_entryModified
+	);
+	entry->setGroup(
+		other->getRootGroup()
+	);
+	entry->setNotes(
+		"notes"
+	);
+	QCOMPARE(
+		spyOther.count(),
+		1
+	);
+	QCOMPARE(
+		spyModified.count(),
+		2
+	);
+	delete other;
+	delete db;
+}
+
+void TestEntry::testHistorySize()
+{
+	Database* db = new Database();
+	db->getMetadata()->setHistoryMaxItems(
+		-1
+	);
+	db->getMetadata()->setHistoryMaxSize(
+		2500
+	);
+	Entry* entry = new Entry();
+	entry->setGroup(
+		db->getRootGroup()
+	);
+	for(int i = 0; i < 10; ++i)
+	{
+		entry->beginUpdate();
+		entry->setTitle(
+			QString("t%1").arg(
+				i
+			)
+		);
+		entry->getAttachments()->set(
+			"file",
+			QByteArray(
+				1000,
+				static_cast<char>('a' + i)
+			)
+		);
+		entry->endUpdate();
+	}
+	// each item carries 1000 bytes of attachment and a 2 byte title
+	QCOMPARE(
+		entry->getHistoryCount(),
+		2
+	);
+	// attachments the entry holds itself don't count towards the size
+	Entry* shared = new Entry();
+	shared->setGroup(
+		db->getRootGroup()
+	);
+	shared->getAttachments()->set(
+		"file",
+		QByteArray(
+			2000,
+			'x'
+		)
+	);
+	for(int i = 0; i < 10; ++i)
+	{
+		shared->beginUpdate();
+		shared->setTitle(
+			QString("t%1").arg(
+				i
+			)
+		);
+		shared->endUpdate();
+	}
+	QCOMPARE(
+		shared->getHistoryCount(),
+		10
+	);
+	// shrinking the limit later only drops the oldest items
+	db->getMetadata()->setHistoryMaxSize(
+		1500
+	);
+	entry->truncateHistory();
+	QCOMPARE(
+		entry->getHistoryCount(),
+		1
+	);
+	QList<Entry*> items = entry->buildHistoryItems();
+	const ListDeleter<Entry*> deleter(
+		&items
+	);
+	QCOMPARE(
+		items.at(0)->getTitle(),
+		QString("t8")
+	);
+	shared->truncateHistory();
+	QCOMPARE(
+		shared->getHistoryCount(),
+		10
+	);
+	delete db;
+}
+
+void TestEntry::testResolvePlaceholders()
+{
+	Database* db = new Database();
+	Entry* entry = new Entry();
+	entry->setUUID(
+		UUID::random()
+	);
+	entry->setGroup(
+		db->getRootGroup()
+	);
+	entry->setTitle(
+		"Title"
+	);
+	entry->setUsername(
+		"user"
+	);
+	entry->setPassword(
+		"secret"
+	);
+	entry->setURL(
+		"https://example.com/?u={USERNAME}"
+	);
+	entry->getAttributes()->set(
+		"custom",
+		"value"
+	);
+	Entry* other = new Entry();
+	other->setUUID(
+		UUID::random()
+	);
+	other->setGroup(
+		db->getRootGroup()
+	);
+	other->setTitle(
+		"Other Server"
+	);
+	other->setUsername(
+		"admin"
+	);
+	QCOMPARE(
+		entry->resolvePlaceholders(
+			"{title}:{USERNAME}:{Password}"
+		),
+		QString("Title:user:secret")
+	);
+	// values are resolved again
+	QCOMPARE(
+		entry->resolvePlaceholders(
+			entry->getURL()
+		),
+		QString("https://example.com/?u=user")
+	);
+	QCOMPARE(
+		entry->resolvePlaceholders(
+			"{S:custom}{S:missing}{UNKNOWN}{"
+		),
+		QString("value{S:missing}{UNKNOWN}{")
+	);
+	QCOMPARE(
+		entry->resolvePlaceholders(
+			QString("{REF:U@I:%1}").arg(
+				other->getUUID().toHex()
+			)
+		),
+		QString("admin")
+	);
+	QCOMPARE(
+		entry->resolvePlaceholders(
+			"{REF:U@T:other server}"
+		),
+		QString("admin")
+	);
+	QCOMPARE(
+		entry->resolvePlaceholders(
+			"{REF:U@T:nothing}"
+		),
+		QString("{REF:U@T:nothing}")
+	);
+	// references back to the entry itself stop at the depth limit
+	other->setNotes(
+		QString("{REF:N@I:%1}").arg(
+			other->getUUID().toHex()
+		)
+	);
+	QCOMPARE(
+		other->resolvePlaceholders(
+			"{NOTES}"
+		),
+		other->getNotes()
+	);
+	QVERIFY(
+		!PlaceholderTemplate::compile(
+			"plain"
+		).hasPlaceholders()
+	);
+	delete db;
+}
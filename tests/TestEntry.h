@@ -26,5 +26,12 @@ class TestEntry:public QObject
 	void testHistoryItemDeletion();
 	void testCopyDataFrom();
 	void testClone();
+	void testAttachmentStore();
+	void testAttributes();
+	void testStringPool();
+	void testHistoryDeltas();
+	void testDispatcher();
+	void testHistorySize();
+	void testResolvePlaceholders();
 };
 #endif // KEEPASSX_TESTENTRY_H
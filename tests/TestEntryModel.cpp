@@ -18,6 +18,7 @@
 #include <QSignalSpy>
 #include <QTest>
 #include "modeltest.h"
+#include "core/Database.h"
 #include "core/DatabaseIcons.h"
 #include "core/Entry.h"
 #include "core/Group.h"
@@ -186,9 +187,7 @@ void TestEntryModel::test()
 
 void TestEntryModel::testAttachmentsModel()
 {
-	EntryAttachments* entryAttachments = new EntryAttachments(
-		this
-	);
+	EntryAttachments* entryAttachments = new EntryAttachments();
 	EntryAttachmentsModel* model = new EntryAttachmentsModel(
 		this
 	);
@@ -307,9 +306,7 @@ void TestEntryModel::testAttachmentsModel()
 
 void TestEntryModel::testAttributesModel()
 {
-	EntryAttributes* entryAttributes = new EntryAttributes(
-		this
-	);
+	EntryAttributes* entryAttributes = new EntryAttributes();
 	EntryAttributesModel* model = new EntryAttributesModel(
 		this
 	);
@@ -426,6 +423,7 @@ void TestEntryModel::testAttributesModel()
 	);
 	delete modelTest;
 	delete model;
+	delete entryAttributes;
 }
 
 void TestEntryModel::testDefaultIconModel()
@@ -640,3 +638,201 @@ void TestEntryModel::testDatabaseDelete()
 	delete modelTest;
 	delete model;
 }
+
+void TestEntryModel::testTransaction()
+{
+	Database* db = new Database();
+	Group* group1 = new Group();
+	group1->setParent(
+		db->getRootGroup()
+	);
+	Group* group2 = new Group();
+	group2->setParent(
+		db->getRootGroup()
+	);
+	Entry* entry1 = new Entry();
+	entry1->setGroup(
+		group1
+	);
+	Entry* entry2 = new Entry();
+	entry2->setGroup(
+		group1
+	);
+	Entry* entry3 = new Entry();
+	entry3->setGroup(
+		group1
+	);
+	EntryModel* model = new EntryModel(
+		this
+	);
+	ModelTest* modelTest = new ModelTest(
+		model,
+		this
+	);
+	model->do_setGroup(
+		group1
+	);
+	QPersistentModelIndex index3 = model->index(
+		2,
+		1
+	);
+	QPersistentModelIndex index2 = model->index(
+		1,
+		1
+	);
+	QSignalSpy spyLayoutAboutToChange(
+		model,
+		&EntryModel::layoutAboutToBeChanged
+	);
+	QSignalSpy spyLayoutChanged(
+		model,
+		&EntryModel::layoutChanged
+	);
+	QSignalSpy spyAdded(
+		model,
+		&EntryModel::rowsInserted
+	);
+	QSignalSpy spyRemoved(
+		model,
+		&EntryModel::rowsRemoved
+	);
+	db->beginTransaction();
+	entry1->setGroup(
+		group2
+	);
+	delete entry2;
+	Entry* entry4 = new Entry();
+	entry4->setGroup(
+		group1
+	);
+	entry4->setTitle(
+		"title4"
+	);
+	db->commitTransaction();
+	QCOMPARE(
+		spyLayoutAboutToChange.count(),
+		1
+	);
+	QCOMPARE(
+		spyLayoutChanged.count(),
+		1
+	);
+	QCOMPARE(
+		spyAdded.count(),
+		0
+	);
+	QCOMPARE(
+		spyRemoved.count(),
+		0
+	);
+	QCOMPARE(
+		model->rowCount(),
+		2
+	);
+	QCOMPARE(
+		model->entryFromIndex(
+			index3
+		),
+		entry3
+	);
+	QCOMPARE(
+		index3.row(),
+		0
+	);
+	QVERIFY(
+		!index2.isValid()
+	);
+	QCOMPARE(
+		model->data(
+			model->index(
+				1,
+				1
+			)
+		).toString(),
+		QString("title4")
+	);
+	// entry list mode drops the entries moved to the recycle bin
+	model->setEntryList(
+		group1->getEntries() + group2->getEntries()
+	);
+	QCOMPARE(
+		model->rowCount(),
+		3
+	);
+	db->beginTransaction();
+	db->recycleEntry(
+		entry1
+	);
+	db->recycleEntry(
+		entry4
+	);
+	db->commitTransaction();
+	QCOMPARE(
+		model->rowCount(),
+		1
+	);
+	QCOMPARE(
+		model->entryFromIndex(
+			model->index(
+				0,
+				1
+			)
+		),
+		entry3
+	);
+	delete modelTest;
+	delete model;
+	delete db;
+}
+
+void TestEntryModel::benchmarkMoveEntries()
+{
+	QByteArray env = qgetenv(
+		"BENCHMARK"
+	);
+	if(env.isEmpty() || env == "0" || env == "no")
+	{
+		QSKIP(
+			"Benchmark skipped. Set env variable BENCHMARK=1 to enable."
+		);
+	}
+	Database* db = new Database();
+	Group* group1 = new Group();
+	group1->setParent(
+		db->getRootGroup()
+	);
+	Group* group2 = new Group();
+	group2->setParent(
+		db->getRootGroup()
+	);
+	for(int i = 0; i < 20000; i++)
+	{
+		Entry* entry = new Entry();
+		entry->setGroup(
+			group1
+		);
+	}
+	EntryModel* model = new EntryModel(
+		this
+	);
+	model->do_setGroup(
+		group1
+	);
+	QBENCHMARK_ONCE
+	{
+		db->beginTransaction();
+		for(Entry* entry: group1->getEntries())
+		{
+			entry->setGroup(
+				group2
+			);
+		}
+		db->commitTransaction();
+	}
+	QCOMPARE(
+		model->rowCount(),
+		0
+	);
+	delete model;
+	delete db;
+}
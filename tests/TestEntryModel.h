@@ -29,5 +29,7 @@ class TestEntryModel:public QObject
 	void testCustomIconModel();
 	void testProxyModel();
 	void testDatabaseDelete();
+	void testTransaction();
+	void benchmarkMoveEntries();
 };
 #endif // KEEPASSX_TESTENTRYMODEL_H
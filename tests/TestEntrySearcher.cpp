@@ -15,7 +15,15 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "TestEntrySearcher.h"
+#include <QCoreApplication>
+#include <QSignalSpy>
 #include <QTest>
+#include "core/Database.h"
+#include "core/EntrySearchTask.h"
+#include "core/Global.h"
+#include "core/GlobalSearchTask.h"
+#include "core/SearchIndex.h"
+#include "core/UrlIndex.h"
 QTEST_GUILESS_MAIN(
 	TestEntrySearcher
 )
@@ -256,3 +264,1462 @@ void TestEntrySearcher::testAllAttributesAreSearched()
 		1
 	);
 }
+
+void TestEntrySearcher::testSearchIndex()
+{
+	Database* db = new Database();
+	Group* root = db->getRootGroup();
+	Group* group1 = new Group();
+	group1->setParent(
+		root
+	);
+	Group* group11 = new Group();
+	group11->setParent(
+		group1
+	);
+	Group* group2 = new Group();
+	group2->setParent(
+		root
+	);
+	group2->setSearchingEnabled(
+		Group::Disable
+	);
+	Entry* entry1 = new Entry();
+	entry1->setGroup(
+		root
+	);
+	entry1->setTitle(
+		"Mail Server"
+	);
+	Entry* entry2 = new Entry();
+	entry2->setGroup(
+		group11
+	);
+	entry2->setTitle(
+		"mail archive"
+	);
+	Entry* entry3 = new Entry();
+	entry3->setGroup(
+		group2
+	);
+	entry3->setTitle(
+		"mail backup"
+	);
+	Entry* entry4 = new Entry();
+	entry4->setGroup(
+		group1
+	);
+	entry4->setTitle(
+		"bank"
+	);
+	Entry* entry5 = new Entry();
+	entry5->setGroup(
+		root
+	);
+	entry5->setURL(
+		"https://MAIL.example.com"
+	);
+	SearchIndex* index = db->getSearchIndex();
+	QVERIFY(
+		!index->isUpToDate()
+	);
+	// results come in the order of the group tree, like without an index
+	m_searchResult = m_entrySearcher.search(
+		"mail",
+		root,
+		Qt::CaseInsensitive
+	);
+	QCOMPARE(
+		m_searchResult,
+		QList<Entry*>() << entry1 << entry5 << entry2
+	);
+	QVERIFY(
+		index->isUpToDate()
+	);
+	QCOMPARE(
+		index->count(),
+		5
+	);
+	m_searchResult = m_entrySearcher.search(
+		"Mail",
+		root,
+		Qt::CaseSensitive
+	);
+	QCOMPARE(
+		m_searchResult,
+		QList<Entry*>() << entry1
+	);
+	m_searchResult = m_entrySearcher.search(
+		"mail ARCH",
+		root,
+		Qt::CaseInsensitive
+	);
+	QCOMPARE(
+		m_searchResult,
+		QList<Entry*>() << entry2
+	);
+	m_searchResult = m_entrySearcher.search(
+		"mailbox",
+		root,
+		Qt::CaseInsensitive
+	);
+	QVERIFY(
+		m_searchResult.isEmpty()
+	);
+	// words too short for the index fall back to matching every entry
+	m_searchResult = m_entrySearcher.search(
+		"ma",
+		group1,
+		Qt::CaseInsensitive
+	);
+	QCOMPARE(
+		m_searchResult,
+		QList<Entry*>() << entry2
+	);
+	// modified entries are indexed again
+	entry4->setTitle(
+		"Mailbox"
+	);
+	QVERIFY(
+		!index->isUpToDate()
+	);
+	m_searchResult = m_entrySearcher.search(
+		"mailbox",
+		root,
+		Qt::CaseInsensitive
+	);
+	QCOMPARE(
+		m_searchResult,
+		QList<Entry*>() << entry4
+	);
+	db->beginTransaction();
+	entry2->setTitle(
+		"archive"
+	);
+	db->commitTransaction();
+	entry3->setGroup(
+		group1
+	);
+	delete entry5;
+	m_searchResult = m_entrySearcher.search(
+		"mail",
+		root,
+		Qt::CaseInsensitive
+	);
+	QCOMPARE(
+		m_searchResult,
+		QList<Entry*>() << entry1 << entry4 << entry3
+	);
+	QCOMPARE(
+		index->count(),
+		4
+	);
+	// queued entries are indexed on a worker from the event loop
+	Entry* entry6 = new Entry();
+	entry6->setGroup(
+		root
+	);
+	entry6->setTitle(
+		"relay"
+	);
+	QVERIFY(
+		!index->isUpToDate()
+	);
+	QTRY_VERIFY(
+		index->isUpToDate()
+	);
+	QCOMPARE(
+		index->count(),
+		5
+	);
+	// an entry modified while the worker runs is indexed again
+	entry6->setTitle(
+		"mail relay"
+	);
+	QCoreApplication::processEvents();
+	entry6->setTitle(
+		"mail relay 2"
+	);
+	QTRY_VERIFY(
+		index->isUpToDate()
+	);
+	m_searchResult = m_entrySearcher.search(
+		"mail",
+		root,
+		Qt::CaseInsensitive
+	);
+	QCOMPARE(
+		m_searchResult,
+		QList<Entry*>() << entry1 << entry6 << entry4 << entry3
+	);
+	QCOMPARE(
+		m_entrySearcher.search(
+			"relay 2",
+			root,
+			Qt::CaseInsensitive
+		),
+		QList<Entry*>() << entry6
+	);
+	delete db;
+}
+
+void TestEntrySearcher::testSearchTask()
+{
+	Database* db = new Database();
+	Group* root = db->getRootGroup();
+	for(int i = 0; i < 3000; ++i)
+	{
+		Entry* entry = new Entry();
+		entry->setGroup(
+			root
+		);
+		entry->setTitle(
+			QString("entry %1").arg(
+				i
+			)
+		);
+	}
+	EntrySearchTask task;
+	QSignalSpy spyFound(
+		&task,
+		&EntrySearchTask::sig_entriesFound
+	);
+	QSignalSpy spyFinished(
+		&task,
+		&EntrySearchTask::sig_finished
+	);
+	task.start(
+		"entry 1",
+		root,
+		Qt::CaseInsensitive
+	);
+	QVERIFY(
+		task.isRunning()
+	);
+	QVERIFY(
+		spyFinished.wait()
+	);
+	QVERIFY(
+		!task.isRunning()
+	);
+	QVERIFY(
+		spyFound.first().at(
+			1
+		).toBool()
+	);
+	QList<Entry*> found;
+	for(const QList<QVariant> &args: asConst(
+			spyFound
+		))
+	{
+		found.append(
+			args.at(
+				0
+			).value<QList<Entry*>>()
+		);
+	}
+	QCOMPARE(
+		found,
+		m_entrySearcher.search(
+			"entry 1",
+			root,
+			Qt::CaseInsensitive
+		)
+	);
+	// a cancelled search reports nothing
+	spyFound.clear();
+	spyFinished.clear();
+	task.start(
+		"entry",
+		root,
+		Qt::CaseInsensitive
+	);
+	task.cancel();
+	QTest::qWait(
+		100
+	);
+	QCOMPARE(
+		spyFound.count(),
+		0
+	);
+	QCOMPARE(
+		spyFinished.count(),
+		0
+	);
+	// a modification while the search runs starts it over
+	task.start(
+		"changed",
+		root,
+		Qt::CaseInsensitive
+	);
+	Entry* changed = root->getEntries().at(
+		42
+	);
+	changed->setTitle(
+		"changed"
+	);
+	QVERIFY(
+		spyFinished.wait()
+	);
+	QCOMPARE(
+		spyFound.count(),
+		1
+	);
+	QCOMPARE(
+		spyFound.first().at(
+			0
+		).value<QList<Entry*>>(),
+		QList<Entry*>() << changed
+	);
+	delete db;
+}
+
+void TestEntrySearcher::testRefinement()
+{
+	Database* db = new Database();
+	Group* root = db->getRootGroup();
+	Entry* entry1 = new Entry();
+	entry1->setGroup(
+		root
+	);
+	entry1->setTitle(
+		"GitHub"
+	);
+	Entry* entry2 = new Entry();
+	entry2->setGroup(
+		root
+	);
+	entry2->setTitle(
+		"GitLab"
+	);
+	Entry* entry3 = new Entry();
+	entry3->setGroup(
+		root
+	);
+	entry3->setURL(
+		"https://github.com"
+	);
+	EntrySearcher searcher;
+	QCOMPARE(
+		searcher.search(
+			"git",
+			root,
+			Qt::CaseInsensitive
+		),
+		QList<Entry*>() << entry1 << entry2 << entry3
+	);
+	QVERIFY(
+		searcher.hasCachedMatches()
+	);
+	QCOMPARE(
+		searcher.search(
+			"gith",
+			root,
+			Qt::CaseInsensitive
+		),
+		QList<Entry*>() << entry1 << entry3
+	);
+	QCOMPARE(
+		searcher.search(
+			"github com",
+			root,
+			Qt::CaseInsensitive
+		),
+		QList<Entry*>() << entry3
+	);
+	// a query that drops characters is searched from scratch
+	QCOMPARE(
+		searcher.search(
+			"git",
+			root,
+			Qt::CaseInsensitive
+		),
+		QList<Entry*>() << entry1 << entry2 << entry3
+	);
+	QCOMPARE(
+		searcher.search(
+			"Git",
+			root,
+			Qt::CaseSensitive
+		),
+		QList<Entry*>() << entry1 << entry2
+	);
+	// modifications drop the cached matches
+	entry2->setTitle(
+		"GitHub Enterprise"
+	);
+	QVERIFY(
+		!searcher.hasCachedMatches()
+	);
+	QCOMPARE(
+		searcher.search(
+			"GitHub",
+			root,
+			Qt::CaseSensitive
+		),
+		QList<Entry*>() << entry1 << entry2
+	);
+	Entry* entry4 = new Entry();
+	entry4->setGroup(
+		root
+	);
+	entry4->setTitle(
+		"GitHub Gist"
+	);
+	QCOMPARE(
+		searcher.search(
+			"GitHub Gist",
+			root,
+			Qt::CaseSensitive
+		),
+		QList<Entry*>() << entry4
+	);
+	delete db;
+	QVERIFY(
+		!searcher.hasCachedMatches()
+	);
+	// groups outside of a database can't report changes, nothing is cached
+	searcher.search(
+		"",
+		m_groupRoot,
+		Qt::CaseInsensitive
+	);
+	QVERIFY(
+		!searcher.hasCachedMatches()
+	);
+}
+
+void TestEntrySearcher::testSearchedText()
+{
+	Database* db = new Database();
+	Group* root = db->getRootGroup();
+	Entry* entry1 = new Entry();
+	entry1->setGroup(
+		root
+	);
+	entry1->setTitle(
+		"Bank"
+	);
+	entry1->setPassword(
+		"password123"
+	);
+	entry1->getAttributes()->set(
+		EntryAttributes::NotesKey,
+		"pin 4711",
+		true
+	);
+	Entry* entry2 = new Entry();
+	entry2->setGroup(
+		root
+	);
+	// characters outside the BMP fold like in QString::contains()
+	entry2->setTitle(
+		QString::fromUtf8(
+			"\xF0\x90\x90\x80xyz"
+		)
+	);
+	SearchIndex* index = db->getSearchIndex();
+	index->update();
+	SearchItem item;
+	QVERIFY(
+		index->getItem(
+			entry1,
+			&item
+		)
+	);
+	// empty fields keep their separator, the protected notes are left out
+	QCOMPARE(
+		item.foldedText,
+		QString("bank\n\n")
+	);
+	QCOMPARE(
+		item.fieldStarts[0],
+		0
+	);
+	QCOMPARE(
+		item.fieldStarts[2],
+		6
+	);
+	QCOMPARE(
+		item.fieldStarts[3],
+		-1
+	);
+	QCOMPARE(
+		item.protectedValues,
+		QStringList() << "pin 4711"
+	);
+	// protected values aren't copied but still searched, passwords never
+	QCOMPARE(
+		m_entrySearcher.search(
+			"4711",
+			root,
+			Qt::CaseInsensitive
+		),
+		QList<Entry*>() << entry1
+	);
+	QVERIFY(
+		m_entrySearcher.search(
+			"password123",
+			root,
+			Qt::CaseInsensitive
+		).isEmpty()
+	);
+	const QString lower = QString::fromUtf8(
+		"\xF0\x90\x90\xA8xyz"
+	);
+	QVERIFY(
+		entry2->getTitle().contains(
+			lower,
+			Qt::CaseInsensitive
+		)
+	);
+	QCOMPARE(
+		SearchIndex::fold(
+			entry2->getTitle()
+		),
+		lower
+	);
+	QCOMPARE(
+		m_entrySearcher.search(
+			lower,
+			root,
+			Qt::CaseInsensitive
+		),
+		QList<Entry*>() << entry2
+	);
+	QVERIFY(
+		m_entrySearcher.search(
+			lower,
+			root,
+			Qt::CaseSensitive
+		).isEmpty()
+	);
+	delete db;
+}
+
+void TestEntrySearcher::testRankedSearch()
+{
+	Database* db = new Database();
+	Group* root = db->getRootGroup();
+	Entry* entryNotes = new Entry();
+	entryNotes->setGroup(
+		root
+	);
+	entryNotes->setTitle(
+		"Notes only"
+	);
+	entryNotes->setNotes(
+		"mail"
+	);
+	Entry* entryOld = new Entry();
+	entryOld->setGroup(
+		root
+	);
+	entryOld->setTitle(
+		"Mail"
+	);
+	TimeInfo timeInfo = entryOld->getTimeInfo();
+	timeInfo.setLastModificationTime(
+		QDateTime::currentDateTimeUtc().addYears(
+			-1
+		)
+	);
+	entryOld->setTimeInfo(
+		timeInfo
+	);
+	Entry* entryInside = new Entry();
+	entryInside->setGroup(
+		root
+	);
+	entryInside->setTitle(
+		"Gmail"
+	);
+	Entry* entryWord = new Entry();
+	entryWord->setGroup(
+		root
+	);
+	entryWord->setTitle(
+		"My mail"
+	);
+	Entry* entryUsername = new Entry();
+	entryUsername->setGroup(
+		root
+	);
+	entryUsername->setUsername(
+		"mail"
+	);
+	Entry* entryTitle = new Entry();
+	entryTitle->setGroup(
+		root
+	);
+	entryTitle->setTitle(
+		"Mail"
+	);
+	// the title beats the other fields, the start of a field or word beats
+	// the inside of one and recent entries beat old ones
+	const QList<Entry*> ranked = QList<Entry*>() << entryTitle << entryWord
+		<< entryOld << entryInside << entryUsername << entryNotes;
+	EntrySearcher searcher;
+	qsizetype matchCount = 0;
+	QCOMPARE(
+		searcher.searchRanked(
+			"mail",
+			root,
+			Qt::CaseInsensitive,
+			10,
+			&matchCount
+		),
+		ranked
+	);
+	QCOMPARE(
+		matchCount,
+		qsizetype(6)
+	);
+	QCOMPARE(
+		searcher.searchRanked(
+			"mail",
+			root,
+			Qt::CaseInsensitive,
+			2,
+			&matchCount
+		),
+		ranked.mid(
+			0,
+			2
+		)
+	);
+	QCOMPARE(
+		matchCount,
+		qsizetype(6)
+	);
+	// the task reports the following matches when asked for more
+	EntrySearchTask task;
+	QSignalSpy spyFound(
+		&task,
+		&EntrySearchTask::sig_entriesFound
+	);
+	QSignalSpy spyFinished(
+		&task,
+		&EntrySearchTask::sig_finished
+	);
+	task.start(
+		"mail",
+		root,
+		Qt::CaseInsensitive,
+		2
+	);
+	QVERIFY(
+		spyFinished.wait()
+	);
+	QCOMPARE(
+		spyFound.count(),
+		1
+	);
+	QCOMPARE(
+		spyFound.at(
+			0
+		).at(
+			0
+		).value<QList<Entry*>>(),
+		ranked.mid(
+			0,
+			2
+		)
+	);
+	QVERIFY(
+		spyFound.at(
+			0
+		).at(
+			1
+		).toBool()
+	);
+	QVERIFY(
+		task.hasMore()
+	);
+	task.fetchMore();
+	QVERIFY(
+		spyFinished.wait()
+	);
+	QCOMPARE(
+		spyFound.count(),
+		2
+	);
+	QCOMPARE(
+		spyFound.at(
+			1
+		).at(
+			0
+		).value<QList<Entry*>>(),
+		ranked.mid(
+			2,
+			2
+		)
+	);
+	QVERIFY(
+		!spyFound.at(
+			1
+		).at(
+			1
+		).toBool()
+	);
+	task.fetchMore();
+	QVERIFY(
+		spyFinished.wait()
+	);
+	QCOMPARE(
+		spyFound.at(
+			2
+		).at(
+			0
+		).value<QList<Entry*>>(),
+		ranked.mid(
+			4
+		)
+	);
+	QVERIFY(
+		!task.hasMore()
+	);
+	// an edit between two pages neither repeats nor skips a match
+	task.start(
+		"mail",
+		root,
+		Qt::CaseInsensitive,
+		2
+	);
+	QVERIFY(
+		spyFinished.wait()
+	);
+	entryTitle->setTitle(
+		"Other"
+	);
+	task.fetchMore();
+	QVERIFY(
+		spyFinished.wait()
+	);
+	QCOMPARE(
+		spyFound.last().at(
+			0
+		).value<QList<Entry*>>(),
+		ranked.mid(
+			2,
+			3
+		)
+	);
+	QVERIFY(
+		!spyFound.last().at(
+			1
+		).toBool()
+	);
+	delete db;
+}
+
+void TestEntrySearcher::testQueryLanguage()
+{
+	Database* db = new Database();
+	Group* root = db->getRootGroup();
+	Group* work = new Group();
+	work->setName(
+		"Work"
+	);
+	work->setParent(
+		root
+	);
+	Entry* entryRetired = new Entry();
+	entryRetired->setGroup(
+		root
+	);
+	entryRetired->setTitle(
+		"Intranet"
+	);
+	entryRetired->setURL(
+		"https://internal.corp/wiki"
+	);
+	entryRetired->setTags(
+		"wiki; retired"
+	);
+	Entry* entryOld = new Entry();
+	entryOld->setGroup(
+		root
+	);
+	entryOld->setTitle(
+		"Mail"
+	);
+	entryOld->setURL(
+		"https://internal.corp/mail"
+	);
+	entryOld->setTags(
+		"mail"
+	);
+	Entry* entryExpired = new Entry();
+	entryExpired->setGroup(
+		root
+	);
+	entryExpired->setTitle(
+		"Bank"
+	);
+	entryExpired->setNotes(
+		"call internal.corp"
+	);
+	entryExpired->setPassword(
+		"secret"
+	);
+	entryExpired->getAttributes()->set(
+		"Account",
+		"12345"
+	);
+	Entry* entryWork = new Entry();
+	entryWork->setGroup(
+		work
+	);
+	entryWork->setTitle(
+		"Corp"
+	);
+	entryWork->setUsername(
+		"admin"
+	);
+	entryWork->setURL(
+		"https://internal.corp"
+	);
+	for(Entry* entry: QList<Entry*>() << entryRetired << entryOld)
+	{
+		TimeInfo timeInfo = entry->getTimeInfo();
+		timeInfo.setLastModificationTime(
+			QDateTime::currentDateTimeUtc().addYears(
+				-2
+			)
+		);
+		entry->setTimeInfo(
+			timeInfo
+		);
+	}
+	TimeInfo timeInfo = entryExpired->getTimeInfo();
+	timeInfo.setExpires(
+		true
+	);
+	timeInfo.setExpiryTime(
+		QDateTime::currentDateTimeUtc().addDays(
+			-1
+		)
+	);
+	entryExpired->setTimeInfo(
+		timeInfo
+	);
+	// the cheap predicates are checked first, only words use the index
+	const SearchQuery query = EntrySearcher::parseQuery(
+		"url:internal.corp -tag:retired modified:>365d",
+		Qt::CaseInsensitive
+	);
+	QCOMPARE(
+		query.plan.size(),
+		qsizetype(3)
+	);
+	QVERIFY(
+		query.plan.at(
+			0
+		).kind == SearchPredicate::Modified
+	);
+	QVERIFY(
+		query.plan.at(
+			1
+		).kind == SearchPredicate::Tag
+	);
+	QVERIFY(
+		query.plan.at(
+			1
+		).negated
+	);
+	QVERIFY(
+		query.plan.at(
+			2
+		).kind == SearchPredicate::Field
+	);
+	QCOMPARE(
+		query.words,
+		QStringList() << "internal.corp"
+	);
+	EntrySearcher searcher;
+	QCOMPARE(
+		searcher.search(
+			"url:internal.corp -tag:retired modified:>365d",
+			root,
+			Qt::CaseInsensitive
+		),
+		QList<Entry*>() << entryOld
+	);
+	QCOMPARE(
+		searcher.search(
+			"internal.corp",
+			root,
+			Qt::CaseInsensitive
+		),
+		QList<Entry*>() << entryRetired << entryOld << entryExpired <<
+		entryWork
+	);
+	QCOMPARE(
+		searcher.search(
+			"url:internal.corp",
+			root,
+			Qt::CaseInsensitive
+		),
+		QList<Entry*>() << entryRetired << entryOld << entryWork
+	);
+	QCOMPARE(
+		searcher.search(
+			"notes:INTERNAL title:bank",
+			root,
+			Qt::CaseInsensitive
+		),
+		QList<Entry*>() << entryExpired
+	);
+	QVERIFY(
+		searcher.search(
+			"notes:INTERNAL",
+			root,
+			Qt::CaseSensitive
+		).isEmpty()
+	);
+	QCOMPARE(
+		searcher.search(
+			"-tag:RETIRED",
+			root,
+			Qt::CaseInsensitive
+		),
+		QList<Entry*>() << entryOld << entryExpired << entryWork
+	);
+	QCOMPARE(
+		searcher.search(
+			"modified:<30d",
+			root,
+			Qt::CaseInsensitive
+		),
+		QList<Entry*>() << entryExpired << entryWork
+	);
+	QCOMPARE(
+		searcher.search(
+			"expired:yes",
+			root,
+			Qt::CaseInsensitive
+		),
+		QList<Entry*>() << entryExpired
+	);
+	QCOMPARE(
+		searcher.search(
+			"expired:no group:work",
+			root,
+			Qt::CaseInsensitive
+		),
+		QList<Entry*>() << entryWork
+	);
+	QCOMPARE(
+		searcher.search(
+			"attr:Account=234",
+			root,
+			Qt::CaseInsensitive
+		),
+		QList<Entry*>() << entryExpired
+	);
+	QCOMPARE(
+		searcher.search(
+			"attr:Account",
+			root,
+			Qt::CaseInsensitive
+		),
+		QList<Entry*>() << entryExpired
+	);
+	// passwords are never searched
+	QVERIFY(
+		searcher.search(
+			"attr:Password=secret",
+			root,
+			Qt::CaseInsensitive
+		).isEmpty()
+	);
+	// quotes keep a phrase together
+	QCOMPARE(
+		searcher.search(
+			"internal call",
+			root,
+			Qt::CaseInsensitive
+		),
+		QList<Entry*>() << entryExpired
+	);
+	QVERIFY(
+		searcher.search(
+			"\"internal call\"",
+			root,
+			Qt::CaseInsensitive
+		).isEmpty()
+	);
+	QCOMPARE(
+		searcher.search(
+			"notes:\"call internal\"",
+			root,
+			Qt::CaseInsensitive
+		),
+		QList<Entry*>() << entryExpired
+	);
+	// unknown prefixes are part of plain words
+	QCOMPARE(
+		searcher.search(
+			"https://internal.corp/",
+			root,
+			Qt::CaseInsensitive
+		),
+		QList<Entry*>() << entryRetired << entryOld
+	);
+	QCOMPARE(
+		searcher.search(
+			"-https://internal.corp/",
+			root,
+			Qt::CaseInsensitive
+		),
+		QList<Entry*>() << entryExpired << entryWork
+	);
+	delete db;
+}
+
+void TestEntrySearcher::testUrlIndex()
+{
+	QCOMPARE(
+		UrlIndex::getHost(
+			"user:password@Example.COM.:8080/path?a=b"
+		),
+		QString("example.com")
+	);
+	QCOMPARE(
+		UrlIndex::getHost(
+			"mailto:user@example.org"
+		),
+		QString("example.org")
+	);
+	QCOMPARE(
+		UrlIndex::getHost(
+			"https://[::1]:443/"
+		),
+		QString("[::1]")
+	);
+	QVERIFY(
+		UrlIndex::getHost(
+			"/path@example.com"
+		).isEmpty()
+	);
+	QCOMPARE(
+		UrlIndex::getLabels(
+			"192.168.0.1"
+		),
+		QStringList() << "192.168.0.1"
+	);
+	QCOMPARE(
+		UrlIndex::getDomainLabelCount(
+			UrlIndex::getLabels(
+				"shop.example.co.uk"
+			)
+		),
+		qsizetype(3)
+	);
+	Database* db = new Database();
+	Group* root = db->getRootGroup();
+	QList<Entry*> entries;
+	for(const QString &url: QStringList() << "https://sso.corp.example.com"
+		<< "corp.example.com" << "https://example.com" <<
+		"https://mail.example.com:8443/inbox" << "vpn.corp.example.com" <<
+		"https://a.sso.corp.example.com" << "https://example.org" <<
+		"https://shop.example.co.uk" << "https://other.co.uk")
+	{
+		Entry* entry = new Entry();
+		entry->setGroup(
+			root
+		);
+		entry->setURL(
+			url
+		);
+		entries.append(
+			entry
+		);
+	}
+	UrlIndex* index = db->getUrlIndex();
+	// the host, its parent domains, then the hosts sharing most labels
+	const QList<UrlMatch> matches = index->lookup(
+		"https://SSO.corp.example.com/login?next=/"
+	);
+	QCOMPARE(
+		matches.size(),
+		qsizetype(6)
+	);
+	const QList<int> expected = QList<int>() << 0 << 1 << 2 << 5 << 4 << 3;
+	for(qsizetype i = 0; i < matches.size(); i++)
+	{
+		QCOMPARE(
+			matches.at(
+				i
+			).entry,
+			entries.at(
+				expected.at(
+					i
+				)
+			)
+		);
+	}
+	QVERIFY(
+		matches.at(
+			0
+		).kind == UrlMatch::Host
+	);
+	QVERIFY(
+		matches.at(
+			2
+		).kind == UrlMatch::ParentDomain
+	);
+	QVERIFY(
+		matches.at(
+			3
+		).kind == UrlMatch::Domain
+	);
+	// co.uk isn't a registrable domain, other.co.uk is another one
+	const QList<UrlMatch> ukMatches = index->lookup(
+		"example.co.uk"
+	);
+	QCOMPARE(
+		ukMatches.size(),
+		qsizetype(1)
+	);
+	QCOMPARE(
+		ukMatches.first().entry,
+		entries.at(
+			7
+		)
+	);
+	// modified and removed entries are indexed again before a lookup
+	entries.at(
+		3
+	)->setURL(
+		"https://example.org/mail"
+	);
+	delete entries.at(
+		6
+	);
+	QCOMPARE(
+		index->lookup(
+			"mail.example.com"
+		).size(),
+		qsizetype(5)
+	);
+	const QList<UrlMatch> orgMatches = index->lookup(
+		"example.org"
+	);
+	QCOMPARE(
+		orgMatches.size(),
+		qsizetype(1)
+	);
+	QCOMPARE(
+		orgMatches.first().entry,
+		entries.at(
+			3
+		)
+	);
+	QVERIFY(
+		index->lookup(
+			"unknown.example.net"
+		).isEmpty()
+	);
+	delete db;
+}
+
+void TestEntrySearcher::testParallelScan()
+{
+	Database* db = new Database();
+	Group* root = db->getRootGroup();
+	Group* child = new Group();
+	child->setParent(
+		root
+	);
+	for(int i = 0; i < 5000; ++i)
+	{
+		Entry* entry = new Entry();
+		entry->setGroup(
+			i % 2 == 0 ? root : child
+		);
+		entry->setTitle(
+			QString("entry %1").arg(
+				i
+			)
+		);
+		if(i % 7 == 0)
+		{
+			entry->setNotes(
+				"seven"
+			);
+		}
+	}
+	// the ranges are merged back in the order of the items
+	const SearchQuery query = EntrySearcher::parseQuery(
+		"entry",
+		Qt::CaseInsensitive
+	);
+	EntrySearcher serial;
+	serial.setParallelThreshold(
+		0
+	);
+	QVERIFY(
+		!serial.isParallel(
+			5000
+		)
+	);
+	const QList<SearchItem> items = serial.collectItems(
+		query,
+		root
+	);
+	QCOMPARE(
+		EntrySearcher::matchItems(
+			query,
+			items,
+			10,
+			items.size(),
+			true
+		),
+		EntrySearcher::matchItems(
+			query,
+			items,
+			10,
+			items.size(),
+			false
+		)
+	);
+	// the items built off the snapshot of the index are the same, in the
+	// same order
+	for(const QString &term: QStringList() << "entry" << "seven")
+	{
+		const SearchQuery scopeQuery = EntrySearcher::parseQuery(
+			term,
+			Qt::CaseInsensitive
+		);
+		for(const Group* group: QList<const Group*>() << root << child)
+		{
+			EntrySearcher searcher;
+			const QList<SearchItem> built = EntrySearcher::buildItems(
+				scopeQuery,
+				searcher.collectScope(
+					scopeQuery,
+					group
+				)
+			);
+			const QList<SearchItem> collected = searcher.collectItems(
+				scopeQuery,
+				group
+			);
+			QCOMPARE(
+				built.size(),
+				collected.size()
+			);
+			for(qsizetype i = 0; i < built.size(); ++i)
+			{
+				QCOMPARE(
+					built.at(i).entry,
+					collected.at(i).entry
+				);
+				QCOMPARE(
+					built.at(i).foldedText,
+					collected.at(i).foldedText
+				);
+				QCOMPARE(
+					built.at(i).lastModified,
+					collected.at(i).lastModified
+				);
+			}
+		}
+	}
+	EntrySearcher parallel;
+	parallel.setParallelThreshold(
+		100
+	);
+	QVERIFY(
+		parallel.isParallel(
+			100
+		)
+	);
+	for(const QString &term: QStringList() << "entry 1" << "seven" << "" <<
+		"-seven entry 4")
+	{
+		QCOMPARE(
+			parallel.search(
+				term,
+				root,
+				Qt::CaseInsensitive
+			),
+			serial.search(
+				term,
+				root,
+				Qt::CaseInsensitive
+			)
+		);
+	}
+	EntrySearchTask task;
+	task.setParallelThreshold(
+		100
+	);
+	QSignalSpy spyFound(
+		&task,
+		&EntrySearchTask::sig_entriesFound
+	);
+	QSignalSpy spyFinished(
+		&task,
+		&EntrySearchTask::sig_finished
+	);
+	task.start(
+		"seven",
+		root,
+		Qt::CaseInsensitive
+	);
+	QVERIFY(
+		spyFinished.wait()
+	);
+	QList<Entry*> found;
+	for(const QList<QVariant> &args: asConst(
+			spyFound
+		))
+	{
+		found.append(
+			args.at(
+				0
+			).value<QList<Entry*>>()
+		);
+	}
+	QCOMPARE(
+		found,
+		serial.search(
+			"seven",
+			root,
+			Qt::CaseInsensitive
+		)
+	);
+	delete db;
+}
+
+void TestEntrySearcher::testGlobalSearch()
+{
+	Database* db1 = new Database();
+	Entry* entryTitle = new Entry();
+	entryTitle->setGroup(
+		db1->getRootGroup()
+	);
+	entryTitle->setTitle(
+		"Mail"
+	);
+	Entry* entryNotes = new Entry();
+	entryNotes->setGroup(
+		db1->getRootGroup()
+	);
+	entryNotes->setTitle(
+		"Notes only"
+	);
+	entryNotes->setNotes(
+		"mail"
+	);
+	Database* db2 = new Database();
+	Entry* entryWord = new Entry();
+	entryWord->setGroup(
+		db2->getRootGroup()
+	);
+	entryWord->setTitle(
+		"My mail"
+	);
+	Entry* entryUsername = new Entry();
+	entryUsername->setGroup(
+		db2->getRootGroup()
+	);
+	entryUsername->setUsername(
+		"mail"
+	);
+	Database* db3 = new Database();
+	Entry* entryOther = new Entry();
+	entryOther->setGroup(
+		db3->getRootGroup()
+	);
+	entryOther->setTitle(
+		"Bank"
+	);
+	GlobalSearchTask task;
+	QSignalSpy spyFound(
+		&task,
+		&GlobalSearchTask::sig_entriesFound
+	);
+	QSignalSpy spyFinished(
+		&task,
+		&GlobalSearchTask::sig_finished
+	);
+	task.start(
+		"mail",
+		QList<Database*>() << db1 << db2 << db3,
+		Qt::CaseInsensitive,
+		3
+	);
+	QVERIFY(
+		task.isRunning()
+	);
+	QCOMPARE(
+		task.getDatabaseCount(),
+		qsizetype(3)
+	);
+	QVERIFY(
+		spyFinished.wait()
+	);
+	QVERIFY(
+		!task.isRunning()
+	);
+	QCOMPARE(
+		task.getFinishedCount(),
+		qsizetype(3)
+	);
+	// the merged matches are reported as each database finishes
+	QCOMPARE(
+		spyFound.count(),
+		3
+	);
+	for(int i = 1; i < spyFound.count(); i++)
+	{
+		QVERIFY(
+			spyFound.at(
+				i
+			).at(
+				0
+			).value<QList<Entry*>>().size() >= spyFound.at(
+				i - 1
+			).at(
+				0
+			).value<QList<Entry*>>().size()
+		);
+	}
+	// ranked across the databases and cut to the limit
+	QCOMPARE(
+		spyFound.last().at(
+			0
+		).value<QList<Entry*>>(),
+		QList<Entry*>() << entryTitle << entryWord << entryUsername
+	);
+	QCOMPARE(
+		spyFinished.count(),
+		1
+	);
+	// a search without databases finishes right away
+	task.start(
+		"mail",
+		QList<Database*>(),
+		Qt::CaseInsensitive,
+		3
+	);
+	QVERIFY(
+		!task.isRunning()
+	);
+	QCOMPARE(
+		spyFinished.count(),
+		2
+	);
+	QVERIFY(
+		spyFound.last().at(
+			0
+		).value<QList<Entry*>>().isEmpty()
+	);
+	delete db1;
+	delete db2;
+	delete db3;
+}
@@ -28,6 +28,15 @@ class TestEntrySearcher:public QObject
 	void testAndConcatenationInSearch();
 	void testSearch();
 	void testAllAttributesAreSearched();
+	void testSearchIndex();
+	void testSearchTask();
+	void testRefinement();
+	void testSearchedText();
+	void testRankedSearch();
+	void testQueryLanguage();
+	void testUrlIndex();
+	void testParallelScan();
+	void testGlobalSearch();
 private:
 	Group* m_groupRoot;
 	EntrySearcher m_entrySearcher;
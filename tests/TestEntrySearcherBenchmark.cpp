@@ -0,0 +1,714 @@
+/*
+ *  Copyright (C) 2026 The cpp-password-manager contributors
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "TestEntrySearcherBenchmark.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QTest>
+#include <algorithm>
+#include <iterator>
+#include "core/Database.h"
+#include "core/Entry.h"
+#include "core/EntrySearcher.h"
+#include "core/Global.h"
+#include "core/Group.h"
+#include "core/SearchIndex.h"
+#include "crypto/Crypto.h"
+#include "format/KeePass2XmlReader.h"
+QTEST_GUILESS_MAIN(
+	TestEntrySearcherBenchmark
+)
+// calls to malloc, calloc and realloc of all threads. glibc exports its
+// allocator under a second name, so the test can wrap it
+static QAtomicInteger<quint64> allocationCount(
+	0
+);
+#if defined(__GLIBC__)
+extern "C"
+{
+	void* __libc_malloc(
+		size_t size
+	);
+	void* __libc_calloc(
+		size_t count,
+		size_t size
+	);
+	void* __libc_realloc(
+		void* pointer,
+		size_t size
+	);
+
+	void* malloc(
+		size_t size
+	) noexcept
+	{
+		allocationCount.fetchAndAddRelaxed(
+			1
+		);
+		return __libc_malloc(
+			size
+		);
+	}
+
+	void* calloc(
+		size_t count,
+		size_t size
+	) noexcept
+	{
+		allocationCount.fetchAndAddRelaxed(
+			1
+		);
+		return __libc_calloc(
+			count,
+			size
+		);
+	}
+
+	void* realloc(
+		void* pointer,
+		size_t size
+	) noexcept
+	{
+		allocationCount.fetchAndAddRelaxed(
+			1
+		);
+		return __libc_realloc(
+			pointer,
+			size
+		);
+	}
+}
+static const bool CountsAllocations = true;
+#else
+static const bool CountsAllocations = false;
+#endif
+static const QStringList Words = QStringList() << "mail" << "bank" << "shop"
+	<< "admin" << "administrator" << "backup" << "server" << "router"
+	<< "cloud" << "forum" << "office" << "home" << "work" << "private"
+	<< "account" << "login" << "portal" << "wifi" << "vpn" << "database"
+	<< "github" << "social" << "music" << "video" << "travel" << "insurance"
+	<< "tax" << "school" << "family" << "games" << "news" << "phone"
+	<< "printer" << "camera" << "storage" << "hosting" << "domain"
+	<< "payment" << "wallet" << "exchange" << "support" << "test"
+	<< "staging" << "production" << "legacy" << "old" << "new" << "shared";
+static const QStringList TopLevelDomains = QStringList() << "com" << "org"
+	<< "net" << "de" << "co.uk" << "io" << "fr" << "com.au";
+// words in a title, the short ones are the most common
+static const int TitleWordCounts[] = {1, 1, 1, 2, 2, 2, 3, 4};
+// groups are nested at most this deep
+static const int MaxGroupDepth = 12;
+static const int EntriesPerGroup = 25;
+
+static QString getWord(
+	QRandomGenerator* random
+)
+{
+	return Words.at(
+		random->bounded(
+			static_cast<int>(Words.size())
+		)
+	);
+}
+
+static QString getWords(
+	QRandomGenerator* random,
+	const int count
+)
+{
+	QStringList words_;
+	for(int i_ = 0; i_ < count; i_++)
+	{
+		words_.append(
+			getWord(
+				random
+			)
+		);
+	}
+	return words_.join(
+		' '
+	);
+}
+
+static QString getHost(
+	QRandomGenerator* random
+)
+{
+	QString host_ = getWord(
+		random
+	);
+	if(random->bounded(
+		3
+	) == 0)
+	{
+		host_.prepend(
+			getWord(
+				random
+			) + "."
+		);
+	}
+	return host_ + "." + TopLevelDomains.at(
+		random->bounded(
+			static_cast<int>(TopLevelDomains.size())
+		)
+	);
+}
+
+static void fillEntry(
+	Entry* entry,
+	QRandomGenerator* random
+)
+{
+	QString title_ = getWords(
+		random,
+		TitleWordCounts[random->bounded(
+			static_cast<int>(std::size(
+				TitleWordCounts
+			))
+		)]
+	);
+	title_[0] = title_.at(
+		0
+	).toUpper();
+	entry->setTitle(
+		title_
+	);
+	switch(random->bounded(
+		10
+	))
+	{
+		case 0:
+		case 1:
+			break;
+		case 2:
+		case 3:
+		case 4:
+			entry->setUsername(
+				getWord(
+					random
+				) + QString::number(
+					random->bounded(
+						1000
+					)
+				)
+			);
+			break;
+		default:
+			entry->setUsername(
+				getWord(
+					random
+				) + "." + getWord(
+					random
+				) + "@" + getHost(
+					random
+				)
+			);
+			break;
+	}
+	if(random->bounded(
+		5
+	) != 0)
+	{
+		QString url_ = "https://" + getHost(
+			random
+		);
+		if(random->bounded(
+			2
+		) == 0)
+		{
+			url_.append(
+				"/" + getWord(
+					random
+				)
+			);
+		}
+		entry->setURL(
+			url_
+		);
+	}
+	// most entries have no notes, the others from a line to a paragraph
+	if(random->bounded(
+		10
+	) < 3)
+	{
+		entry->setNotes(
+			getWords(
+				random,
+				1 + random->bounded(
+					random->bounded(
+						2
+					) == 0 ? 8 : 60
+				)
+			)
+		);
+	}
+	QString password_;
+	const int passwordLength_ = 12 + random->bounded(
+		21
+	);
+	for(int i_ = 0; i_ < passwordLength_; i_++)
+	{
+		password_.append(
+			QChar(
+				33 + random->bounded(
+					94
+				)
+			)
+		);
+	}
+	entry->setPassword(
+		password_
+	);
+}
+
+static Database* createCorpus(
+	const int entryCount
+)
+{
+	QRandomGenerator random_(
+		static_cast<quint32>(entryCount)
+	);
+	const auto db_ = new Database();
+	QList<Group*> groups_;
+	QList<int> depths_;
+	groups_.append(
+		db_->getRootGroup()
+	);
+	depths_.append(
+		0
+	);
+	// every group hangs below a random earlier one, which gives a few wide
+	// levels near the root and long chains below
+	const int groupCount_ = std::max(
+		1,
+		entryCount / EntriesPerGroup
+	);
+	for(int i_ = 1; i_ < groupCount_; i_++)
+	{
+		int parent_ = random_.bounded(
+			static_cast<int>(groups_.size())
+		);
+		if(depths_.at(
+			parent_
+		) >= MaxGroupDepth)
+		{
+			parent_ = 0;
+		}
+		const auto group_ = new Group();
+		group_->setName(
+			getWord(
+				&random_
+			)
+		);
+		group_->setParent(
+			groups_.at(
+				parent_
+			)
+		);
+		groups_.append(
+			group_
+		);
+		depths_.append(
+			depths_.at(
+				parent_
+			) + 1
+		);
+	}
+	for(int i_ = 0; i_ < entryCount; i_++)
+	{
+		const auto entry_ = new Entry();
+		fillEntry(
+			entry_,
+			&random_
+		);
+		entry_->setGroup(
+			groups_.at(
+				random_.bounded(
+					static_cast<int>(groups_.size())
+				)
+			)
+		);
+	}
+	return db_;
+}
+
+static qint64 getPercentile(
+	const QList<qint64> &sorted,
+	const int percentile
+)
+{
+	// nearest rank
+	const qsizetype rank_ = (sorted.size() * percentile + 99) / 100;
+	return sorted.at(
+		std::max(
+			qsizetype(1),
+			rank_
+		) - 1
+	);
+}
+
+void TestEntrySearcherBenchmark::initTestCase()
+{
+	QByteArray env = qgetenv(
+		"BENCHMARK"
+	);
+	if(env.isEmpty() || env == "0" || env == "no")
+	{
+		QSKIP(
+			"Benchmark skipped. Set env variable BENCHMARK=1 to enable, BENCHMARK=all to include 1M entries."
+		);
+	}
+	QVERIFY(
+		Crypto::init()
+	);
+}
+
+void TestEntrySearcherBenchmark::cleanupTestCase()
+{
+	const QString outputPath = qEnvironmentVariable(
+		"BENCHMARK_OUTPUT"
+	);
+	if(!outputPath.isEmpty() && !m_results.isEmpty())
+	{
+		QFile file(
+			outputPath
+		);
+		QVERIFY(
+			file.open(
+				QIODevice::WriteOnly | QIODevice::Truncate
+			)
+		);
+		file.write(
+			QJsonDocument(
+				m_results
+			).toJson()
+		);
+	}
+	qDeleteAll(
+		m_corpora
+	);
+	m_corpora.clear();
+}
+
+void TestEntrySearcherBenchmark::benchmarkSearch_data()
+{
+	QTest::addColumn<QString>(
+		"corpus"
+	);
+	QTest::addColumn<int>(
+		"entryCount"
+	);
+	QTest::addColumn<QString>(
+		"searchTerm"
+	);
+	QTest::addColumn<bool>(
+		"warm"
+	);
+	QList<QPair<QString, int>> corpora;
+	corpora.append(
+		qMakePair(
+			QString(
+				"10k"
+			),
+			10000
+		)
+	);
+	corpora.append(
+		qMakePair(
+			QString(
+				"100k"
+			),
+			100000
+		)
+	);
+	if(qgetenv(
+		"BENCHMARK"
+	) == "all")
+	{
+		corpora.append(
+			qMakePair(
+				QString(
+					"1M"
+				),
+				1000000
+			)
+		);
+	}
+	// a database exported as KeePass 2 XML, like a real vault
+	if(!qEnvironmentVariable(
+		"BENCHMARK_XML"
+	).isEmpty())
+	{
+		corpora.append(
+			qMakePair(
+				QString(
+					"xml"
+				),
+				0
+			)
+		);
+	}
+	QList<QPair<QString, QString>> queries;
+	queries.append(
+		qMakePair(
+			QString(
+				"short"
+			),
+			QString(
+				"ma"
+			)
+		)
+	);
+	queries.append(
+		qMakePair(
+			QString(
+				"long"
+			),
+			QString(
+				"administrator"
+			)
+		)
+	);
+	queries.append(
+		qMakePair(
+			QString(
+				"multi-word"
+			),
+			QString(
+				"mail backup server"
+			)
+		)
+	);
+	queries.append(
+		qMakePair(
+			QString(
+				"no match"
+			),
+			QString(
+				"qzxvk"
+			)
+		)
+	);
+	for(const QPair<QString, int> &corpus: asConst(
+			corpora
+		))
+	{
+		for(const QPair<QString, QString> &query: asConst(
+				queries
+			))
+		{
+			for(const bool warm: {false, true})
+			{
+				QTest::newRow(
+					qPrintable(
+						QString(
+							"%1 %2 %3"
+						).arg(
+							corpus.first,
+							query.first,
+							QString(
+								warm ? "warm" : "cold"
+							)
+						)
+					)
+				) << corpus.first << corpus.second << query.second << warm;
+			}
+		}
+	}
+}
+
+void TestEntrySearcherBenchmark::benchmarkSearch()
+{
+	QFETCH(
+		QString,
+		corpus
+	);
+	QFETCH(
+		int,
+		entryCount
+	);
+	QFETCH(
+		QString,
+		searchTerm
+	);
+	QFETCH(
+		bool,
+		warm
+	);
+	Database* db = getCorpus(
+		corpus,
+		entryCount
+	);
+	QVERIFY(
+		db
+	);
+	db->getSearchIndex()->update();
+	Group* root = db->getRootGroup();
+	// small corpora get more runs, so their p99 isn't just the maximum
+	const int runs = std::clamp(
+		1000000 / std::max(
+			db->getSearchIndex()->count(),
+			1
+		),
+		5,
+		100
+	);
+	EntrySearcher searcher;
+	qsizetype matchCount = searcher.search(
+		searchTerm,
+		root,
+		Qt::CaseInsensitive
+	).size();
+	QList<qint64> timings;
+	QElapsedTimer timer;
+	const quint64 allocationsBefore = allocationCount.loadRelaxed();
+	for(int i = 0; i < runs; i++)
+	{
+		// a cold search has no earlier result to refine, a warm one repeats
+		// the last search
+		if(!warm)
+		{
+			searcher.do_clearCache();
+		}
+		timer.start();
+		matchCount = searcher.search(
+			searchTerm,
+			root,
+			Qt::CaseInsensitive
+		).size();
+		timings.append(
+			timer.nsecsElapsed()
+		);
+	}
+	const quint64 allocations = (allocationCount.loadRelaxed() -
+		allocationsBefore) / runs;
+	std::sort(
+		timings.begin(),
+		timings.end()
+	);
+	const qint64 p50 = getPercentile(
+		timings,
+		50
+	);
+	const qint64 p99 = getPercentile(
+		timings,
+		99
+	);
+	// the median goes to the regular benchmark output, -o file,csv or
+	// -o file,xml make it machine readable
+	QTest::setBenchmarkResult(
+		static_cast<qreal>(p50),
+		QTest::WalltimeNanoseconds
+	);
+	QJsonObject result;
+	result.insert(
+		"corpus",
+		corpus
+	);
+	result.insert(
+		"entries",
+		db->getSearchIndex()->count()
+	);
+	result.insert(
+		"searchTerm",
+		searchTerm
+	);
+	result.insert(
+		"mode",
+		warm ? "warm" : "cold"
+	);
+	result.insert(
+		"runs",
+		runs
+	);
+	result.insert(
+		"matches",
+		matchCount
+	);
+	result.insert(
+		"p50Nanoseconds",
+		p50
+	);
+	result.insert(
+		"p99Nanoseconds",
+		p99
+	);
+	if(CountsAllocations)
+	{
+		result.insert(
+			"allocationsPerSearch",
+			static_cast<qint64>(allocations)
+		);
+	}
+	m_results.append(
+		result
+	);
+	qInfo(
+		"%s",
+		QJsonDocument(
+			result
+		).toJson(
+			QJsonDocument::Compact
+		).constData()
+	);
+}
+
+Database* TestEntrySearcherBenchmark::getCorpus(
+	const QString &name,
+	const int entryCount
+)
+{
+	if(Database* db = m_corpora.value(
+		name
+	))
+	{
+		return db;
+	}
+	Database* db;
+	if(name == "xml")
+	{
+		KeePass2XmlReader reader;
+		db = reader.readDatabase(
+			qEnvironmentVariable(
+				"BENCHMARK_XML"
+			)
+		);
+		if(reader.hasError())
+		{
+			qWarning(
+				"Reader error: %s",
+				qPrintable(
+					reader.getErrorString()
+				)
+			);
+			delete db;
+			return nullptr;
+		}
+	}
+	else
+	{
+		db = createCorpus(
+			entryCount
+		);
+	}
+	m_corpora.insert(
+		name,
+		db
+	);
+	return db;
+}
@@ -0,0 +1,39 @@
+/*
+ *  Copyright (C) 2026 The cpp-password-manager contributors
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef KEEPASSX_TESTENTRYSEARCHERBENCHMARK_H
+#define KEEPASSX_TESTENTRYSEARCHERBENCHMARK_H
+#include <QHash>
+#include <QJsonArray>
+#include <QObject>
+class Database;
+
+class TestEntrySearcherBenchmark:public QObject
+{
+	Q_OBJECT private Q_SLOTS:
+	void initTestCase();
+	void cleanupTestCase();
+	void benchmarkSearch_data();
+	void benchmarkSearch();
+private:
+	Database* getCorpus(
+		const QString &name,
+		int entryCount
+	);
+	QHash<QString, Database*> m_corpora;
+	QJsonArray m_results;
+};
+#endif // KEEPASSX_TESTENTRYSEARCHERBENCHMARK_H
@@ -19,6 +19,7 @@
 #include <QTest>
 #include "core/ToDbExporter.h"
 #include "core/Group.h"
+#include "core/ListDeleter.h"
 #include "core/Metadata.h"
 #include "crypto/Crypto.h"
 QTEST_GUILESS_MAIN(
@@ -135,11 +136,15 @@ void TestExporter::testToDbExporter()
 		entryOrg->getIconNumber()
 	);
 	QCOMPARE(
-		entryExp->getHistoryItems().size(),
+		entryExp->getHistoryCount(),
 		1
 	);
+	QList<Entry*> historyItems = entryExp->buildHistoryItems();
+	const ListDeleter<Entry*> historyDeleter(
+		&historyItems
+	);
 	QCOMPARE(
-		entryExp->getHistoryItems().at(0)->getIconUUID(),
+		historyItems.at(0)->getIconUUID(),
 		iconUuid
 	);
 	delete dbOrg;
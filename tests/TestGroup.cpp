@@ -585,15 +585,27 @@ void TestGroup::testSignals()
 
 void TestGroup::testEntries()
 {
+	Database* db = new Database();
 	Group* group = new Group();
-	QPointer<Entry> entry1 = new Entry();
+	group->setParent(
+		db->getRootGroup()
+	);
+	Entry* entry1 = new Entry();
+	entry1->setUUID(
+		UUID::random()
+	);
 	entry1->setGroup(
 		group
 	);
-	QPointer<Entry> entry2 = new Entry();
+	Entry* entry2 = new Entry();
+	entry2->setUUID(
+		UUID::random()
+	);
 	entry2->setGroup(
 		group
 	);
+	const UUID uuid1 = entry1->getUUID();
+	const UUID uuid2 = entry2->getUUID();
 	QCOMPARE(
 		group->getEntries().size(),
 		2
@@ -604,13 +616,26 @@ void TestGroup::testEntries()
 	QVERIFY(
 		group->getEntries().at(1) == entry2
 	);
+	// entries record their deletion when they are deleted
 	delete group;
+	QList<UUID> deleted;
+	for(const DeletedObject &deletedObject: db->getDeletedObjects())
+	{
+		deleted.append(
+			deletedObject.uuid
+		);
+	}
 	QVERIFY(
-		entry1.isNull()
+		deleted.contains(
+			uuid1
+		)
 	);
 	QVERIFY(
-		entry2.isNull()
+		deleted.contains(
+			uuid2
+		)
 	);
+	delete db;
 }
 
 void TestGroup::testDeleteSignals()
@@ -902,7 +927,7 @@ void TestGroup::testClone()
 		43
 	);
 	QCOMPARE(
-		clonedGroupEntry->getHistoryItems().size(),
+		clonedGroupEntry->getHistoryCount(),
 		0
 	);
 	Group* clonedSubGroup = clonedGroup->getChildren().at(
@@ -1063,3 +1088,256 @@ void TestGroup::testCopyCustomIcons()
 		qRgb(4, 5, 6)
 	);
 }
+
+void TestGroup::testResolve()
+{
+	Database* db = new Database();
+	Database* db2 = new Database();
+	Group* root = db->getRootGroup();
+	QCOMPARE(
+		db->resolveGroup(root->getUUID()),
+		root
+	);
+	Group* group = new Group();
+	group->setUuid(
+		UUID::random()
+	);
+	Entry* entry = new Entry();
+	entry->setUUID(
+		UUID::random()
+	);
+	entry->setGroup(
+		group
+	);
+	QVERIFY(
+		!db->resolveEntry(entry->getUUID())
+	);
+	// attaching a subtree indexes all of it
+	group->setParent(
+		root
+	);
+	QCOMPARE(
+		db->resolveGroup(group->getUUID()),
+		group
+	);
+	QCOMPARE(
+		db->resolveEntry(entry->getUUID()),
+		entry
+	);
+	QVERIFY(
+		db->isIndexConsistent()
+	);
+	// changed UUIDs
+	const UUID oldUuid = entry->getUUID();
+	entry->setUUID(
+		UUID::random()
+	);
+	QVERIFY(
+		!db->resolveEntry(oldUuid)
+	);
+	QCOMPARE(
+		db->resolveEntry(entry->getUUID()),
+		entry
+	);
+	const UUID oldGroupUuid = group->getUUID();
+	group->setUuid(
+		UUID::random()
+	);
+	QVERIFY(
+		!db->resolveGroup(oldGroupUuid)
+	);
+	QCOMPARE(
+		db->resolveGroup(group->getUUID()),
+		group
+	);
+	QVERIFY(
+		db->isIndexConsistent()
+	);
+	// moving to another database
+	group->setParent(
+		db2->getRootGroup()
+	);
+	QVERIFY(
+		!db->resolveGroup(group->getUUID())
+	);
+	QVERIFY(
+		!db->resolveEntry(entry->getUUID())
+	);
+	QCOMPARE(
+		db2->resolveEntry(entry->getUUID()),
+		entry
+	);
+	QVERIFY(
+		db->isIndexConsistent()
+	);
+	QVERIFY(
+		db2->isIndexConsistent()
+	);
+	// moving an entry within the database
+	Group* group2 = new Group();
+	group2->setUuid(
+		UUID::random()
+	);
+	group2->setParent(
+		db2->getRootGroup()
+	);
+	entry->setGroup(
+		group2
+	);
+	QCOMPARE(
+		db2->resolveEntry(entry->getUUID()),
+		entry
+	);
+	QVERIFY(
+		db2->isIndexConsistent()
+	);
+	// duplicate UUIDs stay resolvable until the last one is gone
+	Entry* duplicate = new Entry();
+	duplicate->setUUID(
+		entry->getUUID()
+	);
+	duplicate->setGroup(
+		group
+	);
+	delete entry;
+	QCOMPARE(
+		db2->resolveEntry(duplicate->getUUID()),
+		duplicate
+	);
+	QVERIFY(
+		db2->isIndexConsistent()
+	);
+	const UUID duplicateUuid = duplicate->getUUID();
+	delete group;
+	QVERIFY(
+		!db2->resolveEntry(duplicateUuid)
+	);
+	QVERIFY(
+		db2->isIndexConsistent()
+	);
+	delete db;
+	delete db2;
+}
+
+void TestGroup::testIndexOf()
+{
+	Group* root = new Group();
+	QList<Group*> groups;
+	for(int i = 0; i < 5; i++)
+	{
+		Group* group = new Group();
+		group->setParent(
+			root
+		);
+		groups.append(
+			group
+		);
+	}
+	Entry* entry1 = new Entry();
+	entry1->setGroup(
+		root
+	);
+	Entry* entry2 = new Entry();
+	entry2->setGroup(
+		root
+	);
+	for(int i = 0; i < groups.size(); i++)
+	{
+		QCOMPARE(
+			root->indexOfChild(groups.at(i)),
+			i
+		);
+	}
+	QCOMPARE(
+		root->indexOfEntry(entry2),
+		1
+	);
+	// insert in the middle, move and remove
+	Group* inserted = new Group();
+	inserted->setParent(
+		root,
+		1
+	);
+	groups.at(0)->setParent(
+		root,
+		3
+	);
+	delete groups.at(
+		4
+	);
+	delete entry1;
+	for(int i = 0; i < root->getChildren().size(); i++)
+	{
+		QCOMPARE(
+			root->indexOfChild(root->getChildren().at(i)),
+			i
+		);
+	}
+	QCOMPARE(
+		root->indexOfChild(inserted),
+		0
+	);
+	QCOMPARE(
+		root->indexOfChild(groups.at(0)),
+		3
+	);
+	QCOMPARE(
+		root->indexOfEntry(entry2),
+		0
+	);
+	QCOMPARE(
+		groups.at(1)->indexOfChild(inserted),
+		-1
+	);
+	delete root;
+}
+
+void TestGroup::benchmarkResolve()
+{
+	QByteArray env = qgetenv(
+		"BENCHMARK"
+	);
+	if(env.isEmpty() || env == "0" || env == "no")
+	{
+		QSKIP(
+			"Benchmark skipped. Set env variable BENCHMARK=1 to enable."
+		);
+	}
+	Database* db = new Database();
+	QList<UUID> uuids;
+	for(int i = 0; i < 500; i++)
+	{
+		Group* group = new Group();
+		group->setUuid(
+			UUID::random()
+		);
+		group->setParent(
+			db->getRootGroup()
+		);
+		for(int j = 0; j < 1000; j++)
+		{
+			Entry* entry = new Entry();
+			entry->setUUID(
+				UUID::random()
+			);
+			entry->setGroup(
+				group
+			);
+			uuids.append(
+				entry->getUUID()
+			);
+		}
+	}
+	QVERIFY(
+		db->isIndexConsistent()
+	);
+	int i = 0;
+	QBENCHMARK
+	{
+		QVERIFY(
+			db->resolveEntry(uuids.at(i))
+		);
+		i = static_cast<int>((i + 7919) % uuids.size());
+	}
+	delete db;
+}
@@ -29,5 +29,8 @@ class TestGroup:public QObject
 	void testCopyCustomIcon();
 	void testClone();
 	void testCopyCustomIcons();
+	void testResolve();
+	void testIndexOf();
+	void benchmarkResolve();
 };
 #endif // KEEPASSX_TESTGROUP_H
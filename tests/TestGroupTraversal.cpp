@@ -0,0 +1,381 @@
+/*
+ *  Copyright (C) 2026 The cpp-password-manager contributors
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "TestGroupTraversal.h"
+#include <QTest>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "core/Group.h"
+#include "crypto/Crypto.h"
+QTEST_GUILESS_MAIN(
+	TestGroupTraversal
+)
+// Counts heap allocations so traversals can be compared.
+static std::atomic<qint64> allocationCount(
+	0
+);
+
+void* operator new(
+	std::size_t size
+)
+{
+	allocationCount++;
+	if(void* p = std::malloc(size ? size : 1))
+	{
+		return p;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(
+	void* p
+) noexcept
+{
+	std::free(
+		p
+	);
+}
+
+void operator delete(
+	void* p,
+	std::size_t
+) noexcept
+{
+	std::free(
+		p
+	);
+}
+
+// The list based traversal the range API replaced, kept as a baseline.
+static QList<Entry*> entriesRecursiveList(
+	const Group* group
+)
+{
+	QList<Entry*> entryList = group->getEntries();
+	for(const Group* child: group->getChildren())
+	{
+		entryList.append(
+			entriesRecursiveList(
+				child
+			)
+		);
+	}
+	return entryList;
+}
+
+static Group* addGroup(
+	Group* parent,
+	const QString &name
+)
+{
+	Group* group = new Group();
+	group->setName(
+		name
+	);
+	group->setParent(
+		parent
+	);
+	return group;
+}
+
+static Entry* addEntry(
+	Group* group,
+	const QString &title
+)
+{
+	Entry* entry = new Entry();
+	entry->setTitle(
+		title
+	);
+	entry->setGroup(
+		group
+	);
+	return entry;
+}
+
+/**
+* A visitor that records names and stops at a given name.
+*/
+class RecordingVisitor final:public GroupVisitor
+{
+public:
+	virtual bool visitGroup(
+		Group* group
+	) override
+	{
+		this->names << group->getName();
+		return group->getName() != this->stopAt;
+	}
+
+	virtual bool visitEntry(
+		Entry* entry
+	) override
+	{
+		this->names << entry->getTitle();
+		return entry->getTitle() != this->stopAt;
+	}
+
+	QStringList names;
+	QString stopAt;
+};
+
+void TestGroupTraversal::initTestCase()
+{
+	QVERIFY(
+		Crypto::init()
+	);
+	// root
+	// +- a (ea1, ea2)
+	// |  +- a1 (ea11)
+	// |  +- a2
+	// +- b (eb1)
+	//    +- b1
+	m_root = new Group();
+	m_root->setName(
+		"root"
+	);
+	Group* a = addGroup(
+		m_root,
+		"a"
+	);
+	addEntry(
+		a,
+		"ea1"
+	);
+	Entry* ea2 = addEntry(
+		a,
+		"ea2"
+	);
+	Group* a1 = addGroup(
+		a,
+		"a1"
+	);
+	addEntry(
+		a1,
+		"ea11"
+	);
+	addGroup(
+		a,
+		"a2"
+	);
+	Group* b = addGroup(
+		m_root,
+		"b"
+	);
+	addEntry(
+		b,
+		"eb1"
+	);
+	addGroup(
+		b,
+		"b1"
+	);
+	Entry* history = ea2->clone(
+		Entry::CloneNoFlags
+	);
+	history->setTitle(
+		"ea2-old"
+	);
+	ea2->addHistoryItem(
+		history
+	);
+}
+
+void TestGroupTraversal::testPreOrder()
+{
+	QStringList names;
+	QList<int> depths;
+	const GroupRange<Group> groups = m_root->groupsRecursive(
+		true
+	);
+	for(auto i = groups.begin(); i != groups.end(); ++i)
+	{
+		names << (*i)->getName();
+		depths << i.depth();
+	}
+	QCOMPARE(
+		names,
+		QStringList() << "root" << "a" << "a1" << "a2" << "b" << "b1"
+	);
+	QCOMPARE(
+		depths,
+		QList<int>() << 0 << 1 << 2 << 2 << 1 << 2
+	);
+	names.clear();
+	for(const Group* group: m_root->groupsRecursive(false))
+	{
+		names << group->getName();
+		if(group->getName() == "a2")
+		{
+			break;
+		}
+	}
+	QCOMPARE(
+		names,
+		QStringList() << "a" << "a1" << "a2"
+	);
+	Group* leaf = new Group();
+	names.clear();
+	for(const Group* group: leaf->groupsRecursive(false))
+	{
+		names << group->getName();
+	}
+	QVERIFY(
+		names.isEmpty()
+	);
+	delete leaf;
+}
+
+void TestGroupTraversal::testPostOrder()
+{
+	QStringList names;
+	for(const Group* group: m_root->groupsRecursive(true, PostOrder))
+	{
+		names << group->getName();
+	}
+	QCOMPARE(
+		names,
+		QStringList() << "a1" << "a2" << "a" << "b1" << "b" << "root"
+	);
+	names.clear();
+	for(const Group* group: m_root->groupsRecursive(false, PostOrder))
+	{
+		names << group->getName();
+	}
+	QCOMPARE(
+		names,
+		QStringList() << "a1" << "a2" << "a" << "b1" << "b"
+	);
+}
+
+void TestGroupTraversal::testEntries()
+{
+	QStringList titles;
+	for(const Entry* entry: m_root->entriesRecursive())
+	{
+		titles << entry->getTitle();
+	}
+	QCOMPARE(
+		titles,
+		QStringList() << "ea1" << "ea2" << "ea11" << "eb1"
+	);
+	titles.clear();
+	for(const Entry* entry: m_root->entriesRecursive(true))
+	{
+		titles << entry->getTitle();
+	}
+	QCOMPARE(
+		titles,
+		QStringList() << "ea1" << "ea2" << "ea2-old" << "ea11" << "eb1"
+	);
+}
+
+void TestGroupTraversal::testVisitor()
+{
+	RecordingVisitor visitor;
+	QVERIFY(
+		m_root->accept(&visitor, PreOrder, true)
+	);
+	QCOMPARE(
+		visitor.names,
+		QStringList() << "root" << "a" << "ea1" << "ea2" << "ea2-old" << "a1"
+		<< "ea11" << "a2" << "b" << "eb1" << "b1"
+	);
+	RecordingVisitor postOrderVisitor;
+	QVERIFY(
+		m_root->accept(&postOrderVisitor, PostOrder)
+	);
+	QCOMPARE(
+		postOrderVisitor.names,
+		QStringList() << "ea11" << "a1" << "a2" << "ea1" << "ea2" << "a" <<
+		"b1" << "eb1" << "b" << "root"
+	);
+	RecordingVisitor stoppingVisitor;
+	stoppingVisitor.stopAt = "ea11";
+	QVERIFY(
+		!m_root->accept(&stoppingVisitor)
+	);
+	QCOMPARE(
+		stoppingVisitor.names.last(),
+		QString("ea11")
+	);
+	QVERIFY(
+		!stoppingVisitor.names.contains("b")
+	);
+}
+
+void TestGroupTraversal::testAllocations()
+{
+	Group* root = new Group();
+	Group* parent = root;
+	for(int i = 0; i < 10; i++)
+	{
+		for(int j = 0; j < 10; j++)
+		{
+			Group* group = addGroup(
+				parent,
+				QString()
+			);
+			for(int k = 0; k < 10; k++)
+			{
+				addEntry(
+					group,
+					QString()
+				);
+			}
+		}
+		parent = parent->getChildren().last();
+	}
+	qint64 before = allocationCount;
+	int count = entriesRecursiveList(root).size();
+	const qint64 listAllocations = allocationCount - before;
+	before = allocationCount;
+	int rangeCount = 0;
+	for(const Entry* entry: root->entriesRecursive(true))
+	{
+		Q_UNUSED(
+			entry
+		);
+		rangeCount++;
+	}
+	for(const Group* group: root->groupsRecursive(true, PostOrder))
+	{
+		Q_UNUSED(
+			group
+		);
+	}
+	const qint64 rangeAllocations = allocationCount - before;
+	qDebug() << "allocations for" << count << "entries: list" <<
+		listAllocations << "range" << rangeAllocations;
+	QCOMPARE(
+		rangeCount,
+		count
+	);
+	QVERIFY(
+		listAllocations > 0
+	);
+	QCOMPARE(
+		rangeAllocations,
+		qint64(0)
+	);
+	delete root;
+}
+
+void TestGroupTraversal::cleanupTestCase()
+{
+	delete m_root;
+}
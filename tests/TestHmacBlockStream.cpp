@@ -0,0 +1,437 @@
+/*
+ *  Copyright (C) 2026 The cpp-password-manager contributors
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "TestHmacBlockStream.h"
+#include <QBuffer>
+#include <QTest>
+#include "FailDevice.h"
+#include "crypto/Crypto.h"
+#include "streams/HmacBlockStream.h"
+QTEST_GUILESS_MAIN(
+	TestHmacBlockStream
+)
+
+void TestHmacBlockStream::initTestCase()
+{
+	QVERIFY(
+		Crypto::init()
+	);
+}
+
+void TestHmacBlockStream::testBlockHmac()
+{
+	// HMAC-SHA256(SHA512(index || key), index || size || data)
+	QCOMPARE(
+		HmacBlockStream::getBlockHmac(0, QByteArray(64, '\x01'), "abc"),
+		QByteArray::fromHex(
+			"9ad8eb4d60d49bc744fad0e9d2e2031c468cddf4acc4370056ac95d770a7b84c")
+	);
+}
+
+void TestHmacBlockStream::testWriteRead()
+{
+	const QByteArray key(
+		64,
+		'K'
+	);
+	QByteArray data = QByteArray::fromHex(
+		"603deb1015ca71be2b73aef0857d77811f352c073b6108d72d9810a30914dff4"
+	);
+	QBuffer buffer;
+	QVERIFY(
+		buffer.open(QIODevice::ReadWrite)
+	);
+	HmacBlockStream writer(
+		&buffer,
+		key,
+		16
+	);
+	QVERIFY(
+		writer.open(QIODevice::WriteOnly)
+	);
+	HmacBlockStream reader(
+		&buffer,
+		key
+	);
+	QVERIFY(
+		reader.open(QIODevice::ReadOnly)
+	);
+	QCOMPARE(
+		writer.write(data.left(10)),
+		qint64(10)
+	);
+	QVERIFY(
+		writer.reset()
+	);
+	buffer.reset();
+	QVERIFY(
+		!reader.atEnd()
+	);
+	QCOMPARE(
+		reader.read(5),
+		data.left(5)
+	);
+	QCOMPARE(
+		reader.read(5),
+		data.mid(5, 5)
+	);
+	// the final block was read ahead
+	QVERIFY(
+		reader.atEnd()
+	);
+	QCOMPARE(
+		reader.read(1).size(),
+		0
+	);
+	QVERIFY(
+		reader.reset()
+	);
+	buffer.reset();
+	buffer.buffer().clear();
+	QCOMPARE(
+		writer.write(data.left(20)),
+		qint64(20)
+	);
+	QVERIFY(
+		writer.reset()
+	);
+	buffer.reset();
+	QCOMPARE(
+		reader.read(20),
+		data.left(20)
+	);
+	QCOMPARE(
+		reader.read(1).size(),
+		0
+	);
+	QVERIFY(
+		reader.reset()
+	);
+	buffer.reset();
+	buffer.buffer().clear();
+	// a different key doesn't authenticate
+	QCOMPARE(
+		writer.write(data),
+		qint64(data.size())
+	);
+	QVERIFY(
+		writer.reset()
+	);
+	buffer.reset();
+	HmacBlockStream wrongKeyReader(
+		&buffer,
+		QByteArray(
+			64,
+			'X'
+		)
+	);
+	QVERIFY(
+		wrongKeyReader.open(QIODevice::ReadOnly)
+	);
+	char ch;
+	QCOMPARE(
+		wrongKeyReader.read(&ch, 1),
+		qint64(-1)
+	);
+}
+
+void TestHmacBlockStream::testTampered()
+{
+	const QByteArray key(
+		64,
+		'K'
+	);
+	QBuffer buffer;
+	QVERIFY(
+		buffer.open(QIODevice::ReadWrite)
+	);
+	HmacBlockStream writer(
+		&buffer,
+		key,
+		16
+	);
+	QVERIFY(
+		writer.open(QIODevice::WriteOnly)
+	);
+	QCOMPARE(
+		writer.write(QByteArray(40, 'Z')),
+		qint64(40)
+	);
+	QVERIFY(
+		writer.reset()
+	);
+	// flip a bit in the data of the second block
+	buffer.buffer()[(32 + 4 + 16) + 32 + 4 + 3] ^= 0x01;
+	buffer.reset();
+	HmacBlockStream reader(
+		&buffer,
+		key
+	);
+	QVERIFY(
+		reader.open(QIODevice::ReadOnly)
+	);
+	QCOMPARE(
+		reader.read(16),
+		QByteArray(16, 'Z')
+	);
+	char data[16];
+	QCOMPARE(
+		reader.read(data, 16),
+		qint64(-1)
+	);
+	QCOMPARE(
+		reader.errorString(),
+		QString("Mismatch between HMAC and data.")
+	);
+}
+
+void TestHmacBlockStream::testReorderedBlocks()
+{
+	const QByteArray key(
+		64,
+		'K'
+	);
+	QBuffer buffer;
+	QVERIFY(
+		buffer.open(QIODevice::ReadWrite)
+	);
+	HmacBlockStream writer(
+		&buffer,
+		key,
+		16
+	);
+	QVERIFY(
+		writer.open(QIODevice::WriteOnly)
+	);
+	QCOMPARE(
+		writer.write(QByteArray(16, 'A') + QByteArray(16, 'B')),
+		qint64(32)
+	);
+	QVERIFY(
+		writer.reset()
+	);
+	// swap the first two blocks, their HMACs are still intact
+	const int blockLength = 32 + 4 + 16;
+	QByteArray swapped = buffer.buffer().mid(
+		blockLength,
+		blockLength
+	);
+	swapped.append(
+		buffer.buffer().left(
+			blockLength
+		)
+	);
+	swapped.append(
+		buffer.buffer().mid(
+			2 * blockLength
+		)
+	);
+	buffer.setData(
+		swapped
+	);
+	buffer.reset();
+	HmacBlockStream reader(
+		&buffer,
+		key
+	);
+	QVERIFY(
+		reader.open(QIODevice::ReadOnly)
+	);
+	char data[16];
+	QCOMPARE(
+		reader.read(data, 16),
+		qint64(-1)
+	);
+}
+
+void TestHmacBlockStream::testAuthenticate()
+{
+	const QByteArray key(
+		64,
+		'K'
+	);
+	QByteArray data(
+		100,
+		'A'
+	);
+	for(int i = 0; i < data.size(); i++)
+	{
+		data[i] = static_cast<char>(i);
+	}
+	QBuffer buffer;
+	QVERIFY(
+		buffer.open(QIODevice::ReadWrite)
+	);
+	HmacBlockStream writer(
+		&buffer,
+		key,
+		16
+	);
+	QVERIFY(
+		writer.open(QIODevice::WriteOnly)
+	);
+	QCOMPARE(
+		writer.write(data),
+		qint64(data.size())
+	);
+	QVERIFY(
+		writer.reset()
+	);
+	// trailing data isn't part of the stream
+	buffer.write(
+		"tail"
+	);
+	buffer.reset();
+	HmacBlockStream reader(
+		&buffer,
+		key
+	);
+	QVERIFY(
+		reader.open(QIODevice::ReadOnly)
+	);
+	QVERIFY(
+		reader.authenticate()
+	);
+	QCOMPARE(
+		buffer.read(4),
+		QByteArray("tail")
+	);
+	QCOMPARE(
+		reader.read(30),
+		data.left(30)
+	);
+	QCOMPARE(
+		reader.read(100),
+		data.mid(30)
+	);
+	QVERIFY(
+		reader.atEnd()
+	);
+	QCOMPARE(
+		reader.read(1).size(),
+		0
+	);
+}
+
+void TestHmacBlockStream::testAuthenticateForged()
+{
+	const QByteArray key(
+		64,
+		'K'
+	);
+	QBuffer buffer;
+	QVERIFY(
+		buffer.open(QIODevice::ReadWrite)
+	);
+	HmacBlockStream writer(
+		&buffer,
+		key,
+		16
+	);
+	QVERIFY(
+		writer.open(QIODevice::WriteOnly)
+	);
+	QCOMPARE(
+		writer.write(QByteArray(40, 'Z')),
+		qint64(40)
+	);
+	QVERIFY(
+		writer.reset()
+	);
+	// flip a bit in the data of the last block, authenticate() notices
+	// before the first block is handed out
+	buffer.buffer()[2 * (32 + 4 + 16) + 32 + 4 + 3] ^= 0x01;
+	buffer.reset();
+	HmacBlockStream reader(
+		&buffer,
+		key
+	);
+	QVERIFY(
+		reader.open(QIODevice::ReadOnly)
+	);
+	QVERIFY(
+		!reader.authenticate()
+	);
+	QCOMPARE(
+		reader.errorString(),
+		QString("Mismatch between HMAC and data.")
+	);
+	char data[16];
+	QCOMPARE(
+		reader.read(data, 16),
+		qint64(-1)
+	);
+	// a truncated stream fails as well
+	buffer.buffer().chop(
+		36
+	);
+	buffer.reset();
+	HmacBlockStream truncatedReader(
+		&buffer,
+		key
+	);
+	QVERIFY(
+		truncatedReader.open(QIODevice::ReadOnly)
+	);
+	QVERIFY(
+		!truncatedReader.authenticate()
+	);
+	QCOMPARE(
+		truncatedReader.errorString(),
+		QString("Invalid HMAC size.")
+	);
+}
+
+void TestHmacBlockStream::testWriteFailure()
+{
+	FailDevice failDevice(
+		1500
+	);
+	QVERIFY(
+		failDevice.open(QIODevice::WriteOnly)
+	);
+	QByteArray input(
+		2000,
+		'Z'
+	);
+	HmacBlockStream writer(
+		&failDevice,
+		QByteArray(
+			64,
+			'K'
+		),
+		500
+	);
+	QVERIFY(
+		writer.open(QIODevice::WriteOnly)
+	);
+	QCOMPARE(
+		writer.write(input.left(900)),
+		qint64(900)
+	);
+	writer.write(
+		input.left(
+			900
+		)
+	);
+	QVERIFY(
+		!writer.reset()
+	);
+	QCOMPARE(
+		writer.errorString(),
+		QString("FAILDEVICE")
+	);
+}
@@ -0,0 +1,33 @@
+/*
+ *  Copyright (C) 2026 The cpp-password-manager contributors
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef KEEPASSX_TESTHMACBLOCKSTREAM_H
+#define KEEPASSX_TESTHMACBLOCKSTREAM_H
+#include <QObject>
+
+class TestHmacBlockStream:public QObject
+{
+	Q_OBJECT private Q_SLOTS:
+	void initTestCase();
+	void testBlockHmac();
+	void testWriteRead();
+	void testTampered();
+	void testReorderedBlocks();
+	void testAuthenticate();
+	void testAuthenticateForged();
+	void testWriteFailure();
+};
+#endif // KEEPASSX_TESTHMACBLOCKSTREAM_H
@@ -0,0 +1,447 @@
+/*
+ *  Copyright (C) 2026 The cpp-password-manager contributors
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "TestKeePass2Journal.h"
+#include <QFile>
+#include <QTest>
+#include "core/Database.h"
+#include "core/Group.h"
+#include "core/ListDeleter.h"
+#include "core/Metadata.h"
+#include "crypto/Crypto.h"
+#include "format/KeePass2Journal.h"
+#include "format/KeePass2Reader.h"
+#include "format/KeePass2Writer.h"
+#include "keys/PasswordKey.h"
+QTEST_GUILESS_MAIN(
+	TestKeePass2Journal
+)
+
+void TestKeePass2Journal::initTestCase()
+{
+	QVERIFY(
+		Crypto::init()
+	);
+	QVERIFY(
+		m_tempDir.isValid()
+	);
+	m_key.addKey(
+		PasswordKey(
+			"test"
+		)
+	);
+	m_filename = m_tempDir.path() + "/journal.kdbx";
+}
+
+void TestKeePass2Journal::init()
+{
+	m_db = new Database();
+	m_db->setKey(
+		m_key
+	);
+	Group* group = new Group();
+	group->setUuid(
+		UUID::random()
+	);
+	group->setName(
+		"group"
+	);
+	group->setParent(
+		m_db->getRootGroup()
+	);
+	Entry* entry1 = new Entry();
+	entry1->setUUID(
+		UUID::random()
+	);
+	entry1->setTitle(
+		"entry1"
+	);
+	entry1->setGroup(
+		group
+	);
+	Entry* entry2 = new Entry();
+	entry2->setUUID(
+		UUID::random()
+	);
+	entry2->setTitle(
+		"entry2"
+	);
+	entry2->setGroup(
+		m_db->getRootGroup()
+	);
+}
+
+void TestKeePass2Journal::testReplay()
+{
+	KeePass2Writer writer;
+	writer.writeDatabase(
+		m_filename,
+		m_db
+	);
+	QVERIFY(
+		!writer.hasError()
+	);
+	KeePass2Journal journal(
+		m_db
+	);
+	QVERIFY(
+		journal.open(m_filename, writer.getHeaderHash())
+	);
+	QVERIFY(
+		!journal.hasPendingChanges()
+	);
+	Group* group = m_db->getRootGroup()->getChildren().at(
+		0
+	);
+	Entry* entry1 = group->getEntries().at(
+		0
+	);
+	entry1->beginUpdate();
+	entry1->setTitle(
+		"changed"
+	);
+	entry1->setPassword(
+		"secret"
+	);
+	entry1->getAttachments()->set(
+		"file",
+		QByteArray(
+			"attachment"
+		)
+	);
+	entry1->endUpdate();
+	const UUID entry2Uuid = m_db->getRootGroup()->getEntries().at(
+		0
+	)->getUUID();
+	delete m_db->getRootGroup()->getEntries().at(
+		0
+	);
+	Group* newGroup = new Group();
+	newGroup->setUuid(
+		UUID::random()
+	);
+	newGroup->setName(
+		"new group"
+	);
+	Entry* entry3 = new Entry();
+	entry3->setUUID(
+		UUID::random()
+	);
+	entry3->setTitle(
+		"entry3"
+	);
+	entry3->setGroup(
+		newGroup
+	);
+	newGroup->setParent(
+		m_db->getRootGroup(),
+		0
+	);
+	group->setName(
+		"renamed"
+	);
+	QVERIFY(
+		journal.hasPendingChanges()
+	);
+	QVERIFY(
+		!journal.needsFullSave()
+	);
+	QVERIFY(
+		journal.flush()
+	);
+	QVERIFY(
+		!journal.hasPendingChanges()
+	);
+	QVERIFY(
+		journal.getRecordCount() >= 5
+	);
+	KeePass2Reader reader;
+	Database* db = reader.readDatabase(
+		m_filename,
+		m_key
+	);
+	QVERIFY(
+		db
+	);
+	// the reader leaves the journal to the caller
+	QCOMPARE(
+		db->getRootGroup()->getChildren().size(),
+		1
+	);
+	QCOMPARE(
+		db->getHeaderHash(),
+		writer.getHeaderHash()
+	);
+	KeePass2Journal replayJournal(
+		db
+	);
+	QVERIFY(
+		replayJournal.replay(m_filename, db->getHeaderHash())
+	);
+	QVERIFY(
+		!reader.hasError()
+	);
+	QCOMPARE(
+		reader.getHeaderHash(),
+		writer.getHeaderHash()
+	);
+	QCOMPARE(
+		db->getRootGroup()->getChildren().size(),
+		2
+	);
+	QCOMPARE(
+		db->getRootGroup()->getChildren().at(0)->getName(),
+		QString("new group")
+	);
+	QCOMPARE(
+		db->getRootGroup()->getChildren().at(0)->getEntries().size(),
+		1
+	);
+	QCOMPARE(
+		db->getRootGroup()->getChildren().at(0)->getEntries().at(0)->getTitle(),
+		QString("entry3")
+	);
+	Group* group2 = db->getRootGroup()->getChildren().at(
+		1
+	);
+	QCOMPARE(
+		group2->getName(),
+		QString("renamed")
+	);
+	QCOMPARE(
+		group2->getEntries().size(),
+		1
+	);
+	Entry* entry = group2->getEntries().at(
+		0
+	);
+	QCOMPARE(
+		entry->getUUID(),
+		entry1->getUUID()
+	);
+	QCOMPARE(
+		entry->getTitle(),
+		QString("changed")
+	);
+	QCOMPARE(
+		entry->getPassword(),
+		QString("secret")
+	);
+	QVERIFY(
+		entry->getAttributes()->isProtected("Password") == entry1->
+		getAttributes()->isProtected("Password")
+	);
+	QCOMPARE(
+		entry->getAttachments()->getValue("file"),
+		QByteArray("attachment")
+	);
+	QCOMPARE(
+		entry->getHistoryCount(),
+		1
+	);
+	QList<Entry*> historyItems = entry->buildHistoryItems();
+	const ListDeleter<Entry*> historyDeleter(
+		&historyItems
+	);
+	QCOMPARE(
+		historyItems.at(0)->getTitle(),
+		QString("entry1")
+	);
+	QCOMPARE(
+		entry->getTimeInfo().getLastModificationTime(),
+		entry1->getTimeInfo().getLastModificationTime()
+	);
+	QVERIFY(
+		db->getRootGroup()->getEntries().isEmpty()
+	);
+	QVERIFY(
+		!db->resolveEntry(entry2Uuid)
+	);
+	// the replayed tombstone keeps the time of the journaled deletion
+	QCOMPARE(
+		db->getDeletedObjects().last().uuid,
+		entry2Uuid
+	);
+	QCOMPARE(
+		db->getDeletedObjects().last().deletionTime,
+		m_db->getDeletedObjects().last().deletionTime
+	);
+	delete db;
+}
+
+void TestKeePass2Journal::testStaleJournal()
+{
+	KeePass2Writer writer;
+	writer.writeDatabase(
+		m_filename,
+		m_db
+	);
+	KeePass2Journal journal(
+		m_db
+	);
+	QVERIFY(
+		journal.open(m_filename, writer.getHeaderHash())
+	);
+	m_db->getRootGroup()->getChildren().at(0)->setName(
+		"journaled"
+	);
+	QVERIFY(
+		journal.flush()
+	);
+	// rewriting the database file invalidates the journal
+	m_db->getRootGroup()->getChildren().at(0)->setName(
+		"saved"
+	);
+	writer.writeDatabase(
+		m_filename,
+		m_db
+	);
+	QVERIFY(
+		!writer.hasError()
+	);
+	KeePass2Reader reader;
+	Database* db = reader.readDatabase(
+		m_filename,
+		m_key
+	);
+	QVERIFY(
+		db
+	);
+	KeePass2Journal replayJournal(
+		db
+	);
+	QVERIFY(
+		replayJournal.replay(m_filename, db->getHeaderHash())
+	);
+	QCOMPARE(
+		db->getRootGroup()->getChildren().at(0)->getName(),
+		QString("saved")
+	);
+	delete db;
+}
+
+void TestKeePass2Journal::testCorruptRecord()
+{
+	KeePass2Writer writer;
+	writer.writeDatabase(
+		m_filename,
+		m_db
+	);
+	KeePass2Journal journal(
+		m_db
+	);
+	QVERIFY(
+		journal.open(m_filename, writer.getHeaderHash())
+	);
+	Group* group = m_db->getRootGroup()->getChildren().at(
+		0
+	);
+	group->setName(
+		"first"
+	);
+	QVERIFY(
+		journal.flush()
+	);
+	const qint64 validSize = journal.getSize();
+	group->setNotes(
+		"second"
+	);
+	QVERIFY(
+		journal.flush()
+	);
+	// simulate a crash in the middle of appending the second record
+	QFile file(
+		KeePass2Journal::getJournalPath(
+			m_filename
+		)
+	);
+	QVERIFY(
+		file.resize(validSize + 10)
+	);
+	KeePass2Reader reader;
+	Database* db = reader.readDatabase(
+		m_filename,
+		m_key
+	);
+	QVERIFY(
+		db
+	);
+	KeePass2Journal replayJournal(
+		db
+	);
+	QVERIFY(
+		replayJournal.replay(m_filename, db->getHeaderHash())
+	);
+	QCOMPARE(
+		db->getRootGroup()->getChildren().at(0)->getName(),
+		QString("first")
+	);
+	QCOMPARE(
+		db->getRootGroup()->getChildren().at(0)->getNotes(),
+		QString()
+	);
+	delete db;
+}
+
+void TestKeePass2Journal::testNeedsFullSave()
+{
+	KeePass2Writer writer;
+	writer.writeDatabase(
+		m_filename,
+		m_db
+	);
+	KeePass2Journal journal(
+		m_db
+	);
+	QVERIFY(
+		journal.open(m_filename, writer.getHeaderHash())
+	);
+	QVERIFY(
+		!journal.needsFullSave()
+	);
+	m_db->getMetadata()->setName(
+		"renamed database"
+	);
+	QVERIFY(
+		journal.needsFullSave()
+	);
+	QVERIFY(
+		journal.open(m_filename, writer.getHeaderHash())
+	);
+	journal.setMaxSize(
+		0
+	);
+	QVERIFY(
+		journal.needsFullSave()
+	);
+	journal.remove();
+	QVERIFY(
+		!QFile::exists(KeePass2Journal::getJournalPath(m_filename))
+	);
+}
+
+void TestKeePass2Journal::cleanup()
+{
+	delete m_db;
+	QFile::remove(
+		KeePass2Journal::getJournalPath(
+			m_filename
+		)
+	);
+	QFile::remove(
+		m_filename
+	);
+}
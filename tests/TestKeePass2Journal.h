@@ -0,0 +1,40 @@
+/*
+ *  Copyright (C) 2026 The cpp-password-manager contributors
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 or (at your option)
+ *  version 3 of the License.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef KEEPASSX_TESTKEEPASS2JOURNAL_H
+#define KEEPASSX_TESTKEEPASS2JOURNAL_H
+#include <QObject>
+#include <QTemporaryDir>
+#include "keys/CompositeKey.h"
+class Database;
+
+class TestKeePass2Journal:public QObject
+{
+	Q_OBJECT private Q_SLOTS:
+	void initTestCase();
+	void init();
+	void testReplay();
+	void testStaleJournal();
+	void testCorruptRecord();
+	void testNeedsFullSave();
+	void cleanup();
+private:
+	QString m_filename;
+	QTemporaryDir m_tempDir;
+	CompositeKey m_key;
+	Database* m_db;
+};
+#endif // KEEPASSX_TESTKEEPASS2JOURNAL_H
@@ -164,3 +164,30 @@ void TestKeePass2RandomStream::test()
 		cipherData
 	);
 }
+
+void TestKeePass2RandomStream::testChaCha20()
+{
+	QByteArray key;
+	for(int i = 0; i < 64; i++)
+	{
+		key.append(
+			static_cast<char>(i)
+		);
+	}
+	KeePass2RandomStream randomStream(
+		KeePass2::ChaCha20
+	);
+	QVERIFY(
+		randomStream.init(key)
+	);
+	bool ok;
+	// key and nonce are taken from SHA-512 of the key
+	QCOMPARE(
+		randomStream.process(QByteArray(32, '\0'), &ok),
+		QByteArray::fromHex(
+			"8ce8bc610ac05ff2e3dd88b49a1404c2844f148037027476b83d58f5609adf65")
+	);
+	QVERIFY(
+		ok
+	);
+}
@@ -23,5 +23,6 @@ class TestKeePass2RandomStream:public QObject
 	Q_OBJECT private Q_SLOTS:
 	void initTestCase();
 	void test();
+	void testChaCha20();
 };
 #endif // KEEPASSX_TESTKEEPASS2RANDOMSTREAM_H
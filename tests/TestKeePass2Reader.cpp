@@ -19,6 +19,7 @@
 #include "config-keepassx-tests.h"
 #include "core/Database.h"
 #include "core/Group.h"
+#include "core/ListDeleter.h"
 #include "core/Metadata.h"
 #include "crypto/Crypto.h"
 #include "format/KeePass2Reader.h"
@@ -269,19 +270,23 @@ void TestKeePass2Reader::testFormat200()
 		QByteArray("this is a test")
 	);
 	QCOMPARE(
-		entry->getHistoryItems().size(),
+		entry->getHistoryCount(),
 		2
 	);
+	QList<Entry*> historyItems = entry->buildHistoryItems();
+	const ListDeleter<Entry*> historyDeleter(
+		&historyItems
+	);
 	QCOMPARE(
-		entry->getHistoryItems().at(0)->getAttachments()->getKeys().size(),
+		historyItems.at(0)->getAttachments()->getKeys().size(),
 		0
 	);
 	QCOMPARE(
-		entry->getHistoryItems().at(1)->getAttachments()->getKeys().size(),
+		historyItems.at(1)->getAttachments()->getKeys().size(),
 		1
 	);
 	QCOMPARE(
-		entry->getHistoryItems().at(1)->getAttachments()->getValue(
+		historyItems.at(1)->getAttachments()->getValue(
 			"myattach.txt"),
 		QByteArray("abcdefghijk")
 	);
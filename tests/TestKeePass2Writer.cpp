@@ -23,7 +23,9 @@
 #include "core/Database.h"
 #include "core/Group.h"
 #include "core/Metadata.h"
+#include "core/Endian.h"
 #include "crypto/Crypto.h"
+#include "format/KeePass2.h"
 #include "format/KeePass2Reader.h"
 #include "format/KeePass2Repair.h"
 #include "format/KeePass2Writer.h"
@@ -213,6 +215,110 @@ void TestKeePass2Writer::testNonAsciiPasswords()
 	);
 }
 
+void TestKeePass2Writer::testFormatVersion_data()
+{
+	QTest::addColumn<quint32>(
+		"version"
+	);
+	QTest::addColumn<bool>(
+		"binariesInXml"
+	);
+	QTest::newRow(
+		"3.1"
+	) << KeePass2::FILE_VERSION_3_1 << true;
+	QTest::newRow(
+		"4"
+	) << KeePass2::FILE_VERSION_4 << false;
+}
+
+void TestKeePass2Writer::testFormatVersion()
+{
+	QFETCH(
+		quint32,
+		version
+	);
+	QFETCH(
+		bool,
+		binariesInXml
+	);
+	CompositeKey key;
+	key.addKey(
+		PasswordKey(
+			"test"
+		)
+	);
+	QBuffer buffer;
+	buffer.open(
+		QBuffer::ReadWrite
+	);
+	m_dbOrg->setFormatVersion(
+		version
+	);
+	KeePass2Writer writer;
+	writer.writeDatabase(
+		&buffer,
+		m_dbOrg
+	);
+	m_dbOrg->setFormatVersion(
+		KeePass2::FILE_VERSION
+	);
+	QVERIFY(
+		!writer.hasError()
+	);
+	QCOMPARE(
+		Endian::bytesToUInt32(buffer.data().mid(8, 4), KeePass2::BYTEORDER),
+		version
+	);
+	buffer.seek(
+		0
+	);
+	KeePass2Reader reader;
+	reader.setSaveXml(
+		true
+	);
+	Database* db = reader.readDatabase(
+		&buffer,
+		key
+	);
+	QVERIFY(
+		db
+	);
+	QVERIFY(
+		!reader.hasError()
+	);
+	QCOMPARE(
+		db->getFormatVersion(),
+		version
+	);
+	QCOMPARE(
+		reader.getXMLData().contains("<Binaries>"),
+		binariesInXml
+	);
+	QCOMPARE(
+		reader.getBinaries().size(),
+		binariesInXml ? 0 : 2
+	);
+	Entry* entry = db->getRootGroup()->getEntries().at(
+		0
+	);
+	QCOMPARE(
+		entry->getAttachments()->getValue("myattach.txt"),
+		QByteArray("this is an attachment")
+	);
+	QCOMPARE(
+		entry->getAttachments()->getValue("aaa.txt"),
+		QByteArray("also an attachment")
+	);
+	QCOMPARE(
+		entry->getAttributes()->getValue("test"),
+		QString("protectedTest")
+	);
+	QVERIFY(
+		entry->getAttributes()->isProtected("test")
+	);
+	delete db;
+}
+
 void TestKeePass2Writer::testDeviceFailure()
 {
 	CompositeKey key;
@@ -230,7 +336,7 @@ void TestKeePass2Writer::testDeviceFailure()
 		Database::CompressionNone
 	);
 	Entry* entry = new Entry();
-	entry->setParent(
+	entry->setGroup(
 		db->getRootGroup()
 	);
 	QByteArray attachment(
@@ -27,6 +27,8 @@ class TestKeePass2Writer:public QObject
 	void testProtectedAttributes();
 	void testAttachments();
 	void testNonAsciiPasswords();
+	void testFormatVersion_data();
+	void testFormatVersion();
 	void testDeviceFailure();
 	void testRepair();
 	void cleanupTestCase();
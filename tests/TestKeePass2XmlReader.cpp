@@ -18,8 +18,11 @@
 #include <QBuffer>
 #include <QFile>
 #include <QTest>
+#include <unistd.h>
 #include "core/Database.h"
+#include "core/Entry.h"
 #include "core/Group.h"
+#include "core/ListDeleter.h"
 #include "core/Metadata.h"
 #include "crypto/Crypto.h"
 #include "format/KeePass2XmlReader.h"
@@ -488,7 +491,7 @@ void TestKeePass2XmlReader::testEntry1()
 		QString("+wSUOv6qf0OzW8/ZHAs2sA==")
 	);
 	QCOMPARE(
-		entry->getHistoryItems().size(),
+		entry->getHistoryCount(),
 		2
 	);
 	QCOMPARE(
@@ -623,21 +626,25 @@ void TestKeePass2XmlReader::testEntry1()
 		entry->getAttachments()->getValue("myattach.txt"),
 		QByteArray("abcdefghijk")
 	);
+	QList<Entry*> historyItems = entry->buildHistoryItems();
+	const ListDeleter<Entry*> historyDeleter(
+		&historyItems
+	);
 	QCOMPARE(
-		entry->getHistoryItems().at(0)->getAttachments()->getKeys().size(),
+		historyItems.at(0)->getAttachments()->getKeys().size(),
 		1
 	);
 	QCOMPARE(
-		entry->getHistoryItems().at(0)->getAttachments()->getValue(
+		historyItems.at(0)->getAttachments()->getValue(
 			"myattach.txt"),
 		QByteArray("0123456789")
 	);
 	QCOMPARE(
-		entry->getHistoryItems().at(1)->getAttachments()->getKeys().size(),
+		historyItems.at(1)->getAttachments()->getKeys().size(),
 		1
 	);
 	QCOMPARE(
-		entry->getHistoryItems().at(1)->getAttachments()->getValue(
+		historyItems.at(1)->getAttachments()->getValue(
 			"myattach.txt"),
 		QByteArray("abcdefghijk")
 	);
@@ -751,10 +758,14 @@ void TestKeePass2XmlReader::testEntryHistory()
 		0
 	);
 	QCOMPARE(
-		entryMain->getHistoryItems().size(),
+		entryMain->getHistoryCount(),
 		2
+	);
+	QList<Entry*> historyItems = entryMain->buildHistoryItems();
+	const ListDeleter<Entry*> historyDeleter(
+		&historyItems
 	); {
-		const Entry* entry = entryMain->getHistoryItems().at(
+		const Entry* entry = historyItems.at(
 			0
 		);
 		QCOMPARE(
@@ -762,7 +773,7 @@ void TestKeePass2XmlReader::testEntryHistory()
 			entryMain->getUUID()
 		);
 		QVERIFY(
-			!entry->parent()
+			!entry->getGroup()
 		);
 		QCOMPARE(
 			entry->getTimeInfo().getLastModificationTime(),
@@ -781,7 +792,7 @@ void TestKeePass2XmlReader::testEntryHistory()
 			QString("http://www.somesite.com/")
 		);
 	} {
-		const Entry* entry = entryMain->getHistoryItems().at(
+		const Entry* entry = historyItems.at(
 			1
 		);
 		QCOMPARE(
@@ -789,7 +800,7 @@ void TestKeePass2XmlReader::testEntryHistory()
 			entryMain->getUUID()
 		);
 		QVERIFY(
-			!entry->parent()
+			!entry->getGroup()
 		);
 		QCOMPARE(
 			entry->getTimeInfo().getLastModificationTime(),
@@ -1282,7 +1293,10 @@ void TestKeePass2XmlReader::testRepairUuidHistoryItem()
 	Entry* entry = entries.at(
 		0
 	);
-	QList<Entry*> historyItems = entry->getHistoryItems();
+	QList<Entry*> historyItems = entry->buildHistoryItems();
+	const ListDeleter<Entry*> historyDeleter(
+		&historyItems
+	);
 	QCOMPARE(
 		historyItems.size(),
 		1
@@ -1302,6 +1316,143 @@ void TestKeePass2XmlReader::testRepairUuidHistoryItem()
 	);
 }
 
+static qint64 residentBytes()
+{
+	QFile statm(
+		"/proc/self/statm"
+	);
+	if(!statm.open(
+		QIODevice::ReadOnly
+	))
+	{
+		return 0;
+	}
+	const QList<QByteArray> fields = statm.readAll().split(
+		' '
+	);
+	if(fields.size() < 2)
+	{
+		return 0;
+	}
+	return fields.at(
+		1
+	).toLongLong() * sysconf(
+		_SC_PAGESIZE
+	);
+}
+
+void TestKeePass2XmlReader::benchmarkLoad_data()
+{
+	QTest::addColumn<int>(
+		"count"
+	);
+	QTest::newRow(
+		"100k"
+	) << 100000;
+	QTest::newRow(
+		"1M"
+	) << 1000000;
+}
+
+void TestKeePass2XmlReader::benchmarkLoad()
+{
+	QByteArray env = qgetenv(
+		"BENCHMARK"
+	);
+	if(env.isEmpty() || env == "0" || env == "no")
+	{
+		QSKIP(
+			"Benchmark skipped. Set env variable BENCHMARK=1 to enable."
+		);
+	}
+	QFETCH(
+		int,
+		count
+	);
+	QBuffer buffer;
+	buffer.open(
+		QIODevice::ReadWrite
+	);
+	{
+		QScopedPointer<Database> dbWrite(
+			new Database()
+		);
+		Group* group = nullptr;
+		for(int i = 0; i < count; i++)
+		{
+			if(i % 1000 == 0)
+			{
+				group = new Group();
+				group->setUuid(
+					UUID::random()
+				);
+				group->setParent(
+					dbWrite->getRootGroup()
+				);
+			}
+			Entry* entry = new Entry();
+			entry->setUUID(
+				UUID::random()
+			);
+			entry->setTitle(
+				QString("Entry %1").arg(
+					i
+				)
+			);
+			entry->setUsername(
+				"user"
+			);
+			entry->setURL(
+				QString("https://host%1.example.com/").arg(
+					i % 997
+				)
+			);
+			entry->setPassword(
+				QString::number(
+					i
+				)
+			);
+			entry->setGroup(
+				group
+			);
+		}
+		KeePass2XmlWriter writer;
+		writer.writeDatabase(
+			&buffer,
+			dbWrite.data()
+		);
+		QVERIFY(
+			!writer.hasError()
+		);
+	}
+	buffer.seek(
+		0
+	);
+	const qint64 before = residentBytes();
+	Database* dbRead = nullptr;
+	QBENCHMARK_ONCE
+	{
+		KeePass2XmlReader reader;
+		dbRead = reader.readDatabase(
+			&buffer
+		);
+		QVERIFY(
+			!reader.hasError()
+		);
+	}
+	QScopedPointer<Database> db(
+		dbRead
+	);
+	QVERIFY(
+		!db.isNull()
+	);
+	qInfo(
+		"%d entries: %lld KiB resident after load",
+		count,
+		(residentBytes() - before) / 1024
+	);
+}
+
 void TestKeePass2XmlReader::cleanupTestCase()
 {
 	delete m_db;
@@ -39,6 +39,8 @@ class TestKeePass2XmlReader:public QObject
 	void testEmptyUuids();
 	void testInvalidXmlChars();
 	void testRepairUuidHistoryItem();
+	void benchmarkLoad_data();
+	void benchmarkLoad();
 	void cleanupTestCase();
 private:
 	static QDateTime genDT(
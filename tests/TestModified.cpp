@@ -19,6 +19,7 @@
 #include <QTest>
 #include "core/Database.h"
 #include "core/Group.h"
+#include "core/ListDeleter.h"
 #include "core/Metadata.h"
 #include "core/Tools.h"
 #include "crypto/Crypto.h"
@@ -646,7 +647,6 @@ void TestModified::testHistoryItem()
 	attributes->copyCustomKeysFrom(
 		entry->getAttributes()
 	);
-	Entry* historyEntry;
 	int historyItemsSize = 0;
 	entry->beginUpdate();
 	entry->setTitle(
@@ -660,7 +660,7 @@ void TestModified::testHistoryItem()
 	);
 	entry->endUpdate();
 	QCOMPARE(
-		entry->getHistoryItems().size(),
+		entry->getHistoryCount(),
 		historyItemsSize
 	);
 	QDateTime modified = entry->getTimeInfo().getLastModificationTime();
@@ -673,10 +673,14 @@ void TestModified::testHistoryItem()
 	);
 	entry->endUpdate();
 	QCOMPARE(
-		entry->getHistoryItems().size(),
+		entry->getHistoryCount(),
 		++historyItemsSize
 	);
-	historyEntry = entry->getHistoryItems().at(
+	QList<Entry*> historyItems = entry->buildHistoryItems();
+	const ListDeleter<Entry*> historyDeleter(
+		&historyItems
+	);
+	const Entry* historyEntry = historyItems.at(
 		historyItemsSize - 1
 	);
 	QCOMPARE(
@@ -704,7 +708,7 @@ void TestModified::testHistoryItem()
 		modified
 	);
 	QCOMPARE(
-		historyEntry->getHistoryItems().size(),
+		historyEntry->getHistoryCount(),
 		0
 	);
 	entry->beginUpdate();
@@ -713,11 +717,15 @@ void TestModified::testHistoryItem()
 	);
 	entry->endUpdate();
 	QCOMPARE(
-		entry->getHistoryItems().size(),
+		entry->getHistoryCount(),
 		++historyItemsSize
 	);
+	QList<Entry*> tagsItems = entry->buildHistoryItems();
+	const ListDeleter<Entry*> tagsDeleter(
+		&tagsItems
+	);
 	QCOMPARE(
-		entry->getHistoryItems().at(historyItemsSize - 1)->getTags(),
+		tagsItems.at(historyItemsSize - 1)->getTags(),
 		QString("a")
 	);
 	entry->beginUpdate();
@@ -729,12 +737,16 @@ void TestModified::testHistoryItem()
 	);
 	entry->endUpdate();
 	QCOMPARE(
-		entry->getHistoryItems().size(),
+		entry->getHistoryCount(),
 		++historyItemsSize
 	);
+	QList<Entry*> attachmentItems = entry->buildHistoryItems();
+	const ListDeleter<Entry*> attachmentDeleter(
+		&attachmentItems
+	);
 	QCOMPARE(
-		entry->getHistoryItems().at(historyItemsSize - 1)->getAttachments()->
-		getKeys(). size(),
+		attachmentItems.at(historyItemsSize - 1)->getAttachments()->getKeys().
+		size(),
 		0
 	);
 	attributes->set(
@@ -747,12 +759,16 @@ void TestModified::testHistoryItem()
 	);
 	entry->endUpdate();
 	QCOMPARE(
-		entry->getHistoryItems().size(),
+		entry->getHistoryCount(),
 		++historyItemsSize
 	);
+	QList<Entry*> attributeItems = entry->buildHistoryItems();
+	const ListDeleter<Entry*> attributeDeleter(
+		&attributeItems
+	);
 	QVERIFY(
-		!entry->getHistoryItems().at(historyItemsSize - 1)->getAttributes()->
-		getKeys(). contains("k")
+		!attributeItems.at(historyItemsSize - 1)->getAttributes()->getKeys().
+		contains("k")
 	);
 	delete attributes;
 	delete entry;
@@ -764,7 +780,6 @@ void TestModified::testHistoryItem()
 	db->getMetadata()->setHistoryMaxSize(
 		-1
 	);
-	Entry* historyEntry2;
 	Entry* entry2 = new Entry();
 	entry2->setGroup(
 		root
@@ -785,7 +800,7 @@ void TestModified::testHistoryItem()
 	);
 	entry2->endUpdate();
 	QCOMPARE(
-		entry2->getHistoryItems().size(),
+		entry2->getHistoryCount(),
 		3
 	);
 	entry2->beginUpdate();
@@ -794,7 +809,7 @@ void TestModified::testHistoryItem()
 	);
 	entry2->endUpdate();
 	QCOMPARE(
-		entry2->getHistoryItems().size(),
+		entry2->getHistoryCount(),
 		3
 	);
 	db->getMetadata()->setHistoryMaxItems(
@@ -806,14 +821,15 @@ void TestModified::testHistoryItem()
 	);
 	entry2->endUpdate();
 	QCOMPARE(
-		entry2->getHistoryItems().size(),
+		entry2->getHistoryCount(),
 		1
 	);
-	historyEntry2 = entry2->getHistoryItems().at(
-		0
+	QList<Entry*> historyItems2 = entry2->buildHistoryItems();
+	const ListDeleter<Entry*> historyDeleter2(
+		&historyItems2
 	);
 	QCOMPARE(
-		historyEntry2->getTitle(),
+		historyItems2.at(0)->getTitle(),
 		QString("4")
 	);
 	db->getMetadata()->setHistoryMaxItems(
@@ -833,7 +849,7 @@ void TestModified::testHistoryItem()
 		entry2->endUpdate();
 	}
 	QCOMPARE(
-		entry2->getHistoryItems().size(),
+		entry2->getHistoryCount(),
 		41
 	);
 	db->getMetadata()->setHistoryMaxItems(
@@ -845,7 +861,7 @@ void TestModified::testHistoryItem()
 	);
 	entry2->endUpdate();
 	QCOMPARE(
-		entry2->getHistoryItems().size(),
+		entry2->getHistoryCount(),
 		0
 	);
 	db->getMetadata()->setHistoryMaxItems(
@@ -864,14 +880,15 @@ void TestModified::testHistoryItem()
 	);
 	entry2->endUpdate();
 	QCOMPARE(
-		entry2->getHistoryItems().size(),
+		entry2->getHistoryCount(),
 		1
 	);
-	historyEntry2 = entry2->getHistoryItems().at(
-		0
+	QList<Entry*> historyItems3 = entry2->buildHistoryItems();
+	const ListDeleter<Entry*> historyDeleter3(
+		&historyItems3
 	);
 	QCOMPARE(
-		historyEntry2->getTitle(),
+		historyItems3.at(0)->getTitle(),
 		QString("7")
 	);
 	entry2->beginUpdate();
@@ -880,7 +897,7 @@ void TestModified::testHistoryItem()
 	);
 	entry2->endUpdate();
 	QCOMPARE(
-		entry2->getHistoryItems().size(),
+		entry2->getHistoryCount(),
 		2
 	);
 	entry2->beginUpdate();
@@ -889,7 +906,7 @@ void TestModified::testHistoryItem()
 	);
 	entry2->endUpdate();
 	QCOMPARE(
-		entry2->getHistoryItems().size(),
+		entry2->getHistoryCount(),
 		0
 	);
 	entry2->beginUpdate();
@@ -902,7 +919,7 @@ void TestModified::testHistoryItem()
 	);
 	entry2->endUpdate();
 	QCOMPARE(
-		entry2->getHistoryItems().size(),
+		entry2->getHistoryCount(),
 		1
 	);
 	entry2->beginUpdate();
@@ -915,7 +932,7 @@ void TestModified::testHistoryItem()
 	);
 	entry2->endUpdate();
 	QCOMPARE(
-		entry2->getHistoryItems().size(),
+		entry2->getHistoryCount(),
 		2
 	);
 	entry2->beginUpdate();
@@ -928,7 +945,7 @@ void TestModified::testHistoryItem()
 	);
 	entry2->endUpdate();
 	QCOMPARE(
-		entry2->getHistoryItems().size(),
+		entry2->getHistoryCount(),
 		3
 	);
 	entry2->beginUpdate();
@@ -941,7 +958,7 @@ void TestModified::testHistoryItem()
 	);
 	entry2->endUpdate();
 	QCOMPARE(
-		entry2->getHistoryItems().size(),
+		entry2->getHistoryCount(),
 		4
 	);
 	Entry* entry3 = new Entry();
@@ -949,7 +966,7 @@ void TestModified::testHistoryItem()
 		root
 	);
 	QCOMPARE(
-		entry3->getHistoryItems().size(),
+		entry3->getHistoryCount(),
 		0
 	);
 	entry3->beginUpdate();
@@ -962,7 +979,7 @@ void TestModified::testHistoryItem()
 	);
 	entry3->endUpdate();
 	QCOMPARE(
-		entry3->getHistoryItems().size(),
+		entry3->getHistoryCount(),
 		1
 	);
 	entry3->beginUpdate();
@@ -975,7 +992,7 @@ void TestModified::testHistoryItem()
 	);
 	entry3->endUpdate();
 	QCOMPARE(
-		entry3->getHistoryItems().size(),
+		entry3->getHistoryCount(),
 		2
 	);
 	entry3->beginUpdate();
@@ -988,7 +1005,7 @@ void TestModified::testHistoryItem()
 	);
 	entry3->endUpdate();
 	QCOMPARE(
-		entry3->getHistoryItems().size(),
+		entry3->getHistoryCount(),
 		3
 	);
 	entry3->beginUpdate();
@@ -1001,7 +1018,143 @@ void TestModified::testHistoryItem()
 	);
 	entry3->endUpdate();
 	QCOMPARE(
-		entry3->getHistoryItems().size(),
+		entry3->getHistoryCount(),
+		2
+	);
+	delete db;
+}
+
+void TestModified::testTransaction()
+{
+	Database* db = new Database();
+	Group* root = db->getRootGroup();
+	Group* group1 = new Group();
+	group1->setParent(
+		root
+	);
+	Entry* entry1 = new Entry();
+	entry1->setGroup(
+		group1
+	);
+	QSignalSpy spyModified(
+		db,
+		&Database::sig_modifiedImmediate
+	);
+	QSignalSpy spyGroupModified(
+		db,
+		&Database::sig_groupModified
+	);
+	QSignalSpy spyEntryAdded(
+		db,
+		&Database::sig_entryAdded
+	);
+	QSignalSpy spyEntryModified(
+		db,
+		&Database::sig_entryModified
+	);
+	QSignalSpy spyGroupAboutToAdd(
+		db,
+		&Database::sig_groupAboutToAdd
+	);
+	QSignalSpy spyStarted(
+		db,
+		&Database::sig_transactionStarted
+	);
+	QSignalSpy spyCommitted(
+		db,
+		&Database::sig_transactionCommitted
+	);
+	db->beginTransaction();
+	db->beginTransaction();
+	QVERIFY(
+		db->isInTransaction()
+	);
+	Group* group2 = new Group();
+	group2->setParent(
+		root
+	);
+	for(int i = 0; i < 10; i++)
+	{
+		Entry* entry = new Entry();
+		entry->setGroup(
+			group2
+		);
+		entry->setTitle(
+			QString::number(
+				i
+			)
+		);
+	}
+	entry1->setTitle(
+		"title1"
+	);
+	entry1->setUsername(
+		"user1"
+	);
+	// an entry added and deleted inside the transaction is not reported
+	Entry* entry2 = new Entry();
+	entry2->setGroup(
+		group1
+	);
+	delete entry2;
+	db->commitTransaction();
+	QVERIFY(
+		db->isInTransaction()
+	);
+	QCOMPARE(
+		spyModified.count(),
+		0
+	);
+	QCOMPARE(
+		spyCommitted.count(),
+		0
+	);
+	db->commitTransaction();
+	QVERIFY(
+		!db->isInTransaction()
+	);
+	QCOMPARE(
+		spyStarted.count(),
+		1
+	);
+	QCOMPARE(
+		spyCommitted.count(),
+		1
+	);
+	QCOMPARE(
+		spyModified.count(),
+		1
+	);
+	QCOMPARE(
+		spyGroupAboutToAdd.count(),
+		0
+	);
+	// group1 and group2 once each, the new entries only as added
+	QCOMPARE(
+		spyGroupModified.count(),
+		2
+	);
+	QCOMPARE(
+		spyEntryAdded.count(),
+		10
+	);
+	QCOMPARE(
+		spyEntryModified.count(),
+		1
+	);
+	QCOMPARE(
+		group2->getEntries().size(),
+		10
+	);
+	QVERIFY(
+		db->isIndexConsistent()
+	);
+	// outside of a transaction every change is reported again
+	entry1->setTitle(
+		"title2"
+	);
+	QCOMPARE(
+		spyModified.count(),
 		2
 	);
 	delete db;
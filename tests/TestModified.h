@@ -26,5 +26,6 @@ class TestModified:public QObject
 	void testGroupSets();
 	void testEntrySets();
 	void testHistoryItem();
+	void testTransaction();
 };
 #endif // KEEPASSX_TESTMODIFIED_H
@@ -398,6 +398,63 @@ void TestSymmetricCipher::testSalsa20()
 	);
 }
 
+void TestSymmetricCipher::testChaCha20()
+{
+	// RFC 8439 A.1, test vector #1
+	bool ok;
+	SymmetricCipher cipher(
+		SymmetricCipher::ChaCha20,
+		SymmetricCipher::Stream,
+		SymmetricCipher::Encrypt
+	);
+	QVERIFY(
+		cipher.init(QByteArray(32, '\0'), QByteArray(12, '\0'))
+	);
+	QCOMPARE(
+		cipher.process(QByteArray(64, '\0'), &ok),
+		QByteArray::fromHex(
+			"76b8e0ada0f13d90405d6ae55386bd28bdd219b8a08ded1aa836efcc8b770dc7"
+			"da41597c5157488d7724e03fb8d84a376a43b8f41518a11cc387b669b2ee6586")
+	);
+	QVERIFY(
+		ok
+	);
+	// RFC 8439 2.4.2, the example starts at block counter 1
+	QByteArray key;
+	for(int i = 0; i < 32; i++)
+	{
+		key.append(
+			static_cast<char>(i)
+		);
+	}
+	SymmetricCipher cipher2(
+		SymmetricCipher::ChaCha20,
+		SymmetricCipher::Stream,
+		SymmetricCipher::Encrypt
+	);
+	QVERIFY(
+		cipher2.init(key, QByteArray::fromHex("000000000000004a00000000"))
+	);
+	cipher2.process(
+		QByteArray(
+			64,
+			'\0'
+		),
+		&ok
+	);
+	QVERIFY(
+		ok
+	);
+	QCOMPARE(
+		cipher2.process(QByteArray("Ladies and Gentl"), &ok),
+		QByteArray::fromHex(
+			"6e2e359a2568f98041ba0728dd0d6981")
+	);
+	QVERIFY(
+		ok
+	);
+}
+
 void TestSymmetricCipher::testPadding()
 {
 	QByteArray key = QByteArray::fromHex(
@@ -25,6 +25,7 @@ class TestSymmetricCipher:public QObject
 	void testAes256CbcEncryption();
 	void testAes256CbcDecryption();
 	void testSalsa20();
+	void testChaCha20();
 	void testPadding();
 	void testStreamReset();
 };
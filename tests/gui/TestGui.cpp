@@ -263,7 +263,7 @@ void TestGui::testAddEntry()
 		QString("test")
 	);
 	QCOMPARE(
-		entry->getHistoryItems().size(),
+		entry->getHistoryCount(),
 		0
 	);
 	// wait for modified timer
@@ -309,7 +309,7 @@ void TestGui::testAddEntry()
 		QString("testsomething")
 	);
 	QCOMPARE(
-		entry->getHistoryItems().size(),
+		entry->getHistoryCount(),
 		1
 	);
 	QTest::mouseClick(